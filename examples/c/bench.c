@@ -0,0 +1,214 @@
+#include "scs.h"
+#include "linsys/amatrix.h"
+#include "problemUtils.h"
+
+/*
+ benchmark harness, run by 'make bench': solves a fixed set of random problems of each cone family (LP, SOC,
+ exponential and, with LAPACK, SD) at several sizes and densities, from genRandomProbData with fixed seeds so
+ every run solves the same problems. Each problem is solved cold (scs_init and scs_solve), then warm-started
+ from the previous solution with b and c rescaled, re-using the workspace. One record per solve is written as
+ CSV or JSON, with the setup, solve and per-phase times (milli-seconds), iterations and CG iterations, and for
+ the direct solvers the fill of the factorization (nonzeros below the diagonal of L and the height of the
+ elimination tree) of the ordering given by -amd (default) or -nd.
+ */
+
+#ifndef BENCH_BACKEND
+#define BENCH_BACKEND "unknown"
+#endif
+
+#define NUM_WARM_TRIALS 3 /* warm-started solves of each problem: 3 */
+
+typedef enum {
+	LP, SOC, EXP, SDP
+} Family;
+
+static const char * FAMILY_NAMES[] = { "lp", "soc", "exp", "sdp" };
+
+/* the cones of a problem of family fam with m rows, 10% zero cone */
+static void setCones(Family fam, idxint m, Cone * k) {
+	idxint rest, i;
+	memset(k, 0, sizeof(Cone));
+	k->f = m / 10;
+	rest = m - k->f;
+	switch (fam) {
+	case LP:
+		k->l = rest;
+		break;
+	case SOC:
+		/* a third LP, the rest in second-order cones of 10 to 50 rows */
+		k->l = rest / 3;
+		rest -= k->l;
+		k->q = scs_malloc((rest / 10 + 1) * sizeof(idxint));
+		for (i = 0; rest > 0; ++i) {
+			idxint size = 10 + rand() % 41; /* not in MIN, which would draw twice */
+			k->q[i] = MIN(rest, size);
+			rest -= k->q[i];
+		}
+		k->qsize = i;
+		break;
+	case EXP:
+		/* a third LP, the rest primal and dual exponential cones */
+		k->ep = rest / 3 / 3;
+		k->ed = rest / 3 / 3;
+		k->l = rest - 3 * (k->ep + k->ed);
+		break;
+	case SDP:
+		/* a third LP, the rest 10 by 10 semidefinite cones (full, 100 rows) */
+		k->ssize = rest * 2 / 3 / 100;
+		k->s = scs_malloc(MAX(k->ssize, 1) * sizeof(idxint));
+		for (i = 0; i < k->ssize; ++i) {
+			k->s[i] = 10;
+		}
+		k->l = rest - 100 * k->ssize;
+		break;
+	}
+}
+
+static void setParams(Data * d, idxint ordering) {
+	d->MAX_ITERS = 2500;
+	d->EPS = 1e-3;
+	d->ALPHA = 1.8;
+	d->RHO_X = 1e-3;
+	d->SCALE = 5;
+	d->CG_RATE = 2;
+	d->VERBOSE = 0;
+	d->NORMALIZE = 1;
+	d->WARM_START = 0;
+	d->ORDERING = ordering;
+}
+
+static void writeRecord(FILE * fp, idxint json, idxint * first, Family fam, Data * d, idxint seed, const char * mode,
+		idxint trial, Info * info) {
+	const Profile * p = &(info->prof);
+	if (json) {
+		fprintf(fp, "%s\n  {\"backend\": \"%s\", \"family\": \"%s\", \"m\": %li, \"n\": %li, \"nnz\": %li, "
+				"\"seed\": %li, \"mode\": \"%s\", \"trial\": %li, \"status\": \"%s\", \"iter\": %li, "
+				"\"linSysIters\": %li, \"setupTime\": %.6g, \"solveTime\": %.6g, \"normalizeTime\": %.6g, "
+				"\"kktTime\": %.6g, \"orderTime\": %.6g, \"factorTime\": %.6g, \"linSysTime\": %.6g, "
+				"\"coneTime\": %.6g, \"convergedTime\": %.6g, \"avgIterTime\": %.6g, \"maxIterTime\": %.6g, "
+				"\"ordering\": %li, \"lnz\": %.0f, \"treeHeight\": %li}",
+				*first ? "" : ",", BENCH_BACKEND, FAMILY_NAMES[fam], (long) d->m, (long) d->n,
+				(long) d->A->p[d->n], (long) seed, mode, (long) trial, info->status, (long) info->iter,
+				(long) info->linSysIters, info->setupTime, info->solveTime, p->normalizeTime, p->kktTime,
+				p->orderTime, p->factorTime, p->linSysTime, p->coneTime, p->convergedTime, p->avgIterTime,
+				p->maxIterTime, (long) p->ordering, p->lnz, (long) p->treeHeight);
+	} else {
+		if (*first) {
+			fprintf(fp, "backend,family,m,n,nnz,seed,mode,trial,status,iter,linSysIters,setupTime,solveTime,"
+					"normalizeTime,kktTime,orderTime,factorTime,linSysTime,coneTime,convergedTime,avgIterTime,"
+					"maxIterTime,ordering,lnz,treeHeight\n");
+		}
+		fprintf(fp, "%s,%s,%li,%li,%li,%li,%s,%li,%s,%li,%li,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,"
+				"%.6g,%li,%.0f,%li\n", BENCH_BACKEND, FAMILY_NAMES[fam], (long) d->m, (long) d->n, (long) d->A->p[d->n],
+				(long) seed, mode, (long) trial, info->status, (long) info->iter, (long) info->linSysIters,
+				info->setupTime, info->solveTime, p->normalizeTime, p->kktTime, p->orderTime, p->factorTime,
+				p->linSysTime, p->coneTime, p->convergedTime, p->avgIterTime, p->maxIterTime, (long) p->ordering,
+				p->lnz, (long) p->treeHeight);
+	}
+	*first = 0;
+	fflush(fp);
+}
+
+/* solves one problem cold and NUM_WARM_TRIALS times warm, writing a record for each */
+static idxint benchProblem(FILE * fp, idxint json, idxint * first, Family fam, idxint n, idxint colNnz,
+		idxint seed, idxint ordering) {
+	Cone * k = scs_calloc(1, sizeof(Cone));
+	Data * d = scs_calloc(1, sizeof(Data));
+	Sol * sol = scs_calloc(1, sizeof(Sol));
+	Sol * optSol = scs_calloc(1, sizeof(Sol));
+	Info info = { 0 };
+	Work * w;
+	idxint i;
+
+	srand((unsigned) seed);
+	d->n = n;
+	d->m = 3 * n;
+	setCones(fam, d->m, k);
+	genRandomProbData(n * colNnz, colNnz, d, k, optSol);
+	setParams(d, ordering);
+
+	/* cold: a fresh workspace, setup time includes normalization and factorization */
+	w = scs_init(d, k, &info);
+	if (!w) {
+		freeData(d, k);
+		freeSol(sol);
+		freeSol(optSol);
+		return -1;
+	}
+	scs_solve(w, d, k, sol, &info);
+	writeRecord(fp, json, first, fam, d, seed, "cold", 0, &info);
+
+	/* warm: same workspace, b and c rescaled (which keeps the problem feasible, unlike perturbVector, the
+	 solution rescales with them), started from the last solution */
+	d->WARM_START = 1;
+	for (i = 0; i < NUM_WARM_TRIALS; ++i) {
+		scaleArray(d->b, 1 + 0.01 * rand_gauss(), d->m);
+		scaleArray(d->c, 1 + 0.01 * rand_gauss(), d->n);
+		info.setupTime = 0; /* nothing is set up again */
+		scs_solve(w, d, k, sol, &info);
+		writeRecord(fp, json, first, fam, d, seed, "warm", i + 1, &info);
+	}
+	scs_finish(d, w);
+	freeData(d, k);
+	freeSol(sol);
+	freeSol(optSol);
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	/* sizes (n, A is 3n by n) and nonzeros per column (the sparsity), the -quick run takes the first of each */
+	static const idxint SIZES[] = { 300, 1000, 3000 };
+	static const idxint DENSITIES[] = { 5, 20 };
+	idxint numSizes = 3, numDensities = 2, numFamilies = 4;
+	idxint json = 0, first = 1, fam, i, j, argi, failed = 0, ordering = ORDER_AMD;
+	FILE * fp;
+
+	for (argi = 1; argi < argc && argv[argi][0] == '-'; ++argi) {
+		if (strcmp(argv[argi], "-json") == 0) {
+			json = 1;
+		} else if (strcmp(argv[argi], "-csv") == 0) {
+			json = 0;
+		} else if (strcmp(argv[argi], "-amd") == 0) {
+			ordering = ORDER_AMD;
+		} else if (strcmp(argv[argi], "-nd") == 0) {
+			ordering = ORDER_ND;
+		} else if (strcmp(argv[argi], "-quick") == 0) {
+			numSizes = 1;
+			numDensities = 1;
+		} else {
+			break;
+		}
+	}
+	if (argi != argc - 1) {
+		scs_printf("usage:\t%s [-csv|-json] [-amd|-nd] [-quick] out_file\n"
+				"\tsolves the benchmark problems with the %s solver and writes the results to out_file\n", argv[0],
+				BENCH_BACKEND);
+		return 1;
+	}
+	fp = fopen(argv[argi], "w");
+	if (!fp) {
+		scs_printf("could not open %s\n", argv[argi]);
+		return 1;
+	}
+#ifndef LAPACK_LIB_FOUND
+	numFamilies = 3; /* no SD cones without LAPACK */
+#endif
+	if (json)
+		fprintf(fp, "[");
+	for (fam = 0; fam < numFamilies; ++fam) {
+		for (i = 0; i < numSizes; ++i) {
+			for (j = 0; j < numDensities; ++j) {
+				/* the seed identifies the problem, so records of different runs can be matched */
+				idxint seed = 1000 * (fam + 1) + 10 * i + j;
+				if (benchProblem(fp, json, &first, (Family) fam, SIZES[i], DENSITIES[j], seed, ordering) < 0) {
+					scs_printf("setup failed for %s problem with seed %li\n", FAMILY_NAMES[fam], (long) seed);
+					failed++;
+				}
+			}
+		}
+	}
+	if (json)
+		fprintf(fp, "\n]\n");
+	fclose(fp);
+	return failed ? 1 : 0;
+}
@@ -1,6 +1,7 @@
 #include "scs.h"
 #include "linsys/amatrix.h"
 #include "problemUtils.h"
+#include "rw.h"
 
 #ifndef DEMO_PATH
 #define DEMO_PATH "examples/raw/demo_data"
@@ -9,8 +10,10 @@
 #define NUM_TRIALS 5
 #define RHOX 1e-3
 #define TEST_WARM_START 1
+#define TEST_UPDATE_A 1
 
 idxint read_in_data(FILE * fp, Data * d, Cone * k);
+idxint is_binary_file(FILE * fp);
 idxint open_file(idxint argc, char ** argv, idxint idx, char * default_file, FILE ** fb);
 /* void printSol(Data * d, Sol * sol, Info * info); */
 
@@ -22,19 +25,35 @@ int main(int argc, char **argv) {
 	Sol * sol;
 	Info info = { 0 };
 	idxint i;
+	DataFile * df = NULL; /* the data if read from a binary file */
 
 	if (open_file(argc, argv, 1, DEMO_PATH, &fp) < 0)
 		return -1;
 
-	k = scs_calloc(1, sizeof(Cone));
-	d = scs_calloc(1, sizeof(Data));
 	sol = scs_calloc(1, sizeof(Sol));
-
-	if (read_in_data(fp, d, k) == -1) {
-		printf("Error reading in data, aborting.\n");
-		return -1;
+	if (is_binary_file(fp)) {
+		fclose(fp);
+		df = scs_read_data(argv[1], 1, &d, &k, NULL);
+		if (!df) {
+			printf("Error reading in data, aborting.\n");
+			return -1;
+		}
+		d->VERBOSE = 1;
+	} else {
+		k = scs_calloc(1, sizeof(Cone));
+		d = scs_calloc(1, sizeof(Data));
+		if (read_in_data(fp, d, k) == -1) {
+			printf("Error reading in data, aborting.\n");
+			return -1;
+		}
+		fclose(fp);
+	}
+	/* a second argument names a binary file to write the data to, e.g. to convert a text file */
+	if (argc > 2) {
+		if (scs_write_data(argv[2], d, k, NULL) < 0)
+			return -1;
+		scs_printf("wrote the data to %s\n", argv[2]);
 	}
-	fclose(fp);
 	scs_printf("solve once using scs\n");
 	d->CG_RATE = 2;
 	scs(d, k, sol, &info);
@@ -58,11 +77,37 @@ int main(int argc, char **argv) {
 		scs_printf("finished\n");
 		scs_finish(d, w);
 	}
-	freeData(d, k);
+	if (TEST_UPDATE_A) {
+		scs_printf("solve %i times with perturbed A, re-using the symbolic factorization.\n", NUM_TRIALS);
+		w = scs_init(d, k, &info);
+		if (w) {
+			for (i = 0; i < NUM_TRIALS; i++) {
+				/* scs never rewrites d->A, so its values may be perturbed in place */
+				perturbVector(d->A->x, d->A->p[d->n]);
+				if (scs_update_A(w, d, k, d->A->x) < 0)
+					break;
+				scs_solve(w, d, k, sol, &info);
+			}
+		}
+		scs_printf("finished\n");
+		scs_finish(d, w);
+	}
+	if (df)
+		scs_free_data_file(df);
+	else
+		freeData(d, k);
 	freeSol(sol);
 	return 0;
 }
 
+/* whether fp, at its start, holds a file of scs_write_data, leaves fp at its start */
+idxint is_binary_file(FILE * fp) {
+	char magic[8];
+	idxint binary = fread(magic, 1, 8, fp) == 8 && memcmp(magic, SCS_DATA_MAGIC, 8) == 0;
+	rewind(fp);
+	return binary;
+}
+
 idxint read_in_data(FILE * fp, Data * d, Cone * k) {
 	/* MATRIX IN DATA FILE MUST BE IN COLUMN COMPRESSED FORMAT */
 #define LEN64 64 /* variable-size arrays not allowed in ansi */
@@ -109,39 +154,39 @@ idxint read_in_data(FILE * fp, Data * d, Cone * k) {
 		return -1;
 	if (fscanf(fp, FLOATRW, &(d->EPS)) != 1)
 		return -1;
-	k->q = malloc(sizeof(idxint) * k->qsize);
+	k->q = scs_malloc(sizeof(idxint) * k->qsize);
 	for (i = 0; i < k->qsize; i++) {
 		if (fscanf(fp, INTRW, &k->q[i]) != 1)
 			return -1;
 	}
-	k->s = malloc(sizeof(idxint) * k->ssize);
+	k->s = scs_malloc(sizeof(idxint) * k->ssize);
 	for (i = 0; i < k->ssize; i++) {
 		if (fscanf(fp, INTRW, &k->s[i]) != 1)
 			return -1;
 	}
-	d->b = malloc(sizeof(pfloat) * d->m);
+	d->b = scs_malloc(sizeof(pfloat) * d->m);
 	for (i = 0; i < d->m; i++) {
 		if (fscanf(fp, FLOATRW, &d->b[i]) != 1)
 			return -1;
 	}
-	d->c = malloc(sizeof(pfloat) * d->n);
+	d->c = scs_malloc(sizeof(pfloat) * d->n);
 	for (i = 0; i < d->n; i++) {
 		if (fscanf(fp, FLOATRW, &d->c[i]) != 1)
 			return -1;
 	}
-	A = malloc(sizeof(AMatrix));
-	A->p = malloc(sizeof(idxint) * (d->n + 1));
+	A = scs_malloc(sizeof(AMatrix));
+	A->p = scs_malloc(sizeof(idxint) * (d->n + 1));
 	for (i = 0; i < d->n + 1; i++) {
 		if (fscanf(fp, INTRW, &A->p[i]) != 1)
 			return -1;
 	}
 	Anz = A->p[d->n];
-	A->i = malloc(sizeof(idxint) * Anz);
+	A->i = scs_malloc(sizeof(idxint) * Anz);
 	for (i = 0; i < Anz; i++) {
 		if (fscanf(fp, INTRW, &A->i[i]) != 1)
 			return -1;
 	}
-	A->x = malloc(sizeof(pfloat) * Anz);
+	A->x = scs_malloc(sizeof(pfloat) * Anz);
 	for (i = 0; i < Anz; i++) {
 		if (fscanf(fp, FLOATRW, &A->x[i]) != 1)
 			return -1;
@@ -0,0 +1,164 @@
+#include "scs.h"
+#include "linsys/matfree/amatrix.h"
+#include <time.h> /* to seed random */
+
+/*
+ isotonic regression with the matrix-free solver:
+
+ minimize 	    t
+ subject to 	x_1 <= x_2 <= ... <= x_n, ||x - y||_2 <= t
+
+ in the form Ax <=_K b the variables are (x, t) and A stacks n - 1 differences (LP cone) over
+ -t and -x (one second-order cone), it is applied by the two products below and never formed.
+ The solution is checked against the pool adjacent violators algorithm.
+ */
+
+typedef struct {
+	idxint n;
+} Isotonic;
+
+/* y += A * x */
+static void isoAccumA(void * op, const pfloat * x, pfloat * y) {
+	idxint i, n = ((Isotonic *) op)->n;
+	for (i = 0; i < n - 1; ++i) {
+		y[i] += x[i] - x[i + 1];
+	}
+	y[n - 1] -= x[n];
+	for (i = 0; i < n; ++i) {
+		y[n + i] -= x[i];
+	}
+}
+
+/* y += A' * x */
+static void isoAccumAtrans(void * op, const pfloat * x, pfloat * y) {
+	idxint i, n = ((Isotonic *) op)->n;
+	for (i = 0; i < n; ++i) {
+		y[i] -= x[n + i];
+	}
+	for (i = 0; i < n - 1; ++i) {
+		y[i] += x[i];
+		y[i + 1] -= x[i];
+	}
+	y[n] -= x[n - 1];
+}
+
+/* isotonic fit of y by pool adjacent violators, in x */
+static void pava(const pfloat * y, pfloat * x, idxint n) {
+	idxint i, j, nb = 0;
+	idxint * len = scs_malloc(n * sizeof(idxint));
+	pfloat * mean = scs_malloc(n * sizeof(pfloat));
+	for (i = 0; i < n; ++i) {
+		mean[nb] = y[i];
+		len[nb] = 1;
+		while (nb > 0 && mean[nb - 1] > mean[nb]) {
+			mean[nb - 1] = (mean[nb - 1] * len[nb - 1] + mean[nb] * len[nb]) / (len[nb - 1] + len[nb]);
+			len[nb - 1] += len[nb];
+			nb--;
+		}
+		nb++;
+	}
+	for (i = 0, j = 0; j < nb; ++j) {
+		for (; len[j] > 0; --len[j]) {
+			x[i++] = mean[j];
+		}
+	}
+	scs_free(len);
+	scs_free(mean);
+}
+
+int main(int argc, char **argv) {
+	idxint n, i;
+	Isotonic op;
+	Cone * k;
+	Data * d;
+	Sol * sol;
+	Info info = { 0 };
+	pfloat * y, *xIso, err = 0;
+	int seed = time(NULL);
+
+	switch (argc) {
+	case 3:
+		seed = atoi(argv[2]);
+		/* no break */
+	case 2:
+		n = atoi(argv[1]);
+		break;
+	default:
+		scs_printf("usage:\t%s n s\n"
+				"\tsolves an isotonic regression of n noisy samples of an increasing function\n"
+				"\twith the matrix-free solver, the random number generator is seeded with s.\n", argv[0]);
+		return 0;
+	}
+	if (n < 2) {
+		scs_printf("error: n must be at least 2!\n");
+		return 1;
+	}
+	srand(seed);
+	scs_printf("seed : %i\n", seed);
+
+	op.n = n;
+	k = scs_calloc(1, sizeof(Cone));
+	d = scs_calloc(1, sizeof(Data));
+	sol = scs_calloc(1, sizeof(Sol));
+	d->A = scs_calloc(1, sizeof(AMatrix));
+	y = scs_malloc(n * sizeof(pfloat));
+	xIso = scs_malloc(n * sizeof(pfloat));
+
+	d->n = n + 1;
+	d->m = 2 * n;
+	d->b = scs_calloc(d->m, sizeof(pfloat));
+	d->c = scs_calloc(d->n, sizeof(pfloat));
+	d->c[n] = 1;
+	for (i = 0; i < n; ++i) {
+		y[i] = (pfloat) i / n + 0.3 * ((pfloat) rand() / RAND_MAX - 0.5);
+		d->b[n + i] = -y[i];
+	}
+	k->l = n - 1;
+	k->qsize = 1;
+	k->q = scs_malloc(sizeof(idxint));
+	k->q[0] = n + 1;
+
+	d->A->accumA = isoAccumA;
+	d->A->accumAtrans = isoAccumAtrans;
+	d->A->op = &op;
+	d->A->colNorms = scs_malloc(d->n * sizeof(pfloat));
+	for (i = 0; i < n; ++i) {
+		d->A->colNorms[i] = SQRTF((pfloat) (1 + (i > 0) + (i < n - 1)));
+	}
+	d->A->colNorms[n] = 1;
+
+	d->MAX_ITERS = 2500;
+	d->EPS = 1e-4;
+	d->ALPHA = 1.8;
+	d->RHO_X = 1e-3;
+	d->SCALE = 5;
+	d->CG_RATE = 2;
+	d->VERBOSE = 1;
+	d->NORMALIZE = 1;
+
+	scs(d, k, sol, &info);
+
+	pava(y, xIso, n);
+	for (i = 0; i < n && sol->x; ++i) {
+		err = MAX(err, ABS(sol->x[i] - xIso[i]));
+	}
+	scs_printf("max deviation from the pool adjacent violators fit: %4e\n", err);
+
+	scs_free(d->A->colNorms);
+	scs_free(d->A);
+	scs_free(d->b);
+	scs_free(d->c);
+	scs_free(d);
+	scs_free(k->q);
+	scs_free(k);
+	if (sol->x)
+		scs_free(sol->x);
+	if (sol->y)
+		scs_free(sol->y);
+	if (sol->s)
+		scs_free(sol->s);
+	scs_free(sol);
+	scs_free(y);
+	scs_free(xIso);
+	return 0;
+}
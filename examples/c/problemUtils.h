@@ -103,6 +103,7 @@ void genRandomProbData(idxint nnz, idxint col_nnz, Data * d, Cone * k, Sol * opt
 	pfloat * s = opt_sol->s = scs_calloc(m, sizeof(pfloat));
 	/* temporary variables */
 	pfloat * z = scs_calloc(m, sizeof(pfloat));
+	ConeWork * coneWork = initCone(k);
 	idxint i, j, r;
 
 	A->i = scs_calloc(nnz, sizeof(idxint));
@@ -114,7 +115,8 @@ void genRandomProbData(idxint nnz, idxint col_nnz, Data * d, Cone * k, Sol * opt
 		y[i] = z[i] = rand_pfloat();
 	}
 
-	projDualCone(y, k, NULL, -1);
+	projDualCone(y, k, coneWork, NULL, -1);
+	finishCone(coneWork);
 
 	for (i = 0; i < m; i++) {
 		b[i] = s[i] = y[i] - z[i];
@@ -0,0 +1,111 @@
+#include "scs.h"
+#include "linsys/dense/amatrix.h"
+#include <time.h> /* to seed random */
+
+/*
+ the random SOCP of randomSOCPProb.c with a dense A for the dense solver, run as e.g.
+
+ out/demo_dense n seed
+
+ A is 3n by n with all entries drawn, the problem is built primal and dual feasible with a known optimum.
+ */
+
+/* uniform random number in [-1,1] */
+static pfloat rand_pfloat(void) {
+	return 2 * (((pfloat) rand()) / RAND_MAX) - 1;
+}
+
+static void setScsParams(Data * d) {
+	d->MAX_ITERS = 2500;
+	d->EPS = 1e-3;
+	d->ALPHA = 1.8;
+	d->RHO_X = 1e-3;
+	d->SCALE = 5;
+	d->VERBOSE = 1;
+	d->NORMALIZE = 1;
+}
+
+int main(int argc, char **argv) {
+	idxint n, m, i, j, q_num_rows, max_q;
+	Cone * k;
+	Data * d;
+	AMatrix * A;
+	Sol sol = { 0 };
+	Info info = { 0 };
+	pfloat * x, * y, * z;
+	ConeWork * coneWork;
+	int seed;
+
+	n = argc > 1 ? atoi(argv[1]) : 500;
+	seed = argc > 2 ? atoi(argv[2]) : (int) time(NULL);
+	srand(seed);
+
+	k = scs_calloc(1, sizeof(Cone));
+	d = scs_calloc(1, sizeof(Data));
+	A = d->A = scs_calloc(1, sizeof(AMatrix));
+	m = d->m = 3 * n;
+	d->n = n;
+	max_q = (idxint) ceil(3 * n / log(3 * n));
+	k->f = (idxint) floor(3 * n * 0.1);
+	k->l = (idxint) floor(3 * n * 0.3);
+	q_num_rows = m - k->f - k->l;
+	k->q = scs_malloc(q_num_rows * sizeof(idxint));
+	while (q_num_rows > max_q) {
+		k->q[k->qsize] = (rand() % max_q) + 1;
+		q_num_rows -= k->q[k->qsize++];
+	}
+	if (q_num_rows > 0) {
+		k->q[k->qsize++] = q_num_rows;
+	}
+
+	/* y, s >= 0 and y'*s = 0, b = A*x + s and c = -A'*y */
+	d->b = scs_calloc(m, sizeof(pfloat));
+	d->c = scs_calloc(n, sizeof(pfloat));
+	x = scs_calloc(n, sizeof(pfloat));
+	y = scs_calloc(m, sizeof(pfloat));
+	z = scs_calloc(m, sizeof(pfloat));
+	for (i = 0; i < m; i++) {
+		y[i] = z[i] = rand_pfloat();
+	}
+	coneWork = initCone(k);
+	projDualCone(y, k, coneWork, NULL, -1);
+	finishCone(coneWork);
+	for (i = 0; i < m; i++) {
+		d->b[i] = y[i] - z[i];
+	}
+	for (j = 0; j < n; j++) {
+		x[j] = rand_pfloat();
+	}
+	A->x = scs_malloc(m * n * sizeof(pfloat));
+	for (j = 0; j < n; j++) {
+		for (i = 0; i < m; i++) {
+			A->x[i + j * m] = rand_pfloat();
+			d->b[i] += A->x[i + j * m] * x[j];
+			d->c[j] -= A->x[i + j * m] * y[i];
+		}
+	}
+	setScsParams(d);
+	scs_printf("seed : %i\n", seed);
+
+	scs(d, k, &sol, &info);
+	scs_printf("true pri opt = %4f\n", innerProd(d->c, x, n));
+	scs_printf("true dua opt = %4f\n", -innerProd(d->b, y, m));
+
+	scs_free(x);
+	scs_free(y);
+	scs_free(z);
+	if (sol.x)
+		scs_free(sol.x);
+	if (sol.y)
+		scs_free(sol.y);
+	if (sol.s)
+		scs_free(sol.s);
+	scs_free(A->x);
+	scs_free(A);
+	scs_free(d->b);
+	scs_free(d->c);
+	scs_free(d);
+	scs_free(k->q);
+	scs_free(k);
+	return 0;
+}
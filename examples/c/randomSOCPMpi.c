@@ -0,0 +1,140 @@
+#include "scs.h"
+#include "linsys/mpi/amatrix.h"
+#include <mpi.h>
+#include <time.h> /* to seed random */
+
+/*
+ the random SOCP of randomSOCPProb.c with the MPI solver, run as e.g.
+
+ mpirun -np 4 out/demo_SOCP_mpi n seed
+
+ every rank draws the same problem from the seed (rank 0's, broadcast) but keeps only the entries of A in its own
+ block of rows, b and c are whole on every rank. Rank 0 prints the progress and the true optimum.
+ */
+
+/* uniform random number in [-1,1] */
+static pfloat rand_pfloat(void) {
+	return 2 * (((pfloat) rand()) / RAND_MAX) - 1;
+}
+
+static void setScsParams(Data * d, int rank) {
+	d->MAX_ITERS = 2500;
+	d->EPS = 1e-3;
+	d->ALPHA = 1.8;
+	d->RHO_X = 1e-3;
+	d->SCALE = 5;
+	d->CG_RATE = 2;
+	d->VERBOSE = rank == 0; /* every rank runs the same iterations, one report is enough */
+	d->NORMALIZE = 1;
+	d->TIME_LIMIT = 0; /* the clocks of the ranks differ, a time limit could stop them at different iterations */
+}
+
+int main(int argc, char **argv) {
+	idxint n, m, col_nnz, nnz, i, j, r, q_num_rows, max_q;
+	Cone * k;
+	Data * d;
+	AMatrix * A;
+	Sol sol = { 0 };
+	Info info = { 0 };
+	pfloat * x, * y, * z, v;
+	ConeWork * coneWork;
+	int rank, seed;
+
+	MPI_Init(&argc, &argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	n = argc > 1 ? atoi(argv[1]) : 1000;
+	seed = argc > 2 ? atoi(argv[2]) : (int) time(NULL);
+	MPI_Bcast(&seed, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	srand(seed);
+
+	k = scs_calloc(1, sizeof(Cone));
+	d = scs_calloc(1, sizeof(Data));
+	A = d->A = scs_calloc(1, sizeof(AMatrix));
+	m = d->m = 3 * n;
+	d->n = n;
+	col_nnz = (idxint) ceil(sqrt(n));
+	nnz = n * col_nnz;
+	max_q = (idxint) ceil(3 * n / log(3 * n));
+	k->f = (idxint) floor(3 * n * 0.1);
+	k->l = (idxint) floor(3 * n * 0.3);
+	q_num_rows = m - k->f - k->l;
+	k->q = scs_malloc(q_num_rows * sizeof(idxint));
+	while (q_num_rows > max_q) {
+		k->q[k->qsize] = (rand() % max_q) + 1;
+		q_num_rows -= k->q[k->qsize++];
+	}
+	if (q_num_rows > 0) {
+		k->q[k->qsize++] = q_num_rows;
+	}
+	scs_mpi_rows(k, m, &(A->r0), &(A->r1));
+
+	/* y, s >= 0 and y'*s = 0, b = A*x + s and c = -A'*y */
+	d->b = scs_calloc(m, sizeof(pfloat));
+	d->c = scs_calloc(n, sizeof(pfloat));
+	x = scs_calloc(n, sizeof(pfloat));
+	y = scs_calloc(m, sizeof(pfloat));
+	z = scs_calloc(m, sizeof(pfloat));
+	for (i = 0; i < m; i++) {
+		y[i] = z[i] = rand_pfloat();
+	}
+	coneWork = initCone(k);
+	projDualCone(y, k, coneWork, NULL, -1);
+	finishCone(coneWork);
+	for (i = 0; i < m; i++) {
+		d->b[i] = y[i] - z[i];
+	}
+	for (j = 0; j < n; j++) {
+		x[j] = rand_pfloat();
+	}
+	/* all of A is drawn, to keep the random sequence of the ranks alike, but only the block is stored */
+	A->i = scs_malloc(nnz * sizeof(idxint));
+	A->x = scs_malloc(nnz * sizeof(pfloat));
+	A->p = scs_malloc((n + 1) * sizeof(idxint));
+	A->p[0] = 0;
+	for (j = 0; j < n; j++) {
+		A->p[j + 1] = A->p[j];
+		for (r = 0; r < col_nnz; r++) {
+			i = rand() % m;
+			v = rand_pfloat();
+			d->b[i] += v * x[j];
+			d->c[j] -= v * y[i];
+			if (i >= A->r0 && i < A->r1) {
+				A->i[A->p[j + 1]] = i;
+				A->x[A->p[j + 1]++] = v;
+			}
+		}
+	}
+	setScsParams(d, rank);
+	if (rank == 0) {
+		scs_printf("seed : %i\n", seed);
+		scs_printf("A is %ld by %ld with %ld nonzeros, rank 0 holds rows %ld to %ld\n", (long) m, (long) n, (long) nnz,
+				(long) A->r0, (long) A->r1 - 1);
+	}
+
+	scs(d, k, &sol, &info);
+	if (rank == 0) {
+		scs_printf("true pri opt = %4f\n", innerProd(d->c, x, n));
+		scs_printf("true dua opt = %4f\n", -innerProd(d->b, y, m));
+	}
+
+	scs_free(x);
+	scs_free(y);
+	scs_free(z);
+	if (sol.x)
+		scs_free(sol.x);
+	if (sol.y)
+		scs_free(sol.y);
+	if (sol.s)
+		scs_free(sol.s);
+	scs_free(A->i);
+	scs_free(A->x);
+	scs_free(A->p);
+	scs_free(A);
+	scs_free(d->b);
+	scs_free(d->c);
+	scs_free(d);
+	scs_free(k->q);
+	scs_free(k);
+	MPI_Finalize();
+	return 0;
+}
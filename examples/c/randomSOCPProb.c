@@ -26,6 +26,20 @@ void setScsParams(Data * d) {
 	d->VERBOSE = 1; /* boolean, write out progress: 1 */
 	d->NORMALIZE = 1; /* boolean, heuristic data rescaling: 1 */
 	d->WARM_START = 0;
+	d->STORE_TRANSPOSE = 0; /* boolean, for direct, store A' for multi-threaded A*x: 0 */
+	d->ACCEL_MEM = 0; /* memory of Anderson acceleration, 0 turns it off: 0 */
+	d->MIXED_PRECISION = 0; /* boolean, for indirect, early CG solves use single precision A: 0 */
+	d->CG_ADAPTIVE = 0; /* boolean, for indirect, CG tolerance follows the ADMM residuals rather than CG_RATE: 0 */
+	d->CG_MAX_ITERS = 0; /* for indirect, max CG iterations per ADMM step, 0 for no cap (n): 0 */
+	d->CG_PRECOND = 0; /* for indirect, CG preconditioner: 0 diagonal, 1 block Jacobi, 2 incomplete Cholesky: 0 */
+	d->NORMAL_EQS = 0; /* for direct, factor RHO_X * I + A'A: 0 if its factor is smaller, 1 always, 2 never: 0 */
+	d->ADAPTIVE_RHO = 0; /* boolean, adapt RHO_X during scs_solve to balance the residuals: 0 */
+	d->ARENA = 0; /* boolean, scs_init places the workspace in a few large blocks: 0 */
+	d->PRESOLVE = 1; /* boolean, remove empty and duplicate rows, fixed variables and empty cones: 1 */
+	d->LOW_MEMORY = 0; /* boolean, iterate with fewer vectors, for indirect without storing A': 0 */
+	d->ORDERING = ORDER_AMD; /* for direct and supernodal, ORDER_AMD, ORDER_ND (nested dissection) or ORDER_USER: ORDER_AMD */
+	d->PERM = NULL; /* with ORDER_USER, the permutation of the KKT rows: NULL */
+	d->TIME_LIMIT = 0; /* wall-clock limit of scs_solve in seconds, 0 for none: 0 */
 }
 
 int main(int argc, char **argv) {
@@ -113,6 +127,8 @@ int main(int argc, char **argv) {
 
 	k->s = NULL;
 	k->ssize = 0;
+	k->sp = NULL;
+	k->spsize = 0;
 	k->ep = 0;
 	k->ed = 0;
 
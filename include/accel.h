@@ -0,0 +1,20 @@
+#ifndef ACCEL_H_GUARD
+#define ACCEL_H_GUARD
+
+#include "scs.h"
+
+/* Anderson (type-II) acceleration of the ADMM fixed point iteration z = (u, v) -> F(z), keeps the last mem
+ differences of the iterates and of the fixed point residuals z - F(z) and extrapolates from them */
+
+/* l is the length of u and v, returns NULL on failure */
+Accel * initAccel(idxint l, idxint mem);
+/* forgets the memory, (u, v) is the starting point of the next step */
+void resetAccel(Accel * a, const pfloat * u, const pfloat * v);
+/* called with (u, v) = F(z) right after a step from the last iterate z, overwrites (u, v) with the next iterate,
+ returns 1 if that is an extrapolated point, 0 if it is a plain step (no memory yet, or safeguarded) */
+idxint accelerate(Accel * a, pfloat * u, pfloat * v);
+void freeAccel(Accel * a);
+/* returns string describing the acceleration steps taken, if not null free will be called on output */
+char * getAccelSummary(Accel * a, Info * info);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef CHORDAL_H_GUARD
+#define CHORDAL_H_GUARD
+
+#include "scs.h"
+
+/* chordal decomposition of CHORDAL: the entries of an SD cone (full or packed) whose rows of A are empty and whose b
+ is 0 (at scs_init) are 0 in every s = b - A x, so the matrix of s is PSD with that sparsity pattern. With a chordal
+ extension of the pattern (of a minimum degree ordering) and its maximal cliques C_1, ..., C_p, such a matrix is the
+ sum of PSD matrices on the cliques, so the cone is replaced by p smaller cones, one per clique:
+ - the rows of the entries in one clique only move to the cone of that clique,
+ - an entry in t > 1 cliques takes t - 1 new variables u, its row in the first clique is that of A plus the u and
+   its rows in the others are -u (so its s is split between the cliques, and its y, the dual, is the same in all),
+ - the rows outside the cliques are dropped, their y is set by a PSD completion of the y of the cliques.
+ The cliques of the ordering are merged child into parent while that removes little work, and a cone is decomposed
+ only if more than one clique is left */
+typedef struct {
+	idxint n, packed, row; /* size of the cone, whether packed, its first row in the problem decomposed */
+	/* the cliques in topological order (children first), clique q is the vertices cl[clP[q]] to cl[clP[q + 1] - 1],
+	 the first sepLen[q] of them shared with its parent */
+	idxint nCl;
+	idxint * clP, * cl, * sepLen;
+} ChordalBlock;
+
+struct CHORDAL {
+	Data * d; /* the decomposed problem, A, b and c of the decomposed sizes */
+	Cone * k;
+	Sol sol; /* solution (and warm-start) of the decomposed problem */
+	idxint m, n; /* of the problem decomposed */
+	/* the rows rows[rowP[i]] to rows[rowP[i + 1] - 1] of the decomposed problem of row i, the first of the clique
+	 holding A and b, the s of all add up to that of row i and each has its y, none for a dropped row */
+	idxint * rowP, * rows;
+	idxint * uRow; /* size d->n - n, the row split by each new variable */
+	idxint * Amap; /* size nnz of the decomposed A, the entry of A of each entry, -1 for the 1 and -1 of the u */
+	idxint nBlk, nCl, maxCl; /* decomposed cones, their cliques, the size of the largest */
+	ChordalBlock * blks;
+};
+
+/* with used[i] nonzero for the rows whose b can be nonzero, returns NULL if no cone decomposes or on failure */
+Chordal * initChordal(const Data * d, const Cone * k, const idxint * used);
+/* sets the b and c of the decomposed problem, rb and rc, from b and c, returns FAILURE if b is nonzero on a dropped
+ row, 0 otherwise */
+idxint chordalBC(Chordal * ch, const pfloat * b, const pfloat * c, pfloat * rb, pfloat * rc);
+/* warm-start rsol of the decomposed problem from sol, the s of a split row evenly between its cliques */
+void chordalSol(Chordal * ch, const Sol * sol, Sol * rsol);
+/* the solution sol of the problem decomposed from rsol with status (SOLVED, INFEASIBLE, UNBOUNDED or anything else
+ for none), y completed on the dropped rows for SOLVED and INFEASIBLE */
+void unchordalSol(Chordal * ch, const Sol * rsol, Sol * sol, idxint status);
+/* after the values of A change, sets those of the decomposed A */
+void updateChordal(Chordal * ch, const AMatrix * A);
+void freeChordal(Chordal * ch);
+
+#endif
@@ -10,6 +10,9 @@ struct CONE {
 	idxint qsize; /* length of SOC array */
 	idxint *s; /* array of SD constraints */
 	idxint ssize; /* length of SD array */
+	idxint *sp; /* array of packed SD constraints, n by n matrix stored as its n(n+1)/2 lower triangle
+	 column by column with the off-diagonal entries scaled by sqrt(2) */
+	idxint spsize; /* length of packed SD array */
 	idxint ep; /* number of primal exponential cone triples */
 	idxint ed; /* number of dual exponential cone triples */
 };
@@ -21,14 +24,20 @@ struct CONE {
  */
 idxint getConeBoundaries(Cone * k, idxint ** boundaries);
 
-idxint initCone(Cone * k);
+/* allocates the per-workspace cone projection data (eigen workspaces, timers), returns NULL on failure */
+ConeWork * initCone(Cone * k);
 char * getConeHeader(Cone * k);
 idxint validateCones(Data * d, Cone * k);
 /* pass in iter to control how accurate the cone projection
  with iteration, set iter < 0 for exact projection, warm_start contains guess
  of solution, can be NULL*/
-idxint projDualCone(pfloat *x, Cone *k, const pfloat * warm_start, idxint iter);
-void finishCone(void);
+idxint projDualCone(pfloat *x, Cone *k, ConeWork * c, const pfloat * warm_start, idxint iter);
+/* the cone step of the ADMM iteration in one pass over each block of cones: projects
+ x = alpha * ut + (1 - alpha) * uprev - v onto the dual cone and then updates v += x - alpha * ut - (1 - alpha) * uprev,
+ all arrays are over the cone variables, uprev may be x itself (the step is then done in place) */
+idxint projDualConeFused(pfloat * x, pfloat * v, const pfloat * ut, const pfloat * uprev, pfloat alpha, Cone * k,
+		ConeWork * c, idxint iter);
+void finishCone(ConeWork * c);
 char * getConeSummary(Info * info);
 
 #endif
@@ -6,22 +6,49 @@
 #include "mex.h"
 #define scs_printf   mexPrintf
 #define scs_free     mxFree
-#define scs_malloc   mxMalloc
-#define scs_calloc   mxCalloc
+#define scs_malloc   scs_mex_malloc
+#define scs_calloc   scs_mex_calloc
+/* mxMalloc and mxCalloc made persistent, so a workspace may outlive the mex call that set it up (see
+ matlab/scs_mex.c), it is freed with mxFree as any other */
+void * scs_mex_malloc(size_t size);
+void * scs_mex_calloc(size_t num, size_t size);
 #elif defined PYTHON
 #include <Python.h>
 #include <stdlib.h>
-#define scs_printf   PySys_WriteStdout
-#define scs_free     free
-#define scs_malloc   malloc
-#define scs_calloc   calloc
+/* takes the GIL before printing, so the solve itself may run without it */
+#define scs_printf   scs_py_printf
+void scs_py_printf(const char * fmt, ...);
+#define scs_free     scs_hook_free
+#define scs_malloc   scs_hook_malloc
+#define scs_calloc   scs_hook_calloc
 #else
 #include <stdio.h>
 #include <stdlib.h>
 #define scs_printf   printf
-#define scs_free     free
-#define scs_malloc   malloc
-#define scs_calloc   calloc
+#define scs_free     scs_hook_free
+#define scs_malloc   scs_hook_malloc
+#define scs_calloc   scs_hook_calloc
+#endif
+
+/* memory of the workspace, kept until scs_finish: scs_wmalloc and scs_wcalloc take it from the arena that scs_init
+ fills with ARENA set in Data, else they are scs_malloc and scs_calloc, scs_wreserve(size) makes room in that
+ arena for size bytes in a few allocations (e.g. a factor once its size is known), it is freed with scs_free */
+#ifdef MATLAB_MEX_FILE
+#define scs_wmalloc  scs_malloc
+#define scs_wcalloc  scs_calloc
+#define scs_wreserve(size)
+#define scs_caller_malloc scs_malloc
+#else
+/* through the allocator of scs_set_allocator, scs_hook_free ignores memory of the arena of the workspace in use */
+void * scs_hook_malloc(size_t size);
+void * scs_hook_calloc(size_t num, size_t size);
+void scs_hook_free(void * p);
+void * scs_wmalloc(size_t size);
+void * scs_wcalloc(size_t num, size_t size);
+void scs_wreserve(size_t size);
+/* memory handed to the caller, e.g. of Sol, which is not counted as the workspace's (see Info) as the caller frees it,
+ it is freed with scs_free */
+void * scs_caller_malloc(size_t size);
 #endif
 
 /* SCS VERSION NUMBER --------------------------------------- */
@@ -40,6 +67,15 @@
     /* #define idxint int */
 #endif
 
+/* row indices of the matrices the solvers build (A' and L), their column pointers stay idxint: with DLONG and
+ COMPACT_INDICES these are ints, so large nnz is still allowed but m + n must be below 2^31 */
+#if defined DLONG && defined COMPACT_INDICES
+    typedef int rowidx;
+    #define COMPACT_ROWS /* rowidx is narrower than idxint */
+#else
+    typedef idxint rowidx;
+#endif
+
 #ifndef FLOAT
 typedef double pfloat;
 #ifndef NAN
@@ -80,10 +116,44 @@ typedef float pfloat;
 #endif
 #endif
 
+#ifdef LAPACK_LIB_FOUND
+/* underscore for blas / lapack, single or double precision */
+#ifdef NOBLASUNDERSCORE
+#ifndef FLOAT
+#define BLAS(x) d ## x
+#else
+#define BLAS(x) s ## x
+#endif
+#else
+#ifndef FLOAT
+#define BLAS(x) d ## x ## _
+#else
+#define BLAS(x) s ## x ## _
+#endif
+#endif
+
+#ifdef MATLAB_MEX_FILE
+typedef ptrdiff_t blasint;
+#elif defined BLAS64
+typedef long blasint;
+#else
+typedef int blasint;
+#endif
+#endif
+
 typedef struct PROBLEM_DATA Data;
 typedef struct SOL_VARS Sol;
 typedef struct INFO Info;
+typedef struct PROFILE Profile;
+typedef struct SCALING Scaling;
+typedef struct ALLOCATOR Allocator;
+typedef struct ARENA Arena;
+typedef struct METER Meter;
 typedef struct WORK Work;
 typedef struct CONE Cone;
+typedef struct CONE_WORK ConeWork;
+typedef struct ACCEL_WORK Accel;
+typedef struct PRESOLVE Presolve;
+typedef struct CHORDAL Chordal;
 
 #endif
@@ -11,6 +11,9 @@ pfloat calcNormSq(const pfloat * v, idxint len);
 pfloat calcNorm(const pfloat * v, idxint len);
 pfloat calcNormInf(const pfloat *a, idxint l);
 void addScaledArray(pfloat * a, const pfloat * b, idxint n, const pfloat sc);
+void addScaledArray2(pfloat * a, const pfloat * b, const pfloat * c, idxint n, const pfloat sb, const pfloat sc);
+pfloat addScaledArrayNormSq(pfloat * a, const pfloat * b, idxint n, const pfloat sc);
+void scaleAndAddArray(pfloat * a, const pfloat sa, const pfloat * b, idxint n);
 pfloat calcNormDiff(const pfloat *a, const pfloat *b, idxint l);
 pfloat calcNormInfDiff(const pfloat *a, const pfloat *b, idxint l);
 #endif
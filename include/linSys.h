@@ -9,16 +9,33 @@ typedef struct A_DATA_MATRIX AMatrix;
 /* stores the necessary private workspace, only the linear system solver interacts with this struct */
 typedef struct PRIVATE_DATA Priv;
 
-/* initialize Priv structure and perform any necessary preprocessing */
-Priv * initPriv(Data * d);
+/* initialize Priv structure and perform any necessary preprocessing,
+ D and E are the normalization of A (NULL if d->NORMALIZE is off) and stay valid until freePriv:
+ the solver works with Anew = d->SCALE * (D^-1)*A*(E^-1) but must not modify d->A */
+Priv * initPriv(Data * d, const pfloat * D, const pfloat * E);
 /* solves [d->RHO_X * I  A' ; A  -I] x = b for x, stores result in b, s contains warm-start, iter is current scs iteration count */
 idxint solveLinSys(Data * d, Priv * p, pfloat * b, const pfloat * s, idxint iter);
+/* solves the same system for K right-hand sides at once, as K calls to solveLinSys(d, p, b[k], s[k], iter)
+ but sharing the passes over the factorization or matrix, s (or any s[k]) may be NULL */
+idxint solveLinSysBatch(Data * d, Priv * p, idxint K, pfloat ** b, const pfloat ** s, idxint iter);
 /* frees Priv structure and allocated memory in Priv */
 void freePriv(Priv * p);
-
-/* forms y += A'*x */
+/* called after the values (but not the sparsity pattern) of d->A or d->RHO_X change,
+ updates any data derived from them (e.g. numeric re-factorization), returns < 0 on failure */
+idxint updateLinSys(Data * d, Priv * p);
+
+/* hint for the next solves: the largest relative (primal or dual) ADMM residual at the last convergence check,
+ NAN if not known (e.g. at the start of a solve), only iterative solvers use it */
+void setLinSysResidual(Priv * p, pfloat res);
+/* returns the total iterations (e.g. of CG) taken in the solves with iter >= 0 so far, 0 for direct solvers */
+idxint getLinSysIters(Priv * p);
+/* sets the setup times of prof (kktTime, orderTime, factorTime) to those of the last initPriv or updateLinSys,
+ 0 for the phases the solver does not have */
+void getLinSysProfile(Priv * p, Profile * prof);
+
+/* forms y += Anew'*x */
 void accumByAtrans(Data * d, Priv * p, const pfloat *x, pfloat *y);
-/* forms y += A*x */
+/* forms y += Anew*x */
 void accumByA(Data * d, Priv * p, const pfloat *x, pfloat *y);
 
 /* returns negative num if input data is invalid */
@@ -30,11 +47,13 @@ char * getLinSysMethod(Data * d, Priv * p);
 char * getLinSysSummary(Priv * p, Info * info);
 
 /* Normalization routines, used if d->NORMALIZE is true */
-/* normalizes A matrix, sets w->E and w->D diagonal scaling matrices, Anew = d->SCALE * (D^-1)*A*(E^-1) (different to paper which is D*A*E)
+/* computes the normalization of A without modifying it, sets w->E and w->D diagonal scaling matrices,
+ * Anew = d->SCALE * (D^-1)*A*(E^-1) (different to paper which is D*A*E)
  * D and E must be all positive entries, D must satisfy cone boundaries
- * must set (w->meanNormRowA = mean of norms of rows of normalized A) THEN scale resulting A by d->SCALE */
+ * must set w->meanNormRowA (w->meanNormColA) = mean of norms of rows (cols) of (D^-1)*A*(E^-1)
+ * if w->D and w->E are already set (re-normalization) they must be overwritten in place */
 void normalizeA(Data * d, Work * w, Cone * k);
-/* unnormalizes A matrix, unnormalizes by w->D and w->E and d->SCALE */
-void unNormalizeA(Data *d, Work * w);
+/* overwrites the values of A with (unnormalized) Ax, the sparsity pattern is unchanged */
+void setAMatrixValues(Data * d, const pfloat * Ax);
 
 #endif
@@ -0,0 +1,62 @@
+#ifndef PRESOLVE_H_GUARD
+#define PRESOLVE_H_GUARD
+
+#include "scs.h"
+#include "chordal.h"
+
+/* presolve of PRESOLVE: removes from the equality (f) and LP (l) rows
+ - the singleton equality rows, fixing their variable (repeated on the rows left singleton by that),
+ - the rows that are empty but for fixed variables,
+ - the rows equal to another row of the same cone on the variables that are not fixed (of LP rows the one with the
+   smallest b is kept in each solve),
+ and the cones of size 0, from A and the cones only, so the reduction holds for any b and c: the fixed variables and
+ the b of the reduced problem are computed in each solve and those b that make a removed row infeasible are detected
+ there, with a certificate. With CHORDAL the sparse SD cones of the reduced problem are then decomposed (chordal.h) */
+struct PRESOLVE {
+	/* the problem solved, the reduced one or its decomposition, the settings are copied by reducedData */
+	Data * d;
+	Cone * k;
+	Sol * sol; /* solution (and warm-start) of the problem solved */
+	Data * rd; /* the reduced problem, A, b and c of the reduced sizes, NULL if nothing is removed (the maps too) */
+	Cone * rk;
+	Sol rsol;
+	Chordal * ch; /* the decomposition of CHORDAL of the reduced problem (the problem if not reduced), or NULL */
+	idxint m, n, f, l; /* of the original problem */
+	idxint * rowMap; /* size m, row of the reduced problem or -1 if removed */
+	idxint * colMap; /* size n, column of the reduced problem or -1 if fixed */
+	/* size m, the kept row of the group of equal rows of each row (itself if in none), -1 for an empty row and -2
+	 for a row that fixes a variable */
+	idxint * rowRep;
+	idxint * Amap; /* size nnz of the reduced A, the entry of A of each entry */
+	/* the fixes in order: row, column and entry of A of the pivot, and the value of the last presolveBC */
+	idxint nFix;
+	idxint * fixRow, * fixCol, * fixEntry;
+	pfloat * xFix;
+	/* of the last presolveBC: b minus the fixed variables (size m), the row of smallest b of each group of equal
+	 LP rows (size of the reduced m), and rows showing infeasibility (infeasRow < 0 if none, infeasRow2 the other
+	 row of two equal equality rows with different b, -1 otherwise) */
+	pfloat * r;
+	idxint * minRow;
+	idxint infeasRow, infeasRow2;
+	pfloat cFix; /* c'x of the fixed variables of the last presolveBC, missing from the objective of the problem solved */
+};
+
+/* returns NULL if nothing can be removed or decomposed or on failure (the problem is then solved as it is) */
+Presolve * initPresolve(Data * d, Cone * k);
+/* copies the settings of d into the problem solved and returns it */
+Data * reducedData(Presolve * pre, const Data * d);
+/* sets the b and c of the problem solved, rb and rc, from b and c, returns INFEASIBLE if b makes a removed row
+ infeasible, FAILURE if b is nonzero on a row the decomposition dropped, 0 otherwise */
+idxint presolveBC(Presolve * pre, const Data * d, const pfloat * b, const pfloat * c, pfloat * rb, pfloat * rc);
+/* warm-start rsol of the problem solved from sol, allocating its arrays if NULL */
+void presolveSol(Presolve * pre, const Sol * sol, Sol * rsol);
+/* the solution of the problem of the last presolveBC, with b and c, from rsol of the problem solved with status
+ (SOLVED, INFEASIBLE, UNBOUNDED or anything else for none), or the certificate of infeasibility presolveBC found,
+ allocating the arrays of sol if NULL, with SOLVED sets the objectives and the gap of info from it */
+void postsolve(Presolve * pre, const Data * d, const pfloat * b, const pfloat * c, const Sol * rsol, Sol * sol,
+		idxint status, Info * info);
+/* after the values of A change, sets those of the A solved, returns < 0 if A does not allow the reduction anymore */
+idxint updatePresolve(Presolve * pre, const Data * d);
+void freePresolve(Presolve * pre);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef QUEUE_H_GUARD
+#define QUEUE_H_GUARD
+
+#include "scs.h"
+
+/* solve queue: a pool of worker threads that solve submitted problems (scs_init, scs_solve, scs_finish) in the
+ order of submission, as many at once as there are workers. With OPENMP a job of more than QUEUE_ROWS_PER_THREAD
+ rows (m + n) also takes idle workers for the parallel regions of its solve (cone projections, products with A,
+ normalization, factorization), one per QUEUE_ROWS_PER_THREAD rows, and they take no other job until it is done.
+ Not available on Windows or in the Matlab mex. */
+#if !(defined _WIN32 || defined _WIN64 || defined _WINDLL || defined MATLAB_MEX_FILE)
+
+#define QUEUE_ROWS_PER_THREAD 20000
+
+typedef struct SCS_QUEUE Queue;
+typedef struct SCS_JOB Job;
+/* called on the worker thread once the job is solved, with the status of the solve */
+typedef void (*JobCallback)(idxint status, Data * d, Cone * k, Sol * sol, Info * info, void * ctx);
+
+/* scs_queue_init: starts nWorkers threads (the number of processors if nWorkers <= 0), returns NULL on failure */
+Queue * scs_queue_init(idxint nWorkers);
+/* returned by scs_submit for a job with a callback, which is not waited for */
+extern Job * const SCS_JOB_QUEUED;
+
+/* scs_submit: queues the solve of d and k into sol and info, which must stay valid (and d and k unchanged) until it
+ is done, without cb returns a job for scs_job_done and scs_job_wait, with cb calls cb (which may submit more jobs)
+ when it is done and returns SCS_JOB_QUEUED, returns NULL on failure either way */
+Job * scs_submit(Queue * q, Data * d, Cone * k, Sol * sol, Info * info, JobCallback cb, void * ctx);
+/* scs_job_done: 1 if the job is solved, without blocking */
+idxint scs_job_done(Job * j);
+/* scs_job_wait: blocks until the job is solved, frees it and returns the status of the solve, call it once for
+ every job returned by scs_submit but SCS_JOB_QUEUED */
+idxint scs_job_wait(Job * j);
+/* scs_queue_finish: waits for all jobs submitted and stops the workers, the jobs without callback must still be
+ waited for with scs_job_wait */
+void scs_queue_finish(Queue * q);
+
+#endif
+
+#endif
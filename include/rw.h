@@ -0,0 +1,33 @@
+#ifndef RW_H_GUARD
+#define RW_H_GUARD
+
+#include "glbopts.h"
+
+/* binary problem file, for replaying instances: written and read by the solvers with A in column compressed
+ format (not matfree), all values in the byte order of the writer:
+
+ offset 0: char magic[8] = SCS_DATA_MAGIC
+        8: uint32 version, byte order mark 0x01020304, size of the integers, size of the floats (4 or 8)
+       24: int64 m, n, nnz(A), f, l, qsize, ssize, spsize, ep, ed, hasWarmStart, MAX_ITERS, NORMALIZE, 0, 0, 0
+      152: float64 EPS, ALPHA, RHO_X, SCALE, CG_RATE, 0, 0, 0
+      256: the arrays q, s, sp, Ap, Ai (integers), Ax, b, c and if hasWarmStart x, y, s (floats), each nonempty one at a
+           multiple of SCS_DATA_ALIGN bytes, zero padded
+ */
+#define SCS_DATA_MAGIC "SCS_DATA"
+#define SCS_DATA_VERSION 1
+#define SCS_DATA_ALIGN 64
+
+typedef struct SCS_DATA_FILE DataFile;
+
+/* scs_write_data: writes d, k and the settings above, and if sol is not NULL and holds x, y and s, those as a warm
+ start, returns < 0 on failure */
+idxint scs_write_data(const char * filename, const Data * d, const Cone * k, const Sol * sol);
+/* scs_read_data: reads a file of scs_write_data into *d and *k, allocated with the settings of the file set and the
+ others 0, with useMmap the arrays are mapped rather than read (privately, so writing to them does not change the
+ file), arrays whose integer or float size differs from this build are converted, if the file holds a warm start
+ and sol is not NULL its x, y and s are allocated and set and d->WARM_START is 1, returns NULL on failure;
+ d, k and their arrays belong to the returned handle, free them with scs_free_data_file (after scs_finish) */
+DataFile * scs_read_data(const char * filename, idxint useMmap, Data ** d, Cone ** k, Sol * sol);
+void scs_free_data_file(DataFile * f);
+
+#endif
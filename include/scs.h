@@ -8,6 +8,9 @@
 #include "linAlg.h"
 #include "linSys.h"
 #include "util.h"
+#include "accel.h"
+
+struct residuals;
 
 /* struct that containing standard problem data */
 struct PROBLEM_DATA {
@@ -27,6 +30,46 @@ struct PROBLEM_DATA {
 	idxint VERBOSE; /* boolean, write out progress: 1 */
 	idxint NORMALIZE; /* boolean, heuristic data rescaling: 1 */
 	idxint WARM_START; /* boolean, warm start (put initial guess in Sol struct): 0 */
+	idxint STORE_TRANSPOSE; /* boolean, for direct, store A' to allow multi-threaded A*x (uses memory of nnz(A)): 0 */
+	idxint ACCEL_MEM; /* memory of the Anderson acceleration of the iterates, 0 turns it off (uses memory of 4 * ACCEL_MEM * (m + n)): 0 */
+	idxint MIXED_PRECISION; /* boolean, for indirect, early CG solves use A rounded to single precision (uses memory of 4 * nnz(A)): 0 */
+	idxint CG_ADAPTIVE; /* boolean, for indirect, CG tolerance follows the ADMM residuals rather than CG_RATE: 0 */
+	idxint CG_MAX_ITERS; /* for indirect, max CG iterations per ADMM step, 0 for no cap (n): 0 */
+	idxint CG_PRECOND; /* for indirect, preconditioner of CG: 0 diagonal, 1 block Jacobi, 2 incomplete Cholesky of RHO_X * I + A'A: 0 */
+	idxint NORMAL_EQS; /* for direct, factor RHO_X * I + A'A (n by n) rather than the KKT matrix (n + m), then y = Ax - b
+	 costs a product with A per solve: 0 if its factor is small (at most half the nonzeros of A), 1 always, 2 never: 0 */
+	idxint ADAPTIVE_RHO; /* boolean, scs_solve rescales RHO_X to balance the progress of the primal and dual residuals,
+	 re-factorizing numerically (direct) or recomputing the preconditioner (indirect), the last value is left in RHO_X
+	 for later solves (not in scs_solve_batch): 0 */
+	idxint ARENA; /* boolean, scs_init places the workspace in a few large blocks (sized from the dimensions and, for
+	 the direct solver, the nonzeros of L) rather than many separate allocations, freed at once by scs_finish
+	 (not in the Matlab mex): 0 */
+	idxint PRESOLVE; /* boolean, scs_init removes the empty and duplicate equality and LP rows, the variables fixed by
+	 singleton equality rows and the cones of size 0, scs_solve solves the smaller problem and maps the solution back
+	 (not with the matrix-free solver, a saved scaling or ORDER_USER): 1 */
+	idxint CHORDAL; /* boolean, scs_init splits each SD cone whose entries outside a sparse pattern are 0 (rows of A
+	 empty, b 0) into smaller overlapping cones, one per clique of a chordal extension of the pattern (not with the
+	 matrix-free solver, a saved scaling or ORDER_USER): 0 */
+	idxint LOW_MEMORY; /* boolean, iterate without u_prev and the residual buffers (the residuals at the convergence
+	 checks then take a product with A and one with A'), and for indirect without storing A' (two passes over A per CG
+	 iteration, diagonal preconditioner only, no MIXED_PRECISION): 0 */
+	idxint ORDERING; /* for direct and supernodal, fill-reducing ordering of the matrix factored: ORDER_AMD, ORDER_ND
+	 (nested dissection, splitting the graph by a narrow level near the middle of a breadth first search until the
+	 parts are small, which are ordered by AMD) or ORDER_USER (PERM): ORDER_AMD */
+	const idxint * PERM; /* with ORDER_USER, row k of the permuted matrix is row PERM[k] of the KKT matrix (n + m
+	 rows, x first) or, with NORMAL_EQS 1, of RHO_X * I + A'A (n rows), the normal equations are not tried otherwise
+	 and PRESOLVE and CHORDAL are skipped as they change the rows: NULL */
+	pfloat TIME_LIMIT; /* wall-clock limit of scs_solve in seconds, 0 for none: stops before an iteration that would
+	 likely overrun it and returns the best iterate so far, never a certificate, with status TIMEOUT: 0 */
+	/* optional, NULL for none: with NORMALIZE, a normalization of this same A saved by scs_get_scaling, used by
+	 scs_init instead of normalizing A again */
+	const Scaling * scaling;
+
+	/* optional progress callback of scs_solve, NULL for none: called after every convergence check with the
+	 iteration, the residuals as printed in the summary and the solve time so far (milli-seconds), a nonzero
+	 return stops the solve at the current iterate as if MAX_ITERS had been reached */
+	idxint (*callback)(void * callbackData, idxint iter, const struct residuals * r, pfloat solveTime);
+	void * callbackData; /* user data passed to callback */
 };
 
 /* contains primal-dual solution arrays */
@@ -34,6 +77,46 @@ struct SOL_VARS {
 	pfloat * x, *y, *s;
 };
 
+/* the normalization of A computed by scs_init, see scs_get_scaling */
+struct SCALING {
+	pfloat * D, * E; /* row and column scalings, sizes m and n */
+	pfloat meanNormRowA, meanNormColA;
+};
+
+/* allocator used by the library (not the Matlab mex, which uses mxMalloc), see scs_set_allocator,
+ ctx is passed to every call */
+struct ALLOCATOR {
+	void * (*malloc)(void * ctx, size_t size);
+	void * (*calloc)(void * ctx, size_t num, size_t size);
+	void (*free)(void * ctx, void * p);
+	void * ctx;
+};
+
+/* time (milli-seconds) spent in each phase of the setup and the solve, and the choice of the automatic solver */
+struct PROFILE {
+	/* setup, set by scs_init, 0 for the phases the linear system solver does not have */
+	pfloat normalizeTime; /* normalization of A */
+	pfloat kktTime; /* forming the KKT matrix */
+	pfloat orderTime; /* fill-reducing ordering (see ORDERING) and symbolic factorization */
+	pfloat factorTime; /* numeric factorization (LDL'), or forming the preconditioner of CG */
+	/* solve, set by scs_solve, over all iterations */
+	pfloat linSysTime; /* projectLinSys */
+	pfloat coneTime; /* projectCones */
+	pfloat convergedTime; /* computing residuals and checking convergence */
+	pfloat minIterTime, maxIterTime, avgIterTime; /* of a single iteration */
+	/* setup, the choice of the automatic solver (libscsauto) between the direct and the indirect one, 0 with the
+	 other solvers: AUTO_DIRECT or AUTO_INDIRECT, the nonzeros below the diagonal of the LDL' factor of the KKT and
+	 the bytes of the factorization, from the AMD ordering, and the predicted flops of each solver */
+	idxint autoChoice;
+	pfloat autoLnz, autoMem, autoDirectCost, autoIndirectCost;
+	/* setup, the fill of the factorization of the direct and supernodal solvers, 0 with the others: the ORDERING
+	 used, the nonzeros of L below the diagonal and the height of the elimination tree (the most columns on a path
+	 from a leaf to the root, a bound on the dependent steps of the factorization and of the solves) */
+	idxint ordering;
+	pfloat lnz;
+	idxint treeHeight;
+};
+
 /* contains terminating information */
 struct INFO {
 	idxint iter; /* number of iterations taken */
@@ -46,6 +129,18 @@ struct INFO {
 	pfloat relGap; /* relative duality gap */
 	pfloat setupTime; /* time taken for setup phase */
 	pfloat solveTime; /* time taken for solve phase */
+	idxint linSysIters; /* iterations of an iterative linear system solver (CG) in the solve phase, 0 for direct */
+	/* memory, in bytes allocated through the allocator hooks by the calls on the workspace, whatever thread they run
+	 on (not the Sol handed to the caller, 0 in the Matlab mex): the most held at once by scs_init, the workspace it
+	 keeps until scs_finish, and the most held at once during scs_solve, the workspace included */
+	pfloat setupPeakBytes, workBytes, solvePeakBytes;
+	Profile prof; /* time spent in each phase */
+	/* optional residual trace, set before scs_solve: if resTrace is not NULL it holds 4 * resTraceCap entries
+	 and the solve appends (iter, resPri, resDual, relGap) of every iteration until it is full (while it has room
+	 the residuals are computed every iteration rather than only at the convergence checks) */
+	pfloat * resTrace;
+	idxint resTraceCap;
+	idxint resTraceLen; /* number of (iter, resPri, resDual, relGap) entries written */
 };
 
 /* scs returns one of the following integers: (zero should never be returned) */
@@ -54,6 +149,16 @@ struct INFO {
 #define INFEASIBLE -2 /* primal infeasible, dual unbounded */
 #define UNBOUNDED -1 /* primal unbounded, dual infeasible */
 #define SOLVED 1
+#define TIMEOUT 2 /* TIME_LIMIT reached, status string tells how the iterate looked, e.g. Timeout/Solved */
+
+/* Profile.autoChoice of the automatic solver */
+#define AUTO_DIRECT 1
+#define AUTO_INDIRECT 2
+
+/* Data.ORDERING, fill-reducing orderings of the direct and supernodal solvers */
+#define ORDER_AMD 0
+#define ORDER_ND 1
+#define ORDER_USER 2
 
 /* main library api's:
  scs_init: allocates memory (direct version factorizes matrix [I A; A^T -I])
@@ -63,16 +168,55 @@ struct INFO {
 Work * scs_init(Data * d, Cone * k, Info * info);
 idxint scs_solve(Work * w, Data * d, Cone * k, Sol * sol, Info * info);
 void scs_finish(Data * d, Work * w);
+/* scs_update_A: replaces the values of A by Ax (same sparsity pattern, size nnz(A)), unnormalized,
+ re-normalizes and re-factorizes numerically without redoing the ordering and symbolic analysis,
+ returns < 0 on failure */
+idxint scs_update_A(Work * w, Data * d, Cone * k, const pfloat * Ax);
+/* scs_get_scaling: copies the normalization of A into s, s->D (size m) and s->E (size n) must be allocated, setting
+ d->scaling to s lets later scs_init calls with the same A skip normalizing it, returns < 0 without NORMALIZE */
+idxint scs_get_scaling(const Work * w, const Data * d, Scaling * s);
+/* scs_solve_batch: solves K problems that differ only in b and c in lockstep, sharing each linear system
+ solve, B (m by K) and C (n by K) are column major and are not modified (d->b and d->c are not used),
+ sols and infos have K entries (with d->WARM_START the sols hold the warm-starts),
+ returns the number of problems solved or < 0 on failure */
+idxint scs_solve_batch(Work * w, Data * d, Cone * k, idxint K, const pfloat * B, const pfloat * C, Sol * sols,
+		Info * infos);
+/* scs_set_allocator: the library allocates all its memory (and the arenas of ARENA) with a, copied, or with malloc,
+ calloc and free again if a is NULL, affects all threads so call it before any memory of the library is allocated
+ and only while none is live, memory returned to the caller (e.g. of Sol) is freed with scs_free, which takes only
+ memory of scs_malloc and scs_calloc (or of malloc and calloc with the default allocator): the arrays the caller
+ owns in Data and Cone go through scs_free only if they were allocated so */
+#ifndef MATLAB_MEX_FILE
+void scs_set_allocator(const Allocator * a);
+#endif
 /* scs calls scs_init, scs_solve, and scs_finish */
 idxint scs(Data * d, Cone * k, Sol * sol, Info * info);
 
 /* the following structs do not need to be exposed */
 struct WORK {
-	pfloat *u, *v, *u_t, *u_prev; /* u_prev = u from previous iteration */
-	pfloat *h, *g, *pr, *dr;
+	pfloat *u, *v, *u_t, *u_prev; /* u_prev = u from previous iteration, NULL with d->LOW_MEMORY */
+	pfloat *h, *g, *pr, *dr; /* pr and dr NULL with d->LOW_MEMORY, the residuals then go to u_t */
 	pfloat gTh, sc_b, sc_c, nm_b, nm_c, meanNormRowA, meanNormColA;
 	pfloat *D, *E; /* for normalization */
-	Priv * p;
+	Priv * p; /* struct populated by linear system solver */
+	ConeWork * coneWork; /* struct populated by cone projection routines */
+	Accel * accel; /* Anderson acceleration workspace, NULL if d->ACCEL_MEM is 0 */
+	Arena * arena; /* holds the memory of the workspace with d->ARENA, else NULL */
+	Meter * meter; /* counts the memory of the calls on the workspace, for Info */
+	Presolve * pre; /* the reduced or decomposed problem of d->PRESOLVE and d->CHORDAL, that the rest of the workspace
+	 is of, NULL if none */
+	size_t bytes; /* held by the workspace, Info.workBytes */
+	pfloat objOffset; /* with PRESOLVE, c'x of the fixed variables, added to the objectives of the gap test */
+	/* with TIME_LIMIT, u and v (2 * (n + m + 1)) of the convergence check of the solve with the smallest residuals
+	 and tau > kappa, and those residuals (INFINITY if none yet), the buffer allocated by the first such solve */
+	pfloat * best, bestRes;
+	idxint lineLen; /* length of printed output line */
+	idxint nextCheck; /* iteration of the next convergence check */
+	idxint lastCheck; /* iteration of the last convergence check */
+	/* ADAPTIVE_RHO: the sum of log(resPri / resDual) over the rhoChecks convergence checks since the last decision,
+	 the iteration of the next decision, the interval between decisions and the RHO_X updates of this solve */
+	pfloat rhoLogRatio;
+	idxint rhoChecks, nextRhoUpdate, rhoInterval, rhoUpdates;
 };
 
 /* to hold residual information */
@@ -3,6 +3,7 @@
 
 #include "scs.h"
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdio.h>
 #include "cones.h"
 
@@ -41,6 +42,39 @@ pfloat toc(timer * t);
 pfloat strtoc(char * str, timer * t);
 pfloat tocq(timer * t);
 
+#ifndef MATLAB_MEX_FILE
+/* arenas of ARENA: arenaInit creates one with a first block of size bytes that serves scs_wmalloc while it is
+ open and the arena of this thread, arenaEnter makes a the arena of this thread (whose memory scs_free ignores),
+ returning the previous one for arenaLeave, arenaClose stops it serving scs_wmalloc, arenaFree frees all its
+ memory, arenaSize returns its total size and sets the number of blocks and bytes handed out */
+Arena * arenaInit(size_t size);
+Arena * arenaEnter(Arena * a);
+void arenaLeave(Arena * prev);
+void arenaClose(Arena * a);
+void arenaFree(Arena * a);
+size_t arenaSize(const Arena * a, idxint * nBlocks, size_t * used);
+/* the memory accounting of a workspace: meterInit creates a meter, meterEnter makes m the meter of this thread
+ (whose allocations of the hooks it counts until they are freed on a thread it is the meter of), returning the
+ previous one for meterLeave, meterFree frees it (not the memory it counted), the bytes held by the meter of this
+ thread (0 if none): memMark returns them and starts a new peak there, memPeak returns the most held since */
+Meter * meterInit(void);
+Meter * meterEnter(Meter * m);
+void meterLeave(Meter * prev);
+void meterFree(Meter * m);
+ptrdiff_t memMark(void);
+ptrdiff_t memPeak(void);
+ptrdiff_t memHeld(void);
+#else
+#define arenaEnter(a) ((void) (a), (Arena *) NULL)
+#define arenaLeave(prev) ((void) (prev))
+#define meterEnter(m) ((void) (m), (Meter *) NULL)
+#define meterLeave(prev) ((void) (prev))
+#define meterFree(m) ((void) (m))
+#define memMark() ((ptrdiff_t) 0)
+#define memPeak() ((ptrdiff_t) 0)
+#define memHeld() ((ptrdiff_t) 0)
+#endif
+
 void printConeData(Cone * k);
 void printData(Data * d);
 void printWork(Data * d, Work * w);
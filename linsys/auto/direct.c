@@ -0,0 +1,18 @@
+/* the direct solver of the automatic one: linsys/direct/private.c with the names of the linear system interface,
+ its Priv and its other globals prefixed by dir, see private.h */
+#define PRIVATE_DATA DIR_PRIVATE_DATA
+#define initPriv dirInitPriv
+#define solveLinSys dirSolveLinSys
+#define solveLinSysBatch dirSolveLinSysBatch
+#define freePriv dirFreePriv
+#define updateLinSys dirUpdateLinSys
+#define setLinSysResidual dirSetLinSysResidual
+#define getLinSysIters dirGetLinSysIters
+#define getLinSysProfile dirGetLinSysProfile
+#define accumByAtrans dirAccumByAtrans
+#define accumByA dirAccumByA
+#define getLinSysMethod dirGetLinSysMethod
+#define getLinSysSummary dirGetLinSysSummary
+#define _accumByAtrans dir_accumByAtrans
+
+#include "linsys/direct/private.c"
@@ -0,0 +1,19 @@
+/* the indirect solver of the automatic one: linsys/indirect/private.c with the names of the linear system
+ interface, its Priv and its other globals prefixed by indir, see private.h */
+#define PRIVATE_DATA INDIR_PRIVATE_DATA
+#define initPriv indirInitPriv
+#define solveLinSys indirSolveLinSys
+#define solveLinSysBatch indirSolveLinSysBatch
+#define freePriv indirFreePriv
+#define updateLinSys indirUpdateLinSys
+#define setLinSysResidual indirSetLinSysResidual
+#define getLinSysIters indirGetLinSysIters
+#define getLinSysProfile indirGetLinSysProfile
+#define accumByAtrans indirAccumByAtrans
+#define accumByA indirAccumByA
+#define getLinSysMethod indirGetLinSysMethod
+#define getLinSysSummary indirGetLinSysSummary
+#define _accumByAtrans indir_accumByAtrans
+#define getPreconditioner indirGetPreconditioner
+
+#include "linsys/indirect/private.c"
@@ -0,0 +1,157 @@
+#include "private.h"
+
+/* the solver is chosen by the flops predicted for AUTO_ITERS iterations with AUTO_CG_ITERS CG iterations per
+ indirect solve, and the direct one only if its factorization takes at most AUTO_MAX_MEM bytes: CG takes from a few
+ to a few dozen iterations per solve, AUTO_CG_ITERS is on the high side as a poorly conditioned A needs many */
+#ifndef AUTO_ITERS
+#define AUTO_ITERS 500
+#endif
+#ifndef AUTO_CG_ITERS
+#define AUTO_CG_ITERS 25
+#endif
+#ifndef AUTO_MAX_MEM
+#define AUTO_MAX_MEM 4e9
+#endif
+
+char * getLinSysMethod(Data * d, Priv * p) {
+	char * str = scs_malloc(sizeof(char) * 96);
+	if (p) {
+		sprintf(str, "sparse-auto (%s), nnz in A = %li", p->dir ? "direct" : "indirect", (long) d->A->p[d->n]);
+	} else {
+		sprintf(str, "sparse-auto, nnz in A = %li, direct or indirect by the predicted cost", (long) d->A->p[d->n]);
+	}
+	return str;
+}
+
+char * getLinSysSummary(Priv * p, Info * info) {
+	char * sub = p->dir ? dirGetLinSysSummary(p->dir, info) : indirGetLinSysSummary(p->indir, info);
+	char * str = scs_malloc(sizeof(char) * (160 + (sub ? strlen(sub) : 0)));
+	idxint len = sprintf(str, "\tLin-sys: chose %s, predicted flops %1.2e direct, %1.2e indirect, nnz in L %1.2e\n",
+			p->dir ? "direct" : "indirect", p->directCost, p->indirectCost, p->lnz);
+	if (sub) {
+		strcpy(str + len, sub);
+		scs_free(sub);
+	}
+	return str;
+}
+
+/* predicts the costs from the AMD ordering of the KKT pattern, lnz < 0 if it could not be ordered */
+static void predict(Data * d, Priv * p) {
+	idxint n = d->n, nm = d->n + d->m, nnzA = d->A->p[d->n], status = -1;
+	pfloat info[AMD_INFO];
+	timer orderTimer;
+	cs * C;
+	idxint * P;
+	tic(&orderTimer);
+	C = formKKT(d, NULL, NULL, 0);
+	P = scs_malloc(nm * sizeof(idxint));
+	if (C && P) {
+#ifdef DLONG
+		status = amd_l_order(nm, C->p, C->i, P, (pfloat *) NULL, info);
+#else
+		status = amd_order(nm, C->p, C->i, P, (pfloat *) NULL, info);
+#endif
+	}
+	if (C)
+		cs_spfree(C);
+	if (P)
+		scs_free(P);
+	p->orderTime = tocq(&orderTimer);
+	/* CG: a product with A and A', through a vector of size m, and about ten vector operations per iteration */
+	p->indirectCost = (pfloat) AUTO_ITERS * AUTO_CG_ITERS * (4.0 * nnzA + 2.0 * d->m + 20.0 * n);
+	if (status < 0) {
+		p->lnz = -1;
+		p->mem = p->directCost = INFINITY;
+		return;
+	}
+	/* L and D, with the KKT and the vectors of the factorization alive at once */
+	p->lnz = info[AMD_LNZ];
+	p->mem = p->lnz * (sizeof(pfloat) + sizeof(rowidx)) + (nnzA + nm) * (sizeof(pfloat) + sizeof(idxint))
+			+ nm * (3 * sizeof(idxint) + 3 * sizeof(pfloat));
+	/* the factorization, then a forward and a backward solve, the diagonal and the permutations per iteration */
+	p->directCost = info[AMD_NDIV] + 2 * info[AMD_NMULTSUBS_LDL] + (pfloat) AUTO_ITERS * (4.0 * p->lnz + 3.0 * nm);
+#ifdef EXTRAVERBOSE
+	scs_printf("auto: nnz in L %1.2e, %1.2e bytes, flops %1.2e direct, %1.2e indirect\n", p->lnz, p->mem,
+			p->directCost, p->indirectCost);
+#endif
+}
+
+Priv * initPriv(Data * d, const pfloat * D, const pfloat * E) {
+	Priv * p = scs_wcalloc(1, sizeof(Priv));
+	if (!p) {
+		return NULL;
+	}
+	predict(d, p);
+	if (p->lnz >= 0 && p->mem <= AUTO_MAX_MEM && p->directCost <= p->indirectCost) {
+		p->dir = dirInitPriv(d, D, E);
+	}
+	/* also if the factorization failed */
+	if (!p->dir) {
+		p->indir = indirInitPriv(d, D, E);
+		if (!p->indir) {
+			freePriv(p);
+			return NULL;
+		}
+	}
+	return p;
+}
+
+void freePriv(Priv * p) {
+	if (p) {
+		if (p->dir)
+			dirFreePriv(p->dir);
+		if (p->indir)
+			indirFreePriv(p->indir);
+		scs_free(p);
+	}
+}
+
+idxint solveLinSys(Data * d, Priv * p, pfloat * b, const pfloat * s, idxint iter) {
+	return p->dir ? dirSolveLinSys(d, p->dir, b, s, iter) : indirSolveLinSys(d, p->indir, b, s, iter);
+}
+
+idxint solveLinSysBatch(Data * d, Priv * p, idxint K, pfloat ** b, const pfloat ** s, idxint iter) {
+	return p->dir ? dirSolveLinSysBatch(d, p->dir, K, b, s, iter) : indirSolveLinSysBatch(d, p->indir, K, b, s, iter);
+}
+
+idxint updateLinSys(Data * d, Priv * p) {
+	return p->dir ? dirUpdateLinSys(d, p->dir) : indirUpdateLinSys(d, p->indir);
+}
+
+void setLinSysResidual(Priv * p, pfloat res) {
+	if (p->dir)
+		dirSetLinSysResidual(p->dir, res);
+	else
+		indirSetLinSysResidual(p->indir, res);
+}
+
+idxint getLinSysIters(Priv * p) {
+	return p->dir ? dirGetLinSysIters(p->dir) : indirGetLinSysIters(p->indir);
+}
+
+void getLinSysProfile(Priv * p, Profile * prof) {
+	if (p->dir)
+		dirGetLinSysProfile(p->dir, prof);
+	else
+		indirGetLinSysProfile(p->indir, prof);
+	prof->orderTime += p->orderTime;
+	prof->autoChoice = p->dir ? AUTO_DIRECT : AUTO_INDIRECT;
+	prof->autoLnz = p->lnz;
+	prof->autoMem = p->mem;
+	prof->autoDirectCost = p->directCost;
+	prof->autoIndirectCost = p->indirectCost;
+}
+
+void accumByAtrans(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	if (p->dir)
+		dirAccumByAtrans(d, p->dir, x, y);
+	else
+		indirAccumByAtrans(d, p->indir, x, y);
+}
+
+void accumByA(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	if (p->dir)
+		dirAccumByA(d, p->dir, x, y);
+	else
+		indirAccumByA(d, p->indir, x, y);
+}
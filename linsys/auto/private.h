@@ -0,0 +1,47 @@
+#ifndef PRIV_H_GUARD
+#define PRIV_H_GUARD
+
+#include "glbopts.h"
+#include "scs.h"
+#include "cs.h"
+#include "linsys/direct/external/amd.h"
+#include "linsys/common.h"
+
+/* the direct and indirect solvers, compiled again by direct.c and indirect.c with their names prefixed */
+typedef struct DIR_PRIVATE_DATA DirPriv;
+typedef struct INDIR_PRIVATE_DATA IndirPriv;
+
+DirPriv * dirInitPriv(Data * d, const pfloat * D, const pfloat * E);
+idxint dirSolveLinSys(Data * d, DirPriv * p, pfloat * b, const pfloat * s, idxint iter);
+idxint dirSolveLinSysBatch(Data * d, DirPriv * p, idxint K, pfloat ** b, const pfloat ** s, idxint iter);
+void dirFreePriv(DirPriv * p);
+idxint dirUpdateLinSys(Data * d, DirPriv * p);
+void dirSetLinSysResidual(DirPriv * p, pfloat res);
+idxint dirGetLinSysIters(DirPriv * p);
+void dirGetLinSysProfile(DirPriv * p, Profile * prof);
+void dirAccumByAtrans(Data * d, DirPriv * p, const pfloat *x, pfloat *y);
+void dirAccumByA(Data * d, DirPriv * p, const pfloat *x, pfloat *y);
+char * dirGetLinSysSummary(DirPriv * p, Info * info);
+
+IndirPriv * indirInitPriv(Data * d, const pfloat * D, const pfloat * E);
+idxint indirSolveLinSys(Data * d, IndirPriv * p, pfloat * b, const pfloat * s, idxint iter);
+idxint indirSolveLinSysBatch(Data * d, IndirPriv * p, idxint K, pfloat ** b, const pfloat ** s, idxint iter);
+void indirFreePriv(IndirPriv * p);
+idxint indirUpdateLinSys(Data * d, IndirPriv * p);
+void indirSetLinSysResidual(IndirPriv * p, pfloat res);
+idxint indirGetLinSysIters(IndirPriv * p);
+void indirGetLinSysProfile(IndirPriv * p, Profile * prof);
+void indirAccumByAtrans(Data * d, IndirPriv * p, const pfloat *x, pfloat *y);
+void indirAccumByA(Data * d, IndirPriv * p, const pfloat *x, pfloat *y);
+char * indirGetLinSysSummary(IndirPriv * p, Info * info);
+
+struct PRIVATE_DATA {
+	/* exactly one of the two is set, the solver chosen by initPriv */
+	DirPriv * dir;
+	IndirPriv * indir;
+	/* the prediction of initPriv, see Profile */
+	pfloat lnz, mem, directCost, indirectCost;
+	pfloat orderTime; /* forming and ordering the KKT pattern for the prediction */
+};
+
+#endif
@@ -0,0 +1,758 @@
+#include "chordal.h"
+#include "linsys/amatrix.h"
+
+/* the chordal decomposition of CHORDAL described in chordal.h */
+
+/* a clique is merged into its parent if (|C_p| - |S|) * (|C_c| - |S|) <= CHORDAL_FILL or neither adds more than
+ CHORDAL_SIZE vertices to the other, S their separator: the new variables and rows of small cliques cost more than
+ their smaller projections save */
+#define CHORDAL_FILL 8
+#define CHORDAL_SIZE 8
+#define COMPLETION_TOL 1e-9 /* eigenvalues of a separator below this, relative to the largest, are taken as 0 */
+#define SVEC_LEN(n) ((n) * ((n) + 1) / 2)
+#define SQRT2 1.41421356237309504880
+
+#ifdef LAPACK_LIB_FOUND
+void BLAS(syevr)(char* jobz, char* range, char* uplo, blasint* n, pfloat* a, blasint* lda, pfloat* vl,
+		pfloat* vu, blasint* il, blasint* iu, pfloat* abstol, blasint* m, pfloat* w, pfloat* z, blasint* ldz,
+		blasint* isuppz, pfloat* work, blasint* lwork, blasint* iwork, blasint* liwork, blasint* info);
+#endif
+
+/* an entry of a column of the decomposed A, i its row, e the entry of A or -1 */
+typedef struct {
+	idxint i, e;
+	pfloat x;
+} Entry;
+
+static int cmpEntry(const void * a, const void * b) {
+	const Entry * e1 = a, * e2 = b;
+	return e1->i < e2->i ? -1 : (e1->i > e2->i);
+}
+
+/* the row in a cone of size n of its entry (i, j), i >= j if packed */
+static idxint entryRow(idxint n, idxint packed, idxint i, idxint j) {
+	return packed ? j * n - j * (j - 1) / 2 + i - j : i + j * n;
+}
+
+static idxint coneRows(idxint n, idxint packed) {
+	return packed ? SVEC_LEN(n) : n * n;
+}
+
+/* the rows (of the problem decomposed) of the entries of clique q of blk, in the order of the rows of its cone */
+static idxint cliqueRows(const ChordalBlock * blk, idxint q, idxint * r) {
+	const idxint * v = &(blk->cl[blk->clP[q]]);
+	idxint c = blk->clP[q + 1] - blk->clP[q], i, j, t = 0;
+	for (j = 0; j < c; ++j) {
+		for (i = blk->packed ? j : 0; i < c; ++i) {
+			r[t++] = blk->row + (blk->packed ? entryRow(blk->n, 1, MAX(v[i], v[j]), MIN(v[i], v[j]))
+					: entryRow(blk->n, 0, v[i], v[j]));
+		}
+	}
+	return t;
+}
+
+/* minimum degree elimination of the graph adj (n by n, filled in place): sets the position of each vertex in the
+ order, the order and the number of neighbors of each vertex eliminated after it, ties go to the lowest vertex and
+ the vertices left once they form a clique are eliminated in order */
+static void eliminate(char * adj, idxint n, idxint * deg, idxint * pos, idxint * order, idxint * cnt, idxint * nb) {
+	idxint p, u, v, a, b, nNb;
+	for (v = 0; v < n; ++v) {
+		pos[v] = -1;
+		deg[v] = 0;
+		for (u = 0; u < n; ++u)
+			deg[v] += adj[v * n + u];
+	}
+	for (p = 0; p < n; ++p) {
+		v = -1;
+		for (u = 0; u < n; ++u) {
+			if (pos[u] < 0 && (v < 0 || deg[u] < deg[v]))
+				v = u;
+		}
+		if (deg[v] == n - p - 1) {
+			for (u = 0; u < n; ++u) {
+				if (pos[u] < 0) {
+					pos[u] = p;
+					order[p] = u;
+					cnt[u] = n - p - 1;
+					p++;
+				}
+			}
+			return;
+		}
+		pos[v] = p;
+		order[p] = v;
+		cnt[v] = deg[v];
+		for (u = 0, nNb = 0; u < n; ++u) {
+			if (pos[u] < 0 && adj[v * n + u])
+				nb[nNb++] = u;
+		}
+		for (a = 0; a < nNb; ++a) {
+			for (b = a + 1; b < nNb; ++b) {
+				if (!adj[nb[a] * n + nb[b]]) {
+					adj[nb[a] * n + nb[b]] = adj[nb[b] * n + nb[a]] = 1;
+					deg[nb[a]]++;
+					deg[nb[b]]++;
+				}
+			}
+			deg[nb[a]]--;
+		}
+	}
+}
+
+/* the cliques of the graph adj filled by eliminate, merged, into blk if there are more than one, returns their number,
+ < 0 on failure: a vertex joins the supernode of a child in the elimination tree whose clique holds its own, the
+ clique of a supernode is its first vertex and the neighbors eliminated after it, its separator those of its last */
+static idxint setCliques(ChordalBlock * blk, const char * adj, const idxint * pos, const idxint * order,
+		const idxint * cnt, idxint * iw) {
+	idxint n = blk->n, p, q, s, t, u, v, w, a, b, nNodes = 0, nCl = 0;
+	idxint * par = iw, * node = &(iw[n]), * absorb = &(iw[2 * n]), * first = &(iw[3 * n]), * last = &(iw[4 * n]);
+	idxint * topo = &(iw[5 * n]), * nodeOf = &(iw[6 * n]), * size = &(iw[7 * n]), * sep = &(iw[8 * n]);
+	idxint * parT = &(iw[9 * n]), * into = &(iw[10 * n]), * clOf = &(iw[11 * n]), * cluster = &(iw[12 * n]);
+	/* the elimination tree, the parent of v is its neighbor eliminated next */
+	for (v = 0; v < n; ++v) {
+		par[v] = -1;
+		absorb[v] = -1;
+		for (u = 0; u < n; ++u) {
+			if (adj[v * n + u] && pos[u] > pos[v] && (par[v] < 0 || pos[u] < pos[par[v]]))
+				par[v] = u;
+		}
+	}
+	for (p = 0; p < n; ++p) {
+		v = order[p];
+		if (absorb[v] >= 0) {
+			node[v] = absorb[v];
+		} else {
+			first[nNodes] = v;
+			node[v] = nNodes++;
+		}
+		last[node[v]] = v;
+		w = par[v];
+		if (w >= 0 && absorb[w] < 0 && cnt[v] == cnt[w] + 1)
+			absorb[w] = node[v];
+	}
+	/* the supernodes by the position of their last vertex put children first */
+	for (p = 0, t = 0; p < n; ++p) {
+		v = order[p];
+		if (last[node[v]] == v)
+			topo[node[v]] = t++;
+	}
+	for (s = 0; s < nNodes; ++s) {
+		t = topo[s];
+		nodeOf[t] = s;
+		size[t] = cnt[first[s]] + 1;
+		sep[t] = cnt[last[s]];
+		parT[t] = par[last[s]] >= 0 ? topo[node[par[last[s]]]] : -1;
+		into[t] = t;
+	}
+	/* a child merged into its parent adds its vertices not in the separator, its children move to the parent */
+	for (t = 0; t < nNodes; ++t) {
+		if (parT[t] < 0)
+			continue;
+		a = size[parT[t]] - sep[t];
+		b = size[t] - sep[t];
+		if (a * b <= CHORDAL_FILL || MAX(a, b) <= CHORDAL_SIZE) {
+			into[t] = parT[t];
+			size[parT[t]] += b;
+		}
+	}
+	for (t = 0; t < nNodes; ++t)
+		clOf[t] = into[t] == t ? nCl++ : -1;
+	if (nCl < 2)
+		return nCl;
+	for (v = 0; v < n; ++v) {
+		for (t = topo[node[v]]; into[t] != t; t = into[t])
+			;
+		cluster[v] = clOf[t];
+	}
+	blk->nCl = nCl;
+	blk->clP = scs_wmalloc((nCl + 1) * sizeof(idxint));
+	blk->sepLen = scs_wmalloc(nCl * sizeof(idxint));
+	for (t = 0, s = 0; t < nNodes; ++t)
+		s += into[t] == t ? size[t] : 0;
+	blk->cl = scs_wmalloc(s * sizeof(idxint));
+	if (!blk->clP || !blk->sepLen || !blk->cl)
+		return -1;
+	/* each clique is its separator, then its own vertices */
+	blk->clP[0] = 0;
+	for (t = 0, s = 0; t < nNodes; ++t) {
+		if ((q = clOf[t]) < 0)
+			continue;
+		v = last[nodeOf[t]];
+		for (u = 0; u < n; ++u) {
+			if (adj[v * n + u] && pos[u] > pos[v])
+				blk->cl[s++] = u;
+		}
+		blk->sepLen[q] = sep[t];
+		for (u = 0; u < n; ++u) {
+			if (cluster[u] == q)
+				blk->cl[s++] = u;
+		}
+		blk->clP[q + 1] = s;
+	}
+	return nCl;
+}
+
+/* the cliques of the pattern of the cone of blk (n, packed and row set), the entries whose rows have keep set,
+ returns their number (set in blk if > 1), < 0 on failure */
+static idxint findCliques(ChordalBlock * blk, const idxint * keep) {
+	idxint n = blk->n, i, j, nCl = -1;
+	char * adj = scs_calloc(n * n, sizeof(char));
+	idxint * iw = scs_malloc(18 * n * sizeof(idxint));
+	if (adj && iw) {
+		for (j = 0; j < n; ++j) {
+			for (i = j + 1; i < n; ++i) {
+				if (keep[blk->row + entryRow(n, blk->packed, i, j)]
+						|| (!blk->packed && keep[blk->row + entryRow(n, 0, j, i)]))
+					adj[i * n + j] = adj[j * n + i] = 1;
+			}
+		}
+		eliminate(adj, n, iw, &(iw[n]), &(iw[2 * n]), &(iw[3 * n]), &(iw[4 * n]));
+		nCl = setCliques(blk, adj, &(iw[n]), &(iw[2 * n]), &(iw[3 * n]), &(iw[5 * n]));
+	}
+	if (adj)
+		scs_free(adj);
+	if (iw)
+		scs_free(iw);
+	return nCl;
+}
+
+static void freeBlock(ChordalBlock * blk) {
+	if (blk->clP)
+		scs_free(blk->clP);
+	if (blk->cl)
+		scs_free(blk->cl);
+	if (blk->sepLen)
+		scs_free(blk->sepLen);
+}
+
+/* the entries of a new variable splitting row r with its l-th row */
+static idxint splitEntries(const Chordal * ch, idxint r, idxint l, Entry * col) {
+	col[0].i = ch->rows[ch->rowP[r]];
+	col[0].e = -1;
+	col[0].x = 1;
+	col[1].i = ch->rows[ch->rowP[r] + l];
+	col[1].e = -1;
+	col[1].x = -1;
+	return 2;
+}
+
+/* the columns of the decomposed A: those of A on the first row of each of their rows, then for each new variable
+ +1 on the first row of the row it splits and -1 on its row in another clique (both for the two rows of an
+ off-diagonal entry of a full cone), uL[u] the index of that row in the rows of the row split, uT[u] the row of the
+ transposed entry or -1 */
+static idxint initDecomposedA(Chordal * ch, const AMatrix * A, const idxint * uL, const idxint * uT) {
+	AMatrix * dA = ch->d->A;
+	idxint j, q, t, u, nnz = A->p[ch->n], nu = ch->d->n - ch->n, maxCol = 4, sorted;
+	Entry * col;
+	for (j = 0; j < ch->n; ++j)
+		maxCol = MAX(maxCol, A->p[j + 1] - A->p[j]);
+	for (u = 0; u < nu; ++u)
+		nnz += uT[u] >= 0 ? 4 : 2;
+	dA->p = scs_wmalloc((ch->d->n + 1) * sizeof(idxint));
+	dA->i = scs_wmalloc(MAX(nnz, 1) * sizeof(idxint));
+	dA->x = scs_wmalloc(MAX(nnz, 1) * sizeof(pfloat));
+	ch->Amap = scs_wmalloc(MAX(nnz, 1) * sizeof(idxint));
+	col = scs_malloc(maxCol * sizeof(Entry));
+	if (!dA->p || !dA->i || !dA->x || !ch->Amap || !col) {
+		if (col)
+			scs_free(col);
+		return -1;
+	}
+	nnz = 0;
+	for (j = 0; j < ch->d->n; ++j) {
+		t = 0;
+		if (j < ch->n) {
+			for (q = A->p[j]; q < A->p[j + 1]; ++q) {
+				col[t].i = ch->rows[ch->rowP[A->i[q]]];
+				col[t].e = q;
+				col[t++].x = A->x[q];
+			}
+		} else {
+			u = j - ch->n;
+			t = splitEntries(ch, ch->uRow[u], uL[u], col);
+			if (uT[u] >= 0)
+				t += splitEntries(ch, uT[u], uL[u], &(col[t]));
+		}
+		for (q = 1, sorted = 1; q < t; ++q)
+			sorted = sorted && col[q - 1].i < col[q].i;
+		if (!sorted)
+			qsort(col, t, sizeof(Entry), cmpEntry);
+		dA->p[j] = nnz;
+		for (q = 0; q < t; ++q) {
+			dA->i[nnz] = col[q].i;
+			dA->x[nnz] = col[q].x;
+			ch->Amap[nnz++] = col[q].e;
+		}
+	}
+	dA->p[ch->d->n] = nnz;
+	scs_free(col);
+	return 0;
+}
+
+/* the rows of the decomposed problem: those of the problem decomposed in order but for the decomposed cones, whose
+ rows are those of the cones of their cliques, and the lists of rowP and rows */
+static idxint initDecomposedRows(Chordal * ch) {
+	ChordalBlock * blk;
+	idxint b, q, r, r2, m2 = ch->m, * src, * next;
+	for (b = 0; b < ch->nBlk; ++b) {
+		blk = &(ch->blks[b]);
+		m2 -= coneRows(blk->n, blk->packed);
+		for (q = 0; q < blk->nCl; ++q)
+			m2 += coneRows(blk->clP[q + 1] - blk->clP[q], blk->packed);
+	}
+	ch->d->m = m2;
+	ch->rowP = scs_wcalloc(ch->m + 1, sizeof(idxint));
+	ch->rows = scs_wmalloc(m2 * sizeof(idxint));
+	src = scs_malloc(m2 * sizeof(idxint));
+	next = scs_malloc(ch->m * sizeof(idxint));
+	if (!ch->rowP || !ch->rows || !src || !next) {
+		if (src)
+			scs_free(src);
+		if (next)
+			scs_free(next);
+		return -1;
+	}
+	for (b = 0, r = 0, r2 = 0; b < ch->nBlk; ++b) {
+		blk = &(ch->blks[b]);
+		for (; r < blk->row; ++r)
+			src[r2++] = r;
+		for (q = 0; q < blk->nCl; ++q)
+			r2 += cliqueRows(blk, q, &(src[r2]));
+		r += coneRows(blk->n, blk->packed);
+	}
+	for (; r < ch->m; ++r)
+		src[r2++] = r;
+	for (r2 = 0; r2 < m2; ++r2)
+		ch->rowP[src[r2] + 1]++;
+	for (r = 0; r < ch->m; ++r) {
+		ch->rowP[r + 1] += ch->rowP[r];
+		next[r] = ch->rowP[r];
+	}
+	/* so the rows of each row are in the order of the cliques, the first is in the first clique */
+	for (r2 = 0; r2 < m2; ++r2)
+		ch->rows[next[src[r2]]++] = r2;
+	scs_free(src);
+	scs_free(next);
+	return 0;
+}
+
+/* the new variables, t - 1 for an entry of a decomposed cone in t > 1 cliques (for both rows of an off-diagonal
+ entry of a full cone), the row each splits, its index in the rows of that row (uL) and the transposed row (uT) */
+static idxint initSplits(Chordal * ch, idxint ** uL, idxint ** uT) {
+	ChordalBlock * blk;
+	idxint b, i, j, l, r, t, u, nu = 0;
+	for (b = 0; b < ch->nBlk; ++b) {
+		blk = &(ch->blks[b]);
+		for (j = 0; j < blk->n; ++j) {
+			for (i = j; i < blk->n; ++i) {
+				r = blk->row + entryRow(blk->n, blk->packed, i, j);
+				nu += MAX(ch->rowP[r + 1] - ch->rowP[r] - 1, 0);
+			}
+		}
+	}
+	ch->d->n = ch->n + nu;
+	ch->uRow = scs_wmalloc(MAX(nu, 1) * sizeof(idxint));
+	*uL = scs_malloc(MAX(nu, 1) * sizeof(idxint));
+	*uT = scs_malloc(MAX(nu, 1) * sizeof(idxint));
+	if (!ch->uRow || !*uL || !*uT)
+		return -1;
+	for (b = 0, u = 0; b < ch->nBlk; ++b) {
+		blk = &(ch->blks[b]);
+		for (j = 0; j < blk->n; ++j) {
+			for (i = j; i < blk->n; ++i) {
+				r = blk->row + entryRow(blk->n, blk->packed, i, j);
+				t = ch->rowP[r + 1] - ch->rowP[r];
+				for (l = 1; l < t; ++l, ++u) {
+					ch->uRow[u] = r;
+					(*uL)[u] = l;
+					(*uT)[u] = !blk->packed && i != j ? blk->row + entryRow(blk->n, 0, j, i) : -1;
+				}
+			}
+		}
+	}
+	return 0;
+}
+
+/* the cones of the decomposed problem, those of the cliques in place of each decomposed one */
+static idxint initDecomposedCone(Chordal * ch, const Cone * k) {
+	Cone * dk = ch->k;
+	ChordalBlock * blk;
+	idxint i, q, n, packed, b = 0, row = k->f + k->l, ns = 0, nsp = 0;
+	dk->f = k->f;
+	dk->l = k->l;
+	dk->qsize = k->qsize;
+	dk->ep = k->ep;
+	dk->ed = k->ed;
+	dk->q = scs_wmalloc(MAX(k->qsize, 1) * sizeof(idxint));
+	if (!dk->q)
+		return -1;
+	for (i = 0; i < k->qsize; ++i) {
+		dk->q[i] = k->q[i];
+		row += k->q[i];
+	}
+	for (b = 0; b < ch->nBlk; ++b) {
+		ns += ch->blks[b].packed ? 0 : ch->blks[b].nCl - 1;
+		nsp += ch->blks[b].packed ? ch->blks[b].nCl - 1 : 0;
+	}
+	dk->s = scs_wmalloc(MAX(k->ssize + ns, 1) * sizeof(idxint));
+	dk->sp = scs_wmalloc(MAX(k->spsize + nsp, 1) * sizeof(idxint));
+	if (!dk->s || !dk->sp)
+		return -1;
+	for (i = 0, b = 0; i < k->ssize + k->spsize; ++i) {
+		packed = i >= k->ssize;
+		n = packed ? k->sp[i - k->ssize] : k->s[i];
+		blk = b < ch->nBlk && ch->blks[b].row == row ? &(ch->blks[b++]) : NULL;
+		for (q = 0; q < (blk ? blk->nCl : 1); ++q) {
+			if (packed)
+				dk->sp[dk->spsize++] = blk ? blk->clP[q + 1] - blk->clP[q] : n;
+			else
+				dk->s[dk->ssize++] = blk ? blk->clP[q + 1] - blk->clP[q] : n;
+		}
+		row += coneRows(n, packed);
+	}
+	return 0;
+}
+
+Chordal * initChordal(const Data * d, const Cone * k, const idxint * used) {
+	const AMatrix * A = d->A;
+	ChordalBlock * blk;
+	idxint i, q, nCl, row = k->f + k->l, nBlk = k->ssize + k->spsize, nDec = 0, status = 0;
+	idxint * keep = scs_malloc(d->m * sizeof(idxint)), * uL = NULL, * uT = NULL;
+	ChordalBlock * blks = scs_calloc(MAX(nBlk, 1), sizeof(ChordalBlock));
+	Chordal * ch = NULL;
+	if (!keep || !blks) {
+		status = -1;
+	} else {
+		/* the rows that can be nonzero in s */
+		memcpy(keep, used, d->m * sizeof(idxint));
+		for (q = 0; q < A->p[d->n]; ++q)
+			keep[A->i[q]] = 1;
+	}
+	for (i = 0; i < k->qsize; ++i)
+		row += k->q[i];
+	for (i = 0; i < nBlk && status == 0; ++i) {
+		blk = &(blks[i]);
+		blk->packed = i >= k->ssize;
+		blk->n = blk->packed ? k->sp[i - k->ssize] : k->s[i];
+		blk->row = row;
+		row += coneRows(blk->n, blk->packed);
+		if (blk->n > 2) {
+			nCl = findCliques(blk, keep);
+			status = nCl < 0 ? -1 : 0;
+			nDec += nCl > 1;
+		}
+	}
+	if (status == 0 && nDec > 0 && (ch = scs_wcalloc(1, sizeof(Chordal)))) {
+		ch->m = d->m;
+		ch->n = d->n;
+		ch->blks = scs_wcalloc(nDec, sizeof(ChordalBlock));
+		for (i = 0; ch->blks && i < nBlk; ++i) {
+			if (blks[i].nCl > 1) {
+				ch->blks[ch->nBlk++] = blks[i];
+				ch->nCl += blks[i].nCl;
+				for (q = 0; q < blks[i].nCl; ++q)
+					ch->maxCl = MAX(ch->maxCl, blks[i].clP[q + 1] - blks[i].clP[q]);
+				memset(&(blks[i]), 0, sizeof(ChordalBlock));
+			}
+		}
+		ch->d = scs_wcalloc(1, sizeof(Data));
+		ch->k = scs_wcalloc(1, sizeof(Cone));
+		status = ch->blks && ch->d && ch->k && (ch->d->A = scs_wcalloc(1, sizeof(AMatrix))) ? 0 : -1;
+		if (status == 0)
+			status = initDecomposedRows(ch);
+		if (status == 0)
+			status = initSplits(ch, &uL, &uT);
+		if (status == 0)
+			status = initDecomposedA(ch, A, uL, uT);
+		if (status == 0)
+			status = initDecomposedCone(ch, k);
+		if (status == 0) {
+			ch->d->b = scs_wmalloc(ch->d->m * sizeof(pfloat));
+			ch->d->c = scs_wmalloc(ch->d->n * sizeof(pfloat));
+			ch->sol.x = scs_wmalloc(ch->d->n * sizeof(pfloat));
+			ch->sol.y = scs_wmalloc(ch->d->m * sizeof(pfloat));
+			ch->sol.s = scs_wmalloc(ch->d->m * sizeof(pfloat));
+			if (!ch->d->b || !ch->d->c || !ch->sol.x || !ch->sol.y || !ch->sol.s)
+				status = -1;
+		}
+		if (status < 0) {
+			freeChordal(ch);
+			ch = NULL;
+		}
+	}
+	for (i = 0; blks && i < nBlk; ++i)
+		freeBlock(&(blks[i]));
+	if (blks)
+		scs_free(blks);
+	if (keep)
+		scs_free(keep);
+	if (uL)
+		scs_free(uL);
+	if (uT)
+		scs_free(uT);
+	return ch;
+}
+
+idxint chordalBC(Chordal * ch, const pfloat * b, const pfloat * c, pfloat * rb, pfloat * rc) {
+	idxint i;
+	memset(rb, 0, ch->d->m * sizeof(pfloat));
+	for (i = 0; i < ch->m; ++i) {
+		if (ch->rowP[i] < ch->rowP[i + 1])
+			rb[ch->rows[ch->rowP[i]]] = b[i];
+		else if (b[i] != 0)
+			return FAILURE;
+	}
+	memcpy(rc, c, ch->n * sizeof(pfloat));
+	memset(&(rc[ch->n]), 0, (ch->d->n - ch->n) * sizeof(pfloat));
+	return 0;
+}
+
+void chordalSol(Chordal * ch, const Sol * sol, Sol * rsol) {
+	idxint i, q, t, u;
+	memcpy(rsol->x, sol->x, ch->n * sizeof(pfloat));
+	for (u = 0; u < ch->d->n - ch->n; ++u) {
+		i = ch->uRow[u];
+		rsol->x[ch->n + u] = sol->s[i] / (ch->rowP[i + 1] - ch->rowP[i]);
+	}
+	for (i = 0; i < ch->m; ++i) {
+		t = ch->rowP[i + 1] - ch->rowP[i];
+		for (q = ch->rowP[i]; q < ch->rowP[i + 1]; ++q) {
+			rsol->y[ch->rows[q]] = sol->y[i];
+			rsol->s[ch->rows[q]] = sol->s[i] / t;
+		}
+	}
+}
+
+/* P = the pseudo-inverse of the s by s symmetric positive semidefinite S (overwritten), returns < 0 if not computed
+ (without LAPACK for s > 1, where the cliques could not be projected either) */
+static idxint pseudoInverse(pfloat * S, idxint s, pfloat * P) {
+#ifdef LAPACK_LIB_FOUND
+	idxint i, j, t, status = -1;
+	blasint n = (blasint) s, m = 0, lwork = -1, liwork = -1, iwkopt = 0, info = -1;
+	pfloat wkopt = 0, abstol = 0, emax = 0;
+	pfloat * e = scs_malloc(s * sizeof(pfloat)), * Z = scs_malloc(s * s * sizeof(pfloat)), * work = NULL;
+	blasint * isuppz = scs_malloc(2 * s * sizeof(blasint)), * iwork = NULL;
+	if (e && Z && isuppz) {
+		BLAS(syevr)("Vectors", "All", "Lower", &n, S, &n, NULL, NULL, NULL, NULL, &abstol, &m, e, Z, &n, isuppz,
+				&wkopt, &lwork, &iwkopt, &liwork, &info);
+		lwork = (blasint) (wkopt + 0.01);
+		liwork = iwkopt;
+		work = scs_malloc(MAX(lwork, 1) * sizeof(pfloat));
+		iwork = scs_malloc(MAX(liwork, 1) * sizeof(blasint));
+	}
+	if (info == 0 && work && iwork) {
+		BLAS(syevr)("Vectors", "All", "Lower", &n, S, &n, NULL, NULL, NULL, NULL, &abstol, &m, e, Z, &n, isuppz,
+				work, &lwork, iwork, &liwork, &info);
+	}
+	if (info == 0 && work && iwork) {
+		for (t = 0; t < m; ++t)
+			emax = MAX(emax, ABS(e[t]));
+		memset(P, 0, s * s * sizeof(pfloat));
+		for (t = 0; t < m; ++t) {
+			if (e[t] <= COMPLETION_TOL * emax)
+				continue;
+			for (j = 0; j < s; ++j) {
+				for (i = 0; i < s; ++i)
+					P[i + j * s] += Z[i + t * s] * Z[j + t * s] / e[t];
+			}
+		}
+		status = 0;
+	}
+	if (e)
+		scs_free(e);
+	if (Z)
+		scs_free(Z);
+	if (isuppz)
+		scs_free(isuppz);
+	if (work)
+		scs_free(work);
+	if (iwork)
+		scs_free(iwork);
+	return status;
+#else
+	if (s > 1)
+		return -1;
+	P[0] = S[0] > 0 ? 1 / S[0] : 0;
+	return 0;
+#endif
+}
+
+/* sets y on the dropped rows of blk to a PSD completion of the matrix Y of y on the cliques: from the roots, the
+ entries between the own vertices R of a clique and the vertices W of the cliques before it but not in its separator
+ S are Y(R, W) = Y(R, S) Y(S, S)^+ Y(S, W) */
+static void completeBlock(const Chordal * ch, const ChordalBlock * blk, pfloat * y) {
+	idxint n = blk->n, i, j, q, t, c, s, r, nW, sMax = 1;
+	const idxint * v;
+	pfloat * Y, * S, * P, * M, sum;
+	idxint * W;
+	char * inW, * inS;
+	for (q = 0; q < blk->nCl; ++q)
+		sMax = MAX(sMax, blk->sepLen[q]);
+	Y = scs_malloc(n * n * sizeof(pfloat));
+	S = scs_malloc(sMax * sMax * sizeof(pfloat));
+	P = scs_malloc(sMax * sMax * sizeof(pfloat));
+	M = scs_malloc(sMax * n * sizeof(pfloat));
+	W = scs_malloc(n * sizeof(idxint));
+	inW = scs_calloc(n, sizeof(char));
+	inS = scs_calloc(n, sizeof(char));
+	if (Y && S && P && M && W && inW && inS) {
+		for (j = 0; j < n; ++j) {
+			for (i = j; i < n; ++i) {
+				r = blk->row + entryRow(n, blk->packed, i, j);
+				if (i == j)
+					Y[i + j * n] = y[r];
+				else if (blk->packed)
+					Y[i + j * n] = Y[j + i * n] = y[r] / SQRT2;
+				else
+					Y[i + j * n] = Y[j + i * n] = (y[r] + y[blk->row + entryRow(n, 0, j, i)]) / 2;
+			}
+		}
+		for (q = blk->nCl - 1; q >= 0; --q) {
+			v = &(blk->cl[blk->clP[q]]);
+			c = blk->clP[q + 1] - blk->clP[q];
+			s = blk->sepLen[q];
+			for (t = 0; t < s; ++t)
+				inS[v[t]] = 1;
+			for (i = 0, nW = 0; i < n; ++i) {
+				if (inW[i] && !inS[i])
+					W[nW++] = i;
+			}
+			for (j = 0; j < s; ++j) {
+				for (i = 0; i < s; ++i)
+					S[i + j * s] = Y[v[i] + v[j] * n];
+			}
+			/* M = Y(S, S)^+ Y(S, W), then Y(R, W) = Y(R, S) M */
+			if (s > 0 && nW > 0 && pseudoInverse(S, s, P) == 0) {
+				for (t = 0; t < nW; ++t) {
+					for (i = 0; i < s; ++i) {
+						for (j = 0, sum = 0; j < s; ++j)
+							sum += P[i + j * s] * Y[v[j] + W[t] * n];
+						M[i + t * s] = sum;
+					}
+				}
+				for (i = s; i < c; ++i) {
+					for (t = 0; t < nW; ++t) {
+						for (j = 0, sum = 0; j < s; ++j)
+							sum += Y[v[i] + v[j] * n] * M[j + t * s];
+						Y[v[i] + W[t] * n] = Y[W[t] + v[i] * n] = sum;
+					}
+				}
+			}
+			for (t = 0; t < s; ++t)
+				inS[v[t]] = 0;
+			for (t = 0; t < c; ++t)
+				inW[v[t]] = 1;
+		}
+		for (j = 0; j < n; ++j) {
+			for (i = j + 1; i < n; ++i) {
+				r = blk->row + entryRow(n, blk->packed, i, j);
+				if (ch->rowP[r] < ch->rowP[r + 1])
+					continue;
+				y[r] = blk->packed ? Y[i + j * n] * SQRT2 : Y[i + j * n];
+				if (!blk->packed)
+					y[blk->row + entryRow(n, 0, j, i)] = Y[i + j * n];
+			}
+		}
+	}
+	if (Y)
+		scs_free(Y);
+	if (S)
+		scs_free(S);
+	if (P)
+		scs_free(P);
+	if (M)
+		scs_free(M);
+	if (W)
+		scs_free(W);
+	if (inW)
+		scs_free(inW);
+	if (inS)
+		scs_free(inS);
+}
+
+void unchordalSol(Chordal * ch, const Sol * rsol, Sol * sol, idxint status) {
+	idxint i, q;
+	pfloat s;
+	if (status != SOLVED && status != INFEASIBLE && status != UNBOUNDED) {
+		scaleArray(sol->x, NAN, ch->n);
+		scaleArray(sol->y, NAN, ch->m);
+		scaleArray(sol->s, NAN, ch->m);
+		return;
+	}
+	memcpy(sol->x, rsol->x, ch->n * sizeof(pfloat));
+	for (i = 0; i < ch->m; ++i) {
+		for (q = ch->rowP[i], s = 0; q < ch->rowP[i + 1]; ++q)
+			s += rsol->s[ch->rows[q]];
+		sol->s[i] = s;
+		sol->y[i] = ch->rowP[i] < ch->rowP[i + 1] ? rsol->y[ch->rows[ch->rowP[i]]] : 0;
+	}
+	if (status == UNBOUNDED) {
+		scaleArray(sol->y, NAN, ch->m);
+		return;
+	}
+	for (i = 0; i < ch->nBlk; ++i)
+		completeBlock(ch, &(ch->blks[i]), sol->y);
+	if (status == INFEASIBLE) {
+		scaleArray(sol->x, NAN, ch->n);
+		scaleArray(sol->s, NAN, ch->m);
+	}
+}
+
+void updateChordal(Chordal * ch, const AMatrix * A) {
+	AMatrix * dA = ch->d->A;
+	idxint q;
+	for (q = 0; q < dA->p[ch->d->n]; ++q) {
+		if (ch->Amap[q] >= 0)
+			dA->x[q] = A->x[ch->Amap[q]];
+	}
+}
+
+void freeChordal(Chordal * ch) {
+	idxint i;
+	if (ch) {
+		if (ch->d) {
+			if (ch->d->A) {
+				if (ch->d->A->p)
+					scs_free(ch->d->A->p);
+				if (ch->d->A->i)
+					scs_free(ch->d->A->i);
+				if (ch->d->A->x)
+					scs_free(ch->d->A->x);
+				scs_free(ch->d->A);
+			}
+			if (ch->d->b)
+				scs_free(ch->d->b);
+			if (ch->d->c)
+				scs_free(ch->d->c);
+			scs_free(ch->d);
+		}
+		if (ch->k) {
+			if (ch->k->q)
+				scs_free(ch->k->q);
+			if (ch->k->s)
+				scs_free(ch->k->s);
+			if (ch->k->sp)
+				scs_free(ch->k->sp);
+			scs_free(ch->k);
+		}
+		if (ch->sol.x)
+			scs_free(ch->sol.x);
+		if (ch->sol.y)
+			scs_free(ch->sol.y);
+		if (ch->sol.s)
+			scs_free(ch->sol.s);
+		if (ch->rowP)
+			scs_free(ch->rowP);
+		if (ch->rows)
+			scs_free(ch->rows);
+		if (ch->uRow)
+			scs_free(ch->uRow);
+		if (ch->Amap)
+			scs_free(ch->Amap);
+		for (i = 0; ch->blks && i < ch->nBlk; ++i)
+			freeBlock(&(ch->blks[i]));
+		if (ch->blks)
+			scs_free(ch->blks);
+		scs_free(ch);
+	}
+}
@@ -1,4 +1,9 @@
 #include "common.h"
+#include "cs.h"
+#include <limits.h>
+#ifdef OPENMP
+#include <omp.h>
+#endif
 /* contains routines common to direct and indirect sparse solvers */
 
 #define MIN_SCALE 1e-3
@@ -34,9 +39,138 @@ idxint validateLinSys(Data *d) {
 		scs_printf("number of rows in A inconsistent with input dimension\n");
 		return -1;
 	}
+#ifdef COMPACT_ROWS
+	if (d->m + d->n > INT_MAX) {
+		scs_printf("m + n = %li is too large for COMPACT_INDICES\n", (long) (d->m + d->n));
+		return -1;
+	}
+#endif
 	return 0;
 }
 
+static pfloat scaledAij(const AScaling * s, pfloat a, idxint i, idxint j) {
+	/* same operation order as normalizing A in place: ((a / D_i) * (1 / E_j)) * scale */
+	return s->D ? a / s->D[i] * (1.0 / s->E[j]) * s->scale : a;
+}
+
+idxint initAScaling(Data * d, AScaling * s, const pfloat * D, const pfloat * E) {
+	s->D = D;
+	s->E = E;
+	s->scale = D ? d->SCALE : 1.0;
+	s->wrk = scs_wmalloc(MAX(d->m, d->n) * sizeof(pfloat));
+	return s->wrk ? 0 : -1;
+}
+
+void freeAScaling(AScaling * s) {
+	if (s->wrk)
+		scs_free(s->wrk);
+	s->wrk = NULL;
+}
+
+void accumByScaledAtrans(Data * d, AScaling * s, const pfloat * x, pfloat * y) {
+	/* y += scale * E^-1 * A' * D^-1 * x
+	 A in column compressed format
+	 parallelizes over columns (rows of A')
+	 */
+	AMatrix * A = d->A;
+	const pfloat * xs = x;
+	idxint p, j, c1, c2;
+	pfloat yj;
+	if (s->D) {
+		for (j = 0; j < d->m; ++j) {
+			s->wrk[j] = x[j] / s->D[j];
+		}
+		xs = s->wrk;
+	}
+#ifdef OPENMP
+#pragma omp parallel for private(p,c1,c2,yj)
+#endif
+	for (j = 0; j < d->n; j++) {
+		yj = s->D ? 0 : y[j];
+		c1 = A->p[j];
+		c2 = A->p[j + 1];
+		for (p = c1; p < c2; p++) {
+			yj += A->x[p] * xs[A->i[p]];
+		}
+		y[j] = s->D ? y[j] + yj * (s->scale / s->E[j]) : yj;
+	}
+}
+
+void accumByScaledA(Data * d, AScaling * s, const pfloat * x, pfloat * y) {
+	/* y += scale * D^-1 * A * E^-1 * x
+	 A in column compressed format
+	 not parallelized, concurrent writes to y would race;
+	 the solvers that store A' use the parallel product with A' instead
+	 */
+	AMatrix * A = d->A;
+	pfloat * ys = y;
+	idxint p, j, c1, c2;
+	pfloat xj;
+	if (s->D) {
+		ys = s->wrk;
+		memset(ys, 0, d->m * sizeof(pfloat));
+	}
+	for (j = 0; j < d->n; j++) {
+		xj = s->D ? x[j] * (s->scale / s->E[j]) : x[j];
+		c1 = A->p[j];
+		c2 = A->p[j + 1];
+		for (p = c1; p < c2; p++) {
+			ys[A->i[p]] += A->x[p] * xj;
+		}
+	}
+	if (s->D) {
+		for (j = 0; j < d->m; ++j) {
+			y[j] += ys[j] / s->D[j];
+		}
+	}
+}
+
+/* forms A' in column compressed format (i.e., row compressed A) with the normalized values,
+ * C must be preallocated: Cx and Ci of size nnz(A), Cp of size m+1 */
+void transposeA(Data * d, const AScaling * s, pfloat * Cx, rowidx * Ci, idxint * Cp) {
+	idxint m = d->m;
+	idxint n = d->n;
+
+	idxint * Ap = d->A->p;
+	idxint * Ai = d->A->i;
+	pfloat * Ax = d->A->x;
+
+	idxint i, j, q, *z, c1, c2;
+#ifdef EXTRAVERBOSE
+	timer transposeTimer;
+	scs_printf("transposing A\n");
+	tic(&transposeTimer);
+#endif
+
+	z = scs_calloc(m, sizeof(idxint));
+	for (i = 0; i < Ap[n]; i++)
+		z[Ai[i]]++; /* row counts */
+	cs_cumsum(Cp, z, m); /* row pointers */
+
+	for (j = 0; j < n; j++) {
+		c1 = Ap[j];
+		c2 = Ap[j + 1];
+		for (i = c1; i < c2; i++) {
+			q = z[Ai[i]];
+			Ci[q] = (rowidx) j; /* place A(i,j) as entry C(j,i) */
+			Cx[q] = scaledAij(s, Ax[i], Ai[i], j);
+			z[Ai[i]]++;
+		}
+	}
+	scs_free(z);
+
+#ifdef EXTRAVERBOSE
+	scs_printf("finished transposing A, time: %1.2es\n", tocq(&transposeTimer) / 1e3);
+#endif
+
+}
+
+void setAMatrixValues(Data * d, const pfloat * Ax) {
+	if (Ax != d->A->x) {
+		memcpy(d->A->x, Ax, d->A->p[d->n] * sizeof(pfloat));
+	}
+}
+
 void printAMatrix(Data * d) {
 	idxint i, j;
 	AMatrix * A = d->A;
@@ -54,40 +188,85 @@ void printAMatrix(Data * d) {
 	}
 }
 
+/* threads of the row norm scatters of normalizeA, each scatters into its own buffer of m rows: only used with a
+ few nonzeros per row for each thread, which also bounds the buffers by nnz(A) / 2 */
+static idxint normalizeThreads(Data * d) {
+#ifdef OPENMP
+	idxint nThreads = d->A->p[d->n] / (2 * d->m);
+	return MAX(1, MIN(nThreads, (idxint) omp_get_max_threads()));
+#else
+	return 1;
+#endif
+}
+
+/* sums the nThreads buffers of m rows into the first */
+static void sumBuffers(pfloat * bufs, idxint m, idxint nThreads) {
+	idxint i, t;
+	if (nThreads == 1)
+		return;
+#ifdef OPENMP
+#pragma omp parallel for private(t) num_threads(nThreads)
+#endif
+	for (i = 0; i < m; ++i) {
+		for (t = 1; t < nThreads; ++t) {
+			bufs[i] += bufs[t * m + i];
+		}
+	}
+}
+
+/* squared row norms of D^-1 * A * E^-1 (of A if D is NULL) into the first m entries of bufs, the columns are
+ split in blocks among the threads */
+static void rowNormsSq(Data * d, const pfloat * D, const pfloat * E, pfloat * bufs, idxint nThreads) {
+	AMatrix * A = d->A;
+	idxint i, j;
+	pfloat wrk;
+	memset(bufs, 0, nThreads * d->m * sizeof(pfloat));
+#ifdef OPENMP
+#pragma omp parallel for private(i, wrk) schedule(static) num_threads(nThreads)
+#endif
+	for (j = 0; j < d->n; ++j) {
+#ifdef OPENMP
+		pfloat * nms = &(bufs[omp_get_thread_num() * d->m]);
+#else
+		pfloat * nms = bufs;
+#endif
+		for (i = A->p[j]; i < A->p[j + 1]; ++i) {
+			wrk = D ? A->x[i] / D[A->i[i]] / E[j] : A->x[i];
+			nms[A->i[i]] += wrk * wrk;
+		}
+	}
+	sumBuffers(bufs, d->m, nThreads);
+}
+
 void normalizeA(Data * d, Work * w, Cone * k) {
+	/* computes D and E only, A itself is not rewritten (see AScaling), each pass reads A twice: for the row norms,
+	 and for the col norms, which in the last pass also gathers the row and col norms of D^-1 * A * E^-1 */
 	AMatrix * A = d->A;
 	pfloat * D = scs_malloc(d->m * sizeof(pfloat));
-	pfloat * E = scs_malloc(d->n * sizeof(pfloat));
-	pfloat * Dt = scs_malloc(d->m * sizeof(pfloat));
-	pfloat * Et = scs_malloc(d->n * sizeof(pfloat));
-	pfloat * nms = scs_calloc(d->m, sizeof(pfloat));
+	/* re-normalizing (scs_update_A) reuses w->D and w->E, the solvers keep pointers to them */
+	pfloat * Dt = w->D ? w->D : scs_wmalloc(d->m * sizeof(pfloat));
+	pfloat * Et = w->E ? w->E : scs_wmalloc(d->n * sizeof(pfloat));
+	idxint nThreads = normalizeThreads(d);
+	pfloat * nms = scs_malloc(nThreads * d->m * sizeof(pfloat)); /* a buffer of m rows for each thread */
 	pfloat minRowScale = MIN_SCALE * SQRTF((pfloat) d->n), maxRowScale = MAX_SCALE * SQRTF((pfloat) d->n);
 	pfloat minColScale = MIN_SCALE * SQRTF((pfloat) d->m), maxColScale = MAX_SCALE * SQRTF((pfloat) d->m);
-	idxint i, j, l, count, delta, *boundaries, c1, c2;
-	pfloat wrk, e;
+	idxint i, j, l, count, delta, *boundaries, last;
+	pfloat wrk, e, colSq, meanNormColA = 0.0, meanNormRowA = 0.0;
 	idxint numBoundaries = getConeBoundaries(k, &boundaries);
 
 #ifdef EXTRAVERBOSE
 	timer normalizeTimer;
 	tic(&normalizeTimer);
-	scs_printf("normalizing A\n");
+	scs_printf("normalizing A with %li threads\n", (long) nThreads);
 	printAMatrix(d);
 #endif
 
 	for (l = 0; l < NUM_SCALE_PASSES; ++l) {
-		memset(D, 0, d->m * sizeof(pfloat));
-		memset(E, 0, d->n * sizeof(pfloat));
-		/* calculate row norms */
-		for (i = 0; i < d->n; ++i) {
-			c1 = A->p[i];
-			c2 = A->p[i + 1];
-			for (j = c1; j < c2; ++j) {
-				wrk = A->x[j];
-				D[A->i[j]] += wrk * wrk;
-			}
-		}
+		last = (l == NUM_SCALE_PASSES - 1);
+		/* calculate row norms of A scaled by the previous passes */
+		rowNormsSq(d, l == 0 ? NULL : Dt, Et, nms, nThreads);
 		for (i = 0; i < d->m; ++i) {
-			D[i] = SQRTF(D[i]); /* just the norms */
+			D[i] = SQRTF(nms[i]); /* just the norms */
 		}
 
 		/* mean of norms of rows across each cone  */
@@ -111,81 +290,122 @@ void normalizeA(Data * d, Work * w, Cone * k) {
 			else if (D[i] > maxRowScale)
 				D[i] = maxRowScale;
 		}
+		for (i = 0; i < d->m; ++i) {
+			Dt[i] = (l == 0) ? D[i] : Dt[i] * D[i];
+		}
 
-		/* scale the rows with D */
-		for (i = 0; i < d->n; ++i) {
-			for (j = A->p[i]; j < A->p[i + 1]; ++j) {
-				A->x[j] /= D[A->i[j]];
+		/* calculate col norms of the row scaled A, E, and in the last pass scatter the rows of the scaled A while
+		 its column is in cache */
+		if (last)
+			memset(nms, 0, nThreads * d->m * sizeof(pfloat));
+#ifdef OPENMP
+#pragma omp parallel for private(i, wrk, e, colSq) schedule(static) num_threads(nThreads) \
+		reduction(+:meanNormColA)
+#endif
+		for (j = 0; j < d->n; ++j) {
+			colSq = 0;
+			for (i = A->p[j]; i < A->p[j + 1]; ++i) {
+				wrk = A->x[i] / Dt[A->i[i]];
+				if (l > 0)
+					wrk /= Et[j];
+				colSq += wrk * wrk;
 			}
-		}
-		/* calculate and scale by col norms, E */
-		for (i = 0; i < d->n; ++i) {
-			c1 = A->p[i + 1] - A->p[i];
-			e = calcNorm(&(A->x[A->p[i]]), c1);
+			e = SQRTF(colSq);
 			if (e < minColScale)
 				e = 1;
 			else if (e > maxColScale)
 				e = maxColScale;
-			scaleArray(&(A->x[A->p[i]]), 1.0 / e, c1);
-			E[i] = e;
-		}
-
-		for (i = 0; i < d->m; ++i) {
-			Dt[i] = (l == 0) ? D[i] : Dt[i] * D[i];
-		}
-		for (i = 0; i < d->n; ++i) {
-			Et[i] = (l == 0) ? E[i] : Et[i] * E[i];
+			Et[j] = (l == 0) ? e : Et[j] * e;
+			if (last) {
+#ifdef OPENMP
+				pfloat * rowSq = &(nms[omp_get_thread_num() * d->m]);
+#else
+				pfloat * rowSq = nms;
+#endif
+				for (i = A->p[j]; i < A->p[j + 1]; ++i) {
+					wrk = A->x[i] / Dt[A->i[i]] * (1.0 / Et[j]);
+					rowSq[A->i[i]] += wrk * wrk;
+				}
+				meanNormColA += SQRTF(colSq) / e / d->n;
+			}
 		}
 	}
 	scs_free(boundaries);
 	scs_free(D);
-	scs_free(E);
 
-	/* calculate mean of row norms of A */
-	for (i = 0; i < d->n; ++i) {
-		for (j = A->p[i]; j < A->p[i + 1]; ++j) {
-			wrk = A->x[j];
-			nms[A->i[j]] += wrk * wrk;
-		}
-	}
-	w->meanNormRowA = 0.0;
+	/* mean of row and col norms of D^-1 * A * E^-1 */
+	sumBuffers(nms, d->m, nThreads);
 	for (i = 0; i < d->m; ++i) {
-		w->meanNormRowA += SQRTF(nms[i]) / d->m;
+		meanNormRowA += SQRTF(nms[i]) / d->m;
 	}
 	scs_free(nms);
-
-	/* calculate mean of col norms of A */
-	w->meanNormColA = 0.0;
-	for (i = 0; i < d->n; ++i) {
-		c1 = A->p[i + 1] - A->p[i];
-		w->meanNormColA += calcNorm(&(A->x[A->p[i]]), c1) / d->n;
-	}
-
-	/* scale up by d->SCALE if not equal to 1 */
-	if (d->SCALE != 1) {
-		scaleArray(A->x, d->SCALE, A->p[d->n]);
-	}
+	w->meanNormColA = meanNormColA;
+	w->meanNormRowA = meanNormRowA;
 
 	w->D = Dt;
 	w->E = Et;
 
 #ifdef EXTRAVERBOSE
 	scs_printf("finished normalizing A, time: %1.2es\n", tocq(&normalizeTimer) / 1e3);
-	printAMatrix(d);
 #endif
 }
 
-void unNormalizeA(Data *d, Work * w) {
-	idxint i, j;
-	pfloat * D = w->D;
-	pfloat * E = w->E;
+cs * formKKT(Data * d, const AScaling * s, const idxint * pinv, idxint values) {
+	/* ONLY UPPER TRIANGULAR PART IS STUFFED
+	 * forms the upper triangular part of P * [RHO_X * I A'; A -I] * P' with the normalized A, P the permutation
+	 * with inverse pinv (the identity if pinv is NULL), in column compressed form straight from the columns of A
+	 * (no triplet form or cs_symperm copy), entry (i, j) of the KKT goes to column max(pinv[i], pinv[j])
+	 */
+	idxint i, j, k, q, c;
+	const idxint n = d->n, nm = d->n + d->m;
 	AMatrix * A = d->A;
-	for (i = 0; i < d->n; ++i) {
-		scaleArray(&(A->x[A->p[i]]), E[i] / d->SCALE, A->p[i + 1] - A->p[i]);
+	const idxint Knzmax = nm + A->p[n];
+	cs * K = cs_spalloc(nm, nm, Knzmax, values, 0);
+	idxint * w = scs_calloc(nm, sizeof(idxint));
+
+#ifdef EXTRAVERBOSE
+	scs_printf("forming KKT\n");
+#endif
+
+	if (!K || !w) {
+		if (w)
+			scs_free(w);
+		return cs_spfree(K);
+	}
+	/* column counts: the diagonal, then A' at top right (A(i, j) is entry (j, n + i)) */
+	for (k = 0; k < nm; k++) {
+		w[pinv ? pinv[k] : k]++;
+	}
+	for (j = 0; j < n; j++) {
+		for (k = A->p[j]; k < A->p[j + 1]; k++) {
+			i = A->i[k] + n;
+			w[pinv ? MAX(pinv[i], pinv[j]) : i]++;
+		}
+	}
+	cs_cumsum(K->p, w, nm);
+	/* RHO_X * I at top left, A', -I at bottom right, in this order the columns of the unpermuted KKT are sorted */
+	for (k = 0; k < n; k++) {
+		q = w[pinv ? pinv[k] : k]++;
+		K->i[q] = pinv ? pinv[k] : k;
+		if (values)
+			K->x[q] = d->RHO_X;
 	}
-	for (i = 0; i < d->n; ++i) {
-		for (j = A->p[i]; j < A->p[i + 1]; ++j) {
-			A->x[j] *= D[A->i[j]];
+	for (j = 0; j < n; j++) {
+		for (k = A->p[j]; k < A->p[j + 1]; k++) {
+			i = A->i[k] + n;
+			c = pinv ? MAX(pinv[i], pinv[j]) : i;
+			q = w[c]++;
+			K->i[q] = pinv ? MIN(pinv[i], pinv[j]) : j;
+			if (values)
+				K->x[q] = scaledAij(s, A->x[k], A->i[k], j);
 		}
 	}
+	for (k = n; k < nm; k++) {
+		q = w[pinv ? pinv[k] : k]++;
+		K->i[q] = pinv ? pinv[k] : k;
+		if (values)
+			K->x[q] = -1;
+	}
+	scs_free(w);
+	return K;
 }
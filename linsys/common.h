@@ -4,9 +4,27 @@
 #include "glbopts.h"
 #include "cones.h"
 #include "amatrix.h"
+#include "cs.h"
+
+/* the normalization of A, kept apart from its values: the solvers use Anew = scale * D^-1 * A * E^-1,
+ * D and E are NULL (and scale is 1) if A is not normalized */
+typedef struct {
+	const pfloat * D, * E;
+	pfloat scale;
+	pfloat * wrk; /* workspace for products with A, size max(m, n) */
+} AScaling;
 
 /* contains routines common to direct and indirect sparse solvers */
 idxint validateLinSys(Data *d);
 void normalizeA(Data * d, Work * w, Cone * k);
-void unNormalizeA(Data *d, Work * w);
+void setAMatrixValues(Data * d, const pfloat * Ax);
+idxint initAScaling(Data * d, AScaling * s, const pfloat * D, const pfloat * E);
+void freeAScaling(AScaling * s);
+/* y += Anew' * x and y += Anew * x using the (unnormalized) values of d->A */
+void accumByScaledAtrans(Data * d, AScaling * s, const pfloat * x, pfloat * y);
+void accumByScaledA(Data * d, AScaling * s, const pfloat * x, pfloat * y);
+/* the copies of A made by the solvers hold the normalized values */
+void transposeA(Data * d, const AScaling * s, pfloat * Cx, rowidx * Ci, idxint * Cp);
+/* the upper triangular part of the KKT, symmetrically permuted by pinv (if not NULL), pattern only if !values */
+cs * formKKT(Data * d, const AScaling * s, const idxint * pinv, idxint values);
 #endif
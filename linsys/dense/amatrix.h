@@ -0,0 +1,10 @@
+#ifndef DENSE_AMATRIX_H_GUARD
+#define DENSE_AMATRIX_H_GUARD
+
+/* this struct defines the data matrix A for the dense solver, all m * n entries are stored, for problems whose A has
+ * few zeros (e.g. regression or portfolio models with n in the thousands) */
+struct A_DATA_MATRIX {
+	pfloat * x; /* A values in column major order, entry (i, j) is x[i + j * m], size: m * n */
+};
+
+#endif
@@ -0,0 +1,374 @@
+#include "private.h"
+#include <limits.h>
+
+/* dense solver: A is stored in full (see linsys/dense/amatrix.h), the x part of the KKT system is reduced to
+ * (RHO_X * I + A'A) x = b_x + A'b_y, which is formed with syrk and factorized with potrf once, each solve is then a
+ * gemv with A', a potrs with the factor and a gemv with A (a gemm and a potrs with K right hand sides in a batch) */
+
+/* bounds of the normalization, as for the sparse solvers */
+#define MIN_SCALE 1e-3
+#define MAX_SCALE 1e3
+/* rows of the normalized A formed at a time for syrk */
+#define ROW_BLOCK 256
+
+void BLAS(syrk)(const char *uplo, const char *trans, const blasint *n, const blasint *k, const pfloat *alpha,
+		const pfloat *a, const blasint *lda, const pfloat *beta, pfloat *c, const blasint *ldc);
+void BLAS(potrf)(const char *uplo, const blasint *n, pfloat *a, const blasint *lda, blasint *info);
+void BLAS(potrs)(const char *uplo, const blasint *n, const blasint *nrhs, const pfloat *a, const blasint *lda,
+		pfloat *b, const blasint *ldb, blasint *info);
+void BLAS(gemv)(const char *trans, const blasint *m, const blasint *n, const pfloat *alpha, const pfloat *a,
+		const blasint *lda, const pfloat *x, const blasint *incx, const pfloat *beta, pfloat *y, const blasint *incy);
+void BLAS(gemm)(const char *transa, const char *transb, const blasint *m, const blasint *n, const blasint *k,
+		const pfloat *alpha, const pfloat *a, const blasint *lda, const pfloat *b, const blasint *ldb,
+		const pfloat *beta, pfloat *c, const blasint *ldc);
+
+char * getLinSysMethod(Data * d, Priv * p) {
+	char * str = scs_malloc(sizeof(char) * 96);
+	sprintf(str, "dense-direct, A is %li by %li, Cholesky of RHO_X * I + A'A", (long) d->m, (long) d->n);
+	return str;
+}
+
+char * getLinSysSummary(Priv * p, Info * info) {
+	char * str = scs_malloc(sizeof(char) * 64);
+	sprintf(str, "\tLin-sys: avg solve time: %1.2es\n", p->totalSolveTime / (info->iter + 1) / 1e3);
+	return str;
+}
+
+idxint validateLinSys(Data *d) {
+	if (!d->A->x) {
+		scs_printf("data incompletely specified\n");
+		return -1;
+	}
+#ifndef DLONG
+	/* the entries of A and of the factor are indexed by idxint */
+	if ((pfloat) d->m * d->n > INT_MAX || (pfloat) d->n * d->n > INT_MAX) {
+		scs_printf("A is %li by %li, too large for the dense solver without DLONG\n", (long) d->m, (long) d->n);
+		return -1;
+	}
+#endif
+	return 0;
+}
+
+void normalizeA(Data * d, Work * w, Cone * k) {
+	/* as for the sparse solvers, in one pass */
+	const pfloat * Ax = d->A->x, * a;
+	pfloat * D = w->D ? w->D : scs_wmalloc(d->m * sizeof(pfloat));
+	pfloat * E = w->E ? w->E : scs_wmalloc(d->n * sizeof(pfloat));
+	pfloat * nms = scs_calloc(d->m, sizeof(pfloat));
+	pfloat minRowScale = MIN_SCALE * SQRTF((pfloat) d->n), maxRowScale = MAX_SCALE * SQRTF((pfloat) d->n);
+	pfloat minColScale = MIN_SCALE * SQRTF((pfloat) d->m), maxColScale = MAX_SCALE * SQRTF((pfloat) d->m);
+	idxint i, j, count, delta, * boundaries;
+	idxint numBoundaries = getConeBoundaries(k, &boundaries);
+	pfloat wrk, colSq;
+
+	for (j = 0; j < d->n; ++j) {
+		a = &(Ax[j * d->m]);
+		for (i = 0; i < d->m; ++i) {
+			nms[i] += a[i] * a[i];
+		}
+	}
+	for (i = 0; i < d->m; ++i) {
+		D[i] = SQRTF(nms[i]);
+	}
+	/* mean of norms of rows across each cone */
+	count = boundaries[0];
+	for (i = 1; i < numBoundaries; ++i) {
+		wrk = 0;
+		delta = boundaries[i];
+		for (j = count; j < count + delta; ++j) {
+			wrk += D[j];
+		}
+		wrk /= delta;
+		for (j = count; j < count + delta; ++j) {
+			D[j] = wrk;
+		}
+		count += delta;
+	}
+	scs_free(boundaries);
+	for (i = 0; i < d->m; ++i) {
+		if (D[i] < minRowScale)
+			D[i] = 1;
+		else if (D[i] > maxRowScale)
+			D[i] = maxRowScale;
+	}
+
+	/* col norms of the row scaled A, then the row norms of D^-1 * A * E^-1 */
+	w->meanNormColA = 0;
+	memset(nms, 0, d->m * sizeof(pfloat));
+	for (j = 0; j < d->n; ++j) {
+		a = &(Ax[j * d->m]);
+		colSq = 0;
+		for (i = 0; i < d->m; ++i) {
+			wrk = a[i] / D[i];
+			colSq += wrk * wrk;
+		}
+		E[j] = SQRTF(colSq);
+		if (E[j] < minColScale)
+			E[j] = 1;
+		else if (E[j] > maxColScale)
+			E[j] = maxColScale;
+		w->meanNormColA += SQRTF(colSq) / E[j] / d->n;
+		for (i = 0; i < d->m; ++i) {
+			wrk = a[i] / D[i] / E[j];
+			nms[i] += wrk * wrk;
+		}
+	}
+	w->meanNormRowA = 0;
+	for (i = 0; i < d->m; ++i) {
+		w->meanNormRowA += SQRTF(nms[i]) / d->m;
+	}
+	scs_free(nms);
+
+	w->D = D;
+	w->E = E;
+}
+
+void setAMatrixValues(Data * d, const pfloat * Ax) {
+	if (Ax != d->A->x) {
+		memcpy(d->A->x, Ax, (size_t) d->m * d->n * sizeof(pfloat));
+	}
+}
+
+/* L = the Cholesky factor of RHO_X * I + Anew'Anew, Anew is formed ROW_BLOCK rows at a time for syrk */
+static idxint factorize(Data * d, Priv * p) {
+	blasint n = (blasint) d->n, m = (blasint) d->m, rows, info;
+	pfloat one = 1.0, zero = 0.0, e;
+	const pfloat * a;
+	pfloat * W;
+	idxint i, j, r0;
+	timer phaseTimer;
+
+	tic(&phaseTimer);
+	if (!p->D) {
+		BLAS(syrk)("Lower", "Trans", &n, &m, &one, d->A->x, &m, &zero, p->L, &n);
+	} else {
+		W = scs_malloc(MIN(ROW_BLOCK, d->m) * d->n * sizeof(pfloat));
+		if (!W) {
+			return -1;
+		}
+		for (r0 = 0; r0 < d->m; r0 += ROW_BLOCK) {
+			rows = (blasint) MIN(ROW_BLOCK, d->m - r0);
+			for (j = 0; j < d->n; ++j) {
+				a = &(d->A->x[r0 + j * d->m]);
+				e = p->scale / p->E[j];
+				for (i = 0; i < rows; ++i) {
+					W[i + j * rows] = a[i] / p->D[r0 + i] * e;
+				}
+			}
+			BLAS(syrk)("Lower", "Trans", &n, &rows, &one, W, &rows, r0 == 0 ? &zero : &one, p->L, &n);
+		}
+		scs_free(W);
+	}
+	for (j = 0; j < d->n; ++j) {
+		p->L[j + j * d->n] += d->RHO_X;
+	}
+	p->kktTime = tocq(&phaseTimer);
+
+	tic(&phaseTimer);
+	BLAS(potrf)("Lower", &n, p->L, &n, &info);
+	p->factorTime = tocq(&phaseTimer);
+	if (info != 0) {
+		scs_printf("Error in the Cholesky factorization of RHO_X * I + A'A, info = %li\n", (long) info);
+		return -1;
+	}
+	return 0;
+}
+
+void freePriv(Priv * p) {
+	if (p) {
+		if (p->L)
+			scs_free(p->L);
+		if (p->wn)
+			scs_free(p->wn);
+		if (p->wm)
+			scs_free(p->wm);
+		if (p->bK)
+			scs_free(p->bK);
+		scs_free(p);
+	}
+}
+
+Priv * initPriv(Data * d, const pfloat * D, const pfloat * E) {
+	Priv * p;
+	scs_wreserve(sizeof(Priv) + (d->n * d->n + d->n + d->m) * sizeof(pfloat));
+	p = scs_wcalloc(1, sizeof(Priv));
+	if (!p)
+		return NULL;
+	p->L = scs_wmalloc(d->n * d->n * sizeof(pfloat));
+	p->wn = scs_wmalloc(d->n * sizeof(pfloat));
+	p->wm = scs_wmalloc(d->m * sizeof(pfloat));
+	if (!p->L || !p->wn || !p->wm) {
+		freePriv(p);
+		return NULL;
+	}
+	p->D = D;
+	p->E = E;
+	p->scale = D ? d->SCALE : 1.0;
+	if (factorize(d, p) < 0) {
+		freePriv(p);
+		return NULL;
+	}
+	p->totalSolveTime = 0;
+	return p;
+}
+
+void setLinSysResidual(Priv * p, pfloat res) {
+}
+
+idxint getLinSysIters(Priv * p) {
+	return 0;
+}
+
+void getLinSysProfile(Priv * p, Profile * prof) {
+	/* no ordering, forming A'A is reported as forming the KKT */
+	prof->kktTime = p->kktTime;
+	prof->orderTime = 0;
+	prof->factorTime = p->factorTime;
+}
+
+idxint updateLinSys(Data * d, Priv * p) {
+	return factorize(d, p);
+}
+
+void accumByAtrans(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	/* y += scale * E^-1 * A' * D^-1 * x */
+	blasint m = (blasint) d->m, n = (blasint) d->n, inc = 1;
+	pfloat one = 1.0, zero = 0.0;
+	idxint i;
+	if (!p->D) {
+		BLAS(gemv)("Trans", &m, &n, &one, d->A->x, &m, x, &inc, &one, y, &inc);
+		return;
+	}
+	for (i = 0; i < d->m; ++i) {
+		p->wm[i] = x[i] / p->D[i];
+	}
+	BLAS(gemv)("Trans", &m, &n, &one, d->A->x, &m, p->wm, &inc, &zero, p->wn, &inc);
+	for (i = 0; i < d->n; ++i) {
+		y[i] += p->scale * p->wn[i] / p->E[i];
+	}
+}
+
+void accumByA(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	/* y += scale * D^-1 * A * E^-1 * x */
+	blasint m = (blasint) d->m, n = (blasint) d->n, inc = 1;
+	pfloat one = 1.0, zero = 0.0;
+	idxint i;
+	if (!p->D) {
+		BLAS(gemv)("NoTrans", &m, &n, &one, d->A->x, &m, x, &inc, &one, y, &inc);
+		return;
+	}
+	for (i = 0; i < d->n; ++i) {
+		p->wn[i] = p->scale * x[i] / p->E[i];
+	}
+	BLAS(gemv)("NoTrans", &m, &n, &one, d->A->x, &m, p->wn, &inc, &zero, p->wm, &inc);
+	for (i = 0; i < d->m; ++i) {
+		y[i] += p->wm[i] / p->D[i];
+	}
+}
+
+idxint solveLinSys(Data * d, Priv * p, pfloat * b, const pfloat * s, idxint iter) {
+	/* solves [RHO_X * I A'; A -I] [x; y] = b, stored in b, as x = (RHO_X * I + A'A)^-1 (b_x + A'b_y), y = Ax - b_y */
+	blasint n = (blasint) d->n, nrhs = 1, info;
+	timer linsysTimer;
+	if (iter == 0) {
+		/* the first step of a solve, the counters of the summary start over */
+		p->totalSolveTime = 0;
+	}
+	tic(&linsysTimer);
+	accumByAtrans(d, p, &(b[d->n]), b);
+	BLAS(potrs)("Lower", &n, &nrhs, p->L, &n, b, &n, &info);
+	scaleArray(&(b[d->n]), -1, d->m);
+	accumByA(d, p, b, &(b[d->n]));
+	p->totalSolveTime += tocq(&linsysTimer);
+#ifdef EXTRAVERBOSE
+	scs_printf("linsys solve time: %1.2es\n", tocq(&linsysTimer) / 1e3);
+#endif
+	return info == 0 ? 0 : -1;
+}
+
+idxint solveLinSysBatch(Data * d, Priv * p, idxint K, pfloat ** b, const pfloat ** s, idxint iter) {
+	/* as solveLinSys with the K right hand sides side by side: X (n by K), T (n by K) and Y (m by K) in bK */
+	blasint n = (blasint) d->n, m = (blasint) d->m, nrhs = (blasint) K, info;
+	pfloat one = 1.0, zero = 0.0;
+	pfloat * X, * T, * Y;
+	idxint i, k;
+	timer linsysTimer;
+	if (K == 1) {
+		return solveLinSys(d, p, b[0], s ? s[0] : NULL, iter);
+	}
+	if (iter == 0) {
+		/* the first step of a solve, the counters of the summary start over */
+		p->totalSolveTime = 0;
+	}
+	tic(&linsysTimer);
+	if (K > p->bKCap) {
+		if (p->bK)
+			scs_free(p->bK);
+		p->bK = scs_malloc((size_t) (2 * d->n + d->m) * K * sizeof(pfloat));
+		p->bKCap = p->bK ? K : 0;
+		if (!p->bK)
+			return -1;
+	}
+	X = p->bK;
+	T = &(X[d->n * K]);
+	Y = &(T[d->n * K]);
+	for (k = 0; k < K; ++k) {
+		memcpy(&(X[k * d->n]), b[k], d->n * sizeof(pfloat));
+		for (i = 0; i < d->m; ++i) {
+			Y[i + k * d->m] = p->D ? b[k][d->n + i] / p->D[i] : b[k][d->n + i];
+		}
+	}
+	/* X += scale * E^-1 * A' * D^-1 * Y */
+	BLAS(gemm)("Trans", "NoTrans", &n, &nrhs, &m, &one, d->A->x, &m, Y, &m, &zero, T, &n);
+	for (k = 0; k < K; ++k) {
+		for (i = 0; i < d->n; ++i) {
+			X[i + k * d->n] += p->E ? p->scale * T[i + k * d->n] / p->E[i] : T[i + k * d->n];
+		}
+	}
+	BLAS(potrs)("Lower", &n, &nrhs, p->L, &n, X, &n, &info);
+	/* y = scale * D^-1 * A * E^-1 * x - y */
+	for (k = 0; k < K; ++k) {
+		for (i = 0; i < d->n; ++i) {
+			T[i + k * d->n] = p->E ? p->scale * X[i + k * d->n] / p->E[i] : X[i + k * d->n];
+		}
+	}
+	BLAS(gemm)("NoTrans", "NoTrans", &m, &nrhs, &n, &one, d->A->x, &m, T, &n, &zero, Y, &m);
+	for (k = 0; k < K; ++k) {
+		memcpy(b[k], &(X[k * d->n]), d->n * sizeof(pfloat));
+		for (i = 0; i < d->m; ++i) {
+			b[k][d->n + i] = (p->D ? Y[i + k * d->m] / p->D[i] : Y[i + k * d->m]) - b[k][d->n + i];
+		}
+	}
+	p->totalSolveTime += tocq(&linsysTimer);
+#ifdef EXTRAVERBOSE
+	scs_printf("batch linsys solve time: %1.2es\n", tocq(&linsysTimer) / 1e3);
+#endif
+	return info == 0 ? 0 : -1;
+}
+
+/* the presolve works on the sparse A, so PRESOLVE and CHORDAL are ignored and the others are never called */
+Presolve * initPresolve(Data * d, Cone * k) {
+	return NULL;
+}
+
+Data * reducedData(Presolve * pre, const Data * d) {
+	return NULL;
+}
+
+idxint presolveBC(Presolve * pre, const Data * d, const pfloat * b, const pfloat * c, pfloat * rb, pfloat * rc) {
+	return 0;
+}
+
+void presolveSol(Presolve * pre, const Sol * sol, Sol * rsol) {
+}
+
+void postsolve(Presolve * pre, const Data * d, const pfloat * b, const pfloat * c, const Sol * rsol, Sol * sol,
+		idxint status, Info * info) {
+}
+
+idxint updatePresolve(Presolve * pre, const Data * d) {
+	return -1;
+}
+
+void freePresolve(Presolve * pre) {
+}
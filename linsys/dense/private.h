@@ -0,0 +1,25 @@
+#ifndef PRIV_H_GUARD
+#define PRIV_H_GUARD
+
+#include "glbopts.h"
+#include "scs.h"
+#include <math.h>
+#include "linsys/dense/amatrix.h"
+#include "linAlg.h"
+#include "presolve.h"
+
+struct PRIVATE_DATA {
+	pfloat * L; /* Cholesky factor of RHO_X * I + A'A in its lower triangle, n by n column major */
+	/* normalization of A, the products and A'A use scale * D^-1 * A * E^-1 with the user's values,
+	 D and E are NULL (and scale is 1) if A is not normalized */
+	const pfloat * D, * E;
+	pfloat scale;
+	pfloat * wn, * wm; /* scaled inputs and outputs of the products, sizes n and m */
+	pfloat * bK; /* workspace for batched solves, the n and m parts of bKCap right hand sides as two matrices */
+	idxint bKCap;
+	/* reporting */
+	pfloat totalSolveTime;
+	pfloat kktTime, factorTime; /* forming A'A and its Cholesky factorization, of the last initPriv or update */
+};
+
+#endif
@@ -47,9 +47,9 @@ void (*amd_free) (void *) = mxFree ;
 void *(*amd_realloc) (void *, size_t) = mxRealloc ;
 void *(*amd_calloc) (size_t, size_t) = mxCalloc ;
 #else
-/* standard ANSI-C: */
-void *(*amd_malloc) (size_t) = malloc ;
-void (*amd_free) (void *) = free ;
+/* standard ANSI-C, through the allocator of scs_set_allocator: */
+void *(*amd_malloc) (size_t) = scs_hook_malloc ;
+void (*amd_free) (void *) = scs_hook_free ;
 void *(*amd_realloc) (void *, size_t) = realloc ;
 void *(*amd_calloc) (size_t, size_t) = calloc ;
 #endif
@@ -0,0 +1,367 @@
+#include "ordering.h"
+#include "external/amd.h"
+#include "external/ldl.h"
+
+/* nested dissection: parts of at most ND_LEAF vertices are ordered by AMD rather than split further, and the search
+ for a pseudo-peripheral vertex to start the level structure of a part from takes at most ND_PERIPHERAL_ITERS
+ breadth first searches more */
+#ifndef ND_LEAF
+#define ND_LEAF 128
+#endif
+#define ND_PERIPHERAL_ITERS 4
+
+/* the graph of the matrix and the workspace of the dissection, a part is the segment [start, start + size) of P and
+ its vertices have the tag of the part while it is split */
+typedef struct {
+	idxint n;
+	idxint * Gp, * Gi; /* adjacency, both triangles without the diagonal */
+	idxint * tag; /* the part being split or ordered */
+	idxint * level; /* of the last breadth first search, -1 if not reached */
+	idxint * queue; /* vertices in the order of the last breadth first search */
+	idxint * loc; /* local index of a vertex in a leaf */
+	idxint * Lp, * Li; /* pattern of a leaf for AMD */
+	idxint * amdP;
+} Dissection;
+
+static void freeDissection(Dissection * g) {
+	if (g->Gp)
+		scs_free(g->Gp);
+	if (g->Gi)
+		scs_free(g->Gi);
+	if (g->tag)
+		scs_free(g->tag);
+	if (g->level)
+		scs_free(g->level);
+	if (g->queue)
+		scs_free(g->queue);
+	if (g->loc)
+		scs_free(g->loc);
+	if (g->Lp)
+		scs_free(g->Lp);
+	if (g->Li)
+		scs_free(g->Li);
+	if (g->amdP)
+		scs_free(g->amdP);
+}
+
+/* the adjacency of the upper triangle C, counted then filled */
+static idxint initDissection(const cs * C, Dissection * g) {
+	idxint i, j, q, n = C->n, nz = 0;
+	g->n = n;
+	g->Gp = scs_calloc(n + 1, sizeof(idxint));
+	g->tag = scs_calloc(n, sizeof(idxint));
+	g->level = scs_malloc(n * sizeof(idxint));
+	g->queue = scs_malloc(n * sizeof(idxint));
+	g->loc = scs_malloc(n * sizeof(idxint));
+	g->Lp = scs_malloc((n + 1) * sizeof(idxint));
+	g->amdP = scs_malloc(n * sizeof(idxint));
+	if (!g->Gp || !g->tag || !g->level || !g->queue || !g->loc || !g->Lp || !g->amdP) {
+		return -1;
+	}
+	memset(g->queue, 0, n * sizeof(idxint));
+	for (j = 0; j < n; j++) {
+		for (q = C->p[j]; q < C->p[j + 1]; q++) {
+			if (C->i[q] != j) {
+				g->queue[C->i[q]]++;
+				g->queue[j]++;
+				nz += 2;
+			}
+		}
+	}
+	g->Gi = scs_malloc(MAX(nz, 1) * sizeof(idxint));
+	g->Li = scs_malloc(MAX(nz, 1) * sizeof(idxint));
+	if (!g->Gi || !g->Li) {
+		return -1;
+	}
+	cs_cumsum(g->Gp, g->queue, n);
+	for (j = 0; j < n; j++) {
+		for (q = C->p[j]; q < C->p[j + 1]; q++) {
+			i = C->i[q];
+			if (i != j) {
+				g->Gi[g->queue[i]++] = j;
+				g->Gi[g->queue[j]++] = i;
+			}
+		}
+	}
+	return 0;
+}
+
+/* breadth first search from root within the part tagged t, the vertices of the part have level -1 before, returns
+ the number of levels, the vertices reached are the first *reached of queue */
+static idxint bfs(Dissection * g, idxint root, idxint t, idxint * reached) {
+	idxint head = 0, tail = 1, v, u, q;
+	g->queue[0] = root;
+	g->level[root] = 0;
+	while (head < tail) {
+		v = g->queue[head++];
+		for (q = g->Gp[v]; q < g->Gp[v + 1]; q++) {
+			u = g->Gi[q];
+			if (g->tag[u] == t && g->level[u] < 0) {
+				g->level[u] = g->level[v] + 1;
+				g->queue[tail++] = u;
+			}
+		}
+	}
+	*reached = tail;
+	return g->level[g->queue[tail - 1]] + 1;
+}
+
+static void clearLevels(Dissection * g, const idxint * part, idxint size) {
+	idxint k;
+	for (k = 0; k < size; k++) {
+		g->level[part[k]] = -1;
+	}
+}
+
+/* orders the part of size vertices tagged t by AMD on the pattern among them */
+static idxint orderLeaf(Dissection * g, idxint * part, idxint size, idxint t) {
+	idxint k, q, v, nz = 0, status;
+	for (k = 0; k < size; k++) {
+		g->loc[part[k]] = k;
+	}
+	for (k = 0; k < size; k++) {
+		v = part[k];
+		g->Lp[k] = nz;
+		for (q = g->Gp[v]; q < g->Gp[v + 1]; q++) {
+			if (g->tag[g->Gi[q]] == t) {
+				g->Li[nz++] = g->loc[g->Gi[q]];
+			}
+		}
+	}
+	g->Lp[size] = nz;
+#ifdef DLONG
+	status = amd_l_order(size, g->Lp, g->Li, g->amdP, (pfloat *) NULL, (pfloat *) NULL);
+#else
+	status = amd_order(size, g->Lp, g->Li, g->amdP, (pfloat *) NULL, (pfloat *) NULL);
+#endif
+	if (status < 0) {
+		return -1;
+	}
+	for (k = 0; k < size; k++) {
+		g->queue[k] = part[g->amdP[k]];
+	}
+	memcpy(part, g->queue, size * sizeof(idxint));
+	return 0;
+}
+
+/* 1 if v has a neighbor at level l in the part tagged t */
+static idxint adjacent(const Dissection * g, idxint v, idxint t, idxint l) {
+	idxint q, u;
+	for (q = g->Gp[v]; q < g->Gp[v + 1]; q++) {
+		u = g->Gi[q];
+		if (g->tag[u] == t && g->level[u] == l) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* the vertices of level sl of the part adjacent to level tl */
+static idxint adjacentCount(const Dissection * g, const idxint * part, idxint size, idxint t, idxint sl, idxint tl) {
+	idxint k, cnt = 0;
+	for (k = 0; k < size; k++) {
+		if (g->level[part[k]] == sl && adjacent(g, part[k], t, tl)) {
+			cnt++;
+		}
+	}
+	return cnt;
+}
+
+/* splits the part of size vertices tagged t in place into A, B and the separator S with no edge between A and B,
+ in that order, from the level structure of a pseudo-peripheral vertex: S are the vertices of a middle level
+ adjacent to the next one (or of the next one adjacent to it), an unconnected part is split into the component of its vertex of least degree and the rest,
+ returns the size of A in *sizeA and of B, 0 if no split was found */
+static idxint split(Dissection * g, idxint * part, idxint size, idxint t, idxint * sizeA) {
+	idxint k, l, v, root = part[0], nLevels, next, reached, it, cum, median, sl, tl, nA = 0, nB = 0, nS = 0;
+	/* the vertex of least degree to start from */
+	for (k = 1; k < size; k++) {
+		if (g->Gp[part[k] + 1] - g->Gp[part[k]] < g->Gp[root + 1] - g->Gp[root]) {
+			root = part[k];
+		}
+	}
+	clearLevels(g, part, size);
+	nLevels = bfs(g, root, t, &reached);
+	if (reached < size) {
+		/* A is the component reached, B the rest */
+		for (k = 0; k < size; k++) {
+			if (g->level[part[k]] < 0) {
+				g->queue[reached + nB++] = part[k];
+			}
+		}
+		memcpy(part, g->queue, size * sizeof(idxint));
+		*sizeA = reached;
+		return nB;
+	}
+	for (it = 0; it < ND_PERIPHERAL_ITERS; it++) {
+		/* the vertex of least degree in the last level, a longer level structure from it is narrower */
+		next = g->queue[size - 1];
+		for (k = size - 1; k >= 0 && g->level[g->queue[k]] == nLevels - 1; k--) {
+			v = g->queue[k];
+			if (g->Gp[v + 1] - g->Gp[v] < g->Gp[next + 1] - g->Gp[next]) {
+				next = v;
+			}
+		}
+		clearLevels(g, part, size);
+		k = bfs(g, next, t, &reached);
+		if (k <= nLevels) {
+			if (k < nLevels) {
+				clearLevels(g, part, size);
+				bfs(g, root, t, &reached);
+			}
+			break;
+		}
+		root = next;
+		nLevels = k;
+	}
+	if (nLevels < 3) {
+		return 0;
+	}
+	/* the narrowest level with levels on both sides among those holding part of the middle fifths of the vertices
+	 (the middle vertex if none), level widths in loc */
+	memset(g->loc, 0, nLevels * sizeof(idxint));
+	for (k = 0; k < size; k++) {
+		g->loc[g->level[g->queue[k]]]++;
+	}
+	median = MIN(MAX(g->level[g->queue[size / 2]], 1), nLevels - 2);
+	for (l = 1, cum = g->loc[0]; l < nLevels - 1; cum += g->loc[l++]) {
+		if (5 * cum <= 3 * size && 5 * (cum + g->loc[l]) >= 2 * size && g->loc[l] < g->loc[median]) {
+			median = l;
+		}
+	}
+	/* S is the smaller of the vertices of the median level adjacent to the next one and those of the next one
+	 adjacent to the median one, the others of its level go to the side they are connected to */
+	sl = adjacentCount(g, part, size, t, median + 1, median) < adjacentCount(g, part, size, t, median, median + 1)
+			? median + 1 : median;
+	tl = sl == median ? median + 1 : median;
+	/* A then B from the front of queue, S from the back */
+	for (k = 0; k < size; k++) {
+		v = part[k];
+		if (g->level[v] == sl && adjacent(g, v, t, tl)) {
+			g->queue[size - 1 - nS++] = v;
+		} else if (g->level[v] < sl || (g->level[v] == sl && tl > sl)) {
+			g->queue[nA++] = v;
+		}
+	}
+	for (k = 0; k < size; k++) {
+		v = part[k];
+		if (g->level[v] > sl || (g->level[v] == sl && tl < sl && !adjacent(g, v, t, tl))) {
+			g->queue[nA + nB++] = v;
+		}
+	}
+	memcpy(part, g->queue, size * sizeof(idxint));
+	*sizeA = nA;
+	return nB;
+}
+
+/* nested dissection of C into P: each part is split into two parts ordered first and the separator ordered after
+ them, parts are taken from a stack of (start, size) segments of P until all are leaves */
+static idxint ndOrder(const cs * C, idxint * P) {
+	Dissection g = { 0 };
+	idxint k, n = C->n, top = 0, t = 0, start, size, sizeA, sizeB, status = -1;
+	idxint * stack = scs_malloc(2 * (n + 1) * sizeof(idxint));
+	if (stack && initDissection(C, &g) == 0) {
+		for (k = 0; k < n; k++) {
+			P[k] = k;
+		}
+		if (n > 0) {
+			stack[top++] = 0;
+			stack[top++] = n;
+		}
+		status = 0;
+		while (top > 0 && status == 0) {
+			size = stack[--top];
+			start = stack[--top];
+			t++;
+			for (k = start; k < start + size; k++) {
+				g.tag[P[k]] = t;
+			}
+			sizeB = size > ND_LEAF ? split(&g, &(P[start]), size, t, &sizeA) : 0;
+			if (sizeB == 0) {
+				status = orderLeaf(&g, &(P[start]), size, t);
+				continue;
+			}
+			stack[top++] = start;
+			stack[top++] = sizeA;
+			stack[top++] = start + sizeA;
+			stack[top++] = sizeB;
+		}
+	}
+	if (stack)
+		scs_free(stack);
+	freeDissection(&g);
+	return status;
+}
+
+/* the nonzeros below the diagonal of the factor of P C P' */
+static pfloat fill(const cs * C, const idxint * P) {
+	idxint n = C->n;
+	pfloat lnz = -1;
+	idxint * Pinv = cs_pinv(P, n);
+	cs * T = Pinv ? cs_symperm(C, Pinv, 0) : NULL;
+	idxint * Lp = scs_malloc((n + 1) * sizeof(idxint));
+	idxint * Parent = scs_malloc(MAX(n, 1) * sizeof(idxint));
+	idxint * Lnz = scs_malloc(MAX(n, 1) * sizeof(idxint));
+	idxint * Flag = scs_malloc(MAX(n, 1) * sizeof(idxint));
+	if (T && Lp && Parent && Lnz && Flag) {
+		LDL_symbolic(n, T->p, T->i, Lp, Parent, Lnz, Flag, NULL, NULL);
+		lnz = Lp[n];
+	}
+	if (Pinv)
+		scs_free(Pinv);
+	if (T)
+		cs_spfree(T);
+	if (Lp)
+		scs_free(Lp);
+	if (Parent)
+		scs_free(Parent);
+	if (Lnz)
+		scs_free(Lnz);
+	if (Flag)
+		scs_free(Flag);
+	return lnz;
+}
+
+pfloat orderPattern(const Data * d, const cs * C, idxint * P) {
+	idxint n = C->n, valid;
+	idxint * Flag;
+	if (d->ORDERING == ORDER_USER) {
+		Flag = scs_malloc(MAX(n, 1) * sizeof(idxint));
+		valid = Flag && d->PERM && LDL_valid_perm(n, (idxint *) d->PERM, Flag);
+		if (Flag)
+			scs_free(Flag);
+		if (!valid) {
+			scs_printf("ERROR: PERM must be a permutation of the %li rows of the matrix factored\n", (long) n);
+			return -1;
+		}
+		memcpy(P, d->PERM, n * sizeof(idxint));
+	} else if (ndOrder(C, P) < 0) {
+		return -1;
+	}
+	return fill(C, P);
+}
+
+const char * orderingName(idxint ordering) {
+	switch (ordering) {
+	case ORDER_ND:
+		return "nested dissection";
+	case ORDER_USER:
+		return "PERM";
+	default:
+		return "AMD";
+	}
+}
+
+idxint etreeHeight(const idxint * Parent, idxint n) {
+	idxint j, height = 0;
+	idxint * depth = scs_malloc(MAX(n, 1) * sizeof(idxint));
+	if (!depth) {
+		return -1;
+	}
+	/* a parent comes after its children */
+	for (j = n - 1; j >= 0; j--) {
+		depth[j] = Parent[j] == -1 ? 1 : depth[Parent[j]] + 1;
+		height = MAX(height, depth[j]);
+	}
+	scs_free(depth);
+	return height;
+}
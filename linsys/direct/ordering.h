@@ -0,0 +1,20 @@
+#ifndef ORDERING_H_GUARD
+#define ORDERING_H_GUARD
+
+#include "glbopts.h"
+#include "scs.h"
+#include "cs.h"
+
+/* the orderings of the direct and supernodal solvers other than AMD (see ORDERING in Data) of the symmetric matrix
+ whose upper triangle is C: nested dissection, or PERM after checking it is a permutation of size C->n, into P,
+ returns the nonzeros of L below the diagonal it gives, -1 on failure */
+pfloat orderPattern(const Data * d, const cs * C, idxint * P);
+
+/* the name of an ORDERING for the summaries */
+const char * orderingName(idxint ordering);
+
+/* the height of the elimination tree Parent of n columns, the most columns on a path from a leaf to a root, -1 on
+ failure */
+idxint etreeHeight(const idxint * Parent, idxint n);
+
+#endif
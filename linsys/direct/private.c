@@ -1,87 +1,191 @@
 #include "private.h"
 
-static timer linsysTimer;
-static pfloat totalSolveTime;
+/* with NORMAL_EQS 0: the normal equations are used if their factor has at most NORMAL_MAX_FILL * nnz(A) entries, and
+ A'A is not formed if that takes more than NORMAL_MAX_WORK times the entries of the KKT matrix */
+#define NORMAL_MAX_FILL 0.5
+#define NORMAL_MAX_WORK 8
+
+#ifdef OPENMP
+#include <omp.h>
+
+/* a level goes into its own parallel stage if it has at least this many nonzeros of L */
+#define MIN_PARALLEL_LEVEL_NNZ 4096
+
+static void freeSchedule(LevelSchedule * s) {
+	if (s) {
+		if (s->stagep)
+			scs_free(s->stagep);
+		if (s->parallel)
+			scs_free(s->parallel);
+		if (s->rows)
+			scs_free(s->rows);
+		scs_free(s);
+	}
+}
+
+/* groups the n rows into stages by level in [0, nLevels), wide levels (Cp gives the nonzeros per
+ * row) become parallel stages and runs of narrow levels between them are merged into serial stages,
+ * returns NULL if no level is wide enough to be worth a parallel stage */
+static LevelSchedule * buildSchedule(const idxint * level, idxint nLevels, const idxint * Cp, idxint n, idxint nThreads) {
+	idxint j, l, wide, nParallel = 0;
+	idxint * cnt = scs_calloc(nLevels, sizeof(idxint));
+	idxint * nnz = scs_calloc(nLevels, sizeof(idxint));
+	idxint * levelp = scs_malloc((nLevels + 1) * sizeof(idxint));
+	LevelSchedule * s = scs_calloc(1, sizeof(LevelSchedule));
+	if (s) {
+		s->stagep = scs_malloc((nLevels + 1) * sizeof(idxint));
+		s->parallel = scs_malloc(nLevels * sizeof(idxint));
+		s->rows = scs_malloc(n * sizeof(idxint));
+	}
+	if (!cnt || !nnz || !levelp || !s || !s->stagep || !s->parallel || !s->rows) {
+		freeSchedule(s);
+		s = NULL;
+	} else {
+		for (j = 0; j < n; j++) {
+			cnt[level[j]]++;
+			nnz[level[j]] += Cp[j + 1] - Cp[j];
+		}
+		/* rows sorted by level */
+		cs_cumsum(levelp, cnt, nLevels);
+		for (j = 0; j < n; j++) {
+			s->rows[cnt[level[j]]++] = j;
+		}
+		/* a wide level always starts a new stage, a narrow one only if the previous stage is parallel */
+		s->nStages = 0;
+		for (l = 0; l < nLevels; l++) {
+			wide = nnz[l] >= MIN_PARALLEL_LEVEL_NNZ && levelp[l + 1] - levelp[l] >= nThreads;
+			if (s->nStages == 0 || wide || s->parallel[s->nStages - 1]) {
+				s->stagep[s->nStages] = levelp[l];
+				s->parallel[s->nStages] = wide;
+				s->nStages++;
+			}
+			nParallel += wide;
+		}
+		s->stagep[s->nStages] = n;
+		if (!nParallel) {
+			freeSchedule(s);
+			s = NULL;
+		}
+	}
+	if (cnt)
+		scs_free(cnt);
+	if (nnz)
+		scs_free(nnz);
+	if (levelp)
+		scs_free(levelp);
+	return s;
+}
+
+/* Lt = L', Lt has room for all the entries of L, Li are the row indices of L */
+static void transposeL(const cs * L, const rowidx * Li, cs * Lt, idxint * w) {
+	idxint j, q, k, n = L->n;
+	memset(w, 0, n * sizeof(idxint));
+	for (q = 0; q < L->p[n]; q++)
+		w[Li[q]]++;
+	cs_cumsum(Lt->p, w, n);
+	for (j = 0; j < n; j++) {
+		for (q = L->p[j]; q < L->p[j + 1]; q++) {
+			k = w[Li[q]]++;
+			Lt->i[k] = j;
+			Lt->x[k] = L->x[q];
+		}
+	}
+}
+
+/* level schedules from the elimination tree: row i of the forward solve depends on its descendants,
+ * so its level is its height in the tree, column j of the backward solve depends on its ancestors,
+ * so its level is its depth. Schedules are optional, the serial solve is used if this fails */
+static void buildSchedules(Priv * p) {
+	idxint j, nLevels, n = p->L->n, nThreads = omp_get_max_threads();
+	idxint * level;
+	if (nThreads <= 1) {
+		return;
+	}
+	level = scs_calloc(n, sizeof(idxint));
+	p->Lt = cs_spalloc(n, n, p->L->p[n], 1, 0);
+	if (!level || !p->Lt) {
+		if (level)
+			scs_free(level);
+		p->Lt = cs_spfree(p->Lt);
+		return;
+	}
+	transposeL(p->L, p->Li, p->Lt, level);
+	memset(level, 0, n * sizeof(idxint));
+	nLevels = 1;
+	for (j = 0; j < n; j++) {
+		if (p->Parent[j] != -1) {
+			level[p->Parent[j]] = MAX(level[p->Parent[j]], level[j] + 1);
+		}
+		nLevels = MAX(nLevels, level[j] + 1);
+	}
+	p->fwd = buildSchedule(level, nLevels, p->Lt->p, n, nThreads);
+	if (!p->fwd) {
+		p->Lt = cs_spfree(p->Lt);
+	}
+	nLevels = 1;
+	for (j = n - 1; j >= 0; j--) {
+		level[j] = p->Parent[j] == -1 ? 0 : level[p->Parent[j]] + 1;
+		nLevels = MAX(nLevels, level[j] + 1);
+	}
+	p->bwd = buildSchedule(level, nLevels, p->L->p, n, nThreads);
+	scs_free(level);
+#ifdef EXTRAVERBOSE
+	scs_printf("level scheduled solves, stages: forward %li, backward %li\n", (long) (p->fwd ? p->fwd->nStages : 0),
+			(long) (p->bwd ? p->bwd->nStages : 0));
+#endif
+}
+#endif
 
 char * getLinSysMethod(Data * d, Priv * p) {
 	char * tmp = scs_malloc(sizeof(char) * 64);
-	sprintf(tmp, "sparse-direct, nnz in A = %li", (long) d->A->p[d->n]);
+	sprintf(tmp, "sparse-direct, nnz in A = %li%s", (long) d->A->p[d->n], d->STORE_TRANSPOSE ? ", storing A'" : "");
 	return tmp;
 }
 
 char * getLinSysSummary(Priv * p, Info * info) {
-	char * str = scs_malloc(sizeof(char) * 64);
+	char * str = scs_malloc(sizeof(char) * 160);
 	idxint n = p->L->n;
-	sprintf(str, "\tLin-sys: nnz in L factor: %li, avg solve time: %1.2es\n", (long ) p->L->p[n] + n,
-			totalSolveTime / (info->iter + 1) / 1e3);
-	totalSolveTime = 0;
+	sprintf(str, "\tLin-sys: nnz in L factor%s: %li, tree height: %li (%s), avg solve time: %1.2es\n",
+			p->normal ? " of RHO_X * I + A'A" : "", (long ) p->L->p[n] + n, (long) p->treeHeight,
+			orderingName(p->ordering), p->totalSolveTime / (info->iter + 1) / 1e3);
 	return str;
 }
 
 void freePriv(Priv * p) {
 	if (p) {
+		freeAScaling(&(p->As));
 		if (p->L)
 			cs_spfree(p->L);
+#ifdef COMPACT_ROWS
+		if (p->Li)
+			scs_free(p->Li);
+#endif
 		if (p->P)
 			scs_free(p->P);
+		if (p->Pinv)
+			scs_free(p->Pinv);
+		if (p->Parent)
+			scs_free(p->Parent);
 		if (p->D)
 			scs_free(p->D);
 		if (p->bp)
 			scs_free(p->bp);
-		scs_free(p);
-	}
-}
-
-cs * formKKT(Data * d) {
-	/* ONLY UPPER TRIANGULAR PART IS STUFFED
-	 * forms column compressed KKT matrix
-	 * assumes column compressed form A matrix
-	 *
-	 * forms upper triangular part of [I A'; A -I]
-	 */
-	idxint j, k, kk;
-	cs * K_cs;
-	AMatrix * A = d->A;
-	/* I at top left */
-	const idxint Anz = A->p[d->n];
-	const idxint Knzmax = d->n + d->m + Anz;
-	cs * K = cs_spalloc(d->m + d->n, d->m + d->n, Knzmax, 1, 1);
-
-#ifdef EXTRAVERBOSE
-	scs_printf("forming KKT\n");
+		if (p->bpK)
+			scs_free(p->bpK);
+		if (p->Atx)
+			scs_free(p->Atx);
+		if (p->Ati)
+			scs_free(p->Ati);
+		if (p->Atp)
+			scs_free(p->Atp);
+#ifdef OPENMP
+		freeSchedule(p->fwd);
+		freeSchedule(p->bwd);
+		if (p->Lt)
+			cs_spfree(p->Lt);
 #endif
-
-	if (!K) {
-		return NULL;
-	}
-	kk = 0;
-	for (k = 0; k < d->n; k++) {
-		K->i[kk] = k;
-		K->p[kk] = k;
-		K->x[kk] = d->RHO_X;
-		kk++;
-	}
-	/* A^T at top right : CCS: */
-	for (j = 0; j < d->n; j++) {
-		for (k = A->p[j]; k < A->p[j + 1]; k++) {
-			K->p[kk] = A->i[k] + d->n;
-			K->i[kk] = j;
-			K->x[kk] = A->x[k];
-			kk++;
-		}
-	}
-	/* -I at bottom right */
-	for (k = 0; k < d->m; k++) {
-		K->i[kk] = k + d->n;
-		K->p[kk] = k + d->n;
-		K->x[kk] = -1;
-		kk++;
+		scs_free(p);
 	}
-	/* assert kk == Knzmax */
-	K->nz = Knzmax;
-	K_cs = cs_compress(K);
-	cs_spfree(K);
-	return (K_cs);
 }
 
 idxint LDLInit(cs * A, idxint P[], pfloat **info) {
@@ -93,63 +197,239 @@ idxint LDLInit(cs * A, idxint P[], pfloat **info) {
 #endif
 }
 
-idxint LDLFactor(cs * A, idxint P[], idxint Pinv[], cs **L, pfloat **D) {
+/* symbolic factorization of (permuted) A, allocates pattern of L and stores elimination tree in Parent */
+idxint LDLSymbolic(cs * A, cs * L, idxint * Parent) {
+	idxint n = A->n;
+	idxint * Lnz = scs_malloc(n * sizeof(idxint));
+	idxint * Flag = scs_malloc(n * sizeof(idxint));
+	L->p = (idxint *) scs_wmalloc((1 + n) * sizeof(idxint));
+	if (!Lnz || !Flag || !L->p) {
+		if (Lnz)
+			scs_free(Lnz);
+		if (Flag)
+			scs_free(Flag);
+		return -1;
+	}
+	LDL_symbolic(n, A->p, A->i, L->p, Parent, Lnz, Flag, NULL, NULL);
+	L->nzmax = L->p[n];
+	/* the factor, with ARENA in one block of exactly its size, its row indices are kept in p->Li (see Priv) */
+	scs_wreserve(L->nzmax * (sizeof(pfloat) + sizeof(rowidx)));
+	L->x = (pfloat *) scs_wmalloc(L->nzmax * sizeof(pfloat));
+#ifdef COMPACT_ROWS
+	L->i = (idxint *) scs_malloc(L->nzmax * sizeof(idxint));
+#else
+	L->i = (idxint *) scs_wmalloc(L->nzmax * sizeof(idxint));
+#endif
+	scs_free(Lnz);
+	scs_free(Flag);
+	if (!L->x || !L->i)
+		return -1;
+	return 0;
+}
+
+/* numeric factorization of (permuted) A into L and D, re-uses the pattern from LDLSymbolic */
+idxint LDLNumeric(cs * A, cs * L, pfloat * D, idxint * Parent) {
 	idxint kk, n = A->n;
-	idxint * Parent = scs_malloc(n * sizeof(idxint));
 	idxint * Lnz = scs_malloc(n * sizeof(idxint));
 	idxint * Flag = scs_malloc(n * sizeof(idxint));
 	idxint * Pattern = scs_malloc(n * sizeof(idxint));
 	pfloat * Y = scs_malloc(n * sizeof(pfloat));
-	(*L)->p = (idxint *) scs_malloc((1 + n) * sizeof(idxint));
+	if (!Y || !Pattern || !Flag || !Lnz) {
+		kk = -1;
+	} else {
+#ifdef EXTRAVERBOSE
+		scs_printf("numeric factorization\n");
+#endif
+		kk = LDL_numeric(n, A->p, A->i, A->x, L->p, Parent, Lnz, L->i, L->x, D, Y, Pattern, Flag, NULL, NULL);
+#ifdef EXTRAVERBOSE
+		scs_printf("finished numeric factorization\n");
+#endif
+	}
+	if (Lnz)
+		scs_free(Lnz);
+	if (Flag)
+		scs_free(Flag);
+	if (Pattern)
+		scs_free(Pattern);
+	if (Y)
+		scs_free(Y);
+	return kk < 0 ? -1 : (n - kk);
+}
 
-	/*idxint Parent[n], Lnz[n], Flag[n], Pattern[n]; */
-	/*pfloat Y[n]; */
 
-	LDL_symbolic(n, A->p, A->i, (*L)->p, Parent, Lnz, Flag, P, Pinv);
+/* numeric factorization into p->L and p->D then sets p->Li, see Priv */
+static idxint numericFactor(cs * C, Priv * p) {
+	idxint status;
+#ifdef COMPACT_ROWS
+	idxint q, nz = MAX(p->L->nzmax, 1);
+	if (!p->L->i && !(p->L->i = scs_malloc(nz * sizeof(idxint))))
+		return -1;
+	if (!p->Li && !(p->Li = scs_wmalloc(nz * sizeof(rowidx))))
+		return -1;
+#endif
+	status = LDLNumeric(C, p->L, p->D, p->Parent);
+#ifdef COMPACT_ROWS
+	for (q = 0; q < p->L->nzmax; q++)
+		p->Li[q] = (rowidx) p->L->i[q];
+	scs_free(p->L->i);
+	p->L->i = NULL;
+#else
+	p->Li = p->L->i;
+#endif
+	return status;
+}
+
+/* y = L^-1 y in place in bp, L unit lower triangular with row indices Li */
+static void forwardSolve(const cs * L, const rowidx * Li, pfloat * bp) {
+	idxint j, q, n = L->n;
+	pfloat yj;
+	for (j = 0; j < n; j++) {
+		yj = bp[j];
+		for (q = L->p[j]; q < L->p[j + 1]; q++) {
+			bp[Li[q]] -= L->x[q] * yj;
+		}
+	}
+}
 
-	(*L)->nzmax = *((*L)->p + n);
-	(*L)->x = (pfloat *) scs_malloc((*L)->nzmax * sizeof(pfloat));
-	(*L)->i = (idxint *) scs_malloc((*L)->nzmax * sizeof(idxint));
-	*D = (pfloat *) scs_malloc(n * sizeof(pfloat));
+/* x_j = D_j^-1 y_j - L(:,j)' x, the fused diagonal and backward solve of column j, x of the
+ * ancestors of j already overwrites y in bp */
+static pfloat backwardCol(const cs * L, const rowidx * Li, const pfloat * D, const pfloat * bp, idxint j) {
+	idxint q;
+	pfloat xj = bp[j] / D[j];
+	for (q = L->p[j]; q < L->p[j + 1]; q++) {
+		xj -= L->x[q] * bp[Li[q]];
+	}
+	return xj;
+}
 
-	if (!(*D) || !(*L)->i || !(*L)->x || !Y || !Pattern || !Flag || !Lnz || !Parent)
-		return -1;
+#ifdef OPENMP
+/* y_i = b_i - L(i,:) y, row i of the forward solve using column i of Lt = L' */
+static pfloat forwardRow(const cs * Lt, const pfloat * bp, pfloat bi, idxint i) {
+	idxint q;
+	for (q = Lt->p[i]; q < Lt->p[i + 1]; q++) {
+		bi -= Lt->x[q] * bp[Lt->i[q]];
+	}
+	return bi;
+}
 
-#ifdef EXTRAVERBOSE
-	scs_printf("numeric factorization\n");
+/* level scheduled solve, the permutation of b is fused into the forward sweep and the
+ * inverse permutation into the backward sweep, a barrier between stages */
+static void LDLSolveParallel(pfloat *x, pfloat b[], Priv * p) {
+	idxint st, r, i, n = p->L->n;
+	idxint * P = p->P;
+	pfloat * bp = p->bp;
+	LevelSchedule * fwd = p->fwd, *bwd = p->bwd;
+	if (!fwd) {
+		LDL_perm(n, bp, b, P);
+		forwardSolve(p->L, p->Li, bp);
+	}
+#pragma omp parallel private(st, r, i)
+	{
+		if (fwd) {
+			for (st = 0; st < fwd->nStages; st++) {
+				if (fwd->parallel[st]) {
+#pragma omp for schedule(static)
+					for (r = fwd->stagep[st]; r < fwd->stagep[st + 1]; r++) {
+						i = fwd->rows[r];
+						bp[i] = forwardRow(p->Lt, bp, b[P[i]], i);
+					}
+				} else {
+#pragma omp single
+					for (r = fwd->stagep[st]; r < fwd->stagep[st + 1]; r++) {
+						i = fwd->rows[r];
+						bp[i] = forwardRow(p->Lt, bp, b[P[i]], i);
+					}
+				}
+			}
+		}
+		if (bwd) {
+			for (st = 0; st < bwd->nStages; st++) {
+				if (bwd->parallel[st]) {
+#pragma omp for schedule(static)
+					for (r = bwd->stagep[st]; r < bwd->stagep[st + 1]; r++) {
+						i = bwd->rows[r];
+						x[P[i]] = bp[i] = backwardCol(p->L, p->Li, p->D, bp, i);
+					}
+				} else {
+#pragma omp single
+					for (r = bwd->stagep[st]; r < bwd->stagep[st + 1]; r++) {
+						i = bwd->rows[r];
+						x[P[i]] = bp[i] = backwardCol(p->L, p->Li, p->D, bp, i);
+					}
+				}
+			}
+		} else {
+#pragma omp single
+			for (i = n - 1; i >= 0; i--) {
+				x[P[i]] = bp[i] = backwardCol(p->L, p->Li, p->D, bp, i);
+			}
+		}
+	}
+}
 #endif
-	kk = LDL_numeric(n, A->p, A->i, A->x, (*L)->p, Parent, Lnz, (*L)->i, (*L)->x, *D, Y, Pattern, Flag, P, Pinv);
-#ifdef EXTRAVERBOSE
-	scs_printf("finished numeric factorization\n");
+
+void LDLSolve(pfloat *x, pfloat b[], Priv * p) {
+	/* solves PLDL'P' x = b for x, the diagonal solve and inverse permutation are fused into the backward sweep */
+	cs * L = p->L;
+	idxint j, n = L->n;
+#ifdef OPENMP
+	if (p->fwd || p->bwd) {
+		LDLSolveParallel(x, b, p);
+		return;
+	}
 #endif
+	LDL_perm(n, p->bp, b, p->P);
+	forwardSolve(L, p->Li, p->bp);
+	for (j = n - 1; j >= 0; j--) {
+		x[p->P[j]] = p->bp[j] = backwardCol(L, p->Li, p->D, p->bp, j);
+	}
+}
 
-	scs_free(Parent);
-	scs_free(Lnz);
-	scs_free(Flag);
-	scs_free(Pattern);
-	scs_free(Y);
-	return (n - kk);
-}
-
-void LDLSolve(pfloat *x, pfloat b[], cs * L, pfloat D[], idxint P[], pfloat * bp) {
-	/* solves PLDL'P' x = b for x */
-	idxint n = L->n;
-	if (P == NULL) {
-		if (x != b) /* if they're different addresses */
-			memcpy(x, b, n * sizeof(pfloat));
-		LDL_lsolve(n, x, L->p, L->i, L->x);
-		LDL_dsolve(n, x, D);
-		LDL_ltsolve(n, x, L->p, L->i, L->x);
-	} else {
-		LDL_perm(n, bp, b, P);
-		LDL_lsolve(n, bp, L->p, L->i, L->x);
-		LDL_dsolve(n, bp, D);
-		LDL_ltsolve(n, bp, L->p, L->i, L->x);
-		LDL_permt(n, x, bp, P);
+/* solves PLDL'P' x_k = b_k for K right hand sides in one sweep over L, the K vectors are interleaved
+ * in bpK (entry i of every vector contiguous) so each entry of L is loaded once for all of them */
+static void LDLSolveBatch(Priv * p, idxint K, pfloat ** b) {
+	cs * L = p->L;
+	idxint i, j, k, q, n = L->n;
+	idxint * P = p->P, *Lp = L->p;
+	rowidx * Li = p->Li;
+	pfloat * Lx = L->x, *X = p->bpK;
+	pfloat * Xi, *Xj;
+	pfloat lij;
+	for (i = 0; i < n; i++) {
+		for (k = 0; k < K; k++) {
+			X[i * K + k] = b[k][P[i]];
+		}
+	}
+	/* L unit lower triangular, diagonal not stored */
+	for (j = 0; j < n; j++) {
+		Xj = &(X[j * K]);
+		for (q = Lp[j]; q < Lp[j + 1]; q++) {
+			lij = Lx[q];
+			Xi = &(X[Li[q] * K]);
+			for (k = 0; k < K; k++) {
+				Xi[k] -= lij * Xj[k];
+			}
+		}
+	}
+	for (j = n - 1; j >= 0; j--) {
+		Xj = &(X[j * K]);
+		for (k = 0; k < K; k++) {
+			Xj[k] /= p->D[j];
+		}
+		for (q = Lp[j]; q < Lp[j + 1]; q++) {
+			lij = Lx[q];
+			Xi = &(X[Li[q] * K]);
+			for (k = 0; k < K; k++) {
+				Xj[k] -= lij * Xi[k];
+			}
+		}
+		for (k = 0; k < K; k++) {
+			b[k][P[j]] = Xj[k];
+		}
 	}
 }
 
-void _accumByAtrans(idxint n, pfloat * Ax, idxint * Ai, idxint * Ap, const pfloat *x, pfloat *y) {
+void _accumByAtrans(idxint n, pfloat * Ax, rowidx * Ai, idxint * Ap, const pfloat *x, pfloat *y) {
 	/* y  = A'*x
 	 A in column compressed format
 	 parallelizes over columns (rows of A')
@@ -171,47 +451,141 @@ void _accumByAtrans(idxint n, pfloat * Ax, idxint * Ai, idxint * Ap, const pfloa
 	}
 }
 
-void _accumByA(idxint n, pfloat * Ax, idxint * Ai, idxint * Ap, const pfloat *x, pfloat *y) {
-	/*y  = A*x
-	 A in column compressed format
-	 this parallelizes over columns and uses
-	 pragma atomic to prevent concurrent writes to y
-	 */
-	idxint p, j;
-	idxint c1, c2;
-	pfloat xj;
-	/*#pragma omp parallel for private(p,c1,c2,xj)  */
-	for (j = 0; j < n; j++) {
-		xj = x[j];
-		c1 = Ap[j];
-		c2 = Ap[j + 1];
-		for (p = c1; p < c2; p++) {
-			/*#pragma omp atomic */
-			y[Ai[p]] += Ax[p] * xj;
-		}
+void accumByAtrans(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	accumByScaledAtrans(d, &(p->As), x, y);
+}
+void accumByA(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	/* the stored A' is already normalized, otherwise the serial product with the scaling applied on the fly */
+	if (p->Atx) {
+		_accumByAtrans(d->m, p->Atx, p->Ati, p->Atp, x, y);
+	} else {
+		accumByScaledA(d, &(p->As), x, y);
 	}
 }
-
-void accumByAtrans(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+/* the work of forming A'A, the sum of the squared row counts of A */
+static pfloat normalWork(Data * d) {
 	AMatrix * A = d->A;
-	_accumByAtrans(d->n, A->x, A->i, A->p, x, y);
+	idxint i, * cnt = scs_calloc(d->m, sizeof(idxint));
+	pfloat work = 0;
+	if (!cnt) {
+		return -1;
+	}
+	for (i = 0; i < A->p[d->n]; i++) {
+		cnt[A->i[i]]++;
+	}
+	for (i = 0; i < d->m; i++) {
+		work += (pfloat) cnt[i] * cnt[i];
+	}
+	scs_free(cnt);
+	return work;
 }
-void accumByA(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+
+/* the upper triangle of P * (RHO_X * I + A'A) * P' with the normalized A, P the permutation with inverse pinv (the
+ * identity if both are NULL), pattern only if !values, NULL on failure or if it has more than maxNnz entries (no
+ * limit if maxNnz < 0), column c is column P[c] of A'A, counted in a first pass over A' and filled in a second */
+static cs * formNormal(Data * d, const AScaling * s, const idxint * P, const idxint * pinv, idxint values,
+		idxint maxNnz) {
 	AMatrix * A = d->A;
-	_accumByA(d->n, A->x, A->i, A->p, x, y);
+	idxint n = d->n, nnz = A->p[n], pass, c, i, j, q, r, t, cnt, nz = 0;
+	idxint * Atp = scs_malloc((d->m + 1) * sizeof(idxint));
+	rowidx * Ati = scs_malloc(MAX(nnz, 1) * sizeof(rowidx));
+	pfloat * Atx = scs_malloc(MAX(nnz, 1) * sizeof(pfloat));
+	idxint * mark = scs_malloc(n * sizeof(idxint)), * list = scs_malloc(n * sizeof(idxint));
+	pfloat * w = values ? scs_malloc(n * sizeof(pfloat)) : NULL, arj = 0;
+	cs * N = NULL;
+	if (!Atp || !Ati || !Atx || !mark || !list || (values && !w)) {
+		goto done;
+	}
+	transposeA(d, s, Atx, Ati, Atp);
+	for (pass = 0; pass < 2; pass++) {
+		for (j = 0; j < n; j++) {
+			mark[j] = -1;
+		}
+		nz = 0;
+		for (c = 0; c < n; c++) {
+			j = P ? P[c] : c;
+			mark[j] = c;
+			list[0] = j;
+			cnt = 1;
+			if (pass && values) {
+				w[j] = d->RHO_X;
+			}
+			/* entry (i, j) of A'A is the sum over the rows r of A(r, i) * A(r, j), kept if it is above the diagonal
+			 after the permutation */
+			for (q = A->p[j]; q < A->p[j + 1]; q++) {
+				r = A->i[q];
+				if (pass && values) {
+					arj = s->D ? A->x[q] * (s->scale / (s->D[r] * s->E[j])) : A->x[q];
+				}
+				for (t = Atp[r]; t < Atp[r + 1]; t++) {
+					i = Ati[t];
+					if ((pinv ? pinv[i] : i) > c) {
+						continue;
+					}
+					if (mark[i] != c) {
+						mark[i] = c;
+						list[cnt++] = i;
+						if (pass && values) {
+							w[i] = 0;
+						}
+					}
+					if (pass && values) {
+						w[i] += arj * Atx[t];
+					}
+				}
+			}
+			if (pass) {
+				N->p[c] = nz;
+				for (t = 0; t < cnt; t++) {
+					N->i[nz + t] = pinv ? pinv[list[t]] : list[t];
+					if (values) {
+						N->x[nz + t] = w[list[t]];
+					}
+				}
+			}
+			nz += cnt;
+			if (maxNnz >= 0 && nz > maxNnz) {
+				goto done;
+			}
+		}
+		if (!pass && !(N = cs_spalloc(n, n, MAX(nz, 1), values, 0))) {
+			goto done;
+		}
+	}
+	N->p[n] = nz;
+done:
+	if (N && N->p[n] != nz) {
+		N = cs_spfree(N);
+	}
+	if (Atp)
+		scs_free(Atp);
+	if (Ati)
+		scs_free(Ati);
+	if (Atx)
+		scs_free(Atx);
+	if (mark)
+		scs_free(mark);
+	if (list)
+		scs_free(list);
+	if (w)
+		scs_free(w);
+	return N;
 }
-idxint factorize(Data * d, Priv * p) {
-	pfloat *info;
-	idxint *Pinv, amd_status, ldl_status;
-	cs *C, *K = formKKT(d);
-	if (!K) {
+
+/* the ORDERING of the pattern C into P, returns the nonzeros of L below the diagonal it gives (predicted by AMD),
+ -1 on failure */
+static pfloat order(Data * d, cs * C, idxint * P) {
+	pfloat *info, lnz;
+	idxint amd_status;
+	if (d->ORDERING != ORDER_AMD) {
+		return orderPattern(d, C, P);
+	}
+	amd_status = LDLInit(C, P, &info);
+	if (!info) {
 		return -1;
 	}
-	amd_status = LDLInit(K, p->P, &info);
-	if (amd_status < 0)
-		return (amd_status);
 #ifdef EXTRAVERBOSE
-	if(d->VERBOSE) {
+	if(d->VERBOSE && amd_status >= 0) {
 		scs_printf("Matrix factorization info:\n");
 #ifdef DLONG
 		amd_l_info(info);
@@ -220,22 +594,138 @@ idxint factorize(Data * d, Priv * p) {
 #endif
 	}
 #endif
-	Pinv = cs_pinv(p->P, d->n + d->m);
-	C = cs_symperm(K, Pinv, 1);
-	ldl_status = LDLFactor(C, NULL, NULL, &p->L, &p->D);
-	cs_spfree(C);
-	cs_spfree(K);
-	scs_free(Pinv);
+	lnz = amd_status < 0 ? -1 : info[AMD_LNZ];
 	scs_free(info);
+	return lnz;
+}
+
+idxint factorize(Data * d, Priv * p) {
+	idxint ldl_status, n = d->n, size, forced = d->NORMAL_EQS == 1;
+	pfloat lnz = -1, maxLnz = NORMAL_MAX_FILL * d->A->p[n];
+	timer phaseTimer;
+	cs *C, *K;
+	p->kktTime = 0;
+	p->orderTime = 0;
+	/* the normal equations if forced, or if their factor has at most NORMAL_MAX_FILL * nnz(A) entries below the
+	 diagonal (that of the KKT has at least nnz(A)), not tried if forming A'A alone (e.g. for a dense row of A) would
+	 cost more than NORMAL_MAX_WORK times the entries of the KKT, nor if PERM is of the KKT */
+	p->normal = 0;
+	if (forced || (d->NORMAL_EQS == 0 && d->ORDERING != ORDER_USER
+			&& normalWork(d) <= NORMAL_MAX_WORK * (d->A->p[n] + n + d->m))) {
+		tic(&phaseTimer);
+		K = formNormal(d, &(p->As), NULL, NULL, 0, forced ? -1 : (idxint) maxLnz + n);
+		p->kktTime = tocq(&phaseTimer);
+		if (K) {
+			tic(&phaseTimer);
+			lnz = order(d, K, p->P);
+			cs_spfree(K);
+			p->orderTime = tocq(&phaseTimer);
+		}
+		p->normal = lnz >= 0 && (forced || lnz <= maxLnz);
+		if (forced && !p->normal) {
+			return -1;
+		}
+#ifdef EXTRAVERBOSE
+		scs_printf("predicted nnz of the factor of RHO_X * I + A'A: %.0f, %s\n", lnz, p->normal ? "used" : "not used");
+#endif
+	}
+	if (!p->normal) {
+		tic(&phaseTimer);
+		/* the ordering only needs the pattern, freed before the permuted KKT is formed */
+		K = formKKT(d, &(p->As), NULL, 0);
+		p->kktTime += tocq(&phaseTimer);
+		if (!K) {
+			return -1;
+		}
+		tic(&phaseTimer);
+		lnz = order(d, K, p->P);
+		cs_spfree(K);
+		p->orderTime += tocq(&phaseTimer);
+		if (lnz < 0) {
+			return -1;
+		}
+	}
+	size = p->normal ? n : n + d->m;
+	p->L->m = size;
+	p->L->n = size;
+	tic(&phaseTimer);
+	p->Pinv = cs_pinv(p->P, size);
+	p->orderTime += tocq(&phaseTimer);
+	if (!p->Pinv) {
+		return -1;
+	}
+	tic(&phaseTimer);
+	C = p->normal ? formNormal(d, &(p->As), p->P, p->Pinv, 1, -1) : formKKT(d, &(p->As), p->Pinv, 1);
+	p->kktTime += tocq(&phaseTimer);
+	if (!C) {
+		return -1;
+	}
+	tic(&phaseTimer);
+	ldl_status = LDLSymbolic(C, p->L, p->Parent);
+	if (ldl_status == 0) {
+		p->ordering = d->ORDERING;
+		p->lnz = p->L->p[size];
+		p->treeHeight = etreeHeight(p->Parent, size);
+	}
+	p->orderTime += tocq(&phaseTimer);
+	if (ldl_status == 0) {
+		tic(&phaseTimer);
+		ldl_status = numericFactor(C, p);
+		p->factorTime = tocq(&phaseTimer);
+	}
+	cs_spfree(C);
+#ifdef OPENMP
+	if (ldl_status >= 0) {
+		buildSchedules(p);
+	}
+#endif
+	return (ldl_status);
+}
+
+/* numeric-only re-factorization, re-uses the ordering and symbolic analysis from factorize */
+idxint refactorize(Data * d, Priv * p) {
+	idxint ldl_status;
+	timer phaseTimer;
+	cs *C;
+	tic(&phaseTimer);
+	C = p->normal ? formNormal(d, &(p->As), p->P, p->Pinv, 1, -1) : formKKT(d, &(p->As), p->Pinv, 1);
+	p->kktTime = tocq(&phaseTimer);
+	if (!C) {
+		return -1;
+	}
+	tic(&phaseTimer);
+	ldl_status = numericFactor(C, p);
+	p->factorTime = tocq(&phaseTimer);
+	cs_spfree(C);
+#ifdef OPENMP
+	if (ldl_status >= 0 && p->Lt) {
+		idxint * w = scs_malloc(p->L->n * sizeof(idxint));
+		if (!w) {
+			return -1;
+		}
+		transposeL(p->L, p->Li, p->Lt, w);
+		scs_free(w);
+	}
+#endif
 	return (ldl_status);
 }
 
-Priv * initPriv(Data * d) {
-	Priv * p = scs_calloc(1, sizeof(Priv));
+Priv * initPriv(Data * d, const pfloat * D, const pfloat * E) {
+	Priv * p;
 	idxint n_plus_m = d->n + d->m;
-	p->P = scs_malloc(sizeof(idxint) * n_plus_m);
-	p->L = scs_malloc(sizeof(cs));
-	p->bp = scs_malloc(n_plus_m * sizeof(pfloat));
+	/* with ARENA, room for the vectors here (L is reserved by LDLSymbolic) */
+	scs_wreserve(sizeof(Priv) + sizeof(cs) + n_plus_m * (2 * sizeof(idxint) + 2 * sizeof(pfloat))
+			+ MAX(d->m, d->n) * sizeof(pfloat));
+	p = scs_wcalloc(1, sizeof(Priv));
+	p->P = scs_wmalloc(sizeof(idxint) * n_plus_m);
+	p->Parent = scs_wmalloc(sizeof(idxint) * n_plus_m);
+	p->D = scs_wmalloc(sizeof(pfloat) * n_plus_m);
+	p->L = scs_wcalloc(1, sizeof(cs));
+	p->bp = scs_wmalloc(n_plus_m * sizeof(pfloat));
+	if (!p->P || !p->Parent || !p->D || !p->L || !p->bp || initAScaling(d, &(p->As), D, E) < 0) {
+		freePriv(p);
+		return NULL;
+	}
 	p->L->m = n_plus_m;
 	p->L->n = n_plus_m;
 	p->L->nz = -1;
@@ -244,19 +734,113 @@ Priv * initPriv(Data * d) {
 		freePriv(p);
 		return NULL;
 	}
-	totalSolveTime = 0.0;
+	if (d->STORE_TRANSPOSE) {
+		scs_wreserve(d->A->p[d->n] * (sizeof(rowidx) + sizeof(pfloat)) + (d->m + 1) * sizeof(idxint));
+		p->Ati = scs_wmalloc((d->A->p[d->n]) * sizeof(rowidx));
+		p->Atp = scs_wmalloc((d->m + 1) * sizeof(idxint));
+		p->Atx = scs_wmalloc((d->A->p[d->n]) * sizeof(pfloat));
+		if (!p->Ati || !p->Atp || !p->Atx) {
+			freePriv(p);
+			return NULL;
+		}
+		transposeA(d, &(p->As), p->Atx, p->Ati, p->Atp);
+	}
+	p->totalSolveTime = 0.0;
 	return p;
 }
 
+void setLinSysResidual(Priv * p, pfloat res) {
+}
+
+idxint getLinSysIters(Priv * p) {
+	return 0;
+}
+
+void getLinSysProfile(Priv * p, Profile * prof) {
+	prof->kktTime = p->kktTime;
+	prof->orderTime = p->orderTime;
+	prof->factorTime = p->factorTime;
+	prof->ordering = p->ordering;
+	prof->lnz = p->lnz;
+	prof->treeHeight = p->treeHeight;
+}
+
+idxint updateLinSys(Data * d, Priv * p) {
+	if (refactorize(d, p) < 0) {
+		scs_printf("Error in numeric re-factorization\n");
+		return -1;
+	}
+	if (p->Atx) {
+		transposeA(d, &(p->As), p->Atx, p->Ati, p->Atp);
+	}
+	return 0;
+}
+
+/* with p->normal, the KKT system [RHO_X * I A'; A -I] [x; y] = b reduced to the factored matrix: b_x += A'b_y
+ before the solve for x, and y = Ax - b_y after */
+static void normalRhs(Data * d, Priv * p, pfloat * b) {
+	accumByAtrans(d, p, &(b[d->n]), b);
+}
+
+static void normalY(Data * d, Priv * p, pfloat * b) {
+	scaleArray(&(b[d->n]), -1, d->m);
+	accumByA(d, p, b, &(b[d->n]));
+}
+
 idxint solveLinSys(Data * d, Priv * p, pfloat * b, const pfloat * s, idxint iter) {
 	/* returns solution to linear system */
 	/* Ax = b with solution stored in b */
+	timer linsysTimer;
+	if (iter == 0) {
+		/* the first step of a solve, the counters of the summary start over */
+		p->totalSolveTime = 0;
+	}
 	tic(&linsysTimer);
-	LDLSolve(b, b, p->L, p->D, p->P, p->bp);
-	totalSolveTime += tocq(&linsysTimer);
+	if (p->normal) {
+		normalRhs(d, p, b);
+	}
+	LDLSolve(b, b, p);
+	if (p->normal) {
+		normalY(d, p, b);
+	}
+	p->totalSolveTime += tocq(&linsysTimer);
 #ifdef EXTRAVERBOSE
 	scs_printf("linsys solve time: %1.2es\n", tocq(&linsysTimer) / 1e3);
 #endif
 	return 0;
 }
 
+idxint solveLinSysBatch(Data * d, Priv * p, idxint K, pfloat ** b, const pfloat ** s, idxint iter) {
+	timer linsysTimer;
+	idxint k;
+	if (iter == 0) {
+		/* the first step of a solve, the counters of the summary start over */
+		p->totalSolveTime = 0;
+	}
+	tic(&linsysTimer);
+	for (k = 0; p->normal && k < K; k++) {
+		normalRhs(d, p, b[k]);
+	}
+	if (K == 1) {
+		/* can use the level scheduled solve */
+		LDLSolve(b[0], b[0], p);
+	} else {
+		if (K > p->bpKCap) {
+			if (p->bpK)
+				scs_free(p->bpK);
+			p->bpK = scs_malloc(p->L->n * K * sizeof(pfloat));
+			p->bpKCap = p->bpK ? K : 0;
+			if (!p->bpK)
+				return -1;
+		}
+		LDLSolveBatch(p, K, b);
+	}
+	for (k = 0; p->normal && k < K; k++) {
+		normalY(d, p, b[k]);
+	}
+	p->totalSolveTime += tocq(&linsysTimer);
+#ifdef EXTRAVERBOSE
+	scs_printf("batch linsys solve time: %1.2es\n", tocq(&linsysTimer) / 1e3);
+#endif
+	return 0;
+}
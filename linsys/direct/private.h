@@ -6,13 +6,45 @@
 #include "cs.h"
 #include "external/amd.h"
 #include "external/ldl.h"
+#include "ordering.h"
 #include "linsys/common.h"
 
+/* rows of L grouped into stages for the level scheduled triangular solves, a stage is either one
+ * wide level of the elimination tree, solved in parallel, or a run of narrow levels solved by one thread */
+typedef struct {
+	idxint nStages;
+	idxint * stagep; /* start of each stage in rows, size nStages + 1 */
+	idxint * parallel; /* 1 if the stage is solved in parallel */
+	idxint * rows; /* rows of L ordered by stage */
+} LevelSchedule;
+
 struct PRIVATE_DATA {
+	/* 1 if L factors RHO_X * I + A'A (n by n, see NORMAL_EQS), the solves then reduce the KKT system to it */
+	idxint normal;
 	cs * L; /* KKT, and factorization matrix L resp. */
+	rowidx * Li; /* row indices of L used by the solves: L->i, or with COMPACT_ROWS a narrowed copy (L->i is then
+	 only allocated while factoring) */
 	pfloat * D; /* diagonal matrix of factorization */
 	idxint * P; /* permutation of KKT matrix for factorization */
+	idxint * Pinv; /* inverse permutation, kept for re-factorization */
+	idxint * Parent; /* elimination tree of permuted KKT, kept for re-factorization */
 	pfloat * bp; /* workspace memory for solves */
+	pfloat * bpK; /* workspace for batched solves, bpKCap right hand sides interleaved */
+	idxint bpKCap;
+	/* level schedules of the forward and backward solves, only built with OPENMP and more than one thread */
+	LevelSchedule * fwd, * bwd;
+	cs * Lt; /* L' for the row oriented parallel forward solve, only stored with fwd */
+	AScaling As; /* normalization of A, the KKT matrix and A' hold the normalized values */
+	/* A' in column compressed format, only stored if d->STORE_TRANSPOSE */
+	pfloat * Atx;
+	rowidx * Ati;
+	idxint * Atp;
+	/* reporting */
+	pfloat totalSolveTime;
+	pfloat kktTime, orderTime, factorTime; /* of the last factorize or refactorize */
+	idxint ordering; /* the ORDERING of factorize, see Profile */
+	pfloat lnz;
+	idxint treeHeight;
 };
 
 #endif
@@ -0,0 +1,370 @@
+#include "private.h"
+
+/* indirect solver on the GPU: A, A' and all CG vectors live on the device, each solve moves only its right hand
+ * side (and warm start) there and the solution back; the residual products of scs stay on the host */
+
+#define CG_BEST_TOL 1e-9
+#define CG_MIN_TOL 1e-1
+/* with CG_ADAPTIVE, CG stops once it has reduced the residual of the warm start by this factor */
+#define CG_ADAPT_REDUCTION 0.1
+
+#ifndef FLOAT
+#define CUDA_FLOAT CUDA_R_64F
+#define CUBLAS(x) cublasD ## x
+#else
+#define CUDA_FLOAT CUDA_R_32F
+#define CUBLAS(x) cublasS ## x
+#endif
+#define CUSPARSE_IDX (sizeof(idxint) == 8 ? CUSPARSE_INDEX_64I : CUSPARSE_INDEX_32I)
+
+/* cudaSuccess, CUBLAS_STATUS_SUCCESS and CUSPARSE_STATUS_SUCCESS are all 0 */
+#define GPU_CHECK(call) \
+	if ((call) != 0) { \
+		scs_printf("%s:%d: GPU error in %s\n", __FILE__, __LINE__, #call); \
+		return -1; \
+	}
+
+char * getLinSysMethod(Data * d, Priv * p) {
+	char * str = scs_malloc(sizeof(char) * 128);
+	if (d->CG_ADAPTIVE) {
+		sprintf(str, "sparse-indirect GPU, nnz in A = %li, CG tol ~ %.1f * warm start residual", (long ) d->A->p[d->n],
+				CG_ADAPT_REDUCTION);
+	} else {
+		sprintf(str, "sparse-indirect GPU, nnz in A = %li, CG tol ~ 1/iter^(%2.2f)", (long ) d->A->p[d->n],
+				d->CG_RATE);
+	}
+	return str;
+}
+
+char * getLinSysSummary(Priv * p, Info * info) {
+	char * str = scs_malloc(sizeof(char) * 128);
+	sprintf(str, "\tLin-sys: avg # CG iterations: %2.2f, avg solve time: %1.2es\n",
+			(pfloat ) info->linSysIters / (info->iter + 1), p->totalSolveTime / (info->iter + 1) / 1e3);
+	return str;
+}
+
+/* normalized copies of A and A' on the host, M = inv ( diag ( RHO_X * I + A'A ) ) */
+static void setHostValues(Data * d, Priv * p) {
+	AMatrix * A = d->A;
+	const AScaling * s = &(p->As);
+	idxint i, j;
+	for (j = 0; j < d->n; ++j) {
+		for (i = A->p[j]; i < A->p[j + 1]; ++i) {
+			p->Ax[i] = s->D ? A->x[i] / s->D[A->i[i]] * (1.0 / s->E[j]) * s->scale : A->x[i];
+		}
+	}
+	transposeA(d, s, p->Atx, p->Ati, p->Atp);
+	memset(p->M, 0, d->n * sizeof(pfloat));
+	for (i = 0; i < A->p[d->n]; ++i) {
+		p->M[p->Ati[i]] += p->Atx[i] * p->Atx[i];
+	}
+	for (i = 0; i < d->n; ++i) {
+		p->M[i] = 1 / (d->RHO_X + p->M[i]);
+	}
+}
+
+static idxint uploadValues(Data * d, Priv * p) {
+	idxint Anz = d->A->p[d->n];
+	GPU_CHECK(cudaMemcpy(p->dAx, p->Ax, Anz * sizeof(pfloat), cudaMemcpyHostToDevice));
+	GPU_CHECK(cudaMemcpy(p->dAtx, p->Atx, Anz * sizeof(pfloat), cudaMemcpyHostToDevice));
+	GPU_CHECK(cudaMemcpy(p->dM, p->M, d->n * sizeof(pfloat), cudaMemcpyHostToDevice));
+	return 0;
+}
+
+/* the column indices of A' on the device are idxint, as its row pointers (one index type per cuSPARSE matrix) */
+static idxint uploadColumnIndices(Priv * p, idxint Anz) {
+#ifdef COMPACT_ROWS
+	idxint i, status = -1;
+	idxint * Ati = scs_malloc(Anz * sizeof(idxint));
+	if (Ati) {
+		for (i = 0; i < Anz; ++i) {
+			Ati[i] = p->Ati[i];
+		}
+		status = cudaMemcpy(p->dAti, Ati, Anz * sizeof(idxint), cudaMemcpyHostToDevice) == cudaSuccess ? 0 : -1;
+		scs_free(Ati);
+	}
+	return status;
+#else
+	GPU_CHECK(cudaMemcpy(p->dAti, p->Ati, Anz * sizeof(idxint), cudaMemcpyHostToDevice));
+	return 0;
+#endif
+}
+
+/* allocates the device data, uploads the patterns of A and A' and sets up the cuSPARSE descriptors */
+static idxint initDevice(Data * d, Priv * p) {
+	AMatrix * A = d->A;
+	idxint Anz = A->p[d->n];
+	size_t bufA, bufAt;
+	pfloat one = 1, zero = 0;
+	GPU_CHECK(cusparseCreate(&(p->sparse)));
+	GPU_CHECK(cublasCreate(&(p->blas)));
+	GPU_CHECK(cudaMalloc((void **) &(p->dAx), Anz * sizeof(pfloat)));
+	GPU_CHECK(cudaMalloc((void **) &(p->dAi), Anz * sizeof(idxint)));
+	GPU_CHECK(cudaMalloc((void **) &(p->dAp), (d->n + 1) * sizeof(idxint)));
+	GPU_CHECK(cudaMalloc((void **) &(p->dAtx), Anz * sizeof(pfloat)));
+	GPU_CHECK(cudaMalloc((void **) &(p->dAti), Anz * sizeof(idxint)));
+	GPU_CHECK(cudaMalloc((void **) &(p->dAtp), (d->m + 1) * sizeof(idxint)));
+	GPU_CHECK(cudaMalloc((void **) &(p->db), (d->n + d->m) * sizeof(pfloat)));
+	GPU_CHECK(cudaMalloc((void **) &(p->ds), d->n * sizeof(pfloat)));
+	GPU_CHECK(cudaMalloc((void **) &(p->dp), d->n * sizeof(pfloat)));
+	GPU_CHECK(cudaMalloc((void **) &(p->dr), d->n * sizeof(pfloat)));
+	GPU_CHECK(cudaMalloc((void **) &(p->dGp), d->n * sizeof(pfloat)));
+	GPU_CHECK(cudaMalloc((void **) &(p->dz), d->n * sizeof(pfloat)));
+	GPU_CHECK(cudaMalloc((void **) &(p->dM), d->n * sizeof(pfloat)));
+	GPU_CHECK(cudaMalloc((void **) &(p->dtmp), d->m * sizeof(pfloat)));
+
+	GPU_CHECK(cudaMemcpy(p->dAi, A->i, Anz * sizeof(idxint), cudaMemcpyHostToDevice));
+	GPU_CHECK(cudaMemcpy(p->dAp, A->p, (d->n + 1) * sizeof(idxint), cudaMemcpyHostToDevice));
+	GPU_CHECK(cudaMemcpy(p->dAtp, p->Atp, (d->m + 1) * sizeof(idxint), cudaMemcpyHostToDevice));
+	if (uploadColumnIndices(p, Anz) < 0)
+		return -1;
+	if (uploadValues(d, p) < 0)
+		return -1;
+
+	GPU_CHECK(cusparseCreateCsr(&(p->matA), d->m, d->n, Anz, p->dAtp, p->dAti, p->dAtx, CUSPARSE_IDX, CUSPARSE_IDX,
+			CUSPARSE_INDEX_BASE_ZERO, CUDA_FLOAT));
+	GPU_CHECK(cusparseCreateCsr(&(p->matAt), d->n, d->m, Anz, p->dAp, p->dAi, p->dAx, CUSPARSE_IDX, CUSPARSE_IDX,
+			CUSPARSE_INDEX_BASE_ZERO, CUDA_FLOAT));
+	GPU_CHECK(cusparseCreateDnVec(&(p->vecN), d->n, p->dp, CUDA_FLOAT));
+	GPU_CHECK(cusparseCreateDnVec(&(p->vecM), d->m, p->dtmp, CUDA_FLOAT));
+	GPU_CHECK(cusparseSpMV_bufferSize(p->sparse, CUSPARSE_OPERATION_NON_TRANSPOSE, &one, p->matA, p->vecN, &zero,
+			p->vecM, CUDA_FLOAT, CUSPARSE_SPMV_ALG_DEFAULT, &bufA));
+	GPU_CHECK(cusparseSpMV_bufferSize(p->sparse, CUSPARSE_OPERATION_NON_TRANSPOSE, &one, p->matAt, p->vecM, &zero,
+			p->vecN, CUDA_FLOAT, CUSPARSE_SPMV_ALG_DEFAULT, &bufAt));
+	GPU_CHECK(cudaMalloc(&(p->dBuf), MAX(MAX(bufA, bufAt), 1)));
+	return 0;
+}
+
+void freePriv(Priv * p) {
+	if (p) {
+		freeAScaling(&(p->As));
+		if (p->Ax)
+			scs_free(p->Ax);
+		if (p->Atx)
+			scs_free(p->Atx);
+		if (p->Ati)
+			scs_free(p->Ati);
+		if (p->Atp)
+			scs_free(p->Atp);
+		if (p->M)
+			scs_free(p->M);
+		if (p->matA)
+			cusparseDestroySpMat(p->matA);
+		if (p->matAt)
+			cusparseDestroySpMat(p->matAt);
+		if (p->vecN)
+			cusparseDestroyDnVec(p->vecN);
+		if (p->vecM)
+			cusparseDestroyDnVec(p->vecM);
+		if (p->sparse)
+			cusparseDestroy(p->sparse);
+		if (p->blas)
+			cublasDestroy(p->blas);
+		/* cudaFree ignores NULL */
+		cudaFree(p->dAx);
+		cudaFree(p->dAi);
+		cudaFree(p->dAp);
+		cudaFree(p->dAtx);
+		cudaFree(p->dAti);
+		cudaFree(p->dAtp);
+		cudaFree(p->dBuf);
+		cudaFree(p->db);
+		cudaFree(p->ds);
+		cudaFree(p->dp);
+		cudaFree(p->dr);
+		cudaFree(p->dGp);
+		cudaFree(p->dz);
+		cudaFree(p->dM);
+		cudaFree(p->dtmp);
+		scs_free(p);
+	}
+}
+
+Priv * initPriv(Data * d, const pfloat * D, const pfloat * E) {
+	AMatrix * A = d->A;
+	Priv * p = scs_calloc(1, sizeof(Priv));
+	if (!p)
+		return NULL;
+	p->Ax = scs_malloc((A->p[d->n]) * sizeof(pfloat));
+	p->Atx = scs_malloc((A->p[d->n]) * sizeof(pfloat));
+	p->Ati = scs_malloc((A->p[d->n]) * sizeof(rowidx));
+	p->Atp = scs_malloc((d->m + 1) * sizeof(idxint));
+	p->M = scs_malloc((d->n) * sizeof(pfloat));
+	if (!p->Ax || !p->Atx || !p->Ati || !p->Atp || !p->M || initAScaling(d, &(p->As), D, E) < 0) {
+		freePriv(p);
+		return NULL;
+	}
+	setHostValues(d, p);
+	if (initDevice(d, p) < 0) {
+		scs_printf("GPU initialization failed\n");
+		freePriv(p);
+		return NULL;
+	}
+	p->totalSolveTime = 0;
+	p->totCgIts = 0;
+	p->res = NAN;
+	return p;
+}
+
+void setLinSysResidual(Priv * p, pfloat res) {
+	p->res = res;
+}
+
+idxint getLinSysIters(Priv * p) {
+	return p->totCgIts;
+}
+
+void getLinSysProfile(Priv * p, Profile * prof) {
+	/* only a diagonal preconditioner, nothing to factorize */
+	prof->kktTime = 0;
+	prof->orderTime = 0;
+	prof->factorTime = 0;
+}
+
+idxint updateLinSys(Data * d, Priv * p) {
+	setHostValues(d, p);
+	return uploadValues(d, p);
+}
+
+void accumByAtrans(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	accumByScaledAtrans(d, &(p->As), x, y);
+}
+
+void accumByA(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	accumByScaledA(d, &(p->As), x, y);
+}
+
+/* y = alpha * mat * x + beta * y on the device, vx and vy are rebound to x and y */
+static void spmv(Priv * p, cusparseSpMatDescr_t mat, cusparseDnVecDescr_t vx, pfloat * x, cusparseDnVecDescr_t vy,
+		pfloat * y, pfloat alpha, pfloat beta) {
+	cusparseDnVecSetValues(vx, x);
+	cusparseDnVecSetValues(vy, y);
+	cusparseSpMV(p->sparse, CUSPARSE_OPERATION_NON_TRANSPOSE, &alpha, mat, vx, &beta, vy, CUDA_FLOAT,
+			CUSPARSE_SPMV_ALG_DEFAULT, p->dBuf);
+}
+
+/* y = (RHO_X * I + A'A)x on the device, returns x'y */
+static pfloat matVec(Data * d, Priv * p, pfloat * x, pfloat * y) {
+	pfloat xy;
+	spmv(p, p->matA, p->vecN, x, p->vecM, p->dtmp, 1, 0);
+	cudaMemcpy(y, x, d->n * sizeof(pfloat), cudaMemcpyDeviceToDevice);
+	spmv(p, p->matAt, p->vecM, p->dtmp, p->vecN, y, 1, d->RHO_X);
+	CUBLAS(dot)(p->blas, (int) d->n, x, 1, y, 1, &xy);
+	return xy;
+}
+
+/* z = M r on the device, returns z'r */
+static pfloat applyPreConditioner(Priv * p, pfloat * z, pfloat * r, idxint n) {
+	pfloat ipzr;
+	CUBLAS(dgmm)(p->blas, CUBLAS_SIDE_LEFT, (int) n, 1, r, (int) n, p->dM, 1, z, (int) n);
+	CUBLAS(dot)(p->blas, (int) n, z, 1, r, 1, &ipzr);
+	return ipzr;
+}
+
+/* b is on the device, s (if not NULL) on the host */
+/* with reduction > 0, tol is lowered to reduction times the norm of the initial residual b - G * s */
+static idxint pcg(Data *d, Priv * pr, const pfloat * s, pfloat * b, idxint max_its, pfloat tol, pfloat reduction) {
+	idxint i, n = d->n;
+	pfloat ipzr, ipzrOld, alpha, nmr, beta, negOne = -1;
+	pfloat *p = pr->dp; /* cg direction */
+	pfloat *Gp = pr->dGp; /* updated CG direction */
+	pfloat *r = pr->dr; /* cg residual */
+	pfloat *z = pr->dz; /* for preconditioning */
+
+	if (s == NULL) {
+		cudaMemcpy(r, b, n * sizeof(pfloat), cudaMemcpyDeviceToDevice);
+		cudaMemset(b, 0, n * sizeof(pfloat));
+	} else {
+		cudaMemcpy(pr->ds, s, n * sizeof(pfloat), cudaMemcpyHostToDevice);
+		matVec(d, pr, pr->ds, r);
+		/* r = b - G * s */
+		CUBLAS(scal)(pr->blas, (int) n, &negOne, r, 1);
+		alpha = 1;
+		CUBLAS(axpy)(pr->blas, (int) n, &alpha, b, 1, r, 1);
+		cudaMemcpy(b, pr->ds, n * sizeof(pfloat), cudaMemcpyDeviceToDevice);
+	}
+	if (reduction > 0) {
+		CUBLAS(nrm2)(pr->blas, (int) n, r, 1, &nmr);
+		tol = MAX(MIN(tol, reduction * nmr), CG_BEST_TOL);
+	}
+	ipzr = applyPreConditioner(pr, z, r, n);
+	cudaMemcpy(p, z, n * sizeof(pfloat), cudaMemcpyDeviceToDevice);
+
+	for (i = 0; i < max_its; ++i) {
+		alpha = ipzr / matVec(d, pr, p, Gp); /* Gp = G * p, returns p'Gp */
+		CUBLAS(axpy)(pr->blas, (int) n, &alpha, p, 1, b, 1);
+		alpha = -alpha;
+		CUBLAS(axpy)(pr->blas, (int) n, &alpha, Gp, 1, r, 1);
+		CUBLAS(nrm2)(pr->blas, (int) n, r, 1, &nmr);
+
+		if (nmr < tol) {
+#ifdef EXTRAVERBOSE
+			scs_printf("tol: %.4e, resid: %.4e, iters: %li\n", tol, nmr, (long) i+1);
+#endif
+			return i + 1;
+		}
+		ipzrOld = ipzr;
+		ipzr = applyPreConditioner(pr, z, r, n);
+
+		/* p = z + (ipzr / ipzrOld) * p */
+		beta = ipzr / ipzrOld;
+		CUBLAS(scal)(pr->blas, (int) n, &beta, p, 1);
+		alpha = 1;
+		CUBLAS(axpy)(pr->blas, (int) n, &alpha, z, 1, p, 1);
+	}
+	return i;
+}
+
+/* relative CG tolerance of the solve at ADMM iteration iter >= 0 */
+static pfloat cgRelTol(Data * d, Priv * p, idxint iter) {
+	if (!d->CG_ADAPTIVE) {
+		return CG_MIN_TOL / POWF((pfloat) iter + 1, d->CG_RATE);
+	}
+	/* only a bound, pcg stops earlier once the residual of the warm start is reduced by CG_ADAPT_REDUCTION */
+	return p->res == p->res ? MIN(MAX(p->res, CG_BEST_TOL), 1) : 1;
+}
+
+idxint solveLinSys(Data *d, Priv * p, pfloat * b, const pfloat * s, idxint iter) {
+	idxint cgIts;
+	timer linsysTimer;
+	pfloat negOne = -1;
+	pfloat cgTol = calcNorm(b, d->n) * (iter < 0 ? CG_BEST_TOL : cgRelTol(d, p, iter));
+	/* the accurate solves (iter < 0) are never capped */
+	idxint maxIts = iter >= 0 && d->CG_MAX_ITERS > 0 ? MIN(d->CG_MAX_ITERS, d->n) : d->n;
+
+	if (iter == 0) {
+		/* the first step of a solve, the counters of the summary start over */
+		p->totalSolveTime = 0;
+	}
+	tic(&linsysTimer);
+	GPU_CHECK(cudaMemcpy(p->db, b, (d->n + d->m) * sizeof(pfloat), cudaMemcpyHostToDevice));
+	/* solves Mx = b, for x but stores result in b */
+	/* s contains warm-start (if available) */
+	spmv(p, p->matAt, p->vecM, &(p->db[d->n]), p->vecN, p->db, 1, 1);
+	/* solves (I+A'A)x = b, s warm start, solution stored in b */
+	cgIts = pcg(d, p, s, p->db, maxIts, MAX(cgTol, CG_BEST_TOL),
+			iter >= 0 && d->CG_ADAPTIVE ? CG_ADAPT_REDUCTION : 0);
+	CUBLAS(scal)(p->blas, (int) d->m, &negOne, &(p->db[d->n]), 1);
+	spmv(p, p->matA, p->vecN, p->db, p->vecM, &(p->db[d->n]), 1, 1);
+	GPU_CHECK(cudaMemcpy(b, p->db, (d->n + d->m) * sizeof(pfloat), cudaMemcpyDeviceToHost));
+
+	if (iter >= 0) {
+		p->totCgIts += cgIts;
+	}
+
+	p->totalSolveTime += tocq(&linsysTimer);
+#ifdef EXTRAVERBOSE
+	scs_printf("linsys solve time: %1.2es\n", tocq(&linsysTimer) / 1e3);
+#endif
+	return 0;
+}
+
+idxint solveLinSysBatch(Data * d, Priv * p, idxint K, pfloat ** b, const pfloat ** s, idxint iter) {
+	/* one solve at a time, the device vectors are sized for a single right hand side */
+	idxint k;
+	for (k = 0; k < K; ++k) {
+		if (solveLinSys(d, p, b[k], s ? s[k] : NULL, iter) < 0)
+			return -1;
+	}
+	return 0;
+}
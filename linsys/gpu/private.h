@@ -0,0 +1,40 @@
+#ifndef PRIV_H_GUARD
+#define PRIV_H_GUARD
+
+#include "glbopts.h"
+#include "scs.h"
+#include "cs.h"
+#include <math.h>
+#include "linsys/common.h"
+#include "linAlg.h"
+#include <cuda_runtime.h>
+#include <cublas_v2.h>
+#include <cusparse.h>
+
+struct PRIVATE_DATA {
+	AScaling As; /* normalization of A, the host and device copies hold the normalized values */
+	/* host copies of the normalized A (pattern of d->A) and of A', kept for updateLinSys */
+	pfloat * Ax;
+	pfloat * Atx;
+	rowidx * Ati;
+	idxint * Atp;
+	pfloat * M; /* inverse diagonal of RHO_X * I + A'A */
+	/* device: A' as the row compressed A and A in row compressed form (the column compressed A read as A') */
+	cusparseHandle_t sparse;
+	cublasHandle_t blas;
+	pfloat * dAx, *dAtx;
+	idxint * dAi, *dAp, *dAti, *dAtp;
+	cusparseSpMatDescr_t matA; /* m by n, from dAtp, dAti, dAtx */
+	cusparseSpMatDescr_t matAt; /* n by m, from dAp, dAi, dAx */
+	cusparseDnVecDescr_t vecN, vecM; /* rebound to the vectors of each product */
+	void * dBuf; /* cusparseSpMV workspace */
+	/* device: the right hand side and solution (n + m), warm start, CG vectors and preconditioner */
+	pfloat * db, *ds;
+	pfloat * dp, *dr, *dGp, *dz, *dtmp, *dM;
+	pfloat res; /* ADMM residual of the last convergence check for CG_ADAPTIVE, NAN if not known */
+	/* reporting */
+	idxint totCgIts;
+	pfloat totalSolveTime;
+};
+
+#endif
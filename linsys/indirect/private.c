@@ -3,38 +3,80 @@
 #define CG_BEST_TOL 1e-9
 #define CG_MIN_TOL 1e-1
 #define PRINT_INTERVAL 100
-
-static idxint totCgIts;
-static timer linsysTimer;
-static pfloat totalSolveTime;
+/* with CG_ADAPTIVE, CG stops once it has reduced the residual of the warm start by this factor */
+#define CG_ADAPT_REDUCTION 0.1
+/* with MIXED_PRECISION, solves whose relative CG tolerance is at least this use the single precision A */
+#define MIXED_TOL 1e-6
+/* columns per block of the block Jacobi preconditioner */
+#define PRECOND_BLOCK 16
+/* the incomplete Cholesky is not formed if RHO_X * I + A'A has more than this times nnz(A) + n nonzeros */
+#define IC_MAX_FILL 20
+/* relative diagonal shifts tried, 1e-3 growing tenfold, when the incomplete factorization breaks down */
+#define IC_MAX_SHIFTS 6
 
 char * getLinSysMethod(Data * d, Priv * p) {
-	char * str = scs_malloc(sizeof(char) * 128);
-	sprintf(str, "sparse-indirect, nnz in A = %li, CG tol ~ 1/iter^(%2.2f)", (long ) d->A->p[d->n], d->CG_RATE);
+	char * str = scs_malloc(sizeof(char) * 192);
+	idxint len;
+	if (d->CG_ADAPTIVE) {
+		len = sprintf(str, "sparse-indirect, nnz in A = %li, CG tol ~ %.1f * warm start residual", (long ) d->A->p[d->n],
+				CG_ADAPT_REDUCTION);
+	} else {
+		len = sprintf(str, "sparse-indirect, nnz in A = %li, CG tol ~ 1/iter^(%2.2f)", (long ) d->A->p[d->n],
+				d->CG_RATE);
+	}
+	if (d->CG_MAX_ITERS > 0) {
+		len += sprintf(str + len, ", at most %li CG iterations", (long) d->CG_MAX_ITERS);
+	}
+	if (d->LOW_MEMORY) {
+		sprintf(str + len, ", A' not stored");
+	} else {
+		sprintf(str + len, "%s%s", d->MIXED_PRECISION && sizeof(pfloat) > sizeof(float) ? ", mixed precision" : "",
+				d->CG_PRECOND == 1 ? ", block Jacobi" : (d->CG_PRECOND == 2 ? ", incomplete Cholesky" : ""));
+	}
 	return str;
 }
 
 char * getLinSysSummary(Priv * p, Info * info) {
-	char * str = scs_malloc(sizeof(char) * 128);
-	sprintf(str, "\tLin-sys: avg # CG iterations: %2.2f, avg solve time: %1.2es\n",
-			(pfloat ) totCgIts / (info->iter + 1), totalSolveTime / (info->iter + 1) / 1e3);
-	totCgIts = 0;
-	totalSolveTime = 0;
+	char * str = scs_malloc(sizeof(char) * 192);
+	idxint len = sprintf(str, "\tLin-sys: avg # CG iterations: %2.2f, avg solve time: %1.2es\n",
+			(pfloat ) info->linSysIters / (info->iter + 1), p->totalSolveTime / (info->iter + 1) / 1e3);
+	if (p->AtxF) {
+		len += sprintf(str + len, "\tLin-sys: single precision A in the first %li solves\n", (long) p->totFloatSolves);
+	}
+	if (p->precond == 2) {
+		sprintf(str + len, "\tLin-sys: nnz in incomplete Cholesky factor: %li\n", (long) p->nnzL);
+	}
 	return str;
 }
 
-/* M = inv ( diag ( RHO_X * I + A'A ) ) */
-void getPreconditioner(Data *d, Priv *p) {
-	idxint i;
-	pfloat * M = p->M;
+/* M = inv ( diag ( RHO_X * I + A'A ) ), from the normalized A' so must follow transposeA, or from A without it */
+static void getDiagPreconditioner(Data *d, Priv *p) {
+	idxint i, j;
+	pfloat * M = p->M, a;
+	pfloat * Atx = p->Atx;
+	rowidx * Ati = p->Ati;
 	AMatrix * A = d->A;
+	const AScaling * s = &(p->As);
 
 #ifdef EXTRAVERBOSE
 	scs_printf("getting pre-conditioner\n");
 #endif
 
+	memset(M, 0, d->n * sizeof(pfloat));
+	if (Atx) {
+		for (i = 0; i < p->Atp[d->m]; ++i) {
+			M[Ati[i]] += Atx[i] * Atx[i];
+		}
+	} else {
+		for (j = 0; j < d->n; ++j) {
+			for (i = A->p[j]; i < A->p[j + 1]; ++i) {
+				a = s->D ? A->x[i] * (s->scale / (s->D[A->i[i]] * s->E[j])) : A->x[i];
+				M[j] += a * a;
+			}
+		}
+	}
 	for (i = 0; i < d->n; ++i) {
-		M[i] = 1 / (d->RHO_X + calcNormSq(&(A->x[A->p[i]]), A->p[i + 1] - A->p[i]));
+		M[i] = 1 / (d->RHO_X + M[i]);
 		/* M[i] = 1; */
 	}
 
@@ -44,49 +86,290 @@ void getPreconditioner(Data *d, Priv *p) {
 
 }
 
-static void transpose(Data * d, Priv * p) {
-	idxint * Ci = p->Ati;
-	idxint * Cp = p->Atp;
-	pfloat * Cx = p->Atx;
-	idxint m = d->m;
-	idxint n = d->n;
+/* Cholesky factors of the diagonal blocks of RHO_X * I + A'A, from the normalized A', returns -1 on failure */
+static idxint getBlockJacobi(Data * d, Priv * p) {
+	idxint i, j, k, b, c, q, q2, B = PRECOND_BLOCK, nb = (d->n + B - 1) / B;
+	pfloat * G, s;
+	if (!p->Bj && !(p->Bj = scs_malloc(nb * B * B * sizeof(pfloat)))) {
+		return -1;
+	}
+	/* block b holds columns [b * B, (b + 1) * B), dense column major, lower triangle used */
+	memset(p->Bj, 0, nb * B * B * sizeof(pfloat));
+	for (j = 0; j < d->n; ++j) {
+		p->Bj[(j / B) * B * B + (j % B) * (B + 1)] = d->RHO_X;
+	}
+	/* the entries of each row of A' are sorted, so those falling in one block are consecutive */
+	for (i = 0; i < d->m; ++i) {
+		for (q = p->Atp[i]; q < p->Atp[i + 1]; ++q) {
+			j = p->Ati[q];
+			b = j / B;
+			G = &(p->Bj[b * B * B + (j % B) * B]);
+			for (q2 = q; q2 < p->Atp[i + 1] && p->Ati[q2] / B == b; ++q2) {
+				G[p->Ati[q2] % B] += p->Atx[q] * p->Atx[q2];
+			}
+		}
+	}
+	for (b = 0; b < nb; ++b) {
+		G = &(p->Bj[b * B * B]);
+		c = MIN(B, d->n - b * B);
+		for (k = 0; k < c; ++k) {
+			s = G[k * B + k];
+			for (j = 0; j < k; ++j) {
+				s -= G[j * B + k] * G[j * B + k];
+			}
+			if (s <= 0) {
+				return -1;
+			}
+			G[k * B + k] = s = SQRTF(s);
+			for (i = k + 1; i < c; ++i) {
+				for (j = 0; j < k; ++j) {
+					G[k * B + i] -= G[j * B + i] * G[j * B + k];
+				}
+				G[k * B + i] /= s;
+			}
+		}
+	}
+	return 0;
+}
 
-	idxint * Ap = d->A->p;
-	idxint * Ai = d->A->i;
-	pfloat * Ax = d->A->x;
+/* z = inv(L L') r for the block Jacobi factors */
+static void solveBlockJacobi(const Priv * p, idxint n, pfloat * z, const pfloat * r) {
+	idxint b, i, k, c, B = PRECOND_BLOCK;
+	const pfloat * G;
+	pfloat * zb;
+	memcpy(z, r, n * sizeof(pfloat));
+	for (b = 0; b * B < n; ++b) {
+		G = &(p->Bj[b * B * B]);
+		zb = &(z[b * B]);
+		c = MIN(B, n - b * B);
+		for (k = 0; k < c; ++k) {
+			zb[k] /= G[k * B + k];
+			for (i = k + 1; i < c; ++i) {
+				zb[i] -= G[k * B + i] * zb[k];
+			}
+		}
+		for (k = c - 1; k >= 0; --k) {
+			for (i = k + 1; i < c; ++i) {
+				zb[k] -= G[k * B + i] * zb[i];
+			}
+			zb[k] /= G[k * B + k];
+		}
+	}
+}
 
-	idxint i, j, q, *z, c1, c2;
-#ifdef EXTRAVERBOSE
-	timer transposeTimer;
-	scs_printf("transposing A\n");
-	tic(&transposeTimer);
-#endif
+static int compareIdx(const void * a, const void * b) {
+	idxint ia = *(const idxint *) a, ib = *(const idxint *) b;
+	return ia < ib ? -1 : (ia > ib ? 1 : 0);
+}
 
-	z = scs_calloc(m, sizeof(idxint));
-	for (i = 0; i < Ap[n]; i++)
-		z[Ai[i]]++; /* row counts */
-	cs_cumsum(Cp, z, m); /* row pointers */
+/* forms the lower triangle of RHO_X * I + A'A in Lp, Li, Lx with sorted columns (diagonal first), returns -1 on
+ * failure or if it has more than IC_MAX_FILL * (nnz(A) + n) nonzeros */
+static idxint formGram(Data * d, Priv * p) {
+	AMatrix * A = d->A;
+	const AScaling * s = &(p->As);
+	idxint i, j, q, t, cnt, n = d->n, nz = 0, cap = A->p[n] + n, maxNnz = IC_MAX_FILL * (A->p[n] + n);
+	idxint * mark = scs_malloc(n * sizeof(idxint)), *list = scs_malloc(n * sizeof(idxint));
+	pfloat * w = scs_malloc(n * sizeof(pfloat)), arj, *x;
+	rowidx * ri;
+	p->Lp = scs_malloc((n + 1) * sizeof(idxint));
+	p->Li = scs_malloc(cap * sizeof(rowidx));
+	p->Lx = scs_malloc(cap * sizeof(pfloat));
+	if (!mark || !list || !w || !p->Lp || !p->Li || !p->Lx) {
+		nz = -1;
+		goto done;
+	}
+	for (j = 0; j < n; ++j) {
+		mark[j] = -1;
+	}
+	/* column j is the sum over the rows r of A with an entry in column j of A(r,j) * A(r,:)' */
+	for (j = 0; j < n; ++j) {
+		p->Lp[j] = nz;
+		list[0] = j;
+		mark[j] = j;
+		w[j] = d->RHO_X;
+		cnt = 1;
+		for (q = A->p[j]; q < A->p[j + 1]; ++q) {
+			arj = s->D ? A->x[q] * (s->scale / (s->D[A->i[q]] * s->E[j])) : A->x[q];
+			for (t = p->Atp[A->i[q] + 1] - 1; t >= p->Atp[A->i[q]] && p->Ati[t] >= j; --t) {
+				i = p->Ati[t];
+				if (mark[i] != j) {
+					mark[i] = j;
+					w[i] = 0;
+					list[cnt++] = i;
+				}
+				w[i] += arj * p->Atx[t];
+			}
+		}
+		qsort(&(list[1]), cnt - 1, sizeof(idxint), compareIdx);
+		if (nz + cnt > cap) {
+			while (nz + cnt > cap) {
+				cap *= 2;
+			}
+			if (nz + cnt > maxNnz) {
+				nz = -1;
+				goto done;
+			}
+			ri = scs_malloc(cap * sizeof(rowidx));
+			x = scs_malloc(cap * sizeof(pfloat));
+			if (!ri || !x) {
+				if (ri)
+					scs_free(ri);
+				if (x)
+					scs_free(x);
+				nz = -1;
+				goto done;
+			}
+			memcpy(ri, p->Li, nz * sizeof(rowidx));
+			memcpy(x, p->Lx, nz * sizeof(pfloat));
+			scs_free(p->Li);
+			scs_free(p->Lx);
+			p->Li = ri;
+			p->Lx = x;
+		}
+		for (t = 0; t < cnt; ++t) {
+			p->Li[nz] = (rowidx) list[t];
+			p->Lx[nz++] = w[list[t]];
+		}
+	}
+	p->Lp[n] = nz;
+done:
+	if (mark)
+		scs_free(mark);
+	if (list)
+		scs_free(list);
+	if (w)
+		scs_free(w);
+	return nz < 0 ? -1 : 0;
+}
 
-	for (j = 0; j < n; j++) {
-		c1 = Ap[j];
-		c2 = Ap[j + 1];
-		for (i = c1; i < c2; i++) {
-			q = z[Ai[i]];
-			Ci[q] = j; /* place A(i,j) as entry C(j,i) */
-			Cx[q] = Ax[i];
-			z[Ai[i]]++;
+/* incomplete Cholesky, no fill, of the matrix in Lx in place, pos is workspace of size n set to -1,
+ * returns -1 on breakdown */
+static idxint factorIC(idxint n, const idxint * Lp, const rowidx * Li, pfloat * Lx, idxint * pos) {
+	idxint j, k, q, qi, qj;
+	pfloat dk, ljk;
+	for (k = 0; k < n; ++k) {
+		dk = Lx[Lp[k]];
+		if (dk <= 0 || dk != dk) {
+			return -1;
+		}
+		Lx[Lp[k]] = dk = SQRTF(dk);
+		for (q = Lp[k] + 1; q < Lp[k + 1]; ++q) {
+			Lx[q] /= dk;
+		}
+		/* L(i,j) -= L(i,k) * L(j,k) for i >= j > k where (i,j) is in the pattern */
+		for (qj = Lp[k] + 1; qj < Lp[k + 1]; ++qj) {
+			j = Li[qj];
+			ljk = Lx[qj];
+			for (q = Lp[j]; q < Lp[j + 1]; ++q) {
+				pos[Li[q]] = q;
+			}
+			for (qi = qj; qi < Lp[k + 1]; ++qi) {
+				if (pos[Li[qi]] >= 0) {
+					Lx[pos[Li[qi]]] -= Lx[qi] * ljk;
+				}
+			}
+			for (q = Lp[j]; q < Lp[j + 1]; ++q) {
+				pos[Li[q]] = -1;
+			}
 		}
 	}
-	scs_free(z);
+	return 0;
+}
 
-#ifdef EXTRAVERBOSE
-	scs_printf("finished transposing A, time: %1.2es\n", tocq(&transposeTimer) / 1e3);
-#endif
+/* incomplete Cholesky factor of RHO_X * I + A'A, shifting its diagonal if the factorization breaks down,
+ * returns -1 on failure */
+static idxint getIncompleteCholesky(Data * d, Priv * p) {
+	idxint j, k, status = -1, n = d->n;
+	idxint * pos;
+	pfloat * G, shift = 0;
+	if (p->Lp) {
+		scs_free(p->Lp);
+		scs_free(p->Li);
+		scs_free(p->Lx);
+		p->Lp = NULL;
+		p->Li = NULL;
+		p->Lx = NULL;
+	}
+	if (formGram(d, p) < 0) {
+		return -1;
+	}
+	pos = scs_malloc(n * sizeof(idxint));
+	G = scs_malloc(p->Lp[n] * sizeof(pfloat));
+	if (pos && G) {
+		memcpy(G, p->Lx, p->Lp[n] * sizeof(pfloat));
+		for (j = 0; j < n; ++j) {
+			pos[j] = -1;
+		}
+		for (k = 0; k <= IC_MAX_SHIFTS && status < 0; ++k) {
+			if (k > 0) {
+				shift = shift > 0 ? 10 * shift : 1e-3;
+				memcpy(p->Lx, G, p->Lp[n] * sizeof(pfloat));
+				for (j = 0; j < n; ++j) {
+					p->Lx[p->Lp[j]] *= 1 + shift;
+				}
+				for (j = 0; j < n; ++j) {
+					pos[j] = -1;
+				}
+			}
+			status = factorIC(n, p->Lp, p->Li, p->Lx, pos);
+		}
+	}
+	if (pos)
+		scs_free(pos);
+	if (G)
+		scs_free(G);
+	p->nnzL = p->Lp[n];
+	return status;
+}
 
+/* z = inv(L L') r for the incomplete Cholesky factor */
+static void solveIncompleteCholesky(const Priv * p, idxint n, pfloat * z, const pfloat * r) {
+	idxint j, q;
+	const idxint * Lp = p->Lp;
+	const rowidx * Li = p->Li;
+	const pfloat * Lx = p->Lx;
+	pfloat zj;
+	memcpy(z, r, n * sizeof(pfloat));
+	for (j = 0; j < n; ++j) {
+		z[j] /= Lx[Lp[j]];
+		for (q = Lp[j] + 1; q < Lp[j + 1]; ++q) {
+			z[Li[q]] -= Lx[q] * z[j];
+		}
+	}
+	for (j = n - 1; j >= 0; --j) {
+		zj = z[j];
+		for (q = Lp[j] + 1; q < Lp[j + 1]; ++q) {
+			zj -= Lx[q] * z[Li[q]];
+		}
+		z[j] = zj / Lx[Lp[j]];
+	}
+}
+
+/* the diagonal preconditioner, and the one selected by d->CG_PRECOND for the single solves, falls back to the
+ * diagonal if that cannot be formed */
+void getPreconditioner(Data *d, Priv *p) {
+	timer precondTimer;
+	tic(&precondTimer);
+	getDiagPreconditioner(d, p);
+	/* the others are formed from the rows of A, in A', which LOW_MEMORY does not keep */
+	p->precond = p->Atx ? d->CG_PRECOND : 0;
+	if (d->CG_PRECOND && !p->precond && d->VERBOSE) {
+		scs_printf("%s preconditioner needs A' but LOW_MEMORY is set, using the diagonal\n",
+				d->CG_PRECOND == 1 ? "block Jacobi" : "incomplete Cholesky");
+	}
+	if ((p->precond == 1 && getBlockJacobi(d, p) < 0) || (p->precond == 2 && getIncompleteCholesky(d, p) < 0)) {
+		if (d->VERBOSE) {
+			scs_printf("%s preconditioner could not be formed, using the diagonal\n",
+					p->precond == 1 ? "block Jacobi" : "incomplete Cholesky");
+		}
+		p->precond = 0;
+	}
+	p->factorTime = tocq(&precondTimer);
 }
 
 void freePriv(Priv * p) {
 	if (p) {
+		freeAScaling(&(p->As));
 		if (p->p)
 			scs_free(p->p);
 		if (p->r)
@@ -101,26 +384,139 @@ void freePriv(Priv * p) {
 			scs_free(p->Atx);
 		if (p->Atp)
 			scs_free(p->Atp);
+		if (p->AtxF)
+			scs_free(p->AtxF);
+		if (p->AxF)
+			scs_free(p->AxF);
 		if (p->z)
 			scs_free(p->z);
 		if (p->M)
 			scs_free(p->M);
+		if (p->Bj)
+			scs_free(p->Bj);
+		if (p->Lx)
+			scs_free(p->Lx);
+		if (p->Li)
+			scs_free(p->Li);
+		if (p->Lp)
+			scs_free(p->Lp);
+		if (p->bWork)
+			scs_free(p->bWork);
+		if (p->bAct)
+			scs_free(p->bAct);
 		scs_free(p);
 	}
 }
 
-/* solves (I+A'A)x = b, s warm start, solution stored in b */
-/*y = (RHO_X * I + A'A)x */
-static void matVec(Data * d, Priv * p, const pfloat * x, pfloat * y) {
+#ifdef OPENMP
+/* y += A' * x for A in column compressed format with single precision values, see _accumByAtrans */
+static void _accumByAtransF(idxint n, const float * Ax, const rowidx * Ai, const idxint * Ap, const pfloat *x,
+		pfloat *y) {
+	idxint p, j;
+	idxint c1, c2;
+	pfloat yj;
+#pragma omp parallel for private(p,c1,c2,yj)
+	for (j = 0; j < n; j++) {
+		yj = y[j];
+		c1 = Ap[j];
+		c2 = Ap[j + 1];
+		for (p = c1; p < c2; p++) {
+			yj += Ax[p] * x[Ai[p]];
+		}
+		y[j] = yj;
+	}
+}
+
+/* y += A' * x using the single precision values Ax of the normalized A, in the order of d->A */
+static void accumByAtransF(Data * d, const float * Ax, const pfloat *x, pfloat *y) {
+	idxint p, j;
+	idxint c1, c2;
+	pfloat yj;
+	const idxint * Ai = d->A->i, *Ap = d->A->p;
+#pragma omp parallel for private(p,c1,c2,yj)
+	for (j = 0; j < d->n; j++) {
+		yj = y[j];
+		c1 = Ap[j];
+		c2 = Ap[j + 1];
+		for (p = c1; p < c2; p++) {
+			yj += Ax[p] * x[Ai[p]];
+		}
+		y[j] = yj;
+	}
+}
+#endif
+
+/* matVec without A' (LOW_MEMORY): tmp = Ax and then y = A' * tmp, two passes over the columns of A */
+static pfloat matVecNoTrans(Data * d, Priv * p, const pfloat * x, pfloat * y) {
+	pfloat * tmp = p->tmp;
+	memset(tmp, 0, d->m * sizeof(pfloat));
+	accumByScaledA(d, &(p->As), x, tmp);
+	memset(y, 0, d->n * sizeof(pfloat));
+	accumByScaledAtrans(d, &(p->As), tmp, y);
+	addScaledArray(y, x, d->n, d->RHO_X);
+	return d->RHO_X * calcNormSq(x, d->n) + calcNormSq(tmp, d->m);
+}
+
+/* matVec with the stored A' */
+static pfloat matVecAt(Data * d, Priv * p, const pfloat * x, pfloat * y) {
+#ifdef OPENMP
+	/* scattering into y from many threads would race, use two parallel passes via tmp = Ax */
 	pfloat * tmp = p->tmp;
 	memset(tmp, 0, d->m * sizeof(pfloat));
-	accumByA(d, p, x, tmp);
+	if (p->useFloat) {
+		_accumByAtransF(d->m, p->AtxF, p->Ati, p->Atp, x, tmp);
+	} else {
+		accumByA(d, p, x, tmp);
+	}
 	memset(y, 0, d->n * sizeof(pfloat));
-	accumByAtrans(d, p, tmp, y);
+	if (p->useFloat) {
+		accumByAtransF(d, p->AxF, tmp, y);
+	} else {
+		accumByAtrans(d, p, tmp, y);
+	}
 	addScaledArray(y, x, d->n, d->RHO_X);
+	return d->RHO_X * calcNormSq(x, d->n) + calcNormSq(tmp, d->m);
+#else
+	/* single pass over the rows a_i of A (stored as A'), y += a_i * (a_i'x),
+	 A is streamed once and no m-length temporary is needed */
+	idxint i, j, c1, c2;
+	pfloat aix, xTy = 0;
+	pfloat * Atx = p->Atx;
+	float * AtxF = p->AtxF;
+	rowidx * Ati = p->Ati;
+	idxint * Atp = p->Atp;
+	setAsScaledArray(y, x, d->RHO_X, d->n);
+	for (i = 0; i < d->m; ++i) {
+		c1 = Atp[i];
+		c2 = Atp[i + 1];
+		aix = 0;
+		if (p->useFloat) {
+			for (j = c1; j < c2; ++j) {
+				aix += AtxF[j] * x[Ati[j]];
+			}
+			for (j = c1; j < c2; ++j) {
+				y[Ati[j]] += AtxF[j] * aix;
+			}
+		} else {
+			for (j = c1; j < c2; ++j) {
+				aix += Atx[j] * x[Ati[j]];
+			}
+			for (j = c1; j < c2; ++j) {
+				y[Ati[j]] += Atx[j] * aix;
+			}
+		}
+		xTy += aix * aix;
+	}
+	return xTy + d->RHO_X * calcNormSq(x, d->n);
+#endif
+}
+
+/* y = (RHO_X * I + A'A)x, returns x'y = RHO_X * x'x + |Ax|^2 */
+static pfloat matVec(Data * d, Priv * p, const pfloat * x, pfloat * y) {
+	return p->Atx ? matVecAt(d, p, x, y) : matVecNoTrans(d, p, x, y);
 }
 
-void _accumByAtrans(idxint n, pfloat * Ax, idxint * Ai, idxint * Ap, const pfloat *x, pfloat *y) {
+void _accumByAtrans(idxint n, pfloat * Ax, rowidx * Ai, idxint * Ap, const pfloat *x, pfloat *y) {
 	/* y  = A'*x
 	 A in column compressed format
 	 parallelizes over columns (rows of A')
@@ -143,111 +539,407 @@ void _accumByAtrans(idxint n, pfloat * Ax, idxint * Ai, idxint * Ap, const pfloa
 }
 
 void accumByAtrans(Data * d, Priv * p, const pfloat *x, pfloat *y) {
-	AMatrix * A = d->A;
-	_accumByAtrans(d->n, A->x, A->i, A->p, x, y);
+	accumByScaledAtrans(d, &(p->As), x, y);
 }
 void accumByA(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	if (!p->Atx) {
+		accumByScaledA(d, &(p->As), x, y);
+		return;
+	}
+	/* the stored A' is already normalized */
 	_accumByAtrans(d->m, p->Atx, p->Ati, p->Atp, x, y);
 }
-static void applyPreConditioner(pfloat * M, pfloat * z, pfloat * r, idxint n, pfloat *ipzr) {
+/* z = M r for the preconditioner p->precond, ipzr = z'r */
+static void applyPreConditioner(const Priv * p, pfloat * z, const pfloat * r, idxint n, pfloat *ipzr) {
 	idxint i;
+	if (p->precond == 1) {
+		solveBlockJacobi(p, n, z, r);
+	} else if (p->precond == 2) {
+		solveIncompleteCholesky(p, n, z, r);
+	}
 	*ipzr = 0;
 	for (i = 0; i < n; ++i) {
-		z[i] = r[i] * M[i];
+		if (p->precond == 0)
+			z[i] = r[i] * p->M[i];
 		*ipzr += z[i] * r[i];
 	}
 }
 
-Priv * initPriv(Data * d) {
+/* rounds the normalized values of A' (and A) to the single precision copies */
+static void setFloatValues(Data * d, Priv * p) {
+	idxint i;
+#ifdef OPENMP
+	idxint j;
 	AMatrix * A = d->A;
-	Priv * p = scs_calloc(1, sizeof(Priv));
-	p->p = scs_malloc((d->n) * sizeof(pfloat));
-	p->r = scs_malloc((d->n) * sizeof(pfloat));
-	p->Gp = scs_malloc((d->n) * sizeof(pfloat));
-	p->tmp = scs_malloc((d->m) * sizeof(pfloat));
+	const AScaling * s = &(p->As);
+#endif
+	for (i = 0; i < p->Atp[d->m]; ++i) {
+		p->AtxF[i] = (float) p->Atx[i];
+	}
+#ifdef OPENMP
+	for (j = 0; j < d->n; ++j) {
+		for (i = A->p[j]; i < A->p[j + 1]; ++i) {
+			p->AxF[i] = (float) (s->D ? A->x[i] * (s->scale / (s->D[A->i[i]] * s->E[j])) : A->x[i]);
+		}
+	}
+#endif
+}
+
+Priv * initPriv(Data * d, const pfloat * D, const pfloat * E) {
+	AMatrix * A = d->A;
+	Priv * p;
+	/* the two-pass matVec needs the m-length temporary */
+	idxint twoPass = d->LOW_MEMORY;
+#ifdef OPENMP
+	twoPass = 1;
+#endif
+	/* with ARENA, room for the vectors and A' in one block */
+	scs_wreserve(sizeof(Priv) + (6 * d->n + 2 * d->m) * sizeof(pfloat)
+			+ (d->LOW_MEMORY ? 0 : (d->m + 1) * sizeof(idxint) + A->p[d->n] * (sizeof(rowidx) + sizeof(pfloat))));
+	p = scs_wcalloc(1, sizeof(Priv));
+	p->p = scs_wmalloc((d->n) * sizeof(pfloat));
+	p->r = scs_wmalloc((d->n) * sizeof(pfloat));
+	p->Gp = scs_wmalloc((d->n) * sizeof(pfloat));
+	if (twoPass) {
+		p->tmp = scs_wmalloc((d->m) * sizeof(pfloat));
+	}
 
 	/* preconditioner memory */
-	p->z = scs_malloc((d->n) * sizeof(pfloat));
-	p->M = scs_malloc((d->n) * sizeof(pfloat));
+	p->z = scs_wmalloc((d->n) * sizeof(pfloat));
+	p->M = scs_wmalloc((d->n) * sizeof(pfloat));
 
-	p->Ati = scs_malloc((A->p[d->n]) * sizeof(idxint));
-	p->Atp = scs_malloc((d->m + 1) * sizeof(idxint));
-	p->Atx = scs_malloc((A->p[d->n]) * sizeof(pfloat));
-	transpose(d, p);
-	getPreconditioner(d, p);
-	totalSolveTime = 0;
-	totCgIts = 0;
-	if (!p->p || !p->r || !p->Gp || !p->tmp || !p->Ati || !p->Atp || !p->Atx) {
+	if (!d->LOW_MEMORY) {
+		p->Ati = scs_wmalloc((A->p[d->n]) * sizeof(rowidx));
+		p->Atp = scs_wmalloc((d->m + 1) * sizeof(idxint));
+		p->Atx = scs_wmalloc((A->p[d->n]) * sizeof(pfloat));
+	}
+	if (!p->p || !p->r || !p->Gp || !p->z || !p->M || (twoPass && !p->tmp)
+			|| (!d->LOW_MEMORY && (!p->Ati || !p->Atp || !p->Atx)) || initAScaling(d, &(p->As), D, E) < 0) {
 		freePriv(p);
 		return NULL;
 	}
+	/* nothing to gain from a single precision copy if pfloat is float, it is of A' */
+	if (d->MIXED_PRECISION && !d->LOW_MEMORY && sizeof(pfloat) > sizeof(float)) {
+		p->AtxF = scs_malloc((A->p[d->n]) * sizeof(float));
+#ifdef OPENMP
+		p->AxF = scs_malloc((A->p[d->n]) * sizeof(float));
+		if (!p->AxF) {
+			freePriv(p);
+			return NULL;
+		}
+#endif
+		if (!p->AtxF) {
+			freePriv(p);
+			return NULL;
+		}
+	}
+	if (p->Atx) {
+		transposeA(d, &(p->As), p->Atx, p->Ati, p->Atp);
+	}
+	if (p->AtxF) {
+		setFloatValues(d, p);
+	}
+	getPreconditioner(d, p);
+	p->totalSolveTime = 0;
+	p->totCgIts = 0;
+	p->totFloatSolves = 0;
+	p->res = NAN;
 	return p;
 }
 
-static idxint pcg(Data *d, Priv * pr, const pfloat * s, pfloat * b, idxint max_its, pfloat tol) {
+void setLinSysResidual(Priv * p, pfloat res) {
+	p->res = res;
+}
+
+idxint getLinSysIters(Priv * p) {
+	return p->totCgIts;
+}
+
+void getLinSysProfile(Priv * p, Profile * prof) {
+	prof->kktTime = 0;
+	prof->orderTime = 0;
+	prof->factorTime = p->factorTime;
+}
+
+idxint updateLinSys(Data * d, Priv * p) {
+	if (p->Atx) {
+		transposeA(d, &(p->As), p->Atx, p->Ati, p->Atp);
+	}
+	if (p->AtxF) {
+		setFloatValues(d, p);
+	}
+	getPreconditioner(d, p);
+	return 0;
+}
+
+/* with reduction > 0, tol is lowered to reduction times the norm of the initial residual b - G * s */
+static idxint pcg(Data *d, Priv * pr, const pfloat * s, pfloat * b, idxint max_its, pfloat tol, pfloat reduction) {
 	idxint i, n = d->n;
-	pfloat ipzr, ipzrOld, alpha;
+	pfloat ipzr, ipzrOld, alpha, nmr;
 	pfloat *p = pr->p; /* cg direction */
 	pfloat *Gp = pr->Gp; /* updated CG direction */
 	pfloat *r = pr->r; /* cg residual */
 	pfloat *z = pr->z; /* for preconditioning */
-	pfloat *M = pr->M; /* inverse diagonal preconditioner */
 
 	if (s == NULL) {
 		memcpy(r, b, n * sizeof(pfloat));
 		memset(b, 0, n * sizeof(pfloat));
 	} else {
 		matVec(d, pr, s, r);
-		addScaledArray(r, b, n, -1);
-		scaleArray(r, -1, n);
+		scaleAndAddArray(r, -1, b, n); /* r = b - G * s */
 		memcpy(b, s, n * sizeof(pfloat));
 	}
-	applyPreConditioner(M, z, r, n, &ipzr);
+	if (reduction > 0) {
+		tol = MAX(MIN(tol, reduction * calcNorm(r, n)), CG_BEST_TOL);
+	}
+	applyPreConditioner(pr, z, r, n, &ipzr);
 	memcpy(p, z, n * sizeof(pfloat));
 
 	for (i = 0; i < max_its; ++i) {
-		matVec(d, pr, p, Gp);
-
-		alpha = ipzr / innerProd(p, Gp, n);
+		alpha = ipzr / matVec(d, pr, p, Gp); /* Gp = G * p, returns p'Gp */
 		addScaledArray(b, p, n, alpha);
-		addScaledArray(r, Gp, n, -alpha);
+		nmr = SQRTF(addScaledArrayNormSq(r, Gp, n, -alpha));
 
-		if (calcNorm(r, n) < tol) {
+		if (nmr < tol) {
             #ifdef EXTRAVERBOSE
-            scs_printf("tol: %.4e, resid: %.4e, iters: %li\n", tol, calcNorm(r, n), (long) i+1);
+            scs_printf("tol: %.4e, resid: %.4e, iters: %li\n", tol, nmr, (long) i+1);
             #endif
 			return i + 1;
 		}
 		ipzrOld = ipzr;
-		applyPreConditioner(M, z, r, n, &ipzr);
+		applyPreConditioner(pr, z, r, n, &ipzr);
 
-		scaleArray(p, ipzr / ipzrOld, n);
-		addScaledArray(p, z, n, 1);
+		scaleAndAddArray(p, ipzr / ipzrOld, z, n);
 	}
 	return i;
 }
 
+/* relative CG tolerance of the solve at ADMM iteration iter >= 0 */
+static pfloat cgRelTol(Data * d, Priv * p, idxint iter) {
+	if (!d->CG_ADAPTIVE) {
+		return CG_MIN_TOL / POWF((pfloat) iter + 1, d->CG_RATE);
+	}
+	/* only a bound, pcg stops earlier once the residual of the warm start is reduced by CG_ADAPT_REDUCTION */
+	return p->res == p->res ? MIN(MAX(p->res, CG_BEST_TOL), 1) : 1;
+}
+
 idxint solveLinSys(Data *d, Priv * p, pfloat * b, const pfloat * s, idxint iter) {
 	idxint cgIts;
-	pfloat cgTol = calcNorm(b, d->n) * (iter < 0 ? CG_BEST_TOL : CG_MIN_TOL / POWF((pfloat) iter + 1, d->CG_RATE));
-
+	timer linsysTimer;
+	pfloat relTol = iter < 0 ? CG_BEST_TOL : cgRelTol(d, p, iter);
+	pfloat cgTol = calcNorm(b, d->n) * relTol;
+	/* the accurate solves (iter < 0) are never capped */
+	idxint maxIts = iter >= 0 && d->CG_MAX_ITERS > 0 ? MIN(d->CG_MAX_ITERS, d->n) : d->n;
+
+	if (iter == 0) {
+		/* the first step of a solve, the counters of the summary start over */
+		p->totalSolveTime = 0;
+		p->totFloatSolves = 0;
+	}
 	tic(&linsysTimer);
+	/* the early, loose solves can use A rounded to single precision, halving the traffic for its values */
+	p->useFloat = p->AtxF && relTol >= MIXED_TOL;
 	/* solves Mx = b, for x but stores result in b */
 	/* s contains warm-start (if available) */
 	accumByAtrans(d, p, &(b[d->n]), b);
 	/* solves (I+A'A)x = b, s warm start, solution stored in b */
-	cgIts = pcg(d, p, s, b, d->n, MAX(cgTol, CG_BEST_TOL));
+	cgIts = pcg(d, p, s, b, maxIts, MAX(cgTol, CG_BEST_TOL),
+			iter >= 0 && d->CG_ADAPTIVE ? CG_ADAPT_REDUCTION : 0);
 	scaleArray(&(b[d->n]), -1, d->m);
 	accumByA(d, p, b, &(b[d->n]));
 
 	if (iter >= 0) {
-		totCgIts += cgIts;
+		p->totCgIts += cgIts;
+		p->totFloatSolves += p->useFloat;
 	}
+	p->useFloat = 0;
 
-	totalSolveTime += tocq(&linsysTimer);
+	p->totalSolveTime += tocq(&linsysTimer);
 #ifdef EXTRAVERBOSE
 	scs_printf("linsys solve time: %1.2es\n", tocq(&linsysTimer) / 1e3);
 #endif
 	return 0;
 }
 
+/* Y = (RHO_X * I + A'A)X for the active columns act of the n by K interleaved X, one pass over the
+ * rows of A (stored as A') for all of them, xTy[k] = x_k'y_k, aix is workspace of size K */
+static void matVecBatch(Data * d, Priv * p, idxint K, idxint nAct, const idxint * act, const pfloat * X, pfloat * Y,
+		pfloat * xTy, pfloat * aix) {
+	idxint i, j, a, c1, c2;
+	pfloat v;
+	const pfloat * Xr;
+	pfloat * Yr;
+	pfloat * Atx = p->Atx;
+	rowidx * Ati = p->Ati;
+	idxint * Atp = p->Atp;
+	if (!Atx) {
+		/* without A' (LOW_MEMORY) a column at a time, through p->p and p->Gp that the batched CG does not use */
+		for (a = 0; a < nAct; ++a) {
+			for (i = 0; i < d->n; ++i) {
+				p->p[i] = X[i * K + act[a]];
+			}
+			xTy[act[a]] = matVecNoTrans(d, p, p->p, p->Gp);
+			for (i = 0; i < d->n; ++i) {
+				Y[i * K + act[a]] = p->Gp[i];
+			}
+		}
+		return;
+	}
+	for (a = 0; a < nAct; ++a) {
+		xTy[act[a]] = 0;
+	}
+	for (i = 0; i < d->n; ++i) {
+		for (a = 0; a < nAct; ++a) {
+			v = X[i * K + act[a]];
+			Y[i * K + act[a]] = d->RHO_X * v;
+			xTy[act[a]] += d->RHO_X * v * v;
+		}
+	}
+	for (i = 0; i < d->m; ++i) {
+		c1 = Atp[i];
+		c2 = Atp[i + 1];
+		memset(aix, 0, nAct * sizeof(pfloat));
+		for (j = c1; j < c2; ++j) {
+			v = Atx[j];
+			Xr = &(X[Ati[j] * K]);
+			for (a = 0; a < nAct; ++a) {
+				aix[a] += v * Xr[act[a]];
+			}
+		}
+		for (j = c1; j < c2; ++j) {
+			v = Atx[j];
+			Yr = &(Y[Ati[j] * K]);
+			for (a = 0; a < nAct; ++a) {
+				Yr[act[a]] += v * aix[a];
+			}
+		}
+		for (a = 0; a < nAct; ++a) {
+			xTy[act[a]] += aix[a] * aix[a];
+		}
+	}
+}
+
+/* K preconditioned CGs in lockstep, each stops at its own tolerance (set in bWork by the caller),
+ * returns the number of batched steps */
+static idxint pcgBatch(Data *d, Priv * pr, idxint K, pfloat ** b, const pfloat ** s, idxint max_its) {
+	idxint i, j, k, a, nAct = K, n = d->n;
+	pfloat * X = pr->bWork, *R = &(X[n * K]), *P = &(R[n * K]), *Gp = &(P[n * K]), *Z = &(Gp[n * K]);
+	pfloat * ipzr = &(Z[n * K]), *pGp = &(ipzr[K]), *tol = &(pGp[K]), *nmr = &(tol[K]), *aix = &(nmr[K]);
+	pfloat * M = pr->M;
+	pfloat alpha, beta, ipzrOld;
+	idxint * act = pr->bAct;
+
+	for (k = 0; k < K; ++k) {
+		act[k] = k;
+		for (j = 0; j < n; ++j) {
+			X[j * K + k] = (s && s[k]) ? s[k][j] : 0;
+		}
+	}
+	/* R = B - G * S */
+	matVecBatch(d, pr, K, K, act, X, Gp, pGp, aix);
+	for (j = 0; j < n; ++j) {
+		for (k = 0; k < K; ++k) {
+			R[j * K + k] = b[k][j] - Gp[j * K + k];
+		}
+	}
+	memset(ipzr, 0, K * sizeof(pfloat));
+	for (j = 0; j < n; ++j) {
+		for (k = 0; k < K; ++k) {
+			P[j * K + k] = Z[j * K + k] = R[j * K + k] * M[j];
+			ipzr[k] += Z[j * K + k] * R[j * K + k];
+		}
+	}
+	for (i = 0; i < max_its && nAct > 0; ++i) {
+		matVecBatch(d, pr, K, nAct, act, P, Gp, pGp, aix);
+		for (a = 0; a < nAct; ++a) {
+			k = act[a];
+			pGp[k] = ipzr[k] / pGp[k]; /* alpha */
+			nmr[k] = 0;
+		}
+		for (j = 0; j < n; ++j) {
+			for (a = 0; a < nAct; ++a) {
+				k = act[a];
+				alpha = pGp[k];
+				X[j * K + k] += alpha * P[j * K + k];
+				R[j * K + k] -= alpha * Gp[j * K + k];
+				nmr[k] += R[j * K + k] * R[j * K + k];
+			}
+		}
+		/* drop the converged columns, the rest take a new direction */
+		for (a = 0, j = 0; a < nAct; ++a) {
+			k = act[a];
+			if (SQRTF(nmr[k]) >= tol[k])
+				act[j++] = k;
+		}
+		nAct = j;
+		for (a = 0; a < nAct; ++a) {
+			k = act[a];
+			pGp[k] = ipzr[k]; /* ipzrOld */
+			ipzr[k] = 0;
+		}
+		for (j = 0; j < n; ++j) {
+			for (a = 0; a < nAct; ++a) {
+				k = act[a];
+				Z[j * K + k] = R[j * K + k] * M[j];
+				ipzr[k] += Z[j * K + k] * R[j * K + k];
+			}
+		}
+		for (j = 0; j < n; ++j) {
+			for (a = 0; a < nAct; ++a) {
+				k = act[a];
+				ipzrOld = pGp[k];
+				beta = ipzr[k] / ipzrOld;
+				P[j * K + k] = Z[j * K + k] + beta * P[j * K + k];
+			}
+		}
+	}
+	for (k = 0; k < K; ++k) {
+		for (j = 0; j < n; ++j) {
+			b[k][j] = X[j * K + k];
+		}
+	}
+	return i;
+}
+
+idxint solveLinSysBatch(Data * d, Priv * p, idxint K, pfloat ** b, const pfloat ** s, idxint iter) {
+	idxint k, cgIts;
+	pfloat * tol;
+	timer linsysTimer;
+	if (iter == 0) {
+		/* the first step of a solve, the counters of the summary start over */
+		p->totalSolveTime = 0;
+		p->totFloatSolves = 0;
+	}
+	tic(&linsysTimer);
+	if (K > p->bCap) {
+		if (p->bWork)
+			scs_free(p->bWork);
+		if (p->bAct)
+			scs_free(p->bAct);
+		p->bWork = scs_malloc((5 * d->n + 5) * K * sizeof(pfloat));
+		p->bAct = scs_malloc(K * sizeof(idxint));
+		p->bCap = (p->bWork && p->bAct) ? K : 0;
+		if (!p->bCap)
+			return -1;
+	}
+	tol = &(p->bWork[5 * d->n * K + 2 * K]); /* as laid out in pcgBatch */
+	/* the residual hint belongs to one problem of the batch, so the tolerances keep the CG_RATE schedule */
+	for (k = 0; k < K; ++k) {
+		tol[k] = calcNorm(b[k], d->n) * (iter < 0 ? CG_BEST_TOL : CG_MIN_TOL / POWF((pfloat) iter + 1, d->CG_RATE));
+		tol[k] = MAX(tol[k], CG_BEST_TOL);
+		accumByAtrans(d, p, &(b[k][d->n]), b[k]);
+	}
+	cgIts = pcgBatch(d, p, K, b, s, iter >= 0 && d->CG_MAX_ITERS > 0 ? MIN(d->CG_MAX_ITERS, d->n) : d->n);
+	for (k = 0; k < K; ++k) {
+		scaleArray(&(b[k][d->n]), -1, d->m);
+		accumByA(d, p, b[k], &(b[k][d->n]));
+	}
+	if (iter >= 0) {
+		p->totCgIts += cgIts;
+	}
+	p->totalSolveTime += tocq(&linsysTimer);
+#ifdef EXTRAVERBOSE
+	scs_printf("batch linsys solve time: %1.2es, batched CG steps: %li\n", tocq(&linsysTimer) / 1e3, (long) cgIts);
+#endif
+	return 0;
+}
@@ -12,13 +12,36 @@ struct PRIVATE_DATA {
 	pfloat * p; /* cg iterate  */
 	pfloat * r; /* cg residual */
 	pfloat * Gp;
-	pfloat * tmp;
-	pfloat * Atx;
-	idxint * Ati;
+	pfloat * tmp; /* Ax in the two-pass matVec, with OPENMP or d->LOW_MEMORY */
+	AScaling As; /* normalization of A, the stored A' holds the normalized values */
+	pfloat * Atx; /* A', NULL with d->LOW_MEMORY, the products then use A */
+	rowidx * Ati;
 	idxint * Atp;
+	/* single precision copies of the normalized values of A' (and of A, for the parallel matVec), used by the
+	 loose early solves, only stored if d->MIXED_PRECISION */
+	float * AtxF;
+	float * AxF;
+	idxint useFloat; /* boolean, whether matVec uses the single precision values */
 	/* preconditioning */
 	pfloat * z;
-	pfloat * M;
+	pfloat * M; /* inverse diagonal of RHO_X * I + A'A, also used by the batched solves */
+	idxint precond; /* preconditioner of the single solves, d->CG_PRECOND or 0 if that could not be formed */
+	pfloat * Bj; /* block Jacobi: dense lower Cholesky factors of the PRECOND_BLOCK wide diagonal blocks */
+	/* incomplete Cholesky factor of RHO_X * I + A'A on the pattern of its lower triangle, column compressed */
+	pfloat * Lx;
+	rowidx * Li;
+	idxint * Lp;
+	idxint nnzL; /* nonzeros in the incomplete Cholesky factor */
+	pfloat res; /* ADMM residual of the last convergence check for CG_ADAPTIVE, NAN if not known */
+	/* batched solves, bCap interleaved n-vectors of each CG quantity and per column scalars */
+	pfloat * bWork;
+	idxint * bAct;
+	idxint bCap;
+	/* reporting */
+	idxint totCgIts;
+	idxint totFloatSolves;
+	pfloat totalSolveTime;
+	pfloat factorTime; /* forming the preconditioner, at the last initPriv or updateLinSys */
 };
 
 #endif
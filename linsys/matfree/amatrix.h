@@ -0,0 +1,16 @@
+#ifndef MATFREE_AMATRIX_H_GUARD
+#define MATFREE_AMATRIX_H_GUARD
+
+/* this struct defines the data matrix A for the matrix-free solver, A is only accessed through
+ * products supplied by the user, it is never formed */
+struct A_DATA_MATRIX {
+	/* y += A * x (x of size n, y of size m) and y += A' * x (x of size m, y of size n), x and y never overlap */
+	void (*accumA)(void * op, const pfloat * x, pfloat * y);
+	void (*accumAtrans)(void * op, const pfloat * x, pfloat * y);
+	void * op; /* user data passed to both products */
+	/* Euclidean norms of the columns of A, size n, used for the normalization and the CG preconditioner;
+	 * scs_update_A ignores its Ax argument, update op and colNorms before calling it */
+	pfloat * colNorms;
+};
+
+#endif
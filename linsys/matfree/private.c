@@ -0,0 +1,336 @@
+#include "private.h"
+
+/* matrix-free solver: as the indirect solver, but A is only touched through the user's products */
+
+#define CG_BEST_TOL 1e-9
+#define CG_MIN_TOL 1e-1
+/* with CG_ADAPTIVE, CG stops once it has reduced the residual of the warm start by this factor */
+#define CG_ADAPT_REDUCTION 0.1
+/* bounds of the column normalization, as for the sparse solvers */
+#define MIN_SCALE 1e-3
+#define MAX_SCALE 1e3
+
+char * getLinSysMethod(Data * d, Priv * p) {
+	char * str = scs_malloc(sizeof(char) * 128);
+	if (d->CG_ADAPTIVE) {
+		sprintf(str, "matrix-free-indirect, CG tol ~ %.1f * warm start residual", CG_ADAPT_REDUCTION);
+	} else {
+		sprintf(str, "matrix-free-indirect, CG tol ~ 1/iter^(%2.2f)", d->CG_RATE);
+	}
+	return str;
+}
+
+char * getLinSysSummary(Priv * p, Info * info) {
+	char * str = scs_malloc(sizeof(char) * 192);
+	sprintf(str, "\tLin-sys: avg # CG iterations: %2.2f, avg # products with A and A': %2.2f, avg solve time: %1.2es\n",
+			(pfloat ) info->linSysIters / (info->iter + 1), (pfloat ) p->totProducts / (info->iter + 1),
+			p->totalSolveTime / (info->iter + 1) / 1e3);
+	return str;
+}
+
+idxint validateLinSys(Data *d) {
+	AMatrix * A = d->A;
+	idxint j;
+	if (!A->accumA || !A->accumAtrans || !A->colNorms) {
+		scs_printf("data incompletely specified\n");
+		return -1;
+	}
+	for (j = 0; j < d->n; ++j) {
+		if (!(A->colNorms[j] >= 0)) {
+			scs_printf("column norm %li of A is not a nonnegative number\n", (long) j);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+void normalizeA(Data * d, Work * w, Cone * k) {
+	/* only the columns are scaled, the row norms are unknown without forming A, so D = I */
+	AMatrix * A = d->A;
+	pfloat * D = w->D ? w->D : scs_malloc(d->m * sizeof(pfloat));
+	pfloat * E = w->E ? w->E : scs_malloc(d->n * sizeof(pfloat));
+	pfloat minColScale = MIN_SCALE * SQRTF((pfloat) d->m), maxColScale = MAX_SCALE * SQRTF((pfloat) d->m);
+	pfloat e, sqNorms = 0;
+	idxint i;
+
+	for (i = 0; i < d->m; ++i) {
+		D[i] = 1;
+	}
+	w->meanNormColA = 0.0;
+	for (i = 0; i < d->n; ++i) {
+		e = A->colNorms[i];
+		if (e < minColScale)
+			e = 1;
+		else if (e > maxColScale)
+			e = maxColScale;
+		E[i] = e;
+		w->meanNormColA += A->colNorms[i] / e / d->n;
+		sqNorms += (A->colNorms[i] / e) * (A->colNorms[i] / e);
+	}
+	/* the root mean square of the row norms of A * E^-1, from its Frobenius norm, stands in for their mean */
+	w->meanNormRowA = SQRTF(sqNorms / d->m);
+
+	w->D = D;
+	w->E = E;
+}
+
+void setAMatrixValues(Data * d, const pfloat * Ax) {
+	/* the operator has no values of its own, the user updates it (and its column norms) in place */
+}
+
+static void getPreconditioner(Data * d, Priv * p) {
+	idxint j;
+	pfloat a;
+	for (j = 0; j < d->n; ++j) {
+		a = p->E ? p->scale * d->A->colNorms[j] / p->E[j] : d->A->colNorms[j];
+		p->M[j] = 1 / (d->RHO_X + a * a);
+	}
+}
+
+void freePriv(Priv * p) {
+	if (p) {
+		if (p->p)
+			scs_free(p->p);
+		if (p->r)
+			scs_free(p->r);
+		if (p->Gp)
+			scs_free(p->Gp);
+		if (p->tmp)
+			scs_free(p->tmp);
+		if (p->wn)
+			scs_free(p->wn);
+		if (p->wm)
+			scs_free(p->wm);
+		if (p->z)
+			scs_free(p->z);
+		if (p->M)
+			scs_free(p->M);
+		scs_free(p);
+	}
+}
+
+Priv * initPriv(Data * d, const pfloat * D, const pfloat * E) {
+	Priv * p = scs_calloc(1, sizeof(Priv));
+	if (!p)
+		return NULL;
+	p->p = scs_malloc((d->n) * sizeof(pfloat));
+	p->r = scs_malloc((d->n) * sizeof(pfloat));
+	p->Gp = scs_malloc((d->n) * sizeof(pfloat));
+	p->tmp = scs_malloc((d->m) * sizeof(pfloat));
+	p->wn = scs_malloc((d->n) * sizeof(pfloat));
+	p->wm = scs_malloc((d->m) * sizeof(pfloat));
+	p->z = scs_malloc((d->n) * sizeof(pfloat));
+	p->M = scs_malloc((d->n) * sizeof(pfloat));
+	if (!p->p || !p->r || !p->Gp || !p->tmp || !p->wn || !p->wm || !p->z || !p->M) {
+		freePriv(p);
+		return NULL;
+	}
+	p->D = D;
+	p->E = E;
+	p->scale = D ? d->SCALE : 1.0;
+	getPreconditioner(d, p);
+	p->totalSolveTime = 0;
+	p->totCgIts = 0;
+	p->totProducts = 0;
+	p->res = NAN;
+	return p;
+}
+
+void setLinSysResidual(Priv * p, pfloat res) {
+	p->res = res;
+}
+
+idxint getLinSysIters(Priv * p) {
+	return p->totCgIts;
+}
+
+void getLinSysProfile(Priv * p, Profile * prof) {
+	/* only a diagonal preconditioner, nothing to factorize */
+	prof->kktTime = 0;
+	prof->orderTime = 0;
+	prof->factorTime = 0;
+}
+
+idxint updateLinSys(Data * d, Priv * p) {
+	getPreconditioner(d, p);
+	return 0;
+}
+
+void accumByAtrans(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	/* y += scale * E^-1 * A' * D^-1 * x */
+	AMatrix * A = d->A;
+	idxint i;
+	p->totProducts++;
+	if (!p->D) {
+		A->accumAtrans(A->op, x, y);
+		return;
+	}
+	for (i = 0; i < d->m; ++i) {
+		p->wm[i] = x[i] / p->D[i];
+	}
+	memset(p->wn, 0, d->n * sizeof(pfloat));
+	A->accumAtrans(A->op, p->wm, p->wn);
+	for (i = 0; i < d->n; ++i) {
+		y[i] += p->scale * p->wn[i] / p->E[i];
+	}
+}
+
+void accumByA(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	/* y += scale * D^-1 * A * E^-1 * x */
+	AMatrix * A = d->A;
+	idxint i;
+	p->totProducts++;
+	if (!p->D) {
+		A->accumA(A->op, x, y);
+		return;
+	}
+	for (i = 0; i < d->n; ++i) {
+		p->wn[i] = p->scale * x[i] / p->E[i];
+	}
+	memset(p->wm, 0, d->m * sizeof(pfloat));
+	A->accumA(A->op, p->wn, p->wm);
+	for (i = 0; i < d->m; ++i) {
+		y[i] += p->wm[i] / p->D[i];
+	}
+}
+
+/* y = (RHO_X * I + A'A)x, returns x'y */
+static pfloat matVec(Data * d, Priv * p, const pfloat * x, pfloat * y) {
+	memset(p->tmp, 0, d->m * sizeof(pfloat));
+	accumByA(d, p, x, p->tmp);
+	memcpy(y, x, d->n * sizeof(pfloat));
+	scaleArray(y, d->RHO_X, d->n);
+	accumByAtrans(d, p, p->tmp, y);
+	return innerProd(x, y, d->n);
+}
+
+static void applyPreConditioner(const pfloat * M, pfloat * z, const pfloat * r, idxint n, pfloat *ipzr) {
+	idxint i;
+	*ipzr = 0;
+	for (i = 0; i < n; ++i) {
+		z[i] = r[i] * M[i];
+		*ipzr += z[i] * r[i];
+	}
+}
+
+/* with reduction > 0, tol is lowered to reduction times the norm of the initial residual b - G * s */
+static idxint pcg(Data *d, Priv * pr, const pfloat * s, pfloat * b, idxint max_its, pfloat tol, pfloat reduction) {
+	idxint i, n = d->n;
+	pfloat ipzr, ipzrOld, alpha, nmr;
+	pfloat *p = pr->p; /* cg direction */
+	pfloat *Gp = pr->Gp; /* updated CG direction */
+	pfloat *r = pr->r; /* cg residual */
+	pfloat *z = pr->z; /* for preconditioning */
+	pfloat *M = pr->M; /* inverse diagonal preconditioner */
+
+	if (s == NULL) {
+		memcpy(r, b, n * sizeof(pfloat));
+		memset(b, 0, n * sizeof(pfloat));
+	} else {
+		matVec(d, pr, s, r);
+		scaleAndAddArray(r, -1, b, n); /* r = b - G * s */
+		memcpy(b, s, n * sizeof(pfloat));
+	}
+	if (reduction > 0) {
+		tol = MAX(MIN(tol, reduction * calcNorm(r, n)), CG_BEST_TOL);
+	}
+	applyPreConditioner(M, z, r, n, &ipzr);
+	memcpy(p, z, n * sizeof(pfloat));
+
+	for (i = 0; i < max_its; ++i) {
+		alpha = ipzr / matVec(d, pr, p, Gp); /* Gp = G * p, returns p'Gp */
+		addScaledArray(b, p, n, alpha);
+		nmr = SQRTF(addScaledArrayNormSq(r, Gp, n, -alpha));
+
+		if (nmr < tol) {
+#ifdef EXTRAVERBOSE
+			scs_printf("tol: %.4e, resid: %.4e, iters: %li\n", tol, nmr, (long) i+1);
+#endif
+			return i + 1;
+		}
+		ipzrOld = ipzr;
+		applyPreConditioner(M, z, r, n, &ipzr);
+
+		scaleAndAddArray(p, ipzr / ipzrOld, z, n);
+	}
+	return i;
+}
+
+/* relative CG tolerance of the solve at ADMM iteration iter >= 0 */
+static pfloat cgRelTol(Data * d, Priv * p, idxint iter) {
+	if (!d->CG_ADAPTIVE) {
+		return CG_MIN_TOL / POWF((pfloat) iter + 1, d->CG_RATE);
+	}
+	/* only a bound, pcg stops earlier once the residual of the warm start is reduced by CG_ADAPT_REDUCTION */
+	return p->res == p->res ? MIN(MAX(p->res, CG_BEST_TOL), 1) : 1;
+}
+
+idxint solveLinSys(Data *d, Priv * p, pfloat * b, const pfloat * s, idxint iter) {
+	idxint cgIts;
+	timer linsysTimer;
+	pfloat cgTol = calcNorm(b, d->n) * (iter < 0 ? CG_BEST_TOL : cgRelTol(d, p, iter));
+	/* the accurate solves (iter < 0) are never capped */
+	idxint maxIts = iter >= 0 && d->CG_MAX_ITERS > 0 ? MIN(d->CG_MAX_ITERS, d->n) : d->n;
+
+	if (iter == 0) {
+		/* the first step of a solve, the counters of the summary start over */
+		p->totalSolveTime = 0;
+		p->totProducts = 0;
+	}
+	tic(&linsysTimer);
+	/* solves Mx = b, for x but stores result in b */
+	/* s contains warm-start (if available) */
+	accumByAtrans(d, p, &(b[d->n]), b);
+	/* solves (I+A'A)x = b, s warm start, solution stored in b */
+	cgIts = pcg(d, p, s, b, maxIts, MAX(cgTol, CG_BEST_TOL),
+			iter >= 0 && d->CG_ADAPTIVE ? CG_ADAPT_REDUCTION : 0);
+	scaleArray(&(b[d->n]), -1, d->m);
+	accumByA(d, p, b, &(b[d->n]));
+
+	if (iter >= 0) {
+		p->totCgIts += cgIts;
+	}
+
+	p->totalSolveTime += tocq(&linsysTimer);
+#ifdef EXTRAVERBOSE
+	scs_printf("linsys solve time: %1.2es\n", tocq(&linsysTimer) / 1e3);
+#endif
+	return 0;
+}
+
+idxint solveLinSysBatch(Data * d, Priv * p, idxint K, pfloat ** b, const pfloat ** s, idxint iter) {
+	/* the user's products take one vector, so there is no pass to share */
+	idxint k;
+	for (k = 0; k < K; ++k) {
+		if (solveLinSys(d, p, b[k], s ? s[k] : NULL, iter) < 0)
+			return -1;
+	}
+	return 0;
+}
+
+/* the presolve needs the entries of A, so PRESOLVE and CHORDAL are ignored and the others are never called */
+Presolve * initPresolve(Data * d, Cone * k) {
+	return NULL;
+}
+
+Data * reducedData(Presolve * pre, const Data * d) {
+	return NULL;
+}
+
+idxint presolveBC(Presolve * pre, const Data * d, const pfloat * b, const pfloat * c, pfloat * rb, pfloat * rc) {
+	return 0;
+}
+
+void presolveSol(Presolve * pre, const Sol * sol, Sol * rsol) {
+}
+
+void postsolve(Presolve * pre, const Data * d, const pfloat * b, const pfloat * c, const Sol * rsol, Sol * sol,
+		idxint status, Info * info) {
+}
+
+idxint updatePresolve(Presolve * pre, const Data * d) {
+	return -1;
+}
+
+void freePresolve(Presolve * pre) {
+}
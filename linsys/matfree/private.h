@@ -0,0 +1,31 @@
+#ifndef PRIV_H_GUARD
+#define PRIV_H_GUARD
+
+#include "glbopts.h"
+#include "scs.h"
+#include <math.h>
+#include "linsys/matfree/amatrix.h"
+#include "linAlg.h"
+#include "presolve.h"
+
+struct PRIVATE_DATA {
+	pfloat * p; /* cg iterate  */
+	pfloat * r; /* cg residual */
+	pfloat * Gp;
+	pfloat * tmp; /* A * x in the CG products, size m */
+	/* normalization of A, the products apply scale * D^-1 * A * E^-1 around the user's operator,
+	 D and E are NULL (and scale is 1) if A is not normalized */
+	const pfloat * D, * E;
+	pfloat scale;
+	pfloat * wn, * wm; /* scaled inputs and outputs of the user's products, sizes n and m */
+	/* preconditioning */
+	pfloat * z;
+	pfloat * M; /* inverse diagonal of RHO_X * I + A'A, from the column norms */
+	pfloat res; /* ADMM residual of the last convergence check for CG_ADAPTIVE, NAN if not known */
+	/* reporting */
+	idxint totCgIts;
+	idxint totProducts; /* products with A and A' */
+	pfloat totalSolveTime;
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef MPI_AMATRIX_H_GUARD
+#define MPI_AMATRIX_H_GUARD
+
+/* this struct defines the data matrix A for the MPI solver: every rank of MPI_COMM_WORLD calls scs_init with the
+ * whole b, c and cones but only its block of the rows of A, the rows r0 to r1 - 1, the blocks of ranks 0, 1, ...
+ * following each other and covering all m rows */
+struct A_DATA_MATRIX {
+	/* the entries of A in rows r0 to r1 - 1, in column compressed format with the row indices of the whole A */
+	pfloat * x; /* A values, size: NNZ of the block */
+	idxint * i; /* A row index, size: NNZ of the block */
+	idxint * p; /* A column pointer, size: n+1 */
+	idxint r0, r1; /* the rows of the block */
+};
+
+/* sets r0 and r1 to the block of this rank in a split of the m rows of a problem with cones k into blocks of about
+ * m / (number of ranks) rows, no second-order, semidefinite or exponential cone is split between two ranks */
+void scs_mpi_rows(Cone * k, idxint m, idxint * r0, idxint * r1);
+
+#endif
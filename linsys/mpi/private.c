@@ -0,0 +1,534 @@
+#include "private.h"
+
+/* indirect solver over MPI: each rank holds a block of the rows of A (see linsys/mpi/amatrix.h) and all of every
+ * vector, the products with A and A' and the normalization run on the local blocks and are combined with
+ * collectives, the rest of scs (cone projections, CG vector updates, residuals) is repeated on every rank */
+
+#define CG_BEST_TOL 1e-9
+#define CG_MIN_TOL 1e-1
+/* with CG_ADAPTIVE, CG stops once it has reduced the residual of the warm start by this factor */
+#define CG_ADAPT_REDUCTION 0.1
+/* bounds of the normalization, as for the sparse solvers */
+#define MIN_SCALE 1e-3
+#define MAX_SCALE 1e3
+
+#ifndef FLOAT
+#define MPI_PFLOAT MPI_DOUBLE
+#else
+#define MPI_PFLOAT MPI_FLOAT
+#endif
+#ifdef DLONG
+#define MPI_IDXINT MPI_INT64_T
+#else
+#define MPI_IDXINT MPI_INT
+#endif
+
+/* x = the sum of the x of all ranks, reduced on rank 0 and broadcast so that every rank gets the same bits (the
+ * ranks must take the same decisions, an allreduce may round differently on each), adds the time taken to time */
+static void sumRanks(pfloat * x, idxint len, pfloat * time) {
+	int rank;
+	timer commTimer;
+	tic(&commTimer);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Reduce(rank == 0 ? MPI_IN_PLACE : x, x, (int) len, MPI_PFLOAT, MPI_SUM, 0, MPI_COMM_WORLD);
+	MPI_Bcast(x, (int) len, MPI_PFLOAT, 0, MPI_COMM_WORLD);
+	if (time)
+		*time += tocq(&commTimer);
+}
+
+/* the first row of the block of rank r of size: the first at or after r * m / size that starts a cone, any row of
+ * the equality and LP cones does */
+static idxint splitRow(Cone * k, idxint m, int r, int size) {
+	idxint * boundaries, i, row, target = (idxint) ((pfloat) m * r / size);
+	idxint numBoundaries = getConeBoundaries(k, &boundaries);
+	row = MIN(target, boundaries[0]);
+	for (i = 1; i < numBoundaries && row < target; ++i) {
+		row += boundaries[i];
+	}
+	scs_free(boundaries);
+	return MIN(row, m);
+}
+
+void scs_mpi_rows(Cone * k, idxint m, idxint * r0, idxint * r1) {
+	int rank, size;
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+	*r0 = splitRow(k, m, rank, size);
+	*r1 = splitRow(k, m, rank + 1, size);
+}
+
+char * getLinSysMethod(Data * d, Priv * p) {
+	char * str = scs_malloc(sizeof(char) * 160);
+	int size;
+	idxint len;
+	/* called before initPriv and only where VERBOSE is set, so no collectives here */
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+	len = sprintf(str, "sparse-indirect MPI, %i ranks, nnz in the block of A = %li", size, (long) d->A->p[d->n]);
+	if (d->CG_ADAPTIVE) {
+		sprintf(str + len, ", CG tol ~ %.1f * warm start residual", CG_ADAPT_REDUCTION);
+	} else {
+		sprintf(str + len, ", CG tol ~ 1/iter^(%2.2f)", d->CG_RATE);
+	}
+	return str;
+}
+
+char * getLinSysSummary(Priv * p, Info * info) {
+	char * str = scs_malloc(sizeof(char) * 192);
+	sprintf(str, "\tLin-sys: avg # CG iterations: %2.2f, avg solve time: %1.2es, of which in MPI: %1.2es\n",
+			(pfloat ) info->linSysIters / (info->iter + 1), p->totalSolveTime / (info->iter + 1) / 1e3,
+			p->commTime / (info->iter + 1) / 1e3);
+	return str;
+}
+
+idxint validateLinSys(Data *d) {
+	AMatrix * A = d->A;
+	idxint i, * blocks;
+	int r, size, bad = 0, anyBad, init;
+	MPI_Initialized(&init);
+	if (!init) {
+		scs_printf("MPI is not initialized\n");
+		return -1;
+	}
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+	if (!A->x || !A->i || !A->p) {
+		scs_printf("data incompletely specified\n");
+		bad = 1;
+	}
+	for (i = 0; !bad && i < A->p[d->n]; ++i) {
+		if (A->i[i] < A->r0 || A->i[i] >= A->r1) {
+			scs_printf("row %li of A is outside of the rows %li to %li of this rank\n", (long) A->i[i], (long) A->r0,
+					(long) A->r1 - 1);
+			bad = 1;
+		}
+	}
+	/* the blocks of all ranks must follow each other and cover the rows of A */
+	blocks = scs_malloc(2 * size * sizeof(idxint));
+	MPI_Allgather(&(A->r0), 1, MPI_IDXINT, blocks, 1, MPI_IDXINT, MPI_COMM_WORLD);
+	MPI_Allgather(&(A->r1), 1, MPI_IDXINT, &(blocks[size]), 1, MPI_IDXINT, MPI_COMM_WORLD);
+	for (r = 0; r < size; ++r) {
+		if (blocks[r] != (r == 0 ? 0 : blocks[size + r - 1]) || blocks[size + r] < blocks[r]
+				|| (r == size - 1 && blocks[size + r] != d->m)) {
+			scs_printf("the row blocks of A of the ranks do not follow each other over its %li rows\n", (long) d->m);
+			bad = 1;
+			break;
+		}
+	}
+	scs_free(blocks);
+	/* every rank fails alike, or the others would wait for it */
+	MPI_Allreduce(&bad, &anyBad, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+	return anyBad ? -1 : 0;
+}
+
+void normalizeA(Data * d, Work * w, Cone * k) {
+	/* as for the sparse solvers, in one pass: the squared row norms (0 off the local block) and column norms of the
+	 blocks are summed over the ranks, so every rank gets the whole D and E */
+	AMatrix * A = d->A;
+	pfloat * D = w->D ? w->D : scs_wmalloc(d->m * sizeof(pfloat));
+	pfloat * E = w->E ? w->E : scs_wmalloc(d->n * sizeof(pfloat));
+	pfloat * nms = scs_calloc(d->m, sizeof(pfloat)), * cnms = scs_calloc(d->n + 1, sizeof(pfloat));
+	pfloat minRowScale = MIN_SCALE * SQRTF((pfloat) d->n), maxRowScale = MAX_SCALE * SQRTF((pfloat) d->n);
+	pfloat minColScale = MIN_SCALE * SQRTF((pfloat) d->m), maxColScale = MAX_SCALE * SQRTF((pfloat) d->m);
+	idxint i, j, count, delta, * boundaries;
+	idxint numBoundaries = getConeBoundaries(k, &boundaries);
+	pfloat wrk;
+
+	for (j = 0; j < d->n; ++j) {
+		for (i = A->p[j]; i < A->p[j + 1]; ++i) {
+			nms[A->i[i]] += A->x[i] * A->x[i];
+		}
+	}
+	sumRanks(nms, d->m, NULL);
+	for (i = 0; i < d->m; ++i) {
+		D[i] = SQRTF(nms[i]);
+	}
+	/* mean of norms of rows across each cone */
+	count = boundaries[0];
+	for (i = 1; i < numBoundaries; ++i) {
+		wrk = 0;
+		delta = boundaries[i];
+		for (j = count; j < count + delta; ++j) {
+			wrk += D[j];
+		}
+		wrk /= delta;
+		for (j = count; j < count + delta; ++j) {
+			D[j] = wrk;
+		}
+		count += delta;
+	}
+	scs_free(boundaries);
+	for (i = 0; i < d->m; ++i) {
+		if (D[i] < minRowScale)
+			D[i] = 1;
+		else if (D[i] > maxRowScale)
+			D[i] = maxRowScale;
+	}
+
+	/* col norms of the row scaled A */
+	for (j = 0; j < d->n; ++j) {
+		for (i = A->p[j]; i < A->p[j + 1]; ++i) {
+			wrk = A->x[i] / D[A->i[i]];
+			cnms[j] += wrk * wrk;
+		}
+	}
+	sumRanks(cnms, d->n, NULL);
+	w->meanNormColA = 0;
+	for (j = 0; j < d->n; ++j) {
+		E[j] = SQRTF(cnms[j]);
+		if (E[j] < minColScale)
+			E[j] = 1;
+		else if (E[j] > maxColScale)
+			E[j] = maxColScale;
+		w->meanNormColA += SQRTF(cnms[j]) / E[j] / d->n;
+	}
+
+	/* mean of the row norms of D^-1 * A * E^-1, each rank sums those of its block */
+	memset(nms, 0, d->m * sizeof(pfloat));
+	for (j = 0; j < d->n; ++j) {
+		for (i = A->p[j]; i < A->p[j + 1]; ++i) {
+			wrk = A->x[i] / D[A->i[i]] / E[j];
+			nms[A->i[i]] += wrk * wrk;
+		}
+	}
+	cnms[0] = 0;
+	for (i = A->r0; i < A->r1; ++i) {
+		cnms[0] += SQRTF(nms[i]) / d->m;
+	}
+	sumRanks(cnms, 1, NULL);
+	w->meanNormRowA = cnms[0];
+	scs_free(nms);
+	scs_free(cnms);
+
+	w->D = D;
+	w->E = E;
+}
+
+void setAMatrixValues(Data * d, const pfloat * Ax) {
+	if (Ax != d->A->x) {
+		memcpy(d->A->x, Ax, d->A->p[d->n] * sizeof(pfloat));
+	}
+}
+
+/* the normalized values of the block (in the pattern set by initPriv) and M = inv ( diag ( RHO_X * I + A'A ) ) */
+static void setValues(Data * d, Priv * p) {
+	AMatrix * A = d->A;
+	idxint i, j, * next = scs_malloc(MAX(A->r1 - A->r0, 1) * sizeof(idxint));
+	memcpy(next, p->Atp, (A->r1 - A->r0) * sizeof(idxint));
+	memset(p->wn, 0, d->n * sizeof(pfloat));
+	for (j = 0; j < d->n; ++j) {
+		for (i = A->p[j]; i < A->p[j + 1]; ++i) {
+			pfloat a = p->D ? A->x[i] / p->D[A->i[i]] * (1.0 / p->E[j]) * p->scale : A->x[i];
+			p->Atx[next[A->i[i] - A->r0]++] = a;
+			p->wn[j] += a * a;
+		}
+	}
+	scs_free(next);
+	sumRanks(p->wn, d->n, NULL);
+	for (j = 0; j < d->n; ++j) {
+		p->M[j] = 1 / (d->RHO_X + p->wn[j]);
+	}
+}
+
+/* the pattern of the block in row compressed form */
+static void setPattern(Data * d, Priv * p) {
+	AMatrix * A = d->A;
+	idxint i, j, nr = A->r1 - A->r0, * next = scs_calloc(nr + 1, sizeof(idxint));
+	for (i = 0; i < A->p[d->n]; ++i) {
+		next[A->i[i] - A->r0]++;
+	}
+	p->Atp[0] = 0;
+	for (i = 0; i < nr; ++i) {
+		p->Atp[i + 1] = p->Atp[i] + next[i];
+	}
+	memcpy(next, p->Atp, nr * sizeof(idxint));
+	for (j = 0; j < d->n; ++j) {
+		for (i = A->p[j]; i < A->p[j + 1]; ++i) {
+			p->Ati[next[A->i[i] - A->r0]++] = (rowidx) j;
+		}
+	}
+	scs_free(next);
+}
+
+void freePriv(Priv * p) {
+	if (p) {
+		if (p->cnt)
+			scs_free(p->cnt);
+		if (p->off)
+			scs_free(p->off);
+		if (p->Atx)
+			scs_free(p->Atx);
+		if (p->Ati)
+			scs_free(p->Ati);
+		if (p->Atp)
+			scs_free(p->Atp);
+		if (p->p)
+			scs_free(p->p);
+		if (p->r)
+			scs_free(p->r);
+		if (p->Gp)
+			scs_free(p->Gp);
+		if (p->wn)
+			scs_free(p->wn);
+		if (p->wm)
+			scs_free(p->wm);
+		if (p->z)
+			scs_free(p->z);
+		if (p->M)
+			scs_free(p->M);
+		scs_free(p);
+	}
+}
+
+Priv * initPriv(Data * d, const pfloat * D, const pfloat * E) {
+	AMatrix * A = d->A;
+	idxint nnz = A->p[d->n], rows, * blocks;
+	int r;
+	Priv * p = scs_wcalloc(1, sizeof(Priv));
+	if (!p)
+		return NULL;
+	MPI_Comm_rank(MPI_COMM_WORLD, &(p->rank));
+	MPI_Comm_size(MPI_COMM_WORLD, &(p->size));
+	blocks = scs_malloc(p->size * sizeof(idxint));
+	p->cnt = scs_wmalloc(p->size * sizeof(int));
+	p->off = scs_wmalloc(p->size * sizeof(int));
+	p->Atx = scs_wmalloc(MAX(nnz, 1) * sizeof(pfloat));
+	p->Ati = scs_wmalloc(MAX(nnz, 1) * sizeof(rowidx));
+	p->Atp = scs_wmalloc((A->r1 - A->r0 + 1) * sizeof(idxint));
+	p->p = scs_wmalloc(d->n * sizeof(pfloat));
+	p->r = scs_wmalloc(d->n * sizeof(pfloat));
+	p->Gp = scs_wmalloc(d->n * sizeof(pfloat));
+	p->wn = scs_wmalloc((d->n + 1) * sizeof(pfloat));
+	p->wm = scs_wmalloc(d->m * sizeof(pfloat));
+	p->z = scs_wmalloc(d->n * sizeof(pfloat));
+	p->M = scs_wmalloc(d->n * sizeof(pfloat));
+	if (!p->cnt || !p->off || !p->Atx || !p->Ati || !p->Atp || !p->p || !p->r || !p->Gp || !p->wn || !p->wm || !p->z
+			|| !p->M || !blocks) {
+		if (blocks)
+			scs_free(blocks);
+		freePriv(p);
+		return NULL;
+	}
+	/* validateLinSys checked that the blocks follow each other */
+	rows = A->r1 - A->r0;
+	MPI_Allgather(&rows, 1, MPI_IDXINT, blocks, 1, MPI_IDXINT, MPI_COMM_WORLD);
+	for (r = 0; r < p->size; ++r) {
+		p->cnt[r] = (int) blocks[r];
+		p->off[r] = r == 0 ? 0 : p->off[r - 1] + p->cnt[r - 1];
+	}
+	scs_free(blocks);
+	p->D = D;
+	p->E = E;
+	p->scale = D ? d->SCALE : 1.0;
+	setPattern(d, p);
+	setValues(d, p);
+	p->totalSolveTime = 0;
+	p->commTime = 0;
+	p->totCgIts = 0;
+	p->res = NAN;
+	return p;
+}
+
+void setLinSysResidual(Priv * p, pfloat res) {
+	p->res = res;
+}
+
+idxint getLinSysIters(Priv * p) {
+	return p->totCgIts;
+}
+
+void getLinSysProfile(Priv * p, Profile * prof) {
+	/* only a diagonal preconditioner, nothing to factorize */
+	prof->kktTime = 0;
+	prof->orderTime = 0;
+	prof->factorTime = 0;
+}
+
+idxint updateLinSys(Data * d, Priv * p) {
+	setValues(d, p);
+	return 0;
+}
+
+void accumByAtrans(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	/* y += A' * x, the sum over the ranks of the products with their blocks */
+	idxint i, q, r0 = d->A->r0, nr = d->A->r1 - r0;
+	pfloat xi;
+	memset(p->wn, 0, d->n * sizeof(pfloat));
+	for (i = 0; i < nr; ++i) {
+		xi = x[r0 + i];
+		for (q = p->Atp[i]; q < p->Atp[i + 1]; ++q) {
+			p->wn[p->Ati[q]] += p->Atx[q] * xi;
+		}
+	}
+	sumRanks(p->wn, d->n, &(p->commTime));
+	addScaledArray(y, p->wn, d->n, 1);
+}
+
+void accumByA(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	/* y += A * x, each rank forms the rows of its block and gathers those of the others */
+	idxint i, q, r0 = d->A->r0, nr = d->A->r1 - r0;
+	pfloat yi;
+	timer commTimer;
+	for (i = 0; i < nr; ++i) {
+		yi = 0;
+		for (q = p->Atp[i]; q < p->Atp[i + 1]; ++q) {
+			yi += p->Atx[q] * x[p->Ati[q]];
+		}
+		p->wm[r0 + i] = yi;
+	}
+	tic(&commTimer);
+	MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, p->wm, p->cnt, p->off, MPI_PFLOAT, MPI_COMM_WORLD);
+	p->commTime += tocq(&commTimer);
+	addScaledArray(y, p->wm, d->m, 1);
+}
+
+/* y = (RHO_X * I + A'A)x, returns x'y = RHO_X * x'x + |Ax|^2, one pass over the rows a_i of the block,
+ y += a_i * (a_i'x), and one sum over the ranks of the n products and |Ax|^2 together */
+static pfloat matVec(Data * d, Priv * p, const pfloat * x, pfloat * y) {
+	idxint i, q, nr = d->A->r1 - d->A->r0;
+	pfloat aix, * wn = p->wn;
+	memset(wn, 0, (d->n + 1) * sizeof(pfloat));
+	for (i = 0; i < nr; ++i) {
+		aix = 0;
+		for (q = p->Atp[i]; q < p->Atp[i + 1]; ++q) {
+			aix += p->Atx[q] * x[p->Ati[q]];
+		}
+		for (q = p->Atp[i]; q < p->Atp[i + 1]; ++q) {
+			wn[p->Ati[q]] += p->Atx[q] * aix;
+		}
+		wn[d->n] += aix * aix;
+	}
+	sumRanks(wn, d->n + 1, &(p->commTime));
+	setAsScaledArray(y, x, d->RHO_X, d->n);
+	addScaledArray(y, wn, d->n, 1);
+	return wn[d->n] + d->RHO_X * calcNormSq(x, d->n);
+}
+
+static void applyPreConditioner(const pfloat * M, pfloat * z, const pfloat * r, idxint n, pfloat *ipzr) {
+	idxint i;
+	*ipzr = 0;
+	for (i = 0; i < n; ++i) {
+		z[i] = r[i] * M[i];
+		*ipzr += z[i] * r[i];
+	}
+}
+
+/* with reduction > 0, tol is lowered to reduction times the norm of the initial residual b - G * s */
+static idxint pcg(Data *d, Priv * pr, const pfloat * s, pfloat * b, idxint max_its, pfloat tol, pfloat reduction) {
+	idxint i, n = d->n;
+	pfloat ipzr, ipzrOld, alpha, nmr;
+	pfloat *p = pr->p; /* cg direction */
+	pfloat *Gp = pr->Gp; /* updated CG direction */
+	pfloat *r = pr->r; /* cg residual */
+	pfloat *z = pr->z; /* for preconditioning */
+	pfloat *M = pr->M; /* inverse diagonal preconditioner */
+
+	if (s == NULL) {
+		memcpy(r, b, n * sizeof(pfloat));
+		memset(b, 0, n * sizeof(pfloat));
+	} else {
+		matVec(d, pr, s, r);
+		scaleAndAddArray(r, -1, b, n); /* r = b - G * s */
+		memcpy(b, s, n * sizeof(pfloat));
+	}
+	if (reduction > 0) {
+		tol = MAX(MIN(tol, reduction * calcNorm(r, n)), CG_BEST_TOL);
+	}
+	applyPreConditioner(M, z, r, n, &ipzr);
+	memcpy(p, z, n * sizeof(pfloat));
+
+	for (i = 0; i < max_its; ++i) {
+		alpha = ipzr / matVec(d, pr, p, Gp); /* Gp = G * p, returns p'Gp */
+		addScaledArray(b, p, n, alpha);
+		nmr = SQRTF(addScaledArrayNormSq(r, Gp, n, -alpha));
+
+		if (nmr < tol) {
+#ifdef EXTRAVERBOSE
+			scs_printf("tol: %.4e, resid: %.4e, iters: %li\n", tol, nmr, (long) i+1);
+#endif
+			return i + 1;
+		}
+		ipzrOld = ipzr;
+		applyPreConditioner(M, z, r, n, &ipzr);
+
+		scaleAndAddArray(p, ipzr / ipzrOld, z, n);
+	}
+	return i;
+}
+
+/* relative CG tolerance of the solve at ADMM iteration iter >= 0 */
+static pfloat cgRelTol(Data * d, Priv * p, idxint iter) {
+	if (!d->CG_ADAPTIVE) {
+		return CG_MIN_TOL / POWF((pfloat) iter + 1, d->CG_RATE);
+	}
+	/* only a bound, pcg stops earlier once the residual of the warm start is reduced by CG_ADAPT_REDUCTION */
+	return p->res == p->res ? MIN(MAX(p->res, CG_BEST_TOL), 1) : 1;
+}
+
+idxint solveLinSys(Data *d, Priv * p, pfloat * b, const pfloat * s, idxint iter) {
+	idxint cgIts;
+	timer linsysTimer;
+	pfloat cgTol = calcNorm(b, d->n) * (iter < 0 ? CG_BEST_TOL : cgRelTol(d, p, iter));
+	/* the accurate solves (iter < 0) are never capped */
+	idxint maxIts = iter >= 0 && d->CG_MAX_ITERS > 0 ? MIN(d->CG_MAX_ITERS, d->n) : d->n;
+
+	if (iter == 0) {
+		/* the first step of a solve, the counters of the summary start over */
+		p->totalSolveTime = 0;
+		p->commTime = 0;
+	}
+	tic(&linsysTimer);
+	/* solves Mx = b, for x but stores result in b */
+	/* s contains warm-start (if available) */
+	accumByAtrans(d, p, &(b[d->n]), b);
+	/* solves (I+A'A)x = b, s warm start, solution stored in b */
+	cgIts = pcg(d, p, s, b, maxIts, MAX(cgTol, CG_BEST_TOL),
+			iter >= 0 && d->CG_ADAPTIVE ? CG_ADAPT_REDUCTION : 0);
+	scaleArray(&(b[d->n]), -1, d->m);
+	accumByA(d, p, b, &(b[d->n]));
+
+	if (iter >= 0) {
+		p->totCgIts += cgIts;
+	}
+
+	p->totalSolveTime += tocq(&linsysTimer);
+#ifdef EXTRAVERBOSE
+	scs_printf("linsys solve time: %1.2es\n", tocq(&linsysTimer) / 1e3);
+#endif
+	return 0;
+}
+
+idxint solveLinSysBatch(Data * d, Priv * p, idxint K, pfloat ** b, const pfloat ** s, idxint iter) {
+	/* one solve at a time, each costs a collective per CG iteration either way */
+	idxint k;
+	for (k = 0; k < K; ++k) {
+		if (solveLinSys(d, p, b[k], s ? s[k] : NULL, iter) < 0)
+			return -1;
+	}
+	return 0;
+}
+
+/* the presolve needs all of A, so PRESOLVE and CHORDAL are ignored and the others are never called */
+Presolve * initPresolve(Data * d, Cone * k) {
+	return NULL;
+}
+
+Data * reducedData(Presolve * pre, const Data * d) {
+	return NULL;
+}
+
+idxint presolveBC(Presolve * pre, const Data * d, const pfloat * b, const pfloat * c, pfloat * rb, pfloat * rc) {
+	return 0;
+}
+
+void presolveSol(Presolve * pre, const Sol * sol, Sol * rsol) {
+}
+
+void postsolve(Presolve * pre, const Data * d, const pfloat * b, const pfloat * c, const Sol * rsol, Sol * sol,
+		idxint status, Info * info) {
+}
+
+idxint updatePresolve(Presolve * pre, const Data * d) {
+	return -1;
+}
+
+void freePresolve(Presolve * pre) {
+}
@@ -0,0 +1,37 @@
+#ifndef PRIV_H_GUARD
+#define PRIV_H_GUARD
+
+#include "glbopts.h"
+#include "scs.h"
+#include <math.h>
+#include <mpi.h>
+#include "linsys/mpi/amatrix.h"
+#include "linAlg.h"
+#include "presolve.h"
+
+struct PRIVATE_DATA {
+	int rank, size;
+	int * cnt, * off; /* rows in the block of each rank and its first row, for gathering the products with A */
+	/* the block of A in row compressed form (as its A'), with the normalized values, row i is row r0 + i of A */
+	pfloat * Atx;
+	rowidx * Ati;
+	idxint * Atp;
+	/* normalization of A, D and E are NULL (and scale is 1) if A is not normalized */
+	const pfloat * D, * E;
+	pfloat scale;
+	pfloat * p; /* cg iterate  */
+	pfloat * r; /* cg residual */
+	pfloat * Gp;
+	pfloat * wn; /* products with the block of A', summed over the ranks, size n + 1 (the last for |Ax|^2) */
+	pfloat * wm; /* products with A, each rank computes its block and gathers the others, size m */
+	/* preconditioning */
+	pfloat * z;
+	pfloat * M; /* inverse diagonal of RHO_X * I + A'A */
+	pfloat res; /* ADMM residual of the last convergence check for CG_ADAPTIVE, NAN if not known */
+	/* reporting */
+	idxint totCgIts;
+	pfloat totalSolveTime;
+	pfloat commTime; /* in the collectives of the solves */
+};
+
+#endif
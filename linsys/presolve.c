@@ -0,0 +1,656 @@
+#include "presolve.h"
+#include "chordal.h"
+#include "linsys/amatrix.h"
+#include <stdint.h>
+
+/* the presolve of PRESOLVE and CHORDAL described in presolve.h */
+
+#define PRESOLVE_TOL 1e-9 /* relative tolerance of the b of the removed rows */
+#define EMPTY_ROW -1 /* in rowRep */
+#define FIX_ROW -2
+
+/* the rows of A: row i holds the entries e[p[i]] to e[p[i + 1] - 1] of A, in columns j[...] in increasing order */
+typedef struct {
+	idxint * p, * e, * j;
+} Rows;
+
+/* a row to be sorted with the others of its cone by the hash of its entries */
+typedef struct {
+	uint64_t hash;
+	idxint lp, i;
+} RowHash;
+
+static void freeRows(Rows * R) {
+	if (R->p)
+		scs_free(R->p);
+	if (R->e)
+		scs_free(R->e);
+	if (R->j)
+		scs_free(R->j);
+}
+
+static idxint initRows(const AMatrix * A, idxint m, idxint n, Rows * R) {
+	idxint i, j, q, nnz = A->p[n];
+	R->p = scs_calloc(m + 1, sizeof(idxint));
+	R->e = scs_malloc(MAX(nnz, 1) * sizeof(idxint));
+	R->j = scs_malloc(MAX(nnz, 1) * sizeof(idxint));
+	if (!R->p || !R->e || !R->j) {
+		freeRows(R);
+		return -1;
+	}
+	for (q = 0; q < nnz; ++q)
+		R->p[A->i[q] + 1]++;
+	for (i = 0; i < m; ++i)
+		R->p[i + 1] += R->p[i];
+	/* p[i] runs to the end of row i, which is the start of row i + 1 */
+	for (j = 0; j < n; ++j) {
+		for (q = A->p[j]; q < A->p[j + 1]; ++q) {
+			R->e[R->p[A->i[q]]] = q;
+			R->j[R->p[A->i[q]]++] = j;
+		}
+	}
+	for (i = m; i > 0; --i)
+		R->p[i] = R->p[i - 1];
+	R->p[0] = 0;
+	return 0;
+}
+
+/* FNV-1a of the columns and values of row i on the columns not fixed (colMap < 0) */
+static uint64_t hashRow(const AMatrix * A, const Rows * R, const idxint * colMap, idxint i) {
+	uint64_t h = 14695981039346656037ULL;
+	idxint q;
+	size_t b;
+	for (q = R->p[i]; q < R->p[i + 1]; ++q) {
+		uint64_t v[2];
+		if (colMap[R->j[q]] < 0)
+			continue;
+		v[0] = (uint64_t) R->j[q];
+		v[1] = 0;
+		memcpy(&(v[1]), &(A->x[R->e[q]]), sizeof(pfloat));
+		for (b = 0; b < sizeof(v); ++b) {
+			h ^= ((unsigned char *) v)[b];
+			h *= 1099511628211ULL;
+		}
+	}
+	return h;
+}
+
+/* whether rows i1 and i2 of A are equal on the columns not fixed */
+static idxint equalRows(const AMatrix * A, const Rows * R, const idxint * colMap, idxint i1, idxint i2) {
+	idxint q1 = R->p[i1], q2 = R->p[i2];
+	for (;;) {
+		while (q1 < R->p[i1 + 1] && colMap[R->j[q1]] < 0)
+			q1++;
+		while (q2 < R->p[i2 + 1] && colMap[R->j[q2]] < 0)
+			q2++;
+		if (q1 == R->p[i1 + 1] || q2 == R->p[i2 + 1])
+			return q1 == R->p[i1 + 1] && q2 == R->p[i2 + 1];
+		if (R->j[q1] != R->j[q2] || A->x[R->e[q1]] != A->x[R->e[q2]])
+			return 0;
+		q1++;
+		q2++;
+	}
+}
+
+static int cmpRowHash(const void * a, const void * b) {
+	const RowHash * r1 = a, * r2 = b;
+	if (r1->lp != r2->lp)
+		return r1->lp < r2->lp ? -1 : 1;
+	if (r1->hash != r2->hash)
+		return r1->hash < r2->hash ? -1 : 1;
+	return r1->i < r2->i ? -1 : (r1->i > r2->i);
+}
+
+/* the singleton equality rows fix their variable, those fixes can leave more rows singleton: sets the fixes in fix
+ (row, column, entry), colMap to -1 for the fixed columns and rowRep of their rows, cnt[i] is the number of entries
+ of row i in the columns not fixed, returns the number of fixes */
+static idxint findFixes(const AMatrix * A, const Rows * R, idxint f, idxint n, idxint * cnt, idxint * queue,
+		idxint * colMap, idxint * rowRep, idxint * fix) {
+	idxint i, j, q, t, nQueue = 0, nFix = 0;
+	for (i = 0; i < f; ++i) {
+		if (cnt[i] == 1)
+			queue[nQueue++] = i;
+	}
+	/* each row is queued once, when its count reaches 1, at least one variable is left */
+	for (t = 0; t < nQueue && nFix < n - 1; ++t) {
+		i = queue[t];
+		if (cnt[i] != 1)
+			continue;
+		for (q = R->p[i]; colMap[R->j[q]] < 0; ++q)
+			;
+		if (A->x[R->e[q]] == 0)
+			continue;
+		j = R->j[q];
+		fix[3 * nFix] = i;
+		fix[3 * nFix + 1] = j;
+		fix[3 * nFix + 2] = R->e[q];
+		nFix++;
+		colMap[j] = -1;
+		rowRep[i] = FIX_ROW;
+		for (q = A->p[j]; q < A->p[j + 1]; ++q) {
+			if (--cnt[A->i[q]] == 1 && A->i[q] < f && rowRep[A->i[q]] != FIX_ROW)
+				queue[nQueue++] = A->i[q];
+		}
+	}
+	return nFix;
+}
+
+/* sets rowRep of the rows equal (on the columns not fixed) to an earlier row of the same cone to that row, among
+ the first fl rows with rowRep[i] == i, returns < 0 on failure */
+static idxint findDuplicates(const AMatrix * A, const Rows * R, idxint f, idxint fl, const idxint * colMap,
+		idxint * rowRep) {
+	idxint i, s, t, nRows = 0;
+	RowHash * rows = scs_malloc(MAX(fl, 1) * sizeof(RowHash));
+	if (!rows)
+		return -1;
+	for (i = 0; i < fl; ++i) {
+		if (rowRep[i] != i)
+			continue;
+		rows[nRows].hash = hashRow(A, R, colMap, i);
+		rows[nRows].lp = i >= f;
+		rows[nRows].i = i;
+		nRows++;
+	}
+	qsort(rows, nRows, sizeof(RowHash), cmpRowHash);
+	/* within a run of equal hashes the rows are in increasing order, each is compared to the kept ones before it */
+	for (s = 0; s < nRows; s = t) {
+		for (t = s + 1; t < nRows && rows[t].lp == rows[s].lp && rows[t].hash == rows[s].hash; ++t) {
+			idxint u;
+			for (u = s; u < t; ++u) {
+				if (rowRep[rows[u].i] == rows[u].i && equalRows(A, R, colMap, rows[u].i, rows[t].i)) {
+					rowRep[rows[t].i] = rows[u].i;
+					break;
+				}
+			}
+		}
+	}
+	scs_free(rows);
+	return 0;
+}
+
+/* copies the sizes in q (of size n) but those 0 into a new array, returns its length in nq */
+static idxint * nonzeroSizes(const idxint * q, idxint n, idxint * nq) {
+	idxint i, * r = scs_wmalloc(MAX(n, 1) * sizeof(idxint));
+	*nq = 0;
+	if (!r)
+		return NULL;
+	for (i = 0; i < n; ++i) {
+		if (q[i] > 0)
+			r[(*nq)++] = q[i];
+	}
+	return r;
+}
+
+static idxint numZeroSizes(const idxint * q, idxint n) {
+	idxint i, z = 0;
+	for (i = 0; i < n; ++i)
+		z += q[i] == 0;
+	return z;
+}
+
+/* the reduced cones, A, b and c and the solution, given the maps of pre */
+static idxint initReduced(Presolve * pre, const Data * d, const Cone * k, idxint nm, idxint nn) {
+	const AMatrix * A = d->A;
+	AMatrix * rA;
+	Cone * rk;
+	idxint i, j, q, nnz = 0;
+	pre->rd = scs_wcalloc(1, sizeof(Data));
+	pre->rk = rk = scs_wcalloc(1, sizeof(Cone));
+	if (!pre->rd || !rk || !(pre->rd->A = rA = scs_wcalloc(1, sizeof(AMatrix))))
+		return -1;
+	pre->rd->m = nm;
+	pre->rd->n = nn;
+	for (j = 0; j < d->n; ++j) {
+		for (q = A->p[j]; pre->colMap[j] >= 0 && q < A->p[j + 1]; ++q)
+			nnz += pre->rowMap[A->i[q]] >= 0;
+	}
+	rA->p = scs_wmalloc((nn + 1) * sizeof(idxint));
+	rA->i = scs_wmalloc(MAX(nnz, 1) * sizeof(idxint));
+	rA->x = scs_wmalloc(MAX(nnz, 1) * sizeof(pfloat));
+	pre->Amap = scs_wmalloc(MAX(nnz, 1) * sizeof(idxint));
+	pre->rd->b = scs_wmalloc(nm * sizeof(pfloat));
+	pre->rd->c = scs_wmalloc(nn * sizeof(pfloat));
+	pre->rsol.x = scs_wmalloc(nn * sizeof(pfloat));
+	pre->rsol.y = scs_wmalloc(nm * sizeof(pfloat));
+	pre->rsol.s = scs_wmalloc(nm * sizeof(pfloat));
+	if (!rA->p || !rA->i || !rA->x || !pre->Amap || !pre->rd->b || !pre->rd->c || !pre->rsol.x || !pre->rsol.y
+			|| !pre->rsol.s)
+		return -1;
+	/* the kept rows keep their order, so the columns stay sorted and the cones contiguous */
+	nnz = 0;
+	for (j = 0; j < d->n; ++j) {
+		if (pre->colMap[j] < 0)
+			continue;
+		rA->p[pre->colMap[j]] = nnz;
+		for (q = A->p[j]; q < A->p[j + 1]; ++q) {
+			if (pre->rowMap[A->i[q]] < 0)
+				continue;
+			rA->i[nnz] = pre->rowMap[A->i[q]];
+			rA->x[nnz] = A->x[q];
+			pre->Amap[nnz++] = q;
+		}
+	}
+	rA->p[nn] = nnz;
+	for (i = 0; i < k->f + k->l; ++i) {
+		if (pre->rowMap[i] >= 0 && i < k->f)
+			rk->f++;
+		else if (pre->rowMap[i] >= 0)
+			rk->l++;
+	}
+	rk->q = nonzeroSizes(k->q, k->qsize, &(rk->qsize));
+	rk->s = nonzeroSizes(k->s, k->ssize, &(rk->ssize));
+	rk->sp = nonzeroSizes(k->sp, k->spsize, &(rk->spsize));
+	rk->ep = k->ep;
+	rk->ed = k->ed;
+	return rk->q && rk->s && rk->sp ? 0 : -1;
+}
+
+/* the reduction of PRESOLVE into pre, pre->rd is left NULL if nothing can be removed, returns < 0 on failure */
+static idxint initReduction(Presolve * pre, Data * d, Cone * k) {
+	const AMatrix * A = d->A;
+	idxint i, j, t, nm = 0, nn = 0, nFix = 0, m = d->m, n = d->n, fl = k->f + k->l, status = -1;
+	idxint nZero = numZeroSizes(k->q, k->qsize) + numZeroSizes(k->s, k->ssize) + numZeroSizes(k->sp, k->spsize);
+	Rows R = { NULL, NULL, NULL };
+	idxint * cnt = scs_malloc(m * sizeof(idxint));
+	idxint * queue = scs_malloc(m * sizeof(idxint));
+	idxint * fix = scs_malloc(3 * n * sizeof(idxint));
+	idxint * rowRep = scs_malloc(m * sizeof(idxint));
+	idxint * colMap = scs_calloc(n, sizeof(idxint));
+	if (cnt && queue && fix && rowRep && colMap && initRows(A, m, n, &R) == 0) {
+		for (i = 0; i < m; ++i) {
+			cnt[i] = R.p[i + 1] - R.p[i];
+			rowRep[i] = i;
+		}
+		nFix = findFixes(A, &R, k->f, n, cnt, queue, colMap, rowRep, fix);
+		for (i = 0; i < fl; ++i) {
+			if (rowRep[i] == i && cnt[i] == 0)
+				rowRep[i] = EMPTY_ROW;
+		}
+		status = findDuplicates(A, &R, k->f, fl, colMap, rowRep);
+	}
+	if (status == 0) {
+		for (i = 0; i < m; ++i)
+			nm += rowRep[i] == i;
+		for (j = 0; j < n; ++j)
+			nn += colMap[j] == 0;
+	}
+	/* unless there is nothing to remove, or nothing left */
+	if (status == 0 && !((nm == m && nn == n && nZero == 0) || nm == 0 || nn == 0)) {
+		pre->nFix = nFix;
+		pre->rowMap = scs_wmalloc(m * sizeof(idxint));
+		pre->colMap = scs_wmalloc(n * sizeof(idxint));
+		pre->rowRep = scs_wmalloc(m * sizeof(idxint));
+		pre->fixRow = scs_wmalloc(MAX(nFix, 1) * sizeof(idxint));
+		pre->fixCol = scs_wmalloc(MAX(nFix, 1) * sizeof(idxint));
+		pre->fixEntry = scs_wmalloc(MAX(nFix, 1) * sizeof(idxint));
+		pre->xFix = scs_wmalloc(MAX(nFix, 1) * sizeof(pfloat));
+		pre->r = scs_wmalloc(m * sizeof(pfloat));
+		pre->minRow = scs_wmalloc(nm * sizeof(idxint));
+		status = -1;
+		if (pre->rowMap && pre->colMap && pre->rowRep && pre->fixRow && pre->fixCol && pre->fixEntry && pre->xFix
+				&& pre->r && pre->minRow) {
+			memcpy(pre->rowRep, rowRep, m * sizeof(idxint));
+			for (i = 0, nm = 0; i < m; ++i)
+				pre->rowMap[i] = rowRep[i] == i ? nm++ : -1;
+			for (j = 0, nn = 0; j < n; ++j)
+				pre->colMap[j] = colMap[j] == 0 ? nn++ : -1;
+			for (t = 0; t < nFix; ++t) {
+				pre->fixRow[t] = fix[3 * t];
+				pre->fixCol[t] = fix[3 * t + 1];
+				pre->fixEntry[t] = fix[3 * t + 2];
+			}
+			status = initReduced(pre, d, k, nm, nn);
+		}
+	}
+	freeRows(&R);
+	if (cnt)
+		scs_free(cnt);
+	if (queue)
+		scs_free(queue);
+	if (fix)
+		scs_free(fix);
+	if (rowRep)
+		scs_free(rowRep);
+	if (colMap)
+		scs_free(colMap);
+	return status;
+}
+
+/* the rows of the reduced problem (of the problem if not reduced) whose b can be nonzero: those with entries in A or
+ with a nonzero b */
+static idxint * usedRows(const Presolve * pre, const Data * d) {
+	idxint i, q, * used = scs_calloc(pre->rd ? pre->rd->m : d->m, sizeof(idxint));
+	if (!used)
+		return NULL;
+	for (i = 0; i < d->m; ++i) {
+		if (d->b[i] != 0 && (!pre->rd || pre->rowMap[i] >= 0))
+			used[pre->rd ? pre->rowMap[i] : i] = 1;
+	}
+	for (q = 0; q < d->A->p[d->n]; ++q) {
+		i = d->A->i[q];
+		if (!pre->rd || pre->rowMap[i] >= 0)
+			used[pre->rd ? pre->rowMap[i] : i] = 1;
+	}
+	return used;
+}
+
+Presolve * initPresolve(Data * d, Cone * k) {
+	Presolve * pre = scs_wcalloc(1, sizeof(Presolve));
+	idxint * used, status = pre ? 0 : -1;
+	if (pre) {
+		pre->m = d->m;
+		pre->n = d->n;
+		pre->f = k->f;
+		pre->l = k->l;
+		pre->infeasRow = pre->infeasRow2 = -1;
+	}
+	if (status == 0 && d->PRESOLVE)
+		status = initReduction(pre, d, k);
+	/* failing the decomposition leaves the cones as they are */
+	if (status == 0 && d->CHORDAL && (used = usedRows(pre, d))) {
+		pre->ch = initChordal(pre->rd ? pre->rd : d, pre->rd ? pre->rk : k, used);
+		scs_free(used);
+	}
+	if (status == 0 && (pre->rd || pre->ch)) {
+		pre->d = pre->ch ? pre->ch->d : pre->rd;
+		pre->k = pre->ch ? pre->ch->k : pre->rk;
+		pre->sol = pre->ch ? &(pre->ch->sol) : &(pre->rsol);
+		return pre;
+	}
+	freePresolve(pre);
+	return NULL;
+}
+
+Data * reducedData(Presolve * pre, const Data * d) {
+	Data * rd = pre->d;
+	AMatrix * A = rd->A;
+	pfloat * b = rd->b, * c = rd->c;
+	idxint m = rd->m, n = rd->n;
+	*rd = *d;
+	rd->m = m;
+	rd->n = n;
+	rd->A = A;
+	rd->b = b;
+	rd->c = c;
+	rd->scaling = NULL; /* of the original A */
+	return rd;
+}
+
+/* presolveBC of the reduction */
+static idxint reduceBC(Presolve * pre, const Data * d, const pfloat * b, const pfloat * c, pfloat * rb, pfloat * rc) {
+	const AMatrix * A = d->A;
+	idxint i, j, q, t, ri, rep;
+	pfloat * r = pre->r, tol;
+	/* r = b - A * x for the fixed variables, in the order of the fixes: a fixing row is 0 but for its variable */
+	memcpy(r, b, pre->m * sizeof(pfloat));
+	pre->cFix = 0;
+	for (t = 0; t < pre->nFix; ++t) {
+		pfloat x = r[pre->fixRow[t]] / A->x[pre->fixEntry[t]];
+		j = pre->fixCol[t];
+		pre->xFix[t] = x;
+		pre->cFix += c[j] * x;
+		for (q = A->p[j]; q < A->p[j + 1]; ++q)
+			r[A->i[q]] -= A->x[q] * x;
+	}
+	for (j = 0; j < pre->n; ++j) {
+		if (pre->colMap[j] >= 0)
+			rc[pre->colMap[j]] = c[j];
+	}
+	for (i = 0; i < pre->m; ++i) {
+		if ((ri = pre->rowMap[i]) >= 0) {
+			rb[ri] = r[i];
+			pre->minRow[ri] = i;
+		}
+	}
+	pre->infeasRow = pre->infeasRow2 = -1;
+	for (i = 0; i < pre->f + pre->l && pre->infeasRow < 0; ++i) {
+		rep = pre->rowRep[i];
+		if (rep == i || rep == FIX_ROW)
+			continue;
+		tol = PRESOLVE_TOL * (1 + ABS(b[i]));
+		if (rep == EMPTY_ROW) {
+			/* s = r must be 0, or nonnegative for an LP row */
+			if ((i < pre->f && ABS(r[i]) > tol) || r[i] < -tol)
+				pre->infeasRow = i;
+		} else if (i < pre->f) {
+			if (ABS(r[i] - r[rep]) > tol) {
+				pre->infeasRow = i;
+				pre->infeasRow2 = rep;
+			}
+		} else {
+			ri = pre->rowMap[rep];
+			if (r[i] < rb[ri]) {
+				rb[ri] = r[i];
+				pre->minRow[ri] = i;
+			}
+		}
+	}
+	return pre->infeasRow >= 0 ? INFEASIBLE : 0;
+}
+
+idxint presolveBC(Presolve * pre, const Data * d, const pfloat * b, const pfloat * c, pfloat * rb, pfloat * rc) {
+	pre->cFix = 0;
+	if (pre->rd) {
+		/* the decomposition takes the b and c of the reduced problem */
+		pfloat * b1 = pre->ch ? pre->rd->b : rb, * c1 = pre->ch ? pre->rd->c : rc;
+		if (reduceBC(pre, d, b, c, b1, c1) == INFEASIBLE)
+			return INFEASIBLE;
+		b = b1;
+		c = c1;
+	}
+	return pre->ch ? chordalBC(pre->ch, b, c, rb, rc) : 0;
+}
+
+/* presolveSol of the reduction, into rsol of the reduced sizes */
+static void reduceSol(Presolve * pre, const Sol * sol, Sol * rsol) {
+	idxint i, j;
+	for (j = 0; j < pre->n; ++j) {
+		if (pre->colMap[j] >= 0)
+			rsol->x[pre->colMap[j]] = sol->x[j];
+	}
+	/* the rows of a group of equal rows have the same A' * y with the sum of their y on the kept one */
+	memset(rsol->y, 0, pre->rd->m * sizeof(pfloat));
+	for (i = 0; i < pre->m; ++i) {
+		if (pre->rowRep[i] >= 0)
+			rsol->y[pre->rowMap[pre->rowRep[i]]] += sol->y[i];
+		if (pre->rowMap[i] >= 0)
+			rsol->s[pre->rowMap[i]] = sol->s[i];
+	}
+}
+
+void presolveSol(Presolve * pre, const Sol * sol, Sol * rsol) {
+	if (!rsol->x)
+		rsol->x = scs_malloc(pre->d->n * sizeof(pfloat));
+	if (!rsol->y)
+		rsol->y = scs_malloc(pre->d->m * sizeof(pfloat));
+	if (!rsol->s)
+		rsol->s = scs_malloc(pre->d->m * sizeof(pfloat));
+	if (pre->rd) {
+		reduceSol(pre, sol, pre->ch ? &(pre->rsol) : rsol);
+		sol = &(pre->rsol);
+	}
+	if (pre->ch)
+		chordalSol(pre->ch, sol, rsol);
+}
+
+/* postsolve of the reduction, from rsol of the reduced problem, with status INFEASIBLE for the certificate of
+ presolveBC */
+static void restoreSol(Presolve * pre, const Data * d, const pfloat * c, const Sol * rsol, Sol * sol, idxint status) {
+	const AMatrix * A = d->A;
+	idxint i, j, q, t, ri, rep, m = pre->m, n = pre->n;
+	pfloat * x = sol->x, * y = sol->y, * s = sol->s, * r = pre->r, sum;
+	idxint hom;
+	/* a certificate is of the problem with b = 0 and c = 0 */
+	hom = status != SOLVED;
+	if (pre->infeasRow >= 0) {
+		/* y on the row (or the two equal rows) with b'y = -1, A'y = 0 by the fixing rows below */
+		i = pre->infeasRow;
+		memset(y, 0, m * sizeof(pfloat));
+		y[i] = -1 / (r[i] - (pre->infeasRow2 >= 0 ? r[pre->infeasRow2] : 0));
+		if (pre->infeasRow2 >= 0)
+			y[pre->infeasRow2] = -y[i];
+	} else if (status == SOLVED || status == INFEASIBLE || status == UNBOUNDED) {
+		for (j = 0; j < n; ++j)
+			x[j] = pre->colMap[j] >= 0 ? rsol->x[pre->colMap[j]] : 0;
+		for (t = 0; !hom && t < pre->nFix; ++t)
+			x[pre->fixCol[t]] = pre->xFix[t];
+		for (i = 0; i < m; ++i) {
+			rep = pre->rowRep[i];
+			if (rep < 0) {
+				/* the slack of an empty LP row is its b, a fixing row is solved exactly */
+				y[i] = 0;
+				s[i] = !hom && rep == EMPTY_ROW && i >= pre->f ? MAX(r[i], 0) : 0;
+			} else if (i >= pre->f && i < pre->f + pre->l) {
+				/* the dual of a group of equal LP rows goes to the one of smallest b, the others have more slack */
+				ri = pre->rowMap[rep];
+				y[i] = pre->minRow[ri] == i ? rsol->y[ri] : 0;
+				s[i] = rsol->s[ri] + (hom ? 0 : r[i] - r[pre->minRow[ri]]);
+			} else {
+				ri = pre->rowMap[rep];
+				y[i] = rep == i ? rsol->y[ri] : 0;
+				s[i] = rsol->s[ri];
+			}
+		}
+	} else {
+		scaleArray(x, NAN, n);
+		scaleArray(y, NAN, m);
+		scaleArray(s, NAN, m);
+		return;
+	}
+	/* the dual of each fixing row from the dual equality of its column, A(:, j)' * y + c[j] = 0, last fix first:
+	 the other rows of the column are kept, removed or fixing rows of later fixes */
+	for (t = pre->nFix - 1; t >= 0; --t) {
+		i = pre->fixRow[t];
+		j = pre->fixCol[t];
+		sum = hom ? 0 : c[j];
+		for (q = A->p[j]; q < A->p[j + 1]; ++q) {
+			if (A->i[q] != i)
+				sum += A->x[q] * y[A->i[q]];
+		}
+		y[i] = -sum / A->x[pre->fixEntry[t]];
+	}
+	if (status == INFEASIBLE) {
+		scaleArray(x, NAN, n);
+		scaleArray(s, NAN, m);
+	} else if (status == UNBOUNDED) {
+		scaleArray(y, NAN, m);
+	}
+}
+
+void postsolve(Presolve * pre, const Data * d, const pfloat * b, const pfloat * c, const Sol * rsol, Sol * sol,
+		idxint status, Info * info) {
+	if (!sol->x)
+		sol->x = scs_caller_malloc(pre->n * sizeof(pfloat));
+	if (!sol->y)
+		sol->y = scs_caller_malloc(pre->m * sizeof(pfloat));
+	if (!sol->s)
+		sol->s = scs_caller_malloc(pre->m * sizeof(pfloat));
+	if (pre->infeasRow >= 0)
+		status = INFEASIBLE;
+	if (pre->ch && pre->infeasRow < 0) {
+		unchordalSol(pre->ch, rsol, pre->rd ? &(pre->rsol) : sol, status);
+		rsol = &(pre->rsol);
+	}
+	if (pre->rd)
+		restoreSol(pre, d, c, rsol, sol, status);
+	if (status == SOLVED) {
+		pfloat cTx = innerProd(c, sol->x, pre->n), bTy = innerProd(b, sol->y, pre->m);
+		info->pobj = cTx;
+		info->dobj = -bTy;
+		info->relGap = ABS(cTx + bTy) / (1 + ABS(cTx) + ABS(bTy));
+		/* the solve tests the gap with the objectives offset by cFix, this is only off by rounding */
+		if (info->relGap > d->EPS && strcmp(info->status, "Solved") == 0)
+			strcpy(info->status, "Solved/Inaccurate");
+	}
+}
+
+/* updatePresolve of the reduction */
+static idxint updateReduced(Presolve * pre, const Data * d) {
+	const AMatrix * A = d->A;
+	AMatrix * rA = pre->rd->A;
+	Rows R = { NULL, NULL, NULL };
+	idxint i, q, t, status = 0;
+	for (t = 0; t < pre->nFix; ++t) {
+		if (A->x[pre->fixEntry[t]] == 0)
+			return -1;
+	}
+	for (i = 0; i < pre->f + pre->l && status == 0; ++i) {
+		if (pre->rowRep[i] >= 0 && pre->rowRep[i] != i) {
+			if (!R.p && initRows(A, pre->m, pre->n, &R) < 0)
+				return -1;
+			status = equalRows(A, &R, pre->colMap, i, pre->rowRep[i]) ? 0 : -1;
+		}
+	}
+	freeRows(&R);
+	if (status == 0) {
+		for (q = 0; q < rA->p[pre->rd->n]; ++q)
+			rA->x[q] = A->x[pre->Amap[q]];
+	}
+	return status;
+}
+
+idxint updatePresolve(Presolve * pre, const Data * d) {
+	if (pre->rd && updateReduced(pre, d) < 0)
+		return -1;
+	if (pre->ch)
+		updateChordal(pre->ch, pre->rd ? pre->rd->A : d->A);
+	return 0;
+}
+
+void freePresolve(Presolve * pre) {
+	if (pre) {
+		if (pre->rd) {
+			if (pre->rd->A) {
+				if (pre->rd->A->p)
+					scs_free(pre->rd->A->p);
+				if (pre->rd->A->i)
+					scs_free(pre->rd->A->i);
+				if (pre->rd->A->x)
+					scs_free(pre->rd->A->x);
+				scs_free(pre->rd->A);
+			}
+			if (pre->rd->b)
+				scs_free(pre->rd->b);
+			if (pre->rd->c)
+				scs_free(pre->rd->c);
+			scs_free(pre->rd);
+		}
+		if (pre->rk) {
+			if (pre->rk->q)
+				scs_free(pre->rk->q);
+			if (pre->rk->s)
+				scs_free(pre->rk->s);
+			if (pre->rk->sp)
+				scs_free(pre->rk->sp);
+			scs_free(pre->rk);
+		}
+		if (pre->rsol.x)
+			scs_free(pre->rsol.x);
+		if (pre->rsol.y)
+			scs_free(pre->rsol.y);
+		if (pre->rsol.s)
+			scs_free(pre->rsol.s);
+		freeChordal(pre->ch);
+		if (pre->rowMap)
+			scs_free(pre->rowMap);
+		if (pre->colMap)
+			scs_free(pre->colMap);
+		if (pre->rowRep)
+			scs_free(pre->rowRep);
+		if (pre->Amap)
+			scs_free(pre->Amap);
+		if (pre->fixRow)
+			scs_free(pre->fixRow);
+		if (pre->fixCol)
+			scs_free(pre->fixCol);
+		if (pre->fixEntry)
+			scs_free(pre->fixEntry);
+		if (pre->xFix)
+			scs_free(pre->xFix);
+		if (pre->r)
+			scs_free(pre->r);
+		if (pre->minRow)
+			scs_free(pre->minRow);
+		scs_free(pre);
+	}
+}
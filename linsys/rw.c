@@ -0,0 +1,352 @@
+#include "rw.h"
+#include "scs.h"
+#include "linsys/amatrix.h"
+#include <stdint.h>
+
+#if !(defined _WIN32 || defined _WIN64 || defined _WINDLL)
+#define SCS_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* the binary problem file described in rw.h */
+
+#define HEADER_LEN 256
+#define NUM_HEADER_INTS 16
+#define NUM_HEADER_FLOATS 8
+#define BYTE_ORDER_MARK 0x01020304
+#define MAX_OWNED 11 /* converted arrays, at most one per array of the file */
+
+/* positions in the int64 part of the header */
+enum {
+	H_M, H_N, H_NNZ, H_F, H_L, H_QSIZE, H_SSIZE, H_SPSIZE, H_EP, H_ED, H_WARM, H_MAX_ITERS, H_NORMALIZE
+};
+/* positions in the float64 part of the header */
+enum {
+	H_EPS, H_ALPHA, H_RHO_X, H_SCALE, H_CG_RATE
+};
+
+struct SCS_DATA_FILE {
+	char * base; /* the whole file, mapped or read */
+	size_t len;
+	idxint mapped;
+	void * owned[MAX_OWNED]; /* arrays converted to the sizes of this build */
+	idxint nOwned;
+	Data * d;
+	Cone * k;
+};
+
+static size_t alignUp(size_t off) {
+	return (off + SCS_DATA_ALIGN - 1) / SCS_DATA_ALIGN * SCS_DATA_ALIGN;
+}
+
+/* writes len bytes of v at offset *off, after zero padding up to the alignment, empty arrays take no space */
+static idxint writeSection(FILE * fp, size_t * off, const void * v, size_t len) {
+	static const char zeros[SCS_DATA_ALIGN] = { 0 };
+	size_t start = alignUp(*off);
+	if (len == 0)
+		return 0;
+	if (start > *off && fwrite(zeros, 1, start - *off, fp) != start - *off)
+		return -1;
+	if (fwrite(v, 1, len, fp) != len)
+		return -1;
+	*off = start + len;
+	return 0;
+}
+
+idxint scs_write_data(const char * filename, const Data * d, const Cone * k, const Sol * sol) {
+	char head[HEADER_LEN];
+	uint32_t sizes[4];
+	int64_t ints[NUM_HEADER_INTS] = { 0 };
+	double floats[NUM_HEADER_FLOATS] = { 0 };
+	size_t off = HEADER_LEN, is = sizeof(idxint), fs = sizeof(pfloat);
+	idxint warm = sol && sol->x && sol->y && sol->s, nnz, ok;
+	FILE * fp;
+	if (!filename || !d || !k || !d->A) {
+		scs_printf("ERROR: NULL input\n");
+		return -1;
+	}
+	nnz = d->A->p[d->n];
+	ints[H_M] = d->m;
+	ints[H_N] = d->n;
+	ints[H_NNZ] = nnz;
+	ints[H_F] = k->f;
+	ints[H_L] = k->l;
+	ints[H_QSIZE] = k->q ? k->qsize : 0;
+	ints[H_SSIZE] = k->s ? k->ssize : 0;
+	ints[H_SPSIZE] = k->sp ? k->spsize : 0;
+	ints[H_EP] = k->ep;
+	ints[H_ED] = k->ed;
+	ints[H_WARM] = warm;
+	ints[H_MAX_ITERS] = d->MAX_ITERS;
+	ints[H_NORMALIZE] = d->NORMALIZE;
+	floats[H_EPS] = d->EPS;
+	floats[H_ALPHA] = d->ALPHA;
+	floats[H_RHO_X] = d->RHO_X;
+	floats[H_SCALE] = d->SCALE;
+	floats[H_CG_RATE] = d->CG_RATE;
+	sizes[0] = SCS_DATA_VERSION;
+	sizes[1] = BYTE_ORDER_MARK;
+	sizes[2] = (uint32_t) is;
+	sizes[3] = (uint32_t) fs;
+	memset(head, 0, HEADER_LEN);
+	memcpy(head, SCS_DATA_MAGIC, 8);
+	memcpy(&(head[8]), sizes, sizeof(sizes));
+	memcpy(&(head[24]), ints, sizeof(ints));
+	memcpy(&(head[24 + sizeof(ints)]), floats, sizeof(floats));
+
+	fp = fopen(filename, "wb");
+	if (!fp) {
+		scs_printf("ERROR: could not open %s for writing\n", filename);
+		return -1;
+	}
+	ok = fwrite(head, 1, HEADER_LEN, fp) == HEADER_LEN;
+	ok = ok && writeSection(fp, &off, k->q, ints[H_QSIZE] * is) == 0;
+	ok = ok && writeSection(fp, &off, k->s, ints[H_SSIZE] * is) == 0;
+	ok = ok && writeSection(fp, &off, k->sp, ints[H_SPSIZE] * is) == 0;
+	ok = ok && writeSection(fp, &off, d->A->p, (d->n + 1) * is) == 0;
+	ok = ok && writeSection(fp, &off, d->A->i, nnz * is) == 0;
+	ok = ok && writeSection(fp, &off, d->A->x, nnz * fs) == 0;
+	ok = ok && writeSection(fp, &off, d->b, d->m * fs) == 0;
+	ok = ok && writeSection(fp, &off, d->c, d->n * fs) == 0;
+	if (warm) {
+		ok = ok && writeSection(fp, &off, sol->x, d->n * fs) == 0;
+		ok = ok && writeSection(fp, &off, sol->y, d->m * fs) == 0;
+		ok = ok && writeSection(fp, &off, sol->s, d->m * fs) == 0;
+	}
+	ok = (fclose(fp) == 0) && ok;
+	if (!ok) {
+		scs_printf("ERROR: failed writing %s\n", filename);
+		return -1;
+	}
+	return 0;
+}
+
+void scs_free_data_file(DataFile * f) {
+	idxint i;
+	if (!f)
+		return;
+	for (i = 0; i < f->nOwned; ++i) {
+		scs_free(f->owned[i]);
+	}
+	if (f->base) {
+#ifdef SCS_MMAP
+		if (f->mapped)
+			munmap(f->base, f->len);
+		else
+#endif
+			scs_free(f->base);
+	}
+	if (f->d) {
+		if (f->d->A)
+			scs_free(f->d->A);
+		scs_free(f->d);
+	}
+	if (f->k)
+		scs_free(f->k);
+	scs_free(f);
+}
+
+/* maps or reads the whole file into f->base */
+static idxint loadFile(DataFile * f, const char * filename, idxint useMmap) {
+	FILE * fp;
+	long len;
+#ifdef SCS_MMAP
+	if (useMmap) {
+		struct stat st;
+		int fd = open(filename, O_RDONLY);
+		void * base;
+		if (fd < 0)
+			return -1;
+		if (fstat(fd, &st) < 0 || st.st_size < HEADER_LEN) {
+			close(fd);
+			return -1;
+		}
+		base = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (base == MAP_FAILED)
+			return -1;
+		f->base = base;
+		f->len = (size_t) st.st_size;
+		f->mapped = 1;
+		return 0;
+	}
+#endif
+	fp = fopen(filename, "rb");
+	if (!fp)
+		return -1;
+	if (fseek(fp, 0, SEEK_END) != 0 || (len = ftell(fp)) < HEADER_LEN || fseek(fp, 0, SEEK_SET) != 0) {
+		fclose(fp);
+		return -1;
+	}
+	f->base = scs_malloc((size_t) len);
+	f->len = (size_t) len;
+	if (!f->base || fread(f->base, 1, f->len, fp) != f->len) {
+		fclose(fp);
+		return -1;
+	}
+	fclose(fp);
+	return 0;
+}
+
+/* the array of len entries of size srcSize at *off in the file, in place if srcSize is the size of this build
+ (dstSize), otherwise converted into an array owned by f, moves *off past it */
+static void * readSection(DataFile * f, size_t * off, int64_t len, size_t srcSize, size_t dstSize, idxint isFloat) {
+	char * src;
+	void * dst;
+	int64_t i;
+	if (len == 0)
+		return NULL;
+	*off = alignUp(*off);
+	src = &(f->base[*off]);
+	*off += (size_t) len * srcSize;
+	if (srcSize == dstSize)
+		return src;
+	dst = scs_malloc((size_t) len * dstSize);
+	if (!dst)
+		return NULL;
+	f->owned[f->nOwned++] = dst;
+	for (i = 0; i < len; ++i) {
+		if (isFloat) {
+			((pfloat *) dst)[i] = (pfloat) (srcSize == 4 ? ((float *) src)[i] : ((double *) src)[i]);
+		} else {
+			((idxint *) dst)[i] = (idxint) (srcSize == 4 ? ((int32_t *) src)[i] : ((int64_t *) src)[i]);
+		}
+	}
+	return dst;
+}
+
+/* bytes the arrays of a file with header ints take */
+static size_t dataLen(const int64_t * ints, size_t is, size_t fs) {
+	int64_t lens[11];
+	size_t off = HEADER_LEN, sz;
+	idxint i;
+	lens[0] = ints[H_QSIZE];
+	lens[1] = ints[H_SSIZE];
+	lens[2] = ints[H_SPSIZE];
+	lens[3] = ints[H_N] + 1;
+	lens[4] = ints[H_NNZ];
+	lens[5] = ints[H_NNZ];
+	lens[6] = ints[H_M];
+	lens[7] = ints[H_N];
+	lens[8] = ints[H_WARM] ? ints[H_N] : 0;
+	lens[9] = ints[H_WARM] ? ints[H_M] : 0;
+	lens[10] = ints[H_WARM] ? ints[H_M] : 0;
+	for (i = 0; i < 11; ++i) {
+		sz = i < 5 ? is : fs;
+		if (lens[i] > 0)
+			off = alignUp(off) + (size_t) lens[i] * sz;
+	}
+	return off;
+}
+
+DataFile * scs_read_data(const char * filename, idxint useMmap, Data ** d, Cone ** k, Sol * sol) {
+	DataFile * f;
+	uint32_t sizes[4];
+	int64_t ints[NUM_HEADER_INTS];
+	double floats[NUM_HEADER_FLOATS];
+	size_t off = HEADER_LEN, is, fs;
+	idxint i;
+	pfloat * warm[3];
+	if (!filename || !d || !k) {
+		scs_printf("ERROR: NULL input\n");
+		return NULL;
+	}
+	f = scs_calloc(1, sizeof(DataFile));
+	if (!f)
+		return NULL;
+	if (loadFile(f, filename, useMmap) < 0) {
+		scs_printf("ERROR: could not read %s\n", filename);
+		scs_free_data_file(f);
+		return NULL;
+	}
+	memcpy(sizes, &(f->base[8]), sizeof(sizes));
+	memcpy(ints, &(f->base[24]), sizeof(ints));
+	memcpy(floats, &(f->base[24 + sizeof(ints)]), sizeof(floats));
+	is = sizes[2];
+	fs = sizes[3];
+	if (memcmp(f->base, SCS_DATA_MAGIC, 8) != 0 || sizes[0] > SCS_DATA_VERSION || sizes[1] != BYTE_ORDER_MARK
+			|| (is != 4 && is != 8) || (fs != 4 && fs != 8)) {
+		scs_printf("ERROR: %s is not an scs data file of version <= %i in this byte order\n", filename,
+				SCS_DATA_VERSION);
+		scs_free_data_file(f);
+		return NULL;
+	}
+	for (i = 0; i < H_MAX_ITERS; ++i) {
+		if (ints[i] < 0) {
+			scs_printf("ERROR: negative dimension in %s\n", filename);
+			scs_free_data_file(f);
+			return NULL;
+		}
+	}
+	if (dataLen(ints, is, fs) > f->len) {
+		scs_printf("ERROR: %s is truncated\n", filename);
+		scs_free_data_file(f);
+		return NULL;
+	}
+	f->d = scs_calloc(1, sizeof(Data));
+	f->k = scs_calloc(1, sizeof(Cone));
+	if (!f->d || !f->k || !(f->d->A = scs_calloc(1, sizeof(AMatrix)))) {
+		scs_free_data_file(f);
+		return NULL;
+	}
+	f->d->m = (idxint) ints[H_M];
+	f->d->n = (idxint) ints[H_N];
+	f->d->MAX_ITERS = (idxint) ints[H_MAX_ITERS];
+	f->d->NORMALIZE = (idxint) ints[H_NORMALIZE];
+	f->d->EPS = (pfloat) floats[H_EPS];
+	f->d->ALPHA = (pfloat) floats[H_ALPHA];
+	f->d->RHO_X = (pfloat) floats[H_RHO_X];
+	f->d->SCALE = (pfloat) floats[H_SCALE];
+	f->d->CG_RATE = (pfloat) floats[H_CG_RATE];
+	f->k->f = (idxint) ints[H_F];
+	f->k->l = (idxint) ints[H_L];
+	f->k->qsize = (idxint) ints[H_QSIZE];
+	f->k->ssize = (idxint) ints[H_SSIZE];
+	f->k->spsize = (idxint) ints[H_SPSIZE];
+	f->k->ep = (idxint) ints[H_EP];
+	f->k->ed = (idxint) ints[H_ED];
+	/* NULL only for empty arrays, or if a conversion could not be allocated */
+	f->k->q = readSection(f, &off, ints[H_QSIZE], is, sizeof(idxint), 0);
+	f->k->s = readSection(f, &off, ints[H_SSIZE], is, sizeof(idxint), 0);
+	f->k->sp = readSection(f, &off, ints[H_SPSIZE], is, sizeof(idxint), 0);
+	f->d->A->p = readSection(f, &off, ints[H_N] + 1, is, sizeof(idxint), 0);
+	f->d->A->i = readSection(f, &off, ints[H_NNZ], is, sizeof(idxint), 0);
+	f->d->A->x = readSection(f, &off, ints[H_NNZ], fs, sizeof(pfloat), 1);
+	f->d->b = readSection(f, &off, ints[H_M], fs, sizeof(pfloat), 1);
+	f->d->c = readSection(f, &off, ints[H_N], fs, sizeof(pfloat), 1);
+	if ((ints[H_QSIZE] && !f->k->q) || (ints[H_SSIZE] && !f->k->s) || (ints[H_SPSIZE] && !f->k->sp)
+			|| !f->d->A->p || (ints[H_NNZ] && (!f->d->A->i || !f->d->A->x)) || (ints[H_M] && !f->d->b)
+			|| (ints[H_N] && !f->d->c)) {
+		scs_printf("ERROR: memory allocation failure reading %s\n", filename);
+		scs_free_data_file(f);
+		return NULL;
+	}
+	if (ints[H_WARM] && sol) {
+		for (i = 0; i < 3; ++i) {
+			idxint len = i == 0 ? f->d->n : f->d->m;
+			pfloat * v = readSection(f, &off, len, fs, sizeof(pfloat), 1);
+			warm[i] = scs_malloc(MAX(len, 1) * sizeof(pfloat));
+			if (!warm[i] || (len > 0 && !v)) {
+				scs_printf("ERROR: memory allocation failure reading %s\n", filename);
+				while (i >= 0) {
+					if (warm[i])
+						scs_free(warm[i]);
+					--i;
+				}
+				scs_free_data_file(f);
+				return NULL;
+			}
+			memcpy(warm[i], v, len * sizeof(pfloat));
+		}
+		sol->x = warm[0];
+		sol->y = warm[1];
+		sol->s = warm[2];
+		f->d->WARM_START = 1;
+	}
+	*d = f->d;
+	*k = f->k;
+	return f;
+}
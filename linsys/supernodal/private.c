@@ -0,0 +1,787 @@
+#include "private.h"
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+/* columns per block in the dense front kernels */
+#define BLOCK_SIZE 64
+/* relaxed supernode amalgamation, as in CHOLMOD: merging a column into a supernode is
+ * accepted if the supernode stays small or few explicit zeros are added to L */
+#define RELAX_COLS_ANY 4
+#define RELAX_COLS_SMALL 16
+#define RELAX_ZEROS_SMALL 0.8
+#define RELAX_COLS_MEDIUM 48
+#define RELAX_ZEROS_MEDIUM 0.1
+#define RELAX_ZEROS_LARGE 0.05
+/* aim for about this many independent subtrees per thread so dynamic scheduling can balance load */
+#define SUBTREES_PER_THREAD 4
+/* below this many estimated flops the factorization is not worth running in parallel */
+#define MIN_PARALLEL_FACTOR_COST 1e6
+
+#ifdef LAPACK_LIB_FOUND
+void BLAS(gemm)(const char *transa, const char *transb, const blasint *m, const blasint *n, const blasint *k,
+		const pfloat *alpha, const pfloat *a, const blasint *lda, const pfloat *b, const blasint *ldb,
+		const pfloat *beta, pfloat *c, const blasint *ldc);
+#endif
+
+char * getLinSysMethod(Data * d, Priv * p) {
+	char * tmp = scs_malloc(sizeof(char) * 128);
+	idxint nThreads = 1;
+#ifdef OPENMP
+	nThreads = omp_get_max_threads();
+#endif
+	sprintf(tmp, "sparse-direct supernodal, nnz in A = %li, threads = %li%s", (long) d->A->p[d->n], (long) nThreads,
+			d->STORE_TRANSPOSE ? ", storing A'" : "");
+	return tmp;
+}
+
+char * getLinSysSummary(Priv * p, Info * info) {
+	char * str = scs_malloc(sizeof(char) * 192);
+	sprintf(str, "\tLin-sys: nnz in L factor: %li, supernodes: %li, tree height: %li (%s), avg solve time: %1.2es\n",
+			(long) p->nnzL, (long) p->nSuper, (long) p->treeHeight, orderingName(p->ordering),
+			p->totalSolveTime / (info->iter + 1) / 1e3);
+	return str;
+}
+
+void freePriv(Priv * p) {
+	if (p) {
+		freeAScaling(&(p->As));
+		if (p->P)
+			scs_free(p->P);
+		if (p->Pinv)
+			scs_free(p->Pinv);
+		if (p->super)
+			scs_free(p->super);
+		if (p->sParent)
+			scs_free(p->sParent);
+		if (p->sChildp)
+			scs_free(p->sChildp);
+		if (p->sChild)
+			scs_free(p->sChild);
+		if (p->Lip)
+			scs_free(p->Lip);
+		if (p->Li)
+			scs_free(p->Li);
+		if (p->Lxp)
+			scs_free(p->Lxp);
+		if (p->Lx)
+			scs_free(p->Lx);
+		if (p->D)
+			scs_free(p->D);
+		if (p->subtrees)
+			scs_free(p->subtrees);
+		if (p->top)
+			scs_free(p->top);
+		if (p->relMap)
+			scs_free(p->relMap);
+		if (p->bp)
+			scs_free(p->bp);
+		if (p->Atx)
+			scs_free(p->Atx);
+		if (p->Ati)
+			scs_free(p->Ati);
+		if (p->Atp)
+			scs_free(p->Atp);
+		scs_free(p);
+	}
+}
+
+void _accumByAtrans(idxint n, pfloat * Ax, rowidx * Ai, idxint * Ap, const pfloat *x, pfloat *y) {
+	/* y  = A'*x
+	 A in column compressed format
+	 parallelizes over columns (rows of A')
+	 */
+	idxint p, j;
+	idxint c1, c2;
+	pfloat yj;
+#ifdef OPENMP
+#pragma omp parallel for private(p,c1,c2,yj)
+#endif
+	for (j = 0; j < n; j++) {
+		yj = y[j];
+		c1 = Ap[j];
+		c2 = Ap[j + 1];
+		for (p = c1; p < c2; p++) {
+			yj += Ax[p] * x[Ai[p]];
+		}
+		y[j] = yj;
+	}
+}
+
+void accumByAtrans(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	accumByScaledAtrans(d, &(p->As), x, y);
+}
+void accumByA(Data * d, Priv * p, const pfloat *x, pfloat *y) {
+	/* the stored A' is already normalized, otherwise the serial product with the scaling applied on the fly */
+	if (p->Atx) {
+		_accumByAtrans(d->m, p->Atx, p->Ati, p->Atp, x, y);
+	} else {
+		accumByScaledA(d, &(p->As), x, y);
+	}
+}
+
+static idxint orderKKT(Data * d, cs * K, idxint * P) {
+	idxint amd_status;
+	pfloat * info;
+	if (d->ORDERING != ORDER_AMD) {
+		return orderPattern(d, K, P) < 0 ? -1 : 0;
+	}
+	info = scs_malloc(AMD_INFO * sizeof(pfloat));
+	if (!info)
+		return -1;
+#ifdef DLONG
+	amd_status = amd_l_order(K->n, K->p, K->i, P, (pfloat *) NULL, info);
+#else
+	amd_status = amd_order(K->n, K->p, K->i, P, (pfloat *) NULL, info);
+#endif
+#ifdef EXTRAVERBOSE
+	scs_printf("Matrix factorization info:\n");
+#ifdef DLONG
+	amd_l_info(info);
+#else
+	amd_info(info);
+#endif
+#endif
+	scs_free(info);
+	return amd_status;
+}
+
+/* lower triangular part of the symmetric matrix C, given its upper triangular part */
+static cs * lowerKKT(const cs * C, idxint values) {
+	idxint j, k, q, n = C->n;
+	idxint * w = scs_calloc(n, sizeof(idxint));
+	cs * T = cs_spalloc(n, n, C->p[n], values, 0);
+	if (!w || !T) {
+		if (w)
+			scs_free(w);
+		return cs_spfree(T);
+	}
+	for (k = 0; k < C->p[n]; k++)
+		w[C->i[k]]++;
+	cs_cumsum(T->p, w, n);
+	for (j = 0; j < n; j++) {
+		for (k = C->p[j]; k < C->p[j + 1]; k++) {
+			q = w[C->i[k]]++;
+			T->i[q] = j;
+			if (values)
+				T->x[q] = C->x[k];
+		}
+	}
+	scs_free(w);
+	return T;
+}
+
+/* postorder of the forest given by Parent, children of a node are visited in increasing order */
+static idxint postorder(const idxint * Parent, idxint n, idxint * post) {
+	idxint j, c, top, k = 0;
+	idxint * head = scs_malloc(n * sizeof(idxint));
+	idxint * next = scs_malloc(n * sizeof(idxint));
+	idxint * stack = scs_malloc(n * sizeof(idxint));
+	if (head && next && stack) {
+		for (j = 0; j < n; j++)
+			head[j] = -1;
+		for (j = n - 1; j >= 0; j--) {
+			if (Parent[j] != -1) {
+				next[j] = head[Parent[j]];
+				head[Parent[j]] = j;
+			}
+		}
+		for (j = 0; j < n; j++) {
+			if (Parent[j] != -1)
+				continue;
+			top = 0;
+			stack[0] = j;
+			while (top >= 0) {
+				c = head[stack[top]];
+				if (c == -1) {
+					post[k++] = stack[top--];
+				} else {
+					head[stack[top]] = next[c];
+					stack[++top] = c;
+				}
+			}
+		}
+	}
+	if (head)
+		scs_free(head);
+	if (next)
+		scs_free(next);
+	if (stack)
+		scs_free(stack);
+	return k == n ? 0 : -1;
+}
+
+static idxint relaxMerge(idxint nc, pfloat zeros) {
+	if (nc <= RELAX_COLS_ANY)
+		return 1;
+	if (nc <= RELAX_COLS_SMALL && zeros < RELAX_ZEROS_SMALL)
+		return 1;
+	if (nc <= RELAX_COLS_MEDIUM && zeros < RELAX_ZEROS_MEDIUM)
+		return 1;
+	return zeros < RELAX_ZEROS_LARGE;
+}
+
+/* partitions the columns of the postordered KKT matrix into relaxed supernodes and sets up the
+ * supernodal elimination tree and the sizes of the row structures and dense panels of L.
+ * A supernode is a chain of columns f, ..., l with Parent[j] = j + 1, so its row structure
+ * is its own columns followed by the pattern of column l of L, with Lnz[l] entries */
+static idxint findSupernodes(Priv * p, const idxint * Parent, const idxint * Lnz, idxint * colToSuper) {
+	idxint j, s, f, l, nc, nr, n = p->n;
+	pfloat nzTrue, stored;
+	p->super = scs_malloc((n + 1) * sizeof(idxint));
+	if (!p->super)
+		return -1;
+	s = 0;
+	p->super[0] = 0;
+	nzTrue = 1 + Lnz[0];
+	for (j = 1; j < n; j++) {
+		if (Parent[j - 1] == j) {
+			f = p->super[s];
+			nc = j - f + 1;
+			nr = nc + Lnz[j];
+			stored = (pfloat) nc * nr - (pfloat) nc * (nc - 1) / 2;
+			if (relaxMerge(nc, 1 - (nzTrue + 1 + Lnz[j]) / stored)) {
+				nzTrue += 1 + Lnz[j];
+				continue;
+			}
+		}
+		p->super[++s] = j;
+		nzTrue = 1 + Lnz[j];
+	}
+	p->nSuper = s + 1;
+	p->super[p->nSuper] = n;
+
+	p->sParent = scs_malloc(p->nSuper * sizeof(idxint));
+	p->sChildp = scs_malloc((p->nSuper + 1) * sizeof(idxint));
+	p->sChild = scs_malloc(p->nSuper * sizeof(idxint));
+	p->Lip = scs_malloc((p->nSuper + 1) * sizeof(idxint));
+	p->Lxp = scs_malloc((p->nSuper + 1) * sizeof(idxint));
+	if (!p->sParent || !p->sChildp || !p->sChild || !p->Lip || !p->Lxp)
+		return -1;
+	for (s = 0; s < p->nSuper; s++) {
+		for (j = p->super[s]; j < p->super[s + 1]; j++)
+			colToSuper[j] = s;
+	}
+	p->Lip[0] = 0;
+	p->Lxp[0] = 0;
+	p->nnzL = 0;
+	for (s = 0; s < p->nSuper; s++) {
+		f = p->super[s];
+		l = p->super[s + 1] - 1;
+		nc = l - f + 1;
+		nr = nc + Lnz[l];
+		p->sParent[s] = Parent[l] == -1 ? -1 : colToSuper[Parent[l]];
+		p->Lip[s + 1] = p->Lip[s] + nr;
+		p->Lxp[s + 1] = p->Lxp[s] + nr * nc;
+		p->nnzL += nr * nc - nc * (nc - 1) / 2;
+	}
+	/* children in increasing order, colToSuper is reused as workspace */
+	memset(colToSuper, 0, p->nSuper * sizeof(idxint));
+	for (s = 0; s < p->nSuper; s++) {
+		if (p->sParent[s] != -1)
+			colToSuper[p->sParent[s]]++;
+	}
+	cs_cumsum(p->sChildp, colToSuper, p->nSuper);
+	for (s = 0; s < p->nSuper; s++) {
+		if (p->sParent[s] != -1)
+			p->sChild[colToSuper[p->sParent[s]]++] = s;
+	}
+	return 0;
+}
+
+static int cmpIdxint(const void * a, const void * b) {
+	idxint ia = *(const idxint *) a, ib = *(const idxint *) b;
+	return ia < ib ? -1 : (ia > ib);
+}
+
+/* row structure of each supernode: its own columns, then the union of the rows below it in
+ * its columns of the lower triangular KKT matrix Cl and in the structures of its children */
+static idxint rowStructure(Priv * p, const cs * Cl, idxint * mark) {
+	idxint s, c, j, k, q, f, l, nc, ncc, row;
+	p->Li = scs_malloc(p->Lip[p->nSuper] * sizeof(idxint));
+	if (!p->Li)
+		return -1;
+	for (j = 0; j < p->n; j++)
+		mark[j] = -1;
+	for (s = 0; s < p->nSuper; s++) {
+		f = p->super[s];
+		l = p->super[s + 1] - 1;
+		nc = l - f + 1;
+		q = p->Lip[s];
+		for (j = f; j <= l; j++) {
+			p->Li[q++] = j;
+			mark[j] = s;
+		}
+		for (j = f; j <= l; j++) {
+			for (k = Cl->p[j]; k < Cl->p[j + 1]; k++) {
+				row = Cl->i[k];
+				if (mark[row] != s) {
+					mark[row] = s;
+					p->Li[q++] = row;
+				}
+			}
+		}
+		for (k = p->sChildp[s]; k < p->sChildp[s + 1]; k++) {
+			c = p->sChild[k];
+			ncc = p->super[c + 1] - p->super[c];
+			for (j = p->Lip[c] + ncc; j < p->Lip[c + 1]; j++) {
+				row = p->Li[j];
+				if (mark[row] != s) {
+					mark[row] = s;
+					p->Li[q++] = row;
+				}
+			}
+		}
+		if (q != p->Lip[s + 1]) {
+			scs_printf("supernodal structure mismatch in supernode %li\n", (long) s);
+			return -1;
+		}
+		qsort(p->Li + p->Lip[s] + nc, q - p->Lip[s] - nc, sizeof(idxint), cmpIdxint);
+	}
+	return 0;
+}
+
+static int cmpSubtreeCost(const void * a, const void * b) {
+	pfloat ca = ((const Subtree *) a)->cost, cb = ((const Subtree *) b)->cost;
+	return ca > cb ? -1 : (ca < cb);
+}
+
+/* splits the supernodal elimination tree into independent subtrees of bounded cost, which are
+ * factored in parallel, and the supernodes above them, which are factored in postorder after */
+static idxint scheduleFactor(Priv * p) {
+	idxint s, k, nc, nr, par;
+	pfloat total = 0, target;
+	pfloat * cost = scs_calloc(p->nSuper, sizeof(pfloat));
+	idxint * first = scs_malloc(p->nSuper * sizeof(idxint));
+	p->subtrees = scs_malloc(p->nSuper * sizeof(Subtree));
+	p->top = scs_malloc(p->nSuper * sizeof(idxint));
+	if (!cost || !first || !p->subtrees || !p->top) {
+		if (cost)
+			scs_free(cost);
+		if (first)
+			scs_free(first);
+		return -1;
+	}
+#ifdef OPENMP
+	p->nThreads = omp_get_max_threads();
+#else
+	p->nThreads = 1;
+#endif
+	/* cost of the subtree rooted at each supernode, children come before their parent */
+	for (s = 0; s < p->nSuper; s++)
+		first[s] = s;
+	for (s = 0; s < p->nSuper; s++) {
+		nc = p->super[s + 1] - p->super[s];
+		nr = p->Lip[s + 1] - p->Lip[s];
+		for (k = 0; k < nc; k++)
+			cost[s] += (pfloat) (nr - k) * (nr - k);
+		par = p->sParent[s];
+		if (par != -1) {
+			cost[par] += cost[s];
+			first[par] = MIN(first[par], first[s]);
+		} else {
+			total += cost[s];
+		}
+	}
+	target = (p->nThreads > 1 && total > MIN_PARALLEL_FACTOR_COST) ? total / (p->nThreads * SUBTREES_PER_THREAD) : total;
+	p->nSubtrees = 0;
+	p->nTop = 0;
+	for (s = 0; s < p->nSuper; s++) {
+		par = p->sParent[s];
+		if (cost[s] > target) {
+			p->top[p->nTop++] = s;
+		} else if (par == -1 || cost[par] > target) {
+			p->subtrees[p->nSubtrees].first = first[s];
+			p->subtrees[p->nSubtrees].last = s;
+			p->subtrees[p->nSubtrees].cost = cost[s];
+			p->nSubtrees++;
+		}
+	}
+	qsort(p->subtrees, p->nSubtrees, sizeof(Subtree), cmpSubtreeCost);
+	scs_free(cost);
+	scs_free(first);
+	p->relMap = scs_malloc(p->nThreads * p->n * sizeof(idxint));
+	return p->relMap ? 0 : -1;
+}
+
+/* fill-reducing ordering, postorder of the elimination tree and supernodal symbolic analysis */
+static idxint symbolic(Data * d, Priv * p) {
+	idxint k, n = p->n, status = -1;
+	idxint * Pinv, * amdP = NULL;
+	cs * C = NULL, * Cl = NULL, * K = formKKT(d, &(p->As), NULL, 0);
+	idxint * Lp = scs_malloc((n + 1) * sizeof(idxint));
+	idxint * Parent = scs_malloc(n * sizeof(idxint));
+	idxint * Lnz = scs_malloc(n * sizeof(idxint));
+	idxint * Flag = scs_malloc(n * sizeof(idxint));
+	idxint * work = scs_malloc(n * sizeof(idxint));
+	if (K && Lp && Parent && Lnz && Flag && work && orderKKT(d, K, work) >= 0) {
+		/* elimination tree of the ordered matrix, then postorder it */
+		amdP = work;
+		Pinv = cs_pinv(amdP, n);
+		C = Pinv ? formKKT(d, &(p->As), Pinv, 0) : NULL;
+		if (Pinv)
+			scs_free(Pinv);
+	}
+	if (K) {
+		cs_spfree(K);
+		K = NULL;
+	}
+	if (C) {
+		LDL_symbolic(n, C->p, C->i, Lp, Parent, Lnz, Flag, NULL, NULL);
+		cs_spfree(C);
+		C = NULL;
+		if (postorder(Parent, n, Flag) == 0) {
+			for (k = 0; k < n; k++)
+				p->P[k] = amdP[Flag[k]];
+			p->Pinv = cs_pinv(p->P, n);
+			C = p->Pinv ? formKKT(d, &(p->As), p->Pinv, 0) : NULL;
+		}
+	}
+	if (C) {
+		LDL_symbolic(n, C->p, C->i, Lp, Parent, Lnz, Flag, NULL, NULL);
+		p->ordering = d->ORDERING;
+		p->lnz = Lp[n];
+		p->treeHeight = etreeHeight(Parent, n);
+		Cl = lowerKKT(C, 0);
+	}
+	if (Cl && findSupernodes(p, Parent, Lnz, work) == 0 && rowStructure(p, Cl, Flag) == 0) {
+		status = scheduleFactor(p);
+	}
+	if (K)
+		cs_spfree(K);
+	if (C)
+		cs_spfree(C);
+	if (Cl)
+		cs_spfree(Cl);
+	if (Lp)
+		scs_free(Lp);
+	if (Parent)
+		scs_free(Parent);
+	if (Lnz)
+		scs_free(Lnz);
+	if (Flag)
+		scs_free(Flag);
+	if (work)
+		scs_free(work);
+	return status;
+}
+
+/* lower triangle of C -= W * L', C is nt x nt, W is nt x nb, L is nt x nb, C and L have leading dimension ld */
+static void updateTrailing(pfloat * C, idxint ld, idxint nt, idxint nb, const pfloat * W, const pfloat * L) {
+#ifdef LAPACK_LIB_FOUND
+	idxint jb;
+	blasint m, nn, kk = (blasint) nb, ldw = (blasint) nt, ldb = (blasint) ld;
+	pfloat negOne = -1.0, one = 1.0;
+	/* block columns of the lower triangle */
+	for (jb = 0; jb < nt; jb += BLOCK_SIZE) {
+		m = (blasint) (nt - jb);
+		nn = (blasint) MIN(BLOCK_SIZE, nt - jb);
+		BLAS(gemm)("NoTranspose", "Transpose", &m, &nn, &kk, &negOne, W + jb, &ldw, L + jb, &ldb, &one, C + jb + jb * ld,
+				&ldb);
+	}
+#else
+	idxint i, j, k;
+	pfloat t, *Cj;
+	const pfloat * Lk;
+	for (j = 0; j < nt; j++) {
+		Cj = C + j * ld;
+		for (k = 0; k < nb; k++) {
+			t = W[j + k * nt];
+			Lk = L + k * ld;
+			for (i = j; i < nt; i++)
+				Cj[i] -= Lk[i] * t;
+		}
+	}
+#endif
+}
+
+/* blocked partial LDL' factorization of the first nc columns of the dense nr x nr front F (lower
+ * triangle, column major): leaves L21, L11 (unit diagonal, D on the diagonal) in those columns
+ * and the Schur complement in the trailing columns, W is nr * BLOCK_SIZE workspace */
+static idxint factorFront(pfloat * F, idxint nr, idxint nc, pfloat * W) {
+	idxint i, j, k, kb, nb, r0, nt;
+	pfloat dk, ljk, *Fj, *Fk;
+	for (kb = 0; kb < nc; kb += BLOCK_SIZE) {
+		nb = MIN(BLOCK_SIZE, nc - kb);
+		for (k = kb; k < kb + nb; k++) {
+			Fk = F + k * nr;
+			dk = Fk[k];
+			if (dk == 0)
+				return -1;
+			for (j = k + 1; j < kb + nb; j++) {
+				Fj = F + j * nr;
+				ljk = Fk[j] / dk;
+				for (i = j; i < nr; i++)
+					Fj[i] -= ljk * Fk[i];
+			}
+			for (i = k + 1; i < nr; i++)
+				Fk[i] /= dk;
+		}
+		r0 = kb + nb;
+		nt = nr - r0;
+		if (nt > 0) {
+			for (k = 0; k < nb; k++) {
+				Fk = F + (kb + k) * nr;
+				dk = Fk[kb + k];
+				for (i = 0; i < nt; i++)
+					W[i + k * nt] = Fk[r0 + i] * dk;
+			}
+			updateTrailing(F + r0 + r0 * nr, nr, nt, nb, W, F + r0 + kb * nr);
+		}
+	}
+	return 0;
+}
+
+/* assembles the front of supernode s from the lower triangular KKT matrix Cl and the update
+ * matrices of its children, factors it and keeps its update matrix for the parent */
+static idxint factorSupernode(Priv * p, const cs * Cl, pfloat ** fronts, idxint s, idxint * map) {
+	idxint a, b, c, j, k, q, ncc, nrc, col, status;
+	idxint f = p->super[s], nc = p->super[s + 1] - f, nr = p->Lip[s + 1] - p->Lip[s];
+	idxint * rows = p->Li + p->Lip[s], *crows;
+	pfloat * Fc, * Fj;
+	pfloat * F = scs_calloc(nr * nr, sizeof(pfloat));
+	pfloat * W = scs_malloc(nr * BLOCK_SIZE * sizeof(pfloat));
+	if (!F || !W) {
+		if (F)
+			scs_free(F);
+		if (W)
+			scs_free(W);
+		return -1;
+	}
+	for (a = 0; a < nr; a++)
+		map[rows[a]] = a;
+	for (k = 0; k < nc; k++) {
+		j = f + k;
+		for (q = Cl->p[j]; q < Cl->p[j + 1]; q++)
+			F[map[Cl->i[q]] + k * nr] += Cl->x[q];
+	}
+	/* extend-add, row structures are sorted so the update matrices map into the lower triangle */
+	for (q = p->sChildp[s]; q < p->sChildp[s + 1]; q++) {
+		c = p->sChild[q];
+		Fc = fronts[c];
+		if (!Fc)
+			continue;
+		ncc = p->super[c + 1] - p->super[c];
+		nrc = p->Lip[c + 1] - p->Lip[c];
+		crows = p->Li + p->Lip[c];
+		for (b = ncc; b < nrc; b++) {
+			col = map[crows[b]];
+			Fj = F + col * nr;
+			for (a = b; a < nrc; a++)
+				Fj[map[crows[a]]] += Fc[a + b * nrc];
+		}
+		scs_free(Fc);
+		fronts[c] = NULL;
+	}
+	status = factorFront(F, nr, nc, W);
+	scs_free(W);
+	if (status == 0) {
+		memcpy(p->Lx + p->Lxp[s], F, nr * nc * sizeof(pfloat));
+		for (k = 0; k < nc; k++)
+			p->D[f + k] = F[k + k * nr];
+	}
+	if (status == 0 && nr > nc) {
+		fronts[s] = F;
+	} else {
+		scs_free(F);
+	}
+	return status;
+}
+
+/* multifrontal numeric factorization, re-uses the ordering and symbolic analysis */
+static idxint numeric(Data * d, Priv * p) {
+	idxint s, t, nFailed = 0;
+	pfloat ** fronts;
+	timer phaseTimer;
+	cs * C, * Cl;
+	tic(&phaseTimer);
+	C = formKKT(d, &(p->As), p->Pinv, 1);
+	if (!C) {
+		return -1;
+	}
+	Cl = lowerKKT(C, 1);
+	cs_spfree(C);
+	p->kktTime = tocq(&phaseTimer);
+	tic(&phaseTimer);
+	fronts = scs_calloc(p->nSuper, sizeof(pfloat *));
+	if (!Cl || !fronts) {
+		if (Cl)
+			cs_spfree(Cl);
+		if (fronts)
+			scs_free(fronts);
+		return -1;
+	}
+	if (!p->Lx) {
+		p->Lx = scs_malloc(p->Lxp[p->nSuper] * sizeof(pfloat));
+		if (!p->Lx) {
+			cs_spfree(Cl);
+			scs_free(fronts);
+			return -1;
+		}
+	}
+#ifdef EXTRAVERBOSE
+	scs_printf("numeric factorization: %li subtrees, %li supernodes above them\n", (long) p->nSubtrees, (long) p->nTop);
+#endif
+	/* independent subtrees in parallel, largest first */
+#ifdef OPENMP
+#pragma omp parallel for private(s) schedule(dynamic, 1) num_threads(p->nThreads) reduction(+:nFailed) if (p->nSubtrees > 1 && p->nThreads > 1)
+#endif
+	for (t = 0; t < p->nSubtrees; t++) {
+		idxint * map = p->relMap;
+#ifdef OPENMP
+		map += omp_get_thread_num() * p->n;
+#endif
+		for (s = p->subtrees[t].first; s <= p->subtrees[t].last; s++) {
+			if (factorSupernode(p, Cl, fronts, s, map) < 0) {
+				nFailed++;
+				break;
+			}
+		}
+	}
+	/* supernodes above the subtrees, the dense kernels are threaded by BLAS here */
+	for (t = 0; t < p->nTop && !nFailed; t++) {
+		if (factorSupernode(p, Cl, fronts, p->top[t], p->relMap) < 0)
+			nFailed++;
+	}
+	for (s = 0; s < p->nSuper; s++) {
+		if (fronts[s])
+			scs_free(fronts[s]);
+	}
+	scs_free(fronts);
+	cs_spfree(Cl);
+	p->factorTime = tocq(&phaseTimer);
+	return nFailed ? -1 : 0;
+}
+
+/* solves L D L' x = b in place, x and b in the permuted ordering */
+static void supernodalSolve(Priv * p, pfloat * x) {
+	idxint s, i, k, f, nc, nr, *rows;
+	pfloat xk;
+	const pfloat * Lk;
+	for (s = 0; s < p->nSuper; s++) {
+		f = p->super[s];
+		nc = p->super[s + 1] - f;
+		nr = p->Lip[s + 1] - p->Lip[s];
+		rows = p->Li + p->Lip[s];
+		for (k = 0; k < nc; k++) {
+			xk = x[f + k];
+			if (xk == 0)
+				continue;
+			Lk = p->Lx + p->Lxp[s] + k * nr;
+			for (i = k + 1; i < nr; i++)
+				x[rows[i]] -= Lk[i] * xk;
+		}
+	}
+	for (i = 0; i < p->n; i++)
+		x[i] /= p->D[i];
+	for (s = p->nSuper - 1; s >= 0; s--) {
+		f = p->super[s];
+		nc = p->super[s + 1] - f;
+		nr = p->Lip[s + 1] - p->Lip[s];
+		rows = p->Li + p->Lip[s];
+		for (k = nc - 1; k >= 0; k--) {
+			xk = x[f + k];
+			Lk = p->Lx + p->Lxp[s] + k * nr;
+			for (i = k + 1; i < nr; i++)
+				xk -= Lk[i] * x[rows[i]];
+			x[f + k] = xk;
+		}
+	}
+}
+
+Priv * initPriv(Data * d, const pfloat * D, const pfloat * E) {
+	timer symbolicTimer;
+	Priv * p = scs_calloc(1, sizeof(Priv));
+	if (!p)
+		return NULL;
+	p->n = d->n + d->m;
+	p->P = scs_malloc(sizeof(idxint) * p->n);
+	p->D = scs_malloc(sizeof(pfloat) * p->n);
+	p->bp = scs_malloc(sizeof(pfloat) * p->n);
+	if (!p->P || !p->D || !p->bp || initAScaling(d, &(p->As), D, E) < 0) {
+		freePriv(p);
+		return NULL;
+	}
+	tic(&symbolicTimer);
+	if (symbolic(d, p) < 0) {
+		freePriv(p);
+		return NULL;
+	}
+	p->orderTime = tocq(&symbolicTimer);
+	if (numeric(d, p) < 0) {
+		freePriv(p);
+		return NULL;
+	}
+	if (d->STORE_TRANSPOSE) {
+		p->Ati = scs_malloc((d->A->p[d->n]) * sizeof(rowidx));
+		p->Atp = scs_malloc((d->m + 1) * sizeof(idxint));
+		p->Atx = scs_malloc((d->A->p[d->n]) * sizeof(pfloat));
+		if (!p->Ati || !p->Atp || !p->Atx) {
+			freePriv(p);
+			return NULL;
+		}
+		transposeA(d, &(p->As), p->Atx, p->Ati, p->Atp);
+	}
+	p->totalSolveTime = 0.0;
+	return p;
+}
+
+void setLinSysResidual(Priv * p, pfloat res) {
+}
+
+idxint getLinSysIters(Priv * p) {
+	return 0;
+}
+
+void getLinSysProfile(Priv * p, Profile * prof) {
+	prof->kktTime = p->kktTime;
+	prof->orderTime = p->orderTime;
+	prof->factorTime = p->factorTime;
+	prof->ordering = p->ordering;
+	prof->lnz = p->lnz;
+	prof->treeHeight = p->treeHeight;
+}
+
+idxint updateLinSys(Data * d, Priv * p) {
+	if (numeric(d, p) < 0) {
+		scs_printf("Error in numeric re-factorization\n");
+		return -1;
+	}
+	if (p->Atx) {
+		transposeA(d, &(p->As), p->Atx, p->Ati, p->Atp);
+	}
+	return 0;
+}
+
+idxint solveLinSys(Data * d, Priv * p, pfloat * b, const pfloat * s, idxint iter) {
+	/* returns solution to linear system */
+	/* Ax = b with solution stored in b */
+	idxint k;
+	timer linsysTimer;
+	if (iter == 0) {
+		/* the first step of a solve, the counters of the summary start over */
+		p->totalSolveTime = 0;
+	}
+	tic(&linsysTimer);
+	for (k = 0; k < p->n; k++)
+		p->bp[k] = b[p->P[k]];
+	supernodalSolve(p, p->bp);
+	for (k = 0; k < p->n; k++)
+		b[p->P[k]] = p->bp[k];
+	p->totalSolveTime += tocq(&linsysTimer);
+#ifdef EXTRAVERBOSE
+	scs_printf("linsys solve time: %1.2es\n", tocq(&linsysTimer) / 1e3);
+#endif
+	return 0;
+}
+
+/* no multi right hand side panel solve yet, one supernodal solve per right hand side */
+idxint solveLinSysBatch(Data * d, Priv * p, idxint K, pfloat ** b, const pfloat ** s, idxint iter) {
+	idxint k;
+	for (k = 0; k < K; ++k) {
+		if (solveLinSys(d, p, b[k], s ? s[k] : NULL, iter) < 0)
+			return -1;
+	}
+	return 0;
+}
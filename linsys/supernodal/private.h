@@ -0,0 +1,55 @@
+#ifndef PRIV_H_GUARD
+#define PRIV_H_GUARD
+
+#include "glbopts.h"
+#include "scs.h"
+#include "cs.h"
+#include "linsys/direct/external/amd.h"
+#include "linsys/direct/external/ldl.h"
+#include "linsys/direct/ordering.h"
+#include "linsys/common.h"
+
+/* a subtree of the supernodal elimination tree, supernodes [first, last] in postorder */
+typedef struct {
+	idxint first, last;
+	pfloat cost; /* estimated flops to factor the whole subtree */
+} Subtree;
+
+struct PRIVATE_DATA {
+	idxint n; /* size of KKT matrix, n + m */
+	idxint * P; /* permutation of KKT matrix for factorization (ORDERING, then postordered) */
+	idxint * Pinv; /* inverse permutation, kept for re-factorization */
+	/* supernodal structure of L */
+	idxint nSuper; /* number of supernodes */
+	idxint * super; /* first column of each supernode, size nSuper + 1 */
+	idxint * sParent; /* parent of each supernode, -1 for roots */
+	idxint * sChildp, * sChild; /* children of each supernode, column compressed */
+	idxint * Lip; /* start of each supernode's row structure in Li, size nSuper + 1 */
+	idxint * Li; /* sorted row structure of each supernode, its own columns first */
+	idxint * Lxp; /* start of each supernode's dense panel in Lx, size nSuper + 1 */
+	pfloat * Lx; /* dense column major panels of L, one per supernode */
+	pfloat * D; /* diagonal matrix of factorization */
+	/* factorization schedule: independent subtrees in parallel, then the rest in postorder */
+	idxint nThreads;
+	idxint nSubtrees;
+	Subtree * subtrees; /* sorted by decreasing cost */
+	idxint nTop;
+	idxint * top; /* supernodes above the subtrees, in postorder */
+	idxint * relMap; /* per thread map from row index to row of a frontal matrix, nThreads * n */
+	pfloat * bp; /* workspace memory for solves */
+	AScaling As; /* normalization of A, the KKT matrix and A' hold the normalized values */
+	/* A' in column compressed format, only stored if d->STORE_TRANSPOSE */
+	pfloat * Atx;
+	rowidx * Ati;
+	idxint * Atp;
+	/* reporting */
+	idxint nnzL;
+	idxint ordering; /* see Profile, lnz is below the diagonal of L (nnzL counts the explicit zeros of the panels) */
+	pfloat lnz;
+	idxint treeHeight;
+	pfloat totalSolveTime;
+	pfloat kktTime, orderTime, factorTime; /* orderTime of the ordering and symbolic analysis, the others of the
+	 last numeric factorization */
+};
+
+#endif
@@ -7,5 +7,5 @@ amd_files = {'amd_order', 'amd_dump', 'amd_postorder', 'amd_post_tree', ...
 for i = 1 : length (amd_files)
     cmd = sprintf ('%s ../linsys/direct/external/%s.c', cmd, amd_files {i}) ;
 end
-cmd = sprintf ('%s ../linsys/direct/external/ldl.c %s ../linsys/direct/private.c %s %s %s -output scs_direct', cmd, common_scs, flags.link, flags.LOCS, flags.BLASLIB) ;
+cmd = sprintf ('%s ../linsys/direct/external/ldl.c ../linsys/direct/ordering.c %s ../linsys/direct/private.c %s %s %s -output scs_direct', cmd, common_scs, flags.link, flags.LOCS, flags.BLASLIB) ;
 eval(cmd);
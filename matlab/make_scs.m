@@ -7,7 +7,7 @@ flags.LCFLAG = '-DMATLAB_MEX_FILE -DLAPACK_LIB_FOUND -DDLONG';
 flags.INCS = '';
 flags.LOCS = '';
 
-common_scs = '../src/linAlg.c ../src/cones.c ../src/cs.c ../src/util.c ../src/scs.c ../linsys/common.c scs_mex.c';
+common_scs = '../src/linAlg.c ../src/cones.c ../src/cs.c ../src/util.c ../src/scs.c ../src/accel.c ../linsys/common.c ../linsys/presolve.c ../linsys/chordal.c scs_mex.c';
 if (~isempty (strfind (computer, '64')))
     flags.arr = '-largeArrayDims';
 else
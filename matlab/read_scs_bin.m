@@ -0,0 +1,63 @@
+function [data,K,params] = read_scs_bin(name)
+% reads a binary file of write_scs_bin (or of scs_write_data in C, or
+% scs.write_data in python), see include/rw.h for the layout, data holds
+% x, y and s if the file has a warm start
+
+fi = fopen(name,'r','native');
+magic = fread(fi,8,'char=>char')';
+head = fread(fi,4,'uint32');
+if ~strcmp(magic,'SCS_DATA') || head(1) > 1 || head(2) ~= hex2dec('01020304') || ...
+        ~ismember(head(3),[4 8]) || ~ismember(head(4),[4 8])
+    fclose(fi);
+    error('%s is not an scs data file of version <= 1 in this byte order', name);
+end
+itype = sprintf('int%i=>double',8*head(3));
+ftype = 'double';
+if head(4) == 4
+    ftype = 'single=>double';
+end
+ints = fread(fi,16,'int64');
+floats = fread(fi,8,'double');
+m = ints(1); n = ints(2); nnz = ints(3);
+
+K.f = ints(4); K.l = ints(5); K.ep = ints(9); K.ed = ints(10);
+K.q = read_section(fi,ints(6),itype,head(3))';
+K.s = read_section(fi,ints(7),itype,head(3))';
+K.sp = read_section(fi,ints(8),itype,head(3))';
+Ap = read_section(fi,n+1,itype,head(3));
+Ai = read_section(fi,nnz,itype,head(3));
+Ax = read_section(fi,nnz,ftype,head(4));
+% column of each nonzero from the column pointers (empty columns share a start)
+Aj = cumsum(accumarray(Ap(2:end-1)+1,ones(n-1,1),[nnz+1 1]))+1;
+Aj = Aj(1:nnz);
+data.A = sparse(Ai+1,Aj,Ax,m,n);
+data.b = read_section(fi,m,ftype,head(4));
+data.c = read_section(fi,n,ftype,head(4));
+if ints(11)
+    data.x = read_section(fi,n,ftype,head(4));
+    data.y = read_section(fi,m,ftype,head(4));
+    data.s = read_section(fi,m,ftype,head(4));
+end
+fclose(fi);
+
+params.MAX_ITERS = ints(12);
+params.NORMALIZE = ints(13);
+params.EPS = floats(1);
+params.ALPHA = floats(2);
+params.RHO_X = floats(3);
+params.SCALE = floats(4);
+params.CG_RATE = floats(5);
+end
+
+function v = read_section(fi,len,type,sz)
+% nonempty arrays start at a multiple of 64 bytes
+v = zeros(0,1);
+if len == 0
+    return
+end
+fseek(fi,mod(-ftell(fi),64),'cof');
+v = fread(fi,len,type);
+if length(v) ~= len
+    error('truncated scs data file');
+end
+end
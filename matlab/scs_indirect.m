@@ -20,6 +20,7 @@ function [x, y, s, info] = scs_indirect(data, cone, params)
 % cone.l, length of lp cone
 % cone.q, array of SOC lengths
 % cone.s, array of SD lengths
+% cone.sp, array of packed SD lengths (lower triangle, off-diagonals times sqrt(2))
 % cone.ep, number of primal exp cones
 % cone.ed, number of dual exp cones
 %
@@ -35,4 +36,21 @@ function [x, y, s, info] = scs_indirect(data, cone, params)
 %   EPS     : accuracy of solution
 %   VERBOSE     : verbosity level (0 or 1)
 %   NORMALIZE   : heuristic data rescaling (0 or 1, off or on)
+%   MIXED_PRECISION : early CG solves use A rounded to single precision (0 or 1)
+%   CG_ADAPTIVE : CG tolerance follows the ADMM residuals (0 or 1)
+%   CG_MAX_ITERS : max CG iterations per ADMM step (0 for no cap)
+%   CG_PRECOND  : CG preconditioner (0 diagonal, 1 block Jacobi, 2 incomplete Cholesky)
+%   ADAPTIVE_RHO : adapt RHO_X during the solve to balance the residuals (0 or 1)
+%   PRESOLVE    : remove empty and duplicate rows, fixed variables and empty cones before the solve (0 or 1, default 1)
+%   CHORDAL     : split semidefinite cones with a sparse pattern into cones of its cliques (0 or 1, default 0)
+%   LOW_MEMORY  : iterate with fewer vectors, and for indirect without storing A' (0 or 1)
+%   TIME_LIMIT  : wall-clock limit of the solve in seconds, 0 for none (info.statusVal is 2 when hit)
+%   TRACE_LEN   : columns (iter; resPri; resDual; relGap) of up to this many iterations in info.resTrace
+%
+% The workspace can be kept for solves that differ only in b and c:
+%   h = scs_indirect('init', data, cone, params);
+%   [x, y, s, info] = scs_indirect('solve', h, warm, b, c);  % all but h optional, [] to skip
+%   scs_indirect('update_bc', h, b, c);  % replaces b and c of the handle, [] keeps one
+%   scs_indirect('finish', h);
+% warm has optional fields x, y and s, the b and c of solve are for that solve only.
 error ('scs_indirect mexFunction not found') ;
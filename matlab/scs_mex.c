@@ -5,10 +5,26 @@
 #include "linAlg.h"
 #include "linsys/amatrix.h"
 
+/* a problem set up by scs_direct('init', ...), with its workspace kept until scs_direct('finish', h), see
+ mexFunction; all of it is persistent memory, copied from the inputs of init */
+typedef struct MEX_WORK {
+	Data * d;
+	Cone * k;
+	Work * w;
+	pfloat * b, * c; /* the copies of b and c, d->b and d->c point at the inputs of a solve given them */
+	idxint traceCap; /* TRACE_LEN of the params */
+	pfloat setupTime;
+	Profile setupProf; /* the phases of scs_init */
+	struct MEX_WORK * next;
+} MexWork;
+
+/* the workspaces not finished yet, a handle must be one of them */
+static MexWork * live = NULL;
+
 void freeMex(Data * d, Cone * k);
 
 idxint parseWarmStart(const mxArray * p_mex, pfloat ** p, idxint l) {
-	*p = scs_calloc(l, sizeof(pfloat)); /* this allocates memory used for Sol */
+	*p = mxCalloc(l, sizeof(pfloat)); /* this allocates memory used for Sol, handed to the outputs */
 	if (p_mex == NULL) {
 		return 0;
 	} else if (mxIsSparse(p_mex) || (idxint) *mxGetDimensions(p_mex) != l) {
@@ -20,94 +36,31 @@ idxint parseWarmStart(const mxArray * p_mex, pfloat ** p, idxint l) {
 	}
 }
 
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
-	/* matlab usage: scs(data,cone,params); */
-	idxint i, ns, status;
-	Data *d;
-	Cone *k;
-	Sol sol = { 0 };
-	Info info;
-	AMatrix * A;
-
-	const mxArray *data;
-	const mxArray *A_mex;
-	const mxArray *b_mex;
-	const mxArray *c_mex;
-
-	const mxArray *kf;
-	const mxArray *kl;
-	const mxArray *kq;
-	const mxArray *ks;
-	const mxArray *kep;
-	const mxArray *ked;
-	const pfloat *q_mex;
-	const pfloat *s_mex;
-	const size_t *q_dims;
-	const size_t *s_dims;
-
-	const mxArray *cone;
-	const mxArray *params;
-
-	const mwSize one[1] = { 1 };
-	const int numInfoFields = 9;
-	const char * infoFields[] = { "iter", "status", "pobj", "dobj", "resPri", "resDual", "relGap", "setupTime",
-			"solveTime" };
-	mxArray *tmp;
-
-
-	if (nrhs != 3) {
-		mexErrMsgTxt("Three arguments are required in this order: data struct, cone struct, params struct");
+/* the entries of a dense real vector of length l: its own buffer if it is double, else a copy in *copy (freed by
+ the caller) if it is single, NULL if a is no such vector */
+static pfloat * vecValues(const mxArray * a, idxint l, pfloat ** copy) {
+	idxint i;
+	*copy = NULL;
+	if (a == NULL || mxIsSparse(a) || mxIsComplex(a) || (idxint) mxGetNumberOfElements(a) != l) {
+		return NULL;
 	}
-	if (nlhs > 4) {
-		mexErrMsgTxt("scs returns up to 4 output arguments only.");
+	if (mxIsDouble(a)) {
+		return mxGetPr(a);
 	}
-	d = mxMalloc(sizeof(Data));
-	k = mxMalloc(sizeof(Cone));
-	data = prhs[0];
-
-	A_mex = (mxArray *) mxGetField(data, 0, "A");
-	if (A_mex == NULL) {
-		scs_free(d);
-		scs_free(k);
-		mexErrMsgTxt("Data struct must contain a `A` entry.");
-	}
-	if (!mxIsSparse(A_mex)) {
-		scs_free(d);
-		scs_free(k);
-		mexErrMsgTxt("Input matrix A must be in sparse format (pass in sparse(A))");
-	}
-	b_mex = (mxArray *) mxGetField(data, 0, "b");
-	if (b_mex == NULL) {
-		scs_free(d);
-		scs_free(k);
-		mexErrMsgTxt("Data struct must contain a `b` entry.");
-	}
-	if (mxIsSparse(b_mex)) {
-		scs_free(d);
-		scs_free(k);
-		mexErrMsgTxt("Input vector b must be in dense format (pass in full(b))");
-	}
-	c_mex = (mxArray *) mxGetField(data, 0, "c");
-	if (c_mex == NULL) {
-		scs_free(d);
-		scs_free(k);
-		mexErrMsgTxt("Data struct must contain a `c` entry.");
+	if (!mxIsSingle(a)) {
+		return NULL;
 	}
-	if (mxIsSparse(c_mex)) {
-		scs_free(d);
-		scs_free(k);
-		mexErrMsgTxt("Input vector c must be in dense format (pass in full(c))");
+	*copy = mxMalloc(MAX(l, 1) * sizeof(pfloat));
+	for (i = 0; i < l; ++i) {
+		(*copy)[i] = (pfloat) ((const float *) mxGetData(a))[i];
 	}
+	return *copy;
+}
 
-	cone = prhs[1];
-	params = prhs[2];
-	d->n = (idxint) *(mxGetDimensions(c_mex));
-	d->m = (idxint) *(mxGetDimensions(b_mex));
-
-	d->b = (pfloat *)mxGetPr(b_mex);
-	d->c = (pfloat *)mxGetPr(c_mex);
+static void parseParams(Data * d, const mxArray * params) {
+	const mxArray *tmp;
+	idxint i, l, * perm;
 
-	/* params */
 	tmp = mxGetField(params, 0, "ALPHA");
 	if (tmp == NULL)
 		d->ALPHA = 1.8;
@@ -156,7 +109,140 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
 	else
 		d->NORMALIZE = (idxint) *mxGetPr(tmp);
 
-	/* cones */
+	tmp = mxGetField(params, 0, "STORE_TRANSPOSE");
+	if (tmp == NULL)
+		d->STORE_TRANSPOSE = 0;
+	else
+		d->STORE_TRANSPOSE = (idxint) *mxGetPr(tmp);
+
+	tmp = mxGetField(params, 0, "ACCEL_MEM");
+	if (tmp == NULL)
+		d->ACCEL_MEM = 0;
+	else
+		d->ACCEL_MEM = (idxint) *mxGetPr(tmp);
+
+	tmp = mxGetField(params, 0, "MIXED_PRECISION");
+	if (tmp == NULL)
+		d->MIXED_PRECISION = 0;
+	else
+		d->MIXED_PRECISION = (idxint) *mxGetPr(tmp);
+
+	tmp = mxGetField(params, 0, "CG_ADAPTIVE");
+	if (tmp == NULL)
+		d->CG_ADAPTIVE = 0;
+	else
+		d->CG_ADAPTIVE = (idxint) *mxGetPr(tmp);
+
+	tmp = mxGetField(params, 0, "CG_MAX_ITERS");
+	if (tmp == NULL)
+		d->CG_MAX_ITERS = 0;
+	else
+		d->CG_MAX_ITERS = (idxint) *mxGetPr(tmp);
+
+	tmp = mxGetField(params, 0, "CG_PRECOND");
+	if (tmp == NULL)
+		d->CG_PRECOND = 0;
+	else
+		d->CG_PRECOND = (idxint) *mxGetPr(tmp);
+
+	tmp = mxGetField(params, 0, "NORMAL_EQS");
+	if (tmp == NULL)
+		d->NORMAL_EQS = 0;
+	else
+		d->NORMAL_EQS = (idxint) *mxGetPr(tmp);
+
+	tmp = mxGetField(params, 0, "ADAPTIVE_RHO");
+	if (tmp == NULL)
+		d->ADAPTIVE_RHO = 0;
+	else
+		d->ADAPTIVE_RHO = (idxint) *mxGetPr(tmp);
+
+	tmp = mxGetField(params, 0, "PRESOLVE");
+	if (tmp == NULL)
+		d->PRESOLVE = 1;
+	else
+		d->PRESOLVE = (idxint) *mxGetPr(tmp);
+
+	tmp = mxGetField(params, 0, "CHORDAL");
+	if (tmp == NULL)
+		d->CHORDAL = 0;
+	else
+		d->CHORDAL = (idxint) *mxGetPr(tmp);
+
+	tmp = mxGetField(params, 0, "LOW_MEMORY");
+	if (tmp == NULL)
+		d->LOW_MEMORY = 0;
+	else
+		d->LOW_MEMORY = (idxint) *mxGetPr(tmp);
+
+	tmp = mxGetField(params, 0, "ORDERING");
+	if (tmp == NULL)
+		d->ORDERING = ORDER_AMD;
+	else
+		d->ORDERING = (idxint) *mxGetPr(tmp);
+
+	/* 1-based in Matlab, of the n + m rows of the KKT matrix (n with NORMAL_EQS 1), freed by freeMex */
+	tmp = mxGetField(params, 0, "PERM");
+	d->PERM = NULL;
+	if (tmp != NULL && !mxIsEmpty(tmp)) {
+		l = (idxint) mxGetNumberOfElements(tmp);
+		if (!mxIsDouble(tmp) || (l != d->n + d->m && !(d->NORMAL_EQS == 1 && l == d->n))) {
+			scs_printf("PERM must be a double vector of n + m entries (n with NORMAL_EQS 1), ignored\n");
+		} else {
+			perm = mxMalloc(l * sizeof(idxint));
+			for (i = 0; i < l; ++i) {
+				perm[i] = (idxint) mxGetPr(tmp)[i] - 1;
+			}
+			d->PERM = perm;
+		}
+	}
+
+	tmp = mxGetField(params, 0, "TIME_LIMIT");
+	if (tmp == NULL)
+		d->TIME_LIMIT = 0;
+	else
+		d->TIME_LIMIT = (pfloat) *mxGetPr(tmp);
+
+	d->callback = NULL;
+	d->callbackData = NULL;
+	d->scaling = NULL;
+	d->ARENA = 0; /* the mex allocates with mxMalloc */
+}
+
+/* the length of the residual trace asked for in params, 0 for none */
+static idxint parseTraceLen(const mxArray * params) {
+	const mxArray *tmp = mxGetField(params, 0, "TRACE_LEN");
+	return (tmp != NULL && *mxGetPr(tmp) > 0) ? (idxint) *mxGetPr(tmp) : 0;
+}
+
+/* residual trace, a 4 by cap matrix with columns (iter, resPri, resDual, relGap) */
+static mxArray * newResTrace(Info * info, idxint cap) {
+	mxArray *resTrace;
+	if (cap <= 0) {
+		return NULL;
+	}
+	resTrace = mxCreateDoubleMatrix(4, cap, mxREAL);
+	info->resTraceCap = cap;
+	info->resTrace = mxGetPr(resTrace);
+	return resTrace;
+}
+
+static void parseCone(Cone * k, const mxArray * cone) {
+	idxint i, ns;
+	const mxArray *kf;
+	const mxArray *kl;
+	const mxArray *kq;
+	const mxArray *ks;
+	const mxArray *ksp;
+	const mxArray *kep;
+	const mxArray *ked;
+	const pfloat *q_mex;
+	const pfloat *s_mex;
+	const pfloat *sp_mex;
+	const size_t *q_dims;
+	const size_t *s_dims;
+	const size_t *sp_dims;
+
 	kf = mxGetField(cone, 0, "f");
 	if (kf && !mxIsEmpty(kf))
 		k->f = (idxint) *mxGetPr(kf);
@@ -190,7 +276,7 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
 		if (ns > 1 && q_dims[0] == 1) {
 			k->qsize = (idxint) q_dims[1];
 		}
-		k->q = mxMalloc(sizeof(idxint) * k->qsize);
+		k->q = scs_malloc(sizeof(idxint) * k->qsize);
 		for (i = 0; i < k->qsize; i++) {
 			k->q[i] = (idxint) q_mex[i];
 		}
@@ -208,7 +294,7 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
 		if (ns > 1 && s_dims[0] == 1) {
 			k->ssize = (idxint) s_dims[1];
 		}
-		k->s = mxMalloc(sizeof(idxint) * k->ssize);
+		k->s = scs_malloc(sizeof(idxint) * k->ssize);
 		for (i = 0; i < k->ssize; i++) {
 			k->s[i] = (idxint) s_mex[i];
 		}
@@ -216,85 +302,477 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
 		k->ssize = 0;
 		k->s = NULL;
 	}
-	A = scs_malloc(sizeof(AMatrix));
-	A->x = (pfloat *) mxGetPr(A_mex);
-	/* XXX:
-	 * these return (mwIndex *), equivalent to (size_t *)
-	 * casting as (idxint *), when idxint = long seems to work
-	 * although maybe not on all machines:
-	 */
-	A->p = (idxint *) mxGetJc(A_mex);
-	A->i = (idxint *) mxGetIr(A_mex);
-	d->A = A;
-	/* warm-start inputs, allocates sol->x, ->y, ->s even if warm start not used */
-	d->WARM_START = parseWarmStart((mxArray *) mxGetField(data, 0, "x"), &(sol.x), d->n);
-	d->WARM_START |= parseWarmStart((mxArray *) mxGetField(data, 0, "y"), &(sol.y), d->m);
-	d->WARM_START |= parseWarmStart((mxArray *) mxGetField(data, 0, "s"), &(sol.s), d->m);
 
-	status = scs(d, k, &sol, &info);
+	ksp = mxGetField(cone, 0, "sp");
+	if (ksp && !mxIsEmpty(ksp)) {
+		sp_mex = mxGetPr(ksp);
+		ns = (idxint) mxGetNumberOfDimensions(ksp);
+		sp_dims = mxGetDimensions(ksp);
+		k->spsize = (idxint) sp_dims[0];
+		if (ns > 1 && sp_dims[0] == 1) {
+			k->spsize = (idxint) sp_dims[1];
+		}
+		k->sp = scs_malloc(sizeof(idxint) * k->spsize);
+		for (i = 0; i < k->spsize; i++) {
+			k->sp[i] = (idxint) sp_mex[i];
+		}
+	} else {
+		k->spsize = 0;
+		k->sp = NULL;
+	}
+}
 
+/* checks the A, b and c of the data struct, with an error naming the first missing or malformed one */
+static const char * checkData(const mxArray * data, const mxArray ** A_mex, const mxArray ** b_mex,
+		const mxArray ** c_mex) {
+	*A_mex = mxGetField(data, 0, "A");
+	if (*A_mex == NULL) {
+		return "Data struct must contain a `A` entry.";
+	}
+	if (!mxIsSparse(*A_mex)) {
+		return "Input matrix A must be in sparse format (pass in sparse(A))";
+	}
+	*b_mex = mxGetField(data, 0, "b");
+	if (*b_mex == NULL) {
+		return "Data struct must contain a `b` entry.";
+	}
+	if (mxIsSparse(*b_mex)) {
+		return "Input vector b must be in dense format (pass in full(b))";
+	}
+	*c_mex = mxGetField(data, 0, "c");
+	if (*c_mex == NULL) {
+		return "Data struct must contain a `c` entry.";
+	}
+	if (mxIsSparse(*c_mex)) {
+		return "Input vector c must be in dense format (pass in full(c))";
+	}
+	return NULL;
+}
+
+/* x, y and s as n, m and m column vectors, taking over the buffers of sol (from parseWarmStart) */
+static void setOutputs(int nlhs, mxArray *plhs[], const Data * d, Sol * sol) {
 	plhs[0] = mxCreateDoubleMatrix(0, 0, mxREAL);
-	mxSetPr(plhs[0], sol.x);
+	mxSetPr(plhs[0], sol->x);
 	mxSetM(plhs[0], d->n);
 	mxSetN(plhs[0], 1);
 
-	plhs[1] = mxCreateDoubleMatrix(0, 0, mxREAL);
-	mxSetPr(plhs[1], sol.y);
-	mxSetM(plhs[1], d->m);
-	mxSetN(plhs[1], 1);
+	if (nlhs > 1) {
+		plhs[1] = mxCreateDoubleMatrix(0, 0, mxREAL);
+		mxSetPr(plhs[1], sol->y);
+		mxSetM(plhs[1], d->m);
+		mxSetN(plhs[1], 1);
+	} else {
+		mxFree(sol->y);
+	}
 
-	plhs[2] = mxCreateDoubleMatrix(0, 0, mxREAL);
-	mxSetPr(plhs[2], sol.s);
-	mxSetM(plhs[2], d->m);
-	mxSetN(plhs[2], 1);
+	if (nlhs > 2) {
+		plhs[2] = mxCreateDoubleMatrix(0, 0, mxREAL);
+		mxSetPr(plhs[2], sol->s);
+		mxSetM(plhs[2], d->m);
+		mxSetN(plhs[2], 1);
+	} else {
+		mxFree(sol->s);
+	}
+}
+
+static mxArray * infoStruct(Info * info, mxArray * resTrace) {
+	idxint i;
+	mxArray *out, *tmp;
+	const mwSize one[1] = { 1 };
+	const int numInfoFields = 15;
+	const char * infoFields[] = { "iter", "status", "pobj", "dobj", "resPri", "resDual", "relGap", "setupTime",
+			"solveTime", "linSysIters", "ordering", "lnz", "treeHeight", "prof", "resTrace" };
+	const int numProfFields = 10;
+	const char * profFields[] = { "normalizeTime", "kktTime", "orderTime", "factorTime", "linSysTime", "coneTime",
+			"convergedTime", "minIterTime", "maxIterTime", "avgIterTime" };
+	const pfloat * profTimes[10];
+
+
+	out = mxCreateStructArray(1, one, numInfoFields, infoFields);
+
+	mxSetField(out, 0, "status", mxCreateString(info->status));
+
+	tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
+	mxSetField(out, 0, "iter", tmp);
+	*mxGetPr(tmp) = (pfloat) info->iter;
+
+	tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
+	mxSetField(out, 0, "pobj", tmp);
+	*mxGetPr(tmp) = info->pobj;
 
-	plhs[3] = mxCreateStructArray(1, one, numInfoFields, infoFields);
+	tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
+	mxSetField(out, 0, "dobj", tmp);
+	*mxGetPr(tmp) = info->dobj;
 
-	mxSetField(plhs[3], 0, "status", mxCreateString(info.status));
+	tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
+	mxSetField(out, 0, "resPri", tmp);
+	*mxGetPr(tmp) = info->resPri;
 
 	tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
-	mxSetField(plhs[3], 0, "iter", tmp);
-	*mxGetPr(tmp) = (pfloat) info.iter;
+	mxSetField(out, 0, "resDual", tmp);
+	*mxGetPr(tmp) = info->resDual;
 
 	tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
-	mxSetField(plhs[3], 0, "pobj", tmp);
-	*mxGetPr(tmp) = info.pobj;
+	mxSetField(out, 0, "relGap", tmp);
+	*mxGetPr(tmp) = info->relGap;
 
+	/*info->time is millisecs - return value in secs */
 	tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
-	mxSetField(plhs[3], 0, "dobj", tmp);
-	*mxGetPr(tmp) = info.dobj;
+	mxSetField(out, 0, "setupTime", tmp);
+	*mxGetPr(tmp) = info->setupTime / 1e3;
 
+	/*info->time is millisecs - return value in secs */
 	tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
-	mxSetField(plhs[3], 0, "resPri", tmp);
-	*mxGetPr(tmp) = info.resPri;
+	mxSetField(out, 0, "solveTime", tmp);
+	*mxGetPr(tmp) = info->solveTime / 1e3;
 
 	tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
-	mxSetField(plhs[3], 0, "resDual", tmp);
-	*mxGetPr(tmp) = info.resDual;
+	mxSetField(out, 0, "linSysIters", tmp);
+	*mxGetPr(tmp) = (pfloat) info->linSysIters;
 
+	/* the fill of the factorization, 0 for indirect */
 	tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
-	mxSetField(plhs[3], 0, "relGap", tmp);
-	*mxGetPr(tmp) = info.relGap;
+	mxSetField(out, 0, "ordering", tmp);
+	*mxGetPr(tmp) = (pfloat) info->prof.ordering;
 
-	/*info.time is millisecs - return value in secs */
 	tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
-	mxSetField(plhs[3], 0, "setupTime", tmp);
-	*mxGetPr(tmp) = info.setupTime / 1e3;
+	mxSetField(out, 0, "lnz", tmp);
+	*mxGetPr(tmp) = info->prof.lnz;
 
-	/*info.time is millisecs - return value in secs */
 	tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
-	mxSetField(plhs[3], 0, "solveTime", tmp);
-	*mxGetPr(tmp) = info.solveTime / 1e3;
+	mxSetField(out, 0, "treeHeight", tmp);
+	*mxGetPr(tmp) = (pfloat) info->prof.treeHeight;
+
+	/* the times of each phase, in secs as well */
+	profTimes[0] = &(info->prof.normalizeTime);
+	profTimes[1] = &(info->prof.kktTime);
+	profTimes[2] = &(info->prof.orderTime);
+	profTimes[3] = &(info->prof.factorTime);
+	profTimes[4] = &(info->prof.linSysTime);
+	profTimes[5] = &(info->prof.coneTime);
+	profTimes[6] = &(info->prof.convergedTime);
+	profTimes[7] = &(info->prof.minIterTime);
+	profTimes[8] = &(info->prof.maxIterTime);
+	profTimes[9] = &(info->prof.avgIterTime);
+	mxSetField(out, 0, "prof", mxCreateStructArray(1, one, numProfFields, profFields));
+	for (i = 0; i < numProfFields; ++i) {
+		tmp = mxCreateDoubleMatrix(1, 1, mxREAL);
+		mxSetField(mxGetField(out, 0, "prof"), 0, profFields[i], tmp);
+		*mxGetPr(tmp) = *profTimes[i] / 1e3;
+	}
+
+	if (resTrace) {
+		mxSetN(resTrace, info->resTraceLen);
+		mxSetField(out, 0, "resTrace", resTrace);
+	}
+
+	return out;
+}
+
+/* a copy of the sparse A_mex in persistent memory, indices converted to idxint */
+static AMatrix * copyA(const mxArray * A_mex, idxint n) {
+	idxint j, nnz;
+	const mwIndex * Jc = mxGetJc(A_mex);
+	const mwIndex * Ir = mxGetIr(A_mex);
+	AMatrix * A = scs_malloc(sizeof(AMatrix));
+	nnz = (idxint) Jc[n];
+	A->x = scs_malloc(MAX(nnz, 1) * sizeof(pfloat));
+	A->i = scs_malloc(MAX(nnz, 1) * sizeof(idxint));
+	A->p = scs_malloc((n + 1) * sizeof(idxint));
+	memcpy(A->x, mxGetPr(A_mex), nnz * sizeof(pfloat));
+	for (j = 0; j < nnz; ++j) {
+		A->i[j] = (idxint) Ir[j];
+	}
+	for (j = 0; j <= n; ++j) {
+		A->p[j] = (idxint) Jc[j];
+	}
+	return A;
+}
+
+static pfloat * copyVec(const mxArray * v_mex, idxint l) {
+	pfloat * v = scs_malloc(MAX(l, 1) * sizeof(pfloat));
+	memcpy(v, mxGetPr(v_mex), l * sizeof(pfloat));
+	return v;
+}
+
+static void freeWork(MexWork * mw) {
+	MexWork ** prev;
+	for (prev = &live; *prev; prev = &((*prev)->next)) {
+		if (*prev == mw) {
+			*prev = mw->next;
+			break;
+		}
+	}
+	if (mw->w)
+		scs_finish(mw->d, mw->w);
+	scs_free(mw->d->A->x);
+	scs_free(mw->d->A->i);
+	scs_free(mw->d->A->p);
+	scs_free(mw->b);
+	scs_free(mw->c);
+	freeMex(mw->d, mw->k);
+	scs_free(mw);
+}
+
+/* registered with mexAtExit, for the workspaces never finished when the mex is cleared */
+static void freeAll(void) {
+	while (live) {
+		freeWork(live);
+	}
+}
+
+static MexWork * findHandle(const mxArray * h) {
+	MexWork * mw, * p;
+	if (h == NULL || !mxIsUint64(h) || mxGetNumberOfElements(h) != 1) {
+		return NULL;
+	}
+	p = (MexWork *) (size_t) *(const uint64_T *) mxGetData(h);
+	for (mw = live; mw; mw = mw->next) {
+		if (mw == p) {
+			return mw;
+		}
+	}
+	return NULL;
+}
+
+/* h = scs_direct('init', data, cone, params) */
+static void initHandle(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+	const mxArray *A_mex, *b_mex, *c_mex;
+	const char * err;
+	MexWork * mw;
+	Info info = { 0 };
+	static idxint registered = 0;
+	if (nrhs != 4) {
+		mexErrMsgTxt("init takes three more arguments in this order: data struct, cone struct, params struct");
+	}
+	if ((err = checkData(prhs[1], &A_mex, &b_mex, &c_mex))) {
+		mexErrMsgTxt(err);
+	}
+	if (!registered) {
+		mexAtExit(freeAll);
+		registered = 1;
+	}
+	mw = scs_calloc(1, sizeof(MexWork));
+	mw->d = scs_calloc(1, sizeof(Data));
+	mw->k = scs_calloc(1, sizeof(Cone));
+	mw->d->n = (idxint) *(mxGetDimensions(c_mex));
+	mw->d->m = (idxint) *(mxGetDimensions(b_mex));
+	parseParams(mw->d, prhs[3]);
+	parseCone(mw->k, prhs[2]);
+	mw->traceCap = parseTraceLen(prhs[3]);
+	mw->d->A = copyA(A_mex, mw->d->n);
+	mw->d->b = mw->b = copyVec(b_mex, mw->d->m);
+	mw->d->c = mw->c = copyVec(c_mex, mw->d->n);
+	mw->next = live;
+	live = mw;
+
+	mw->w = scs_init(mw->d, mw->k, &info);
+	/* only needed by the ordering of scs_init, not persistent */
+	if (mw->d->PERM) {
+		mxFree((idxint *) mw->d->PERM);
+		mw->d->PERM = NULL;
+	}
+	if (!mw->w) {
+		freeWork(mw);
+		mexErrMsgTxt("could not initialize work");
+	}
+	mw->setupTime = info.setupTime;
+	mw->setupProf = info.prof;
+	plhs[0] = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+	*(uint64_T *) mxGetData(plhs[0]) = (uint64_T) (size_t) mw;
+}
+
+/* scs_direct('update_bc', h, b, c), b or c empty to keep it */
+static void updateHandle(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+	MexWork * mw;
+	pfloat * v, * copy;
+	if (nrhs != 4) {
+		mexErrMsgTxt("update_bc takes three more arguments in this order: handle, b, c");
+	}
+	if (!(mw = findHandle(prhs[1]))) {
+		mexErrMsgTxt("Invalid handle, it must come from init and not be finished.");
+	}
+	if (!mxIsEmpty(prhs[2])) {
+		if (!(v = vecValues(prhs[2], mw->d->m, &copy))) {
+			mexErrMsgTxt("Input vector b must be dense, real double or single and of the length of the b of init");
+		}
+		memcpy(mw->b, v, mw->d->m * sizeof(pfloat));
+		if (copy)
+			mxFree(copy);
+	}
+	if (!mxIsEmpty(prhs[3])) {
+		if (!(v = vecValues(prhs[3], mw->d->n, &copy))) {
+			mexErrMsgTxt("Input vector c must be dense, real double or single and of the length of the c of init");
+		}
+		memcpy(mw->c, v, mw->d->n * sizeof(pfloat));
+		if (copy)
+			mxFree(copy);
+	}
+}
+
+/* [x, y, s, info] = scs_direct('solve', h, warm, b, c), all but h optional and empty to skip: the x, y and s of
+ the struct warm start the solve, b and c replace those of the handle for this solve only and are used in place
+ when they are double (scaled and restored during the solve, as the vectors of a call with data) */
+static void solveHandle(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+	MexWork * mw;
+	Data * d;
+	Sol sol = { 0 };
+	Info info = { 0 };
+	mxArray *resTrace;
+	const mxArray *warm = nrhs > 2 && !mxIsEmpty(prhs[2]) ? prhs[2] : NULL;
+	pfloat * bCopy = NULL, * cCopy = NULL;
+	if (nrhs < 2 || nrhs > 5) {
+		mexErrMsgTxt("solve takes a handle, then optionally a warm start struct, b and c");
+	}
+	if (!(mw = findHandle(prhs[1]))) {
+		mexErrMsgTxt("Invalid handle, it must come from init and not be finished.");
+	}
+	d = mw->d;
+	if (nrhs > 3 && !mxIsEmpty(prhs[3]) && !(d->b = vecValues(prhs[3], d->m, &bCopy))) {
+		d->b = mw->b;
+		mexErrMsgTxt("Input vector b must be dense, real double or single and of the length of the b of init");
+	}
+	if (nrhs > 4 && !mxIsEmpty(prhs[4]) && !(d->c = vecValues(prhs[4], d->n, &cCopy))) {
+		d->b = mw->b;
+		d->c = mw->c;
+		if (bCopy)
+			mxFree(bCopy);
+		mexErrMsgTxt("Input vector c must be dense, real double or single and of the length of the c of init");
+	}
+	/* scs_solve overwrites the warm start with the solution, so it is copied once into the outputs */
+	d->WARM_START = parseWarmStart(warm ? mxGetField(warm, 0, "x") : NULL, &(sol.x), d->n);
+	d->WARM_START |= parseWarmStart(warm ? mxGetField(warm, 0, "y") : NULL, &(sol.y), d->m);
+	d->WARM_START |= parseWarmStart(warm ? mxGetField(warm, 0, "s") : NULL, &(sol.s), d->m);
+	resTrace = newResTrace(&info, mw->traceCap);
+	info.prof = mw->setupProf;
+
+	scs_solve(mw->w, d, mw->k, &sol, &info);
+	info.setupTime = mw->setupTime;
+
+	d->b = mw->b;
+	d->c = mw->c;
+	if (bCopy)
+		mxFree(bCopy);
+	if (cCopy)
+		mxFree(cCopy);
+	setOutputs(nlhs, plhs, d, &sol);
+	if (nlhs > 3) {
+		plhs[3] = infoStruct(&info, resTrace);
+	} else if (resTrace) {
+		mxDestroyArray(resTrace);
+	}
+}
+
+/* scs_direct('finish', h) */
+static void finishHandle(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+	MexWork * mw;
+	if (nrhs != 2) {
+		mexErrMsgTxt("finish takes one more argument: handle");
+	}
+	if (!(mw = findHandle(prhs[1]))) {
+		mexErrMsgTxt("Invalid handle, it must come from init and not be finished.");
+	}
+	freeWork(mw);
+}
+
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+	/* matlab usage: scs(data,cone,params); or with a workspace kept between calls:
+	 h = scs('init',data,cone,params); [x,y,s,info] = scs('solve',h,warm,b,c); scs('update_bc',h,b,c);
+	 scs('finish',h); */
+	Data *d;
+	Cone *k;
+	Sol sol = { 0 };
+	Info info = { 0 };
+	AMatrix * A;
+	mxArray *resTrace = NULL;
+	char cmd[16];
+
+	const mxArray *data;
+	const mxArray *A_mex;
+	const mxArray *b_mex;
+	const mxArray *c_mex;
+	const char * err;
+
+	if (nrhs >= 1 && mxIsChar(prhs[0])) {
+		if (mxGetString(prhs[0], cmd, sizeof(cmd))) {
+			mexErrMsgTxt("Unknown command, one of init, solve, update_bc and finish is expected.");
+		}
+		if (nlhs > (strcmp(cmd, "solve") ? strcmp(cmd, "init") ? 0 : 1 : 4)) {
+			mexErrMsgTxt("Too many output arguments for this command.");
+		}
+		if (!strcmp(cmd, "init")) {
+			initHandle(nlhs, plhs, nrhs, prhs);
+		} else if (!strcmp(cmd, "solve")) {
+			solveHandle(nlhs, plhs, nrhs, prhs);
+		} else if (!strcmp(cmd, "update_bc")) {
+			updateHandle(nlhs, plhs, nrhs, prhs);
+		} else if (!strcmp(cmd, "finish")) {
+			finishHandle(nlhs, plhs, nrhs, prhs);
+		} else {
+			mexErrMsgTxt("Unknown command, one of init, solve, update_bc and finish is expected.");
+		}
+		return;
+	}
+	if (nrhs != 3) {
+		mexErrMsgTxt("Three arguments are required in this order: data struct, cone struct, params struct");
+	}
+	if (nlhs > 4) {
+		mexErrMsgTxt("scs returns up to 4 output arguments only.");
+	}
+	data = prhs[0];
+	if ((err = checkData(data, &A_mex, &b_mex, &c_mex))) {
+		mexErrMsgTxt(err);
+	}
+	d = mxMalloc(sizeof(Data));
+	k = mxMalloc(sizeof(Cone));
+
+	d->n = (idxint) *(mxGetDimensions(c_mex));
+	d->m = (idxint) *(mxGetDimensions(b_mex));
+
+	d->b = (pfloat *)mxGetPr(b_mex);
+	d->c = (pfloat *)mxGetPr(c_mex);
+
+	parseParams(d, prhs[2]);
+	resTrace = newResTrace(&info, parseTraceLen(prhs[2]));
+	parseCone(k, prhs[1]);
+
+	A = mxMalloc(sizeof(AMatrix));
+	A->x = (pfloat *) mxGetPr(A_mex);
+	/* XXX:
+	 * these return (mwIndex *), equivalent to (size_t *)
+	 * casting as (idxint *), when idxint = long seems to work
+	 * although maybe not on all machines:
+	 */
+	A->p = (idxint *) mxGetJc(A_mex);
+	A->i = (idxint *) mxGetIr(A_mex);
+	d->A = A;
+	/* warm-start inputs, allocates sol->x, ->y, ->s even if warm start not used */
+	d->WARM_START = parseWarmStart((mxArray *) mxGetField(data, 0, "x"), &(sol.x), d->n);
+	d->WARM_START |= parseWarmStart((mxArray *) mxGetField(data, 0, "y"), &(sol.y), d->m);
+	d->WARM_START |= parseWarmStart((mxArray *) mxGetField(data, 0, "s"), &(sol.s), d->m);
+
+	scs(d, k, &sol, &info);
+
+	setOutputs(nlhs, plhs, d, &sol);
+	if (nlhs > 3) {
+		plhs[3] = infoStruct(&info, resTrace);
+	} else if (resTrace) {
+		mxDestroyArray(resTrace);
+	}
 
 	freeMex(d, k);
 	return;
 }
 
 void freeMex(Data * d, Cone * k) {
+	if (d && d->PERM)
+		mxFree((idxint *) d->PERM);
 	if (k->q)
 		scs_free(k->q);
 	if (k->s)
 		scs_free(k->s);
+	if (k->sp)
+		scs_free(k->sp);
 	if (d) {
 		if(d->A) scs_free(d->A);
 		scs_free(d);
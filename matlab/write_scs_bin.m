@@ -0,0 +1,62 @@
+function write_scs_bin(data,K,params,name)
+% writes the problem data, cones, the params MAX_ITERS, NORMALIZE, EPS,
+% ALPHA, RHO_X, SCALE and CG_RATE and, if data has x, y and s, a warm
+% start to the binary file read by the compiled demos (demo_direct,
+% demo_indirect), scs_read_data of the C library, read_scs_bin and
+% scs.read_data in python, see include/rw.h for the layout
+% unlike write_scs_data this is fast and exact for large problems
+
+% set default params if not present:
+if ~isfield(params,'MAX_ITERS');params.MAX_ITERS = 2500;end
+if ~isfield(params,'NORMALIZE');params.NORMALIZE = 1;end
+if ~isfield(params,'EPS');params.EPS = 1e-3;end
+if ~isfield(params,'ALPHA');params.ALPHA = 1.8;end
+if ~isfield(params,'RHO_X');params.RHO_X = 1e-3;end
+if ~isfield(params,'SCALE');params.SCALE = 5;end
+if ~isfield(params,'CG_RATE');params.CG_RATE = 2;end
+
+%% set cone data if not present:
+if ~isfield(K,'f');K.f = 0;end
+if ~isfield(K,'l');K.l = 0;end
+if ~isfield(K,'q');K.q = [];end
+if ~isfield(K,'s');K.s = [];end
+if ~isfield(K,'sp');K.sp = [];end
+if ~isfield(K,'ep');K.ep = 0;end
+if ~isfield(K,'ed');K.ed = 0;end
+
+n = length(data.c);
+m = size(data.A,1);
+A = sparse(data.A);
+% col-compressed A, 0-based
+[i,~,s] = find(A);
+pw = [0 cumsum(full(sum(A~=0)))];
+warm = isfield(data,'x') && isfield(data,'y') && isfield(data,'s');
+
+fi = fopen(name,'w','native');
+fwrite(fi,'SCS_DATA','char');
+fwrite(fi,[1 hex2dec('01020304') 8 8],'uint32');
+fwrite(fi,[m n length(s) K.f K.l length(K.q) length(K.s) length(K.sp) K.ep K.ed warm ...
+    params.MAX_ITERS params.NORMALIZE 0 0 0],'int64');
+fwrite(fi,[params.EPS params.ALPHA params.RHO_X params.SCALE params.CG_RATE 0 0 0],'double');
+arrays = {K.q, K.s, K.sp, pw, i-1};
+for j=1:length(arrays)
+    write_section(fi,arrays{j},'int64');
+end
+arrays = {s, data.b, data.c};
+if warm
+    arrays = [arrays {data.x, data.y, data.s}];
+end
+for j=1:length(arrays)
+    write_section(fi,full(arrays{j}),'double');
+end
+fclose(fi);
+end
+
+function write_section(fi,v,type)
+% nonempty arrays start at a multiple of 64 bytes
+if isempty(v)
+    return
+end
+fwrite(fi,zeros(1,mod(-ftell(fi),64)),'uint8');
+fwrite(fi,v(:),type);
+end
@@ -1,19 +1,17 @@
 #!/usr/bin/env python
 import _scs_direct
 import _scs_indirect
+import _scs_direct_int32
+import _scs_indirect_int32
 from warnings import warn
 from scipy import sparse
+import numpy as np
+import struct
 
 
-def solve(probdata, cone, opts={}, USE_INDIRECT=False):
+def _unpack(probdata, cone):
     """
-    solves convex cone problems
-     
-    @return dictionary with solution with keys:
-         'x' - primal solution
-         's' - primal slack solution
-         'y' - dual solution
-         'info' - information dictionary
+    validates the problem data and returns the csolve arguments
     """
     if not probdata or not cone:
         raise TypeError("Missing data or cone information")
@@ -48,8 +46,153 @@ def solve(probdata, cone, opts={}, USE_INDIRECT=False):
 
     m, n = A.shape
 
-    Adata, Aindices, Acolptr = A.data, A.indices, A.indptr
+    return (m, n), A.data, A.indices, A.indptr, b, c, warm
+
+
+def _module(USE_INDIRECT, Aindices, Acolptr):
+    """
+    picks the extension whose index type matches A, so A is passed without copying
+    (the index arrays are converted otherwise)
+    """
     if USE_INDIRECT:
-        return _scs_indirect.csolve((m, n), Adata, Aindices, Acolptr, b, c, cone, opts, warm)
+        modules = (_scs_indirect, _scs_indirect_int32)
     else:
-        return _scs_direct.csolve((m, n), Adata, Aindices, Acolptr, b, c, cone, opts, warm)
+        modules = (_scs_direct, _scs_direct_int32)
+    for mod in modules:
+        if Aindices.dtype.kind == 'i' and Aindices.dtype.itemsize == mod.INDEX_SIZE and Acolptr.dtype == Aindices.dtype:
+            return mod
+    return modules[0]
+
+
+def solve(probdata, cone, opts={}, USE_INDIRECT=False):
+    """
+    solves convex cone problems
+     
+    @return dictionary with solution with keys:
+         'x' - primal solution
+         's' - primal slack solution
+         'y' - dual solution
+         'info' - information dictionary
+    """
+    shape, Adata, Aindices, Acolptr, b, c, warm = _unpack(probdata, cone)
+    mod = _module(USE_INDIRECT, Aindices, Acolptr)
+    return mod.csolve(shape, Adata, Aindices, Acolptr, b, c, cone, opts, warm)
+
+
+class Workspace(object):
+    """
+    sets up (and for direct, factorizes) once for many solves that share A and the cones
+
+    usage:
+        work = Workspace(probdata, cone, opts)
+        sol = work.solve(b=new_b, c=new_c, warm={'x': x0, 'y': y0, 's': s0})
+
+    any of b, c and warm may be omitted, the last b and c given are kept.
+    The solve releases the GIL, but one Workspace solves one problem at a time.
+    A is referenced, not copied, so it must not be modified while the Workspace is alive.
+    """
+    def __init__(self, probdata, cone, opts={}, USE_INDIRECT=False):
+        shape, Adata, Aindices, Acolptr, b, c, warm = _unpack(probdata, cone)
+        self._warm = warm
+        mod = _module(USE_INDIRECT, Aindices, Acolptr)
+        self._work = mod.Workspace(shape, Adata, Aindices, Acolptr, b, c, cone, opts)
+
+    def solve(self, b=None, c=None, warm=None):
+        """
+        @return dictionary with solution, same as solve
+        """
+        if warm is None:
+            warm, self._warm = self._warm, {}
+        if sparse.issparse(b):
+            b = b.todense()
+        if sparse.issparse(c):
+            c = c.todense()
+        return self._work.solve(b, c, warm)
+
+
+# the binary problem file of scs_write_data, see include/rw.h
+_DATA_MAGIC = b'SCS_DATA'
+_DATA_VERSION = 1
+_DATA_ALIGN = 64
+_DATA_HEADER = '=8sIIII16q8d'
+_DATA_HEADER_LEN = 256
+_DATA_BYTE_ORDER = 0x01020304
+_DATA_OPTS = (('MAX_ITERS', 2500), ('NORMALIZE', 1))
+_DATA_FLOAT_OPTS = (('EPS', 1e-3), ('ALPHA', 1.8), ('RHO_X', 1e-3), ('SCALE', 5), ('CG_RATE', 2))
+
+
+def _align(off):
+    return (off + _DATA_ALIGN - 1) // _DATA_ALIGN * _DATA_ALIGN
+
+
+def write_data(filename, probdata, cone, opts={}):
+    """
+    writes the problem, the settings in opts of the file (MAX_ITERS, NORMALIZE, EPS, ALPHA, RHO_X, SCALE, CG_RATE)
+    and, if probdata has x, y and s, a warm start to a binary file that read_data, the C library
+    (scs_read_data) and the C demos load
+    """
+    shape, Adata, Aindices, Acolptr, b, c, warm = _unpack(probdata, cone)
+    m, n = shape
+    itype = np.int64 if Aindices.dtype.itemsize == 8 else np.int32
+    hasWarm = all(key in warm for key in ('x', 'y', 's'))
+    arrays = [(cone.get(key, []), itype) for key in ('q', 's', 'sp')]
+    arrays += [(Acolptr, itype), (Aindices, itype), (Adata, np.float64), (b, np.float64), (c, np.float64)]
+    if hasWarm:
+        arrays += [(warm[key], np.float64) for key in ('x', 'y', 's')]
+    ints = [m, n, len(Adata), cone.get('f', 0), cone.get('l', 0), len(arrays[0][0]), len(arrays[1][0]),
+            len(arrays[2][0]), cone.get('ep', 0), cone.get('ed', 0), int(hasWarm)]
+    ints += [int(opts.get(key, default)) for key, default in _DATA_OPTS] + [0] * 3
+    floats = [float(opts.get(key, default)) for key, default in _DATA_FLOAT_OPTS] + [0.] * 3
+    head = struct.pack(_DATA_HEADER, _DATA_MAGIC, _DATA_VERSION, _DATA_BYTE_ORDER, np.dtype(itype).itemsize, 8,
+                       *(ints + floats))
+    with open(filename, 'wb') as f:
+        f.write(head + b'\0' * (_DATA_HEADER_LEN - len(head)))
+        off = _DATA_HEADER_LEN
+        for arr, dtype in arrays:
+            data = np.ascontiguousarray(np.asarray(arr).ravel(), dtype=dtype).tobytes()
+            if len(data) == 0:
+                continue
+            f.write(b'\0' * (_align(off) - off))
+            f.write(data)
+            off = _align(off) + len(data)
+
+
+def read_data(filename):
+    """
+    reads a file of write_data or scs_write_data, the arrays are memory-mapped copy-on-write (not read, and
+    changing them does not change the file)
+
+    @return (probdata, cone, opts) to pass to solve, probdata holds x, y and s if the file has a warm start
+    """
+    with open(filename, 'rb') as f:
+        head = f.read(struct.calcsize(_DATA_HEADER))
+    if len(head) < struct.calcsize(_DATA_HEADER):
+        raise ValueError("%s is not an scs data file" % filename)
+    fields = struct.unpack(_DATA_HEADER, head)
+    magic, version, byteOrder, intSize, floatSize = fields[:5]
+    ints, floats = fields[5:21], fields[21:29]
+    if (magic != _DATA_MAGIC or version > _DATA_VERSION or byteOrder != _DATA_BYTE_ORDER
+            or intSize not in (4, 8) or floatSize not in (4, 8)):
+        raise ValueError("%s is not an scs data file of version <= %i in this byte order" % (filename, _DATA_VERSION))
+    m, n, nnz, f, l, qsize, ssize, spsize, ep, ed, hasWarm = ints[:11]
+    itype = np.int32 if intSize == 4 else np.int64
+    ftype = np.float32 if floatSize == 4 else np.float64
+    off = [_DATA_HEADER_LEN]
+
+    def section(length, dtype):
+        if length == 0:
+            return np.zeros(0, dtype=dtype)
+        start = _align(off[0])
+        off[0] = start + length * np.dtype(dtype).itemsize
+        return np.memmap(filename, dtype=dtype, mode='c', offset=start, shape=(length,))
+
+    q, s, sp = section(qsize, itype), section(ssize, itype), section(spsize, itype)
+    Ap, Ai, Ax = section(n + 1, itype), section(nnz, itype), section(nnz, ftype)
+    probdata = {'A': sparse.csc_matrix((Ax, Ai, Ap), shape=(m, n)), 'b': section(m, ftype), 'c': section(n, ftype)}
+    if hasWarm:
+        probdata['x'], probdata['y'], probdata['s'] = section(n, ftype), section(m, ftype), section(m, ftype)
+    cone = {'f': f, 'l': l, 'q': [int(v) for v in q], 's': [int(v) for v in s], 'sp': [int(v) for v in sp],
+            'ep': ep, 'ed': ed}
+    opts = dict((key, ints[11 + i]) for i, (key, default) in enumerate(_DATA_OPTS))
+    opts.update((key, floats[i]) for i, (key, default) in enumerate(_DATA_FLOAT_OPTS))
+    return probdata, cone, opts
@@ -4,6 +4,7 @@
 #include "cones.h"
 #include "linsys/amatrix.h"
 #include "numpy/arrayobject.h"
+#include <stdarg.h>
 
 /* IMPORTANT: This code now uses numpy array types. It is a private C module
  * in the sense that end users only see the front-facing Python code in
@@ -28,15 +29,25 @@
 static int intType;
 static int pfloatType;
 
+/* scs_printf for the python build: the solve may run with the GIL released, so take it before printing */
+void scs_py_printf(const char * fmt, ...) {
+	char buf[1000]; /* PySys_WriteStdout truncates at 1000 bytes as well */
+	va_list args;
+	PyGILState_STATE gilState = PyGILState_Ensure();
+	va_start(args, fmt);
+	PyOS_vsnprintf(buf, sizeof(buf), fmt, args);
+	va_end(args);
+	PySys_WriteStdout("%s", buf);
+	PyGILState_Release(gilState);
+}
+
 struct ScsPyData {
 	PyArrayObject * Ax;
 	PyArrayObject * Ai;
 	PyArrayObject * Ap;
 	PyArrayObject * b;
 	PyArrayObject * c;
-	PyArrayObject * x0;
-	PyArrayObject * y0;
-	PyArrayObject * s0;
+	PyArrayObject * perm; /* PERM of the opts */
 };
 
 /* Note, Python3.x may require special handling for the idxint and pfloat
@@ -62,19 +73,16 @@ static int getDoubleType(void) {
 }
 
 static PyArrayObject *getContiguous(PyArrayObject *array, int typenum) {
-	/* gets the pointer to the block of contiguous C memory */
-	/* the overhead should be small unless the numpy array has been */
-	/* reordered in some way or the data type doesn't quite match */
-	/* */
-	/* the "new_owner" pointer has to have Py_DECREF called on it; it owns */
-	/* the "new" array object created by PyArray_Cast */
-	/* */
-	static PyArrayObject *tmp_arr;
-	PyArrayObject *new_owner;
-	tmp_arr = PyArray_GETCONTIGUOUS(array);
-	new_owner = (PyArrayObject *) PyArray_Cast(tmp_arr, typenum);
-	Py_DECREF(tmp_arr);
-	return new_owner;
+	/* returns a new reference to a C contiguous array of the given type; this is */
+	/* the input array itself (no copy) when it already is one, e.g., the arrays */
+	/* of a scipy CSC matrix when the extension's idxint matches their index type */
+	return (PyArrayObject *) PyArray_FROMANY((PyObject *) array, typenum, 1, 1, NPY_ARRAY_IN_ARRAY);
+}
+
+static PyArrayObject *getCopy(PyArrayObject *array, int typenum) {
+	/* b and c are normalized in place during the solve, so they are always copied */
+	return (PyArrayObject *) PyArray_FROMANY((PyObject *) array, typenum, 1, 1,
+			NPY_ARRAY_IN_ARRAY | NPY_ARRAY_ENSURECOPY);
 }
 
 static int printErr(char * key) {
@@ -82,22 +90,6 @@ static int printErr(char * key) {
 	return -1;
 }
 
-static idxint getWarmStart(char * key, pfloat ** x, PyArrayObject ** px0, idxint l, PyObject * warm) {
-    PyArrayObject *x0 = (PyArrayObject *) PyDict_GetItemString(warm, key);
-	*x = scs_calloc(l, sizeof(pfloat));
-    if (x0) {
-		if (!PyArray_ISFLOAT(x0) || PyArray_NDIM(x0) != 1 || PyArray_DIM(x0,0) != l) {
-			PySys_WriteStderr("Error parsing warm-start input\n");
-			return 0;
-		} else {
-			*px0 = getContiguous(x0, pfloatType);
-			*x = (pfloat *) PyArray_DATA(*px0);
-			return 1;
-		}
-	}
-	return 0;
-}
-
 static int getConeArrDim(char * key, idxint ** varr, idxint * vsize, PyObject * cone) {
 	/* get cone['key'] */
 	idxint i, n = 0;
@@ -180,6 +172,34 @@ static int parseOpts(Data *d, PyObject * opts) {
 		return -1;
 	if (getOptFloatParam("RHO_X", &(d->RHO_X), 1e-3, opts) < 0)
 		return -1;
+	if (getPosIntParam("STORE_TRANSPOSE", &(d->STORE_TRANSPOSE), 0, opts) < 0)
+		return -1;
+	if (getPosIntParam("ACCEL_MEM", &(d->ACCEL_MEM), 0, opts) < 0)
+		return -1;
+	if (getPosIntParam("MIXED_PRECISION", &(d->MIXED_PRECISION), 0, opts) < 0)
+		return -1;
+	if (getPosIntParam("CG_ADAPTIVE", &(d->CG_ADAPTIVE), 0, opts) < 0)
+		return -1;
+	if (getPosIntParam("CG_MAX_ITERS", &(d->CG_MAX_ITERS), 0, opts) < 0)
+		return -1;
+	if (getPosIntParam("CG_PRECOND", &(d->CG_PRECOND), 0, opts) < 0)
+		return -1;
+	if (getPosIntParam("NORMAL_EQS", &(d->NORMAL_EQS), 0, opts) < 0)
+		return -1;
+	if (getPosIntParam("ADAPTIVE_RHO", &(d->ADAPTIVE_RHO), 0, opts) < 0)
+		return -1;
+	if (getPosIntParam("ARENA", &(d->ARENA), 0, opts) < 0)
+		return -1;
+	if (getPosIntParam("PRESOLVE", &(d->PRESOLVE), 1, opts) < 0)
+		return -1;
+	if (getPosIntParam("CHORDAL", &(d->CHORDAL), 0, opts) < 0)
+		return -1;
+	if (getPosIntParam("LOW_MEMORY", &(d->LOW_MEMORY), 0, opts) < 0)
+		return -1;
+	if (getPosIntParam("ORDERING", &(d->ORDERING), ORDER_AMD, opts) < 0)
+		return -1;
+	if (getOptFloatParam("TIME_LIMIT", &(d->TIME_LIMIT), 0, opts) < 0)
+		return -1;
 	return 0;
 }
 
@@ -199,20 +219,16 @@ static void freePyData(Data * d, Cone * k, struct ScsPyData * ps) {
 	if (ps->c) {
 		Py_DECREF(ps->c);
 	}
-	if (ps->x0) {
-		Py_DECREF(ps->x0);
-	}
-	if (ps->y0) {
-		Py_DECREF(ps->y0);
-	}
-	if (ps->s0) {
-		Py_DECREF(ps->s0);
+	if (ps->perm) {
+		Py_DECREF(ps->perm);
 	}
 	if (k) {
 		if (k->q)
 			scs_free(k->q);
 		if (k->s)
 			scs_free(k->s);
+		if (k->sp)
+			scs_free(k->sp);
 		scs_free(k);
 	}
 	if (d) {
@@ -228,6 +244,258 @@ static PyObject * finishWithErr(Data * d, Cone * k, struct ScsPyData * ps, char
 	return NULL;
 }
 
+/* validates and sets the problem data, returns an error message or NULL on success */
+static char * parseProblem(Data * d, Cone * k, struct ScsPyData * ps, PyArrayObject * Ax, PyArrayObject * Ai,
+		PyArrayObject * Ap, PyArrayObject * b, PyArrayObject * c, PyObject * cone, PyObject * opts) {
+	AMatrix * A;
+	PyObject * perm;
+	npy_intp i;
+	if (d->m < 0) {
+		return "m must be a positive integer";
+	}
+	if (d->n < 0) {
+		return "n must be a positive integer";
+	}
+
+	/* get the typenum for the primitive idxint and pfloat types */
+	intType = getIntType();
+	pfloatType = getDoubleType();
+
+	/* set A */
+	if (!PyArray_ISFLOAT(Ax) || PyArray_NDIM(Ax) != 1) {
+		return "Ax must be a numpy array of floats";
+	}
+	if (!PyArray_ISINTEGER(Ai) || PyArray_NDIM(Ai) != 1) {
+		return "Ai must be a numpy array of ints";
+	}
+	if (!PyArray_ISINTEGER(Ap) || PyArray_NDIM(Ap) != 1) {
+		return "Ap must be a numpy array of ints";
+	}
+	/* NULL if the values do not safely cast, e.g. uint64 indices or complex values */
+	if (!(ps->Ax = getContiguous(Ax, pfloatType))) {
+		return "Ax must be a numpy array of floats";
+	}
+	if (!(ps->Ai = getContiguous(Ai, intType))) {
+		return "Ai must be a numpy array of ints";
+	}
+	if (!(ps->Ap = getContiguous(Ap, intType))) {
+		return "Ap must be a numpy array of ints";
+	}
+
+	A = scs_malloc(sizeof(AMatrix));
+	A->x = (pfloat *) PyArray_DATA(ps->Ax);
+	A->i = (idxint *) PyArray_DATA(ps->Ai);
+	A->p = (idxint *) PyArray_DATA(ps->Ap);
+	d->A = A;
+	/*d->Anz = d->Ap[d->n]; */
+	/*d->Anz = PyArray_DIM(Ai,0); */
+	/* set c */
+	if (!PyArray_ISFLOAT(c) || PyArray_NDIM(c) != 1) {
+		return "c must be a dense numpy array with one dimension";
+	}
+	if (PyArray_DIM(c,0) != d->n) {
+		return "c has incompatible dimension with A";
+	}
+	if (!(ps->c = getCopy(c, pfloatType))) {
+		return "c must be a dense numpy array with one dimension";
+	}
+	d->c = (pfloat *) PyArray_DATA(ps->c);
+	/* set b */
+	if (!PyArray_ISFLOAT(b) || PyArray_NDIM(b) != 1) {
+		return "b must be a dense numpy array with one dimension";
+	}
+	if (PyArray_DIM(b,0) != d->m) {
+		return "b has incompatible dimension with A";
+	}
+	if (!(ps->b = getCopy(b, pfloatType))) {
+		return "b must be a dense numpy array with one dimension";
+	}
+	d->b = (pfloat *) PyArray_DATA(ps->b);
+
+	if (getPosIntParam("f", &(k->f), 0, cone) < 0) {
+		return "failed to parse cone field f";
+	}
+	if (getPosIntParam("l", &(k->l), 0, cone) < 0) {
+		return "failed to parse cone field l";
+	}
+	if (getConeArrDim("q", &(k->q), &(k->qsize), cone) < 0) {
+		return "failed to parse cone field q";
+	}
+	if (getConeArrDim("s", &(k->s), &(k->ssize), cone) < 0) {
+		return "failed to parse cone field s";
+	}
+	if (getConeArrDim("sp", &(k->sp), &(k->spsize), cone) < 0) {
+		return "failed to parse cone field sp";
+	}
+	if (getPosIntParam("ep", &(k->ep), 0, cone) < 0) {
+		return "failed to parse cone field ep";
+	}
+	if (getPosIntParam("ed", &(k->ed), 0, cone) < 0) {
+		return "failed to parse cone field ed";
+	}
+	if (parseOpts(d, opts) < 0) {
+		return "failed to parse opts";
+	}
+	/* the permutation of ORDERING 2, of the rows of the KKT matrix (or of A'A with NORMAL_EQS 1) */
+	perm = opts ? PyDict_GetItemString(opts, "PERM") : NULL;
+	if (perm) {
+		if (!PyArray_Check(perm) || !PyArray_ISINTEGER((PyArrayObject *) perm)
+				|| PyArray_NDIM((PyArrayObject *) perm) != 1) {
+			return "PERM must be a numpy array of ints";
+		}
+		if (PyArray_DIM((PyArrayObject *) perm, 0) != d->n + d->m
+				&& !(d->NORMAL_EQS == 1 && PyArray_DIM((PyArrayObject *) perm, 0) == d->n)) {
+			return "PERM must have n + m entries (n with NORMAL_EQS 1)";
+		}
+		/* any int type, e.g. the int64 of np.arange for the _int32 module: checked in int64, then cast */
+		if (!(ps->perm = getContiguous((PyArrayObject *) perm, NPY_INT64))) {
+			return "PERM must be a numpy array of ints";
+		}
+		for (i = 0; i < PyArray_DIM(ps->perm, 0); ++i) {
+			npy_int64 v = ((npy_int64 *) PyArray_DATA(ps->perm))[i];
+			if (v < 0 || v >= PyArray_DIM(ps->perm, 0)) {
+				return "PERM must be a permutation of its length";
+			}
+		}
+		if (intType != NPY_INT64) {
+			PyArrayObject * perm64 = ps->perm;
+			ps->perm = (PyArrayObject *) PyArray_FROMANY((PyObject *) perm64, intType, 1, 1,
+					NPY_ARRAY_IN_ARRAY | NPY_ARRAY_FORCECAST);
+			Py_DECREF(perm64);
+			if (!ps->perm) {
+				return "PERM must be a numpy array of ints";
+			}
+		}
+		d->PERM = (idxint *) PyArray_DATA(ps->perm);
+	}
+
+	return NULL;
+}
+
+/* the times of each phase, in seconds as the other times */
+static PyObject * getProfileDict(Profile * prof) {
+	return Py_BuildValue("{s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d}", "normalizeTime",
+			(pfloat) (prof->normalizeTime / 1e3), "kktTime", (pfloat) (prof->kktTime / 1e3), "orderTime",
+			(pfloat) (prof->orderTime / 1e3), "factorTime", (pfloat) (prof->factorTime / 1e3), "linSysTime",
+			(pfloat) (prof->linSysTime / 1e3), "coneTime", (pfloat) (prof->coneTime / 1e3), "convergedTime",
+			(pfloat) (prof->convergedTime / 1e3), "minIterTime", (pfloat) (prof->minIterTime / 1e3), "maxIterTime",
+			(pfloat) (prof->maxIterTime / 1e3), "avgIterTime", (pfloat) (prof->avgIterTime / 1e3));
+}
+
+/* the residual trace as a resTraceLen by 4 array of rows (iter, resPri, resDual, relGap) */
+static PyObject * getTraceArray(Info * info) {
+	npy_intp dims[2];
+	PyObject * trace;
+	dims[0] = info->resTraceLen;
+	dims[1] = 4;
+	trace = PyArray_ZEROS(2, dims, NPY_DOUBLE, 0);
+	if (trace && info->resTraceLen > 0) {
+		memcpy(PyArray_DATA((PyArrayObject *) trace), info->resTrace, 4 * info->resTraceLen * sizeof(pfloat));
+	}
+	return trace;
+}
+
+static PyObject * getInfoDict(Info * info) {
+	PyObject * prof = getProfileDict(&(info->prof));
+	PyObject * infoDict = Py_BuildValue("{s:l,s:l,s:l,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:l,s:d,s:l,s:s,s:N}",
+			"statusVal", (long) info->statusVal, "iter", (long) info->iter, "linSysIters",
+			(long) info->linSysIters, "pobj", (pfloat) info->pobj, "dobj", (pfloat) info->dobj, "resPri",
+			(pfloat) info->resPri, "resDual", (pfloat) info->resDual, "relGap", (pfloat) info->relGap, "solveTime",
+			(pfloat) (info->solveTime / 1e3), "setupTime", (pfloat) (info->setupTime / 1e3), "setupPeakBytes",
+			(pfloat) info->setupPeakBytes, "workBytes", (pfloat) info->workBytes, "solvePeakBytes",
+			(pfloat) info->solvePeakBytes, "ordering", (long) info->prof.ordering, "lnz", (pfloat) info->prof.lnz,
+			"treeHeight", (long) info->prof.treeHeight, "status", info->status, "prof", prof);
+	if (infoDict && info->resTrace) {
+		PyObject * trace = getTraceArray(info);
+		if (trace) {
+			PyDict_SetItemString(infoDict, "resTrace", trace);
+			Py_DECREF(trace);
+		}
+	}
+	return infoDict;
+}
+
+/* with traceLen > 0 points info at a buffer for that many residual trace entries (TRACE_LEN of the opts) */
+static int newTrace(Info * info, idxint traceLen) {
+	info->resTrace = NULL;
+	info->resTraceCap = traceLen;
+	info->resTraceLen = 0;
+	if (traceLen > 0 && !(info->resTrace = scs_malloc(4 * traceLen * sizeof(pfloat)))) {
+		return -1;
+	}
+	return 0;
+}
+
+/* copies a dense vector of length len into dst, returns -1 if obj is not one */
+static int copyVec(PyObject * obj, pfloat * dst, idxint len) {
+	PyArrayObject * arr;
+	if (!PyArray_Check(obj) || !PyArray_ISFLOAT((PyArrayObject *) obj) || PyArray_NDIM((PyArrayObject *) obj) != 1
+			|| PyArray_DIM((PyArrayObject *) obj, 0) != len) {
+		return -1;
+	}
+	if (!(arr = getContiguous((PyArrayObject *) obj, pfloatType))) {
+		PyErr_Clear();
+		return -1;
+	}
+	memcpy(dst, PyArray_DATA(arr), len * sizeof(pfloat));
+	Py_DECREF(arr);
+	return 0;
+}
+
+static idxint copyWarmStart(char * key, pfloat * x, idxint l, PyObject * warm) {
+	PyObject * x0 = PyDict_GetItemString(warm, key);
+	if (x0) {
+		if (copyVec(x0, x, l) < 0) {
+			PySys_WriteStderr("Error parsing warm-start input\n");
+			return 0;
+		}
+		return 1;
+	}
+	return 0;
+}
+
+/* allocates the returned x, y and s, points sol at them and copies in any warm-start */
+static int newSolution(Data * d, Sol * sol, PyObject ** x, PyObject ** y, PyObject ** s, PyObject * warm) {
+	npy_intp veclen[1];
+	veclen[0] = d->n;
+	*x = PyArray_ZEROS(1, veclen, NPY_DOUBLE, 0);
+	veclen[0] = d->m;
+	*y = PyArray_ZEROS(1, veclen, NPY_DOUBLE, 0);
+	*s = PyArray_ZEROS(1, veclen, NPY_DOUBLE, 0);
+	if (!*x || !*y || !*s) {
+		Py_XDECREF(*x);
+		Py_XDECREF(*y);
+		Py_XDECREF(*s);
+		return -1;
+	}
+	sol->x = (pfloat *) PyArray_DATA((PyArrayObject *) *x);
+	sol->y = (pfloat *) PyArray_DATA((PyArrayObject *) *y);
+	sol->s = (pfloat *) PyArray_DATA((PyArrayObject *) *s);
+	d->WARM_START = 0;
+	if (warm) {
+		d->WARM_START = copyWarmStart("x", sol->x, d->n, warm);
+		d->WARM_START |= copyWarmStart("y", sol->y, d->m, warm);
+		d->WARM_START |= copyWarmStart("s", sol->s, d->m, warm);
+	}
+	return 0;
+}
+
+/* builds the returned dictionary, steals the references to x, y and s and frees the residual trace of info */
+static PyObject * packSolution(PyObject * x, PyObject * y, PyObject * s, Info * info) {
+	PyObject *returnDict, *infoDict = getInfoDict(info);
+	if (info->resTrace) {
+		scs_free(info->resTrace);
+		info->resTrace = NULL;
+	}
+	returnDict = Py_BuildValue("{s:O,s:O,s:O,s:O}", "x", x, "y", y, "s", s, "info", infoDict);
+	/* give up ownership to the return dictionary */
+	Py_DECREF(x);
+	Py_DECREF(y);
+	Py_DECREF(s);
+	Py_DECREF(infoDict);
+	return returnDict;
+}
+
 static PyObject *csolve(PyObject* self, PyObject *args, PyObject *kwargs) {
 	/* Expects a function call
 	 *     sol = csolve((m,n),Ax,Ai,Ap,b,c,cone,opts)
@@ -265,13 +533,13 @@ static PyObject *csolve(PyObject* self, PyObject *args, PyObject *kwargs) {
 	/* data structures for arguments */
 	PyArrayObject *Ax, *Ai, *Ap, *c, *b;
 	PyObject *cone, *opts, *warm = NULL;
-	struct ScsPyData ps = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+	struct ScsPyData ps = { NULL, NULL, NULL, NULL, NULL, NULL };
 	/* scs data structures */
 	Data * d = scs_calloc(sizeof(Data), 1);
 	Cone * k = scs_calloc(sizeof(Cone), 1);
-    AMatrix * A;
 	Sol sol = { 0 };
-	Info info;
+	Info info = { 0 };
+	idxint traceLen;
 	static char *kwlist[] = { "shape", "Ax", "Ai", "Ap", "b", "c", "cone", "opts", "warm", NULL };
 	/* parse the arguments and ensure they are the correct type */
 #ifdef DLONG
@@ -279,8 +547,8 @@ static PyObject *csolve(PyObject* self, PyObject *args, PyObject *kwargs) {
 #else
 	static char *argparse_string = "(ii)O!O!O!O!O!O!|O!O!";
 #endif
-    npy_intp veclen[1];
-    PyObject *x, *y, *s, *returnDict, *infoDict;
+	PyObject *x, *y, *s;
+	char * errMsg;
 
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, argparse_string, kwlist, &(d->m), &(d->n), &PyArray_Type, &Ax,
 			&PyArray_Type, &Ai, &PyArray_Type, &Ap, &PyArray_Type, &b, &PyArray_Type, &c, &PyDict_Type, &cone,
@@ -288,143 +556,184 @@ static PyObject *csolve(PyObject* self, PyObject *args, PyObject *kwargs) {
 		return NULL;
 	}
 
-	if (d->m < 0) {
-		PyErr_SetString(PyExc_ValueError, "m must be a positive integer");
-		return NULL;
+	if ((errMsg = parseProblem(d, k, &ps, Ax, Ai, Ap, b, c, cone, opts))) {
+		return finishWithErr(d, k, &ps, errMsg);
+	}
+	if (getPosIntParam("TRACE_LEN", &traceLen, 0, opts) < 0) {
+		return finishWithErr(d, k, &ps, "failed to parse opts");
 	}
 
-	if (d->n < 0) {
-		PyErr_SetString(PyExc_ValueError, "n must be a positive integer");
-		return NULL;
+	if (newTrace(&info, traceLen) < 0 || newSolution(d, &sol, &x, &y, &s, warm) < 0) {
+		if (info.resTrace)
+			scs_free(info.resTrace);
+		freePyData(d, k, &ps);
+		return PyErr_NoMemory();
 	}
 
-	/* get the typenum for the primitive idxint and pfloat types */
-	intType = getIntType();
-	pfloatType = getDoubleType();
+	/* Solve! the data is not touched by Python while the GIL is released */
+	Py_BEGIN_ALLOW_THREADS
+	scs(d, k, &sol, &info);
+	Py_END_ALLOW_THREADS
 
-	/* set A */
-	if (!PyArray_ISFLOAT(Ax) || PyArray_NDIM(Ax) != 1) {
-		return finishWithErr(d, k, &ps, "Ax must be a numpy array of floats");
-	}
-	if (!PyArray_ISINTEGER(Ai) || PyArray_NDIM(Ai) != 1) {
-		return finishWithErr(d, k, &ps, "Ai must be a numpy array of ints");
-	}
-	if (!PyArray_ISINTEGER(Ap) || PyArray_NDIM(Ap) != 1) {
-		return finishWithErr(d, k, &ps, "Ap must be a numpy array of ints");
-	}
-	ps.Ax = getContiguous(Ax, pfloatType);
-	ps.Ai = getContiguous(Ai, intType);
-	ps.Ap = getContiguous(Ap, intType);
+	/* no longer need pointers to arrays that held primitives */
+	freePyData(d, k, &ps);
+	return packSolution(x, y, s, &info);
+}
 
-    A = scs_malloc(sizeof(AMatrix));
-	A->x = (pfloat *) PyArray_DATA(ps.Ax);
-	A->i = (idxint *) PyArray_DATA(ps.Ai);
-	A->p = (idxint *) PyArray_DATA(ps.Ap);
-	d->A = A;
-	/*d->Anz = d->Ap[d->n]; */
-	/*d->Anz = PyArray_DIM(Ai,0); */
-	/* set c */
-	if (!PyArray_ISFLOAT(c) || PyArray_NDIM(c) != 1) {
-		return finishWithErr(d, k, &ps, "c must be a dense numpy array with one dimension");
-	}
-	if (PyArray_DIM(c,0) != d->n) {
-		return finishWithErr(d, k, &ps, "c has incompatible dimension with A");
+/* Workspace: persistent scs_init for solving many problems that share A and the cones */
+typedef struct {
+	PyObject_HEAD
+	Data * d;
+	Cone * k;
+	Work * w;
+	struct ScsPyData ps; /* references to A (not copied, must not be modified) and the copies of b and c */
+	pfloat setupTime, setupPeakBytes;
+	Profile prof; /* the setup phases */
+	idxint traceLen; /* TRACE_LEN of the opts */
+	idxint busy; /* a solve is running with the GIL released */
+} ScsPyWorkspace;
+
+static void Workspace_dealloc(ScsPyWorkspace * self) {
+	if (self->w) {
+		scs_finish(self->d, self->w);
+	}
+	freePyData(self->d, self->k, &(self->ps));
+	Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+static int Workspace_init(ScsPyWorkspace * self, PyObject *args, PyObject *kwargs) {
+	/* Expects a call
+	 *     work = Workspace((m,n),Ax,Ai,Ap,b,c,cone,opts)
+	 * with the arguments of csolve, sets up (and for direct, factorizes) once
+	 */
+	PyArrayObject *Ax, *Ai, *Ap, *c, *b;
+	PyObject *cone, *opts = NULL;
+	Info info = { 0 };
+	char * errMsg;
+	static char *kwlist[] = { "shape", "Ax", "Ai", "Ap", "b", "c", "cone", "opts", NULL };
+#ifdef DLONG
+	static char *argparse_string = "(ll)O!O!O!O!O!O!|O!";
+#else
+	static char *argparse_string = "(ii)O!O!O!O!O!O!|O!";
+#endif
+	if (self->d) {
+		PyErr_SetString(PyExc_RuntimeError, "Workspace is already initialized");
+		return -1;
 	}
-	ps.c = getContiguous(c, pfloatType);
-	d->c = (pfloat *) PyArray_DATA(ps.c);
-	/* set b */
-	if (!PyArray_ISFLOAT(b) || PyArray_NDIM(b) != 1) {
-		return finishWithErr(d, k, &ps, "b must be a dense numpy array with one dimension");
+	self->d = scs_calloc(sizeof(Data), 1);
+	self->k = scs_calloc(sizeof(Cone), 1);
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, argparse_string, kwlist, &(self->d->m), &(self->d->n),
+			&PyArray_Type, &Ax, &PyArray_Type, &Ai, &PyArray_Type, &Ap, &PyArray_Type, &b, &PyArray_Type, &c,
+			&PyDict_Type, &cone, &PyDict_Type, &opts)) {
+		return -1;
 	}
-	if (PyArray_DIM(b,0) != d->m) {
-		return finishWithErr(d, k, &ps, "b has incompatible dimension with A");
+	if ((errMsg = parseProblem(self->d, self->k, &(self->ps), Ax, Ai, Ap, b, c, cone, opts))) {
+		PyErr_SetString(PyExc_ValueError, errMsg);
+		return -1;
 	}
-	ps.b = getContiguous(b, pfloatType);
-	d->b = (pfloat *) PyArray_DATA(ps.b);
-
-	if (getPosIntParam("f", &(k->f), 0, cone) < 0) {
-		return finishWithErr(d, k, &ps, "failed to parse cone field f");
+	if (getPosIntParam("TRACE_LEN", &(self->traceLen), 0, opts) < 0) {
+		PyErr_SetString(PyExc_ValueError, "failed to parse opts");
+		return -1;
 	}
-	if (getPosIntParam("l", &(k->l), 0, cone) < 0) {
-		return finishWithErr(d, k, &ps, "failed to parse cone field l");
+	self->d->WARM_START = 0;
+	Py_BEGIN_ALLOW_THREADS
+	self->w = scs_init(self->d, self->k, &info);
+	Py_END_ALLOW_THREADS
+	if (!self->w) {
+		PyErr_SetString(PyExc_ValueError, "could not initialize work");
+		return -1;
 	}
-	if (getConeArrDim("q", &(k->q), &(k->qsize), cone) < 0) {
-		return finishWithErr(d, k, &ps, "failed to parse cone field q");
+	self->setupTime = info.setupTime;
+	self->setupPeakBytes = info.setupPeakBytes;
+	self->prof = info.prof;
+	return 0;
+}
+
+static PyObject * Workspace_solve(ScsPyWorkspace * self, PyObject *args, PyObject *kwargs) {
+	/* Expects a call
+	 *     sol = work.solve(b=None,c=None,warm={})
+	 * where new `b` and `c` replace the previous ones (which are kept if not given)
+	 * and `warm` is a dictionary of warm-start vectors 'x', 'y' and 's'.
+	 * Returns the same dictionary as csolve.
+	 */
+	PyObject *b = Py_None, *c = Py_None, *warm = NULL;
+	PyObject *x, *y, *s;
+	static char *kwlist[] = { "b", "c", "warm", NULL };
+	Data * d = self->d;
+	Sol sol = { 0 };
+	Info info = { 0 };
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OOO!", kwlist, &b, &c, &PyDict_Type, &warm)) {
+		return NULL;
 	}
-	if (getConeArrDim("s", &(k->s), &(k->ssize), cone) < 0) {
-		return finishWithErr(d, k, &ps, "failed to parse cone field s");
+	if (!self->w) {
+		PyErr_SetString(PyExc_RuntimeError, "Workspace is not initialized");
+		return NULL;
 	}
-	if (getPosIntParam("ep", &(k->ep), 0, cone) < 0) {
-		return finishWithErr(d, k, &ps, "failed to parse cone field ep");
+	if (self->busy) {
+		PyErr_SetString(PyExc_RuntimeError, "Workspace is already solving in another thread");
+		return NULL;
 	}
-	if (getPosIntParam("ed", &(k->ed), 0, cone) < 0) {
-		return finishWithErr(d, k, &ps, "failed to parse cone field ed");
+	if (b != Py_None && copyVec(b, d->b, d->m) < 0) {
+		PyErr_SetString(PyExc_ValueError, "b must be a dense numpy array of length m");
+		return NULL;
 	}
-	if (parseOpts(d, opts) < 0) {
-		return finishWithErr(d, k, &ps, "failed to parse opts");
+	if (c != Py_None && copyVec(c, d->c, d->n) < 0) {
+		PyErr_SetString(PyExc_ValueError, "c must be a dense numpy array of length n");
+		return NULL;
 	}
 
-	/* Solve! */
-	d->WARM_START = 0;
-	if (warm) {
-		d->WARM_START = getWarmStart("x", &(sol.x), &(ps.x0), d->n, warm);
-		d->WARM_START |= getWarmStart("y", &(sol.y), &(ps.y0), d->m, warm);
-		d->WARM_START |= getWarmStart("s", &(sol.s), &(ps.s0), d->m, warm);
+	/* the solution is written straight into the returned arrays */
+	if (newTrace(&info, self->traceLen) < 0 || newSolution(d, &sol, &x, &y, &s, warm) < 0) {
+		if (info.resTrace)
+			scs_free(info.resTrace);
+		return PyErr_NoMemory();
 	}
-	scs(d, k, &sol, &info);
+	/* scs_solve only sets the solve phases */
+	info.prof = self->prof;
 
-	/* create output (all data is *deep copied*) */
-	/* x */
-	/* matrix *x; */
-	/* if(!(x = Matrix_New(n,1,DOUBLE))) */
-	/*   return PyErr_NoMemory(); */
-	/* memcpy(MAT_BUFD(x), mywork->x, n*sizeof(pfloat)); */
-	veclen[0] = d->n;
-	x = PyArray_SimpleNewFromData(1, veclen, NPY_DOUBLE, sol.x);
-
-	/* y */
-	/* matrix *y; */
-	/* if(!(y = Matrix_New(p,1,DOUBLE))) */
-	/*   return PyErr_NoMemory(); */
-	/* memcpy(MAT_BUFD(y), mywork->y, p*sizeof(pfloat)); */
-	veclen[0] = d->m;
-	y = PyArray_SimpleNewFromData(1, veclen, NPY_DOUBLE, sol.y);
-
-	/* s */
-	/* matrix *s; */
-	/* if(!(s = Matrix_New(m,1,DOUBLE))) */
-	/*   return PyErr_NoMemory(); */
-	/* memcpy(MAT_BUFD(s), mywork->s, m*sizeof(pfloat)); */
-	veclen[0] = d->m;
-	s = PyArray_SimpleNewFromData(1, veclen, NPY_DOUBLE, sol.s);
-
-	infoDict = Py_BuildValue("{s:l,s:l,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:s}", "statusVal",
-			(idxint) info.statusVal, "iter", (idxint) info.iter, "pobj", (pfloat) info.pobj, "dobj", (pfloat) info.dobj,
-			"resPri", (pfloat) info.resPri, "resDual", (pfloat) info.resDual, "relGap", (pfloat) info.relGap,
-			"solveTime", (pfloat) (info.solveTime / 1e3), "setupTime", (pfloat) (info.setupTime / 1e3), "status",
-			info.status);
+	self->busy = 1;
+	Py_BEGIN_ALLOW_THREADS
+	scs_solve(self->w, d, self->k, &sol, &info);
+	Py_END_ALLOW_THREADS
+	self->busy = 0;
+	info.setupTime = self->setupTime;
+	info.setupPeakBytes = self->setupPeakBytes;
+	return packSolution(x, y, s, &info);
+}
 
-    returnDict = Py_BuildValue("{s:O,s:O,s:O,s:O}", "x", x, "y", y, "s", s, "info", infoDict);
-	/* give up ownership to the return dictionary */
-	Py_DECREF(x);
-	Py_DECREF(y);
-	Py_DECREF(s);
-	Py_DECREF(infoDict);
+static PyMethodDef Workspace_methods[] = { { "solve", (PyCFunction) Workspace_solve, METH_VARARGS | METH_KEYWORDS,
+		"Solve with new b and c (and warm-start) re-using the setup of A." }, { NULL, NULL, 0, NULL } /* sentinel */
+};
 
-	/* no longer need pointers to arrays that held primitives */
-	freePyData(d, k, &ps);
-	return returnDict;
-}
+static PyTypeObject ScsPyWorkspaceType = { PyVarObject_HEAD_INIT(NULL, 0) };
 
 static PyMethodDef scsMethods[] = { { "csolve", (PyCFunction) csolve, METH_VARARGS | METH_KEYWORDS,
 		"Solve a convex cone problem using scs." }, { NULL, NULL, 0, NULL } /* sentinel */
 };
 
 /* Module initialization */
+/* one extension per linear system solver and index type, e.g. _scs_direct (idxint is long, DLONG) */
+/* and _scs_direct_int32 (idxint is int), so that scs.py can pass A from scipy without copying */
+#define SCS_CAT_(a, b) a##b
+#define SCS_CAT(a, b) SCS_CAT_(a, b)
+#define SCS_STR_(a) #a
+#define SCS_STR(a) SCS_STR_(a)
+#ifdef INDIRECT
+#define SCS_MOD_LINSYS _scs_indirect
+#else
+#define SCS_MOD_LINSYS _scs_direct
+#endif
+#ifdef DLONG
+#define SCS_MOD SCS_MOD_LINSYS
+#else
+#define SCS_MOD SCS_CAT(SCS_MOD_LINSYS, _int32)
+#endif
+
 #if PY_MAJOR_VERSION >= 3
 static struct PyModuleDef moduledef = {
 	PyModuleDef_HEAD_INIT,
-	"_scs", /* m_name */
+	SCS_STR(SCS_MOD), /* m_name */
 	"Solve a convex cone problem using scs.", /* m_doc */
 	-1, /* m_size */
 	scsMethods, /* m_methods */
@@ -438,14 +747,24 @@ static struct PyModuleDef moduledef = {
 static PyObject* moduleinit(void) {
 	PyObject* m;
 
+	ScsPyWorkspaceType.tp_name = SCS_STR(SCS_MOD) ".Workspace";
+	ScsPyWorkspaceType.tp_basicsize = sizeof(ScsPyWorkspace);
+	ScsPyWorkspaceType.tp_dealloc = (destructor) Workspace_dealloc;
+	ScsPyWorkspaceType.tp_flags = Py_TPFLAGS_DEFAULT;
+	ScsPyWorkspaceType.tp_doc = "Persistent scs workspace, set up once and solved many times.";
+	ScsPyWorkspaceType.tp_methods = Workspace_methods;
+	ScsPyWorkspaceType.tp_init = (initproc) Workspace_init;
+	ScsPyWorkspaceType.tp_new = PyType_GenericNew;
+	if (PyType_Ready(&ScsPyWorkspaceType) < 0)
+		return NULL;
+#if PY_VERSION_HEX < 0x03070000
+	PyEval_InitThreads(); /* needed for PyGILState_Ensure in scs_py_printf */
+#endif
+
 #if PY_MAJOR_VERSION >= 3
 	m = PyModule_Create(&moduledef);
 #else
-#ifdef INDIRECT
-	m = Py_InitModule("_scs_indirect", scsMethods);
-#else
-	m = Py_InitModule("_scs_direct", scsMethods);
-#endif
+	m = Py_InitModule(SCS_STR(SCS_MOD), scsMethods);
 #endif
 
 	/*if (import_array() < 0) return NULL; // for numpy arrays */
@@ -454,28 +773,24 @@ static PyObject* moduleinit(void) {
 	if (m == NULL)
 		return NULL;
 
+	Py_INCREF(&ScsPyWorkspaceType);
+	PyModule_AddObject(m, "Workspace", (PyObject *) &ScsPyWorkspaceType);
+	/* size of the index type, scs.py picks the extension matching the index dtype of A */
+	PyModule_AddIntConstant(m, "INDEX_SIZE", (long) sizeof(idxint));
 	return m;
 }
 ;
 
 #if PY_MAJOR_VERSION >= 3
 PyMODINIT_FUNC
-#ifdef INDIRECT
-PyInit__scs_indirect(void)
-#else
-PyInit__scs_direct(void)
-#endif
+SCS_CAT(PyInit_, SCS_MOD)(void)
 {
 	import_array(); /* for numpy arrays */
 	return moduleinit();
 }
 #else
 PyMODINIT_FUNC
-#ifdef INDIRECT
-init_scs_indirect(void)
-#else
-init_scs_direct(void)
-#endif
+SCS_CAT(init, SCS_MOD)(void)
 {
 	import_array(); /* for numpy arrays */
 	moduleinit();
@@ -15,7 +15,7 @@ def install_scs(USE_LAPACK, USE_64_BIT_BLAS, BLAS_STR, LAPACK_STR, USE_OPENMP, r
     sources = ['scsmodule.c', ] + glob(rootDir + 'src/*.c') + glob(rootDir + 'linsys/*.c')
     include_dirs = [rootDir, rootDir + 'include', get_include(), rootDir + 'linsys']
     
-    define_macros = [('PYTHON', None), ('DLONG', None)]
+    define_macros = [('PYTHON', None)]
     extra_compile_args = ["-O3"]
     library_dirs = []
     extra_link_args = []
@@ -38,27 +38,29 @@ def install_scs(USE_LAPACK, USE_64_BIT_BLAS, BLAS_STR, LAPACK_STR, USE_OPENMP, r
         extra_link_args += blas_info.pop('extra_link_args', []) + lapack_info.pop('extra_link_args', [])
         extra_compile_args += blas_info.pop('extra_compile_args', []) + lapack_info.pop('extra_compile_args', [])
     
-    _scs_direct = Extension(
-                        name='_scs_direct',
+    # one build per index type: A from scipy is passed without copying when its index dtype matches
+    ext_modules = []
+    for suffix, index_macros in (('', [('DLONG', None)]), ('_int32', [])):
+        ext_modules += [Extension(
+                        name='_scs_direct' + suffix,
                         sources=sources + glob(rootDir + 'linsys/direct/*.c') + glob(rootDir + 'linsys/direct/external/*.c'),
-                        define_macros=define_macros,
+                        define_macros=define_macros + index_macros,
                         include_dirs=include_dirs + [rootDir + 'linsys/direct/', rootDir + 'linsys/direct/external/'],
                         library_dirs=library_dirs,
                         libraries=libraries,
                         extra_link_args=extra_link_args,
                         extra_compile_args=extra_compile_args
-                        )
-    
-    _scs_indirect = Extension(
-                        name='_scs_indirect',
+                        ),
+                        Extension(
+                        name='_scs_indirect' + suffix,
                         sources=sources + glob(rootDir + 'linsys/indirect/*.c'),
-                        define_macros=define_macros + [('INDIRECT', None)],
+                        define_macros=define_macros + index_macros + [('INDIRECT', None)],
                         include_dirs=include_dirs + [rootDir + 'linsys/indirect/'],
                         library_dirs=library_dirs,
                         libraries=libraries,
                         extra_link_args=extra_link_args,
                         extra_compile_args=extra_compile_args
-                        )
+                        )]
     setup(name='scs',
             version='1.0.5',
             author = 'Brendan O\'Donoghue',
@@ -66,7 +68,7 @@ def install_scs(USE_LAPACK, USE_64_BIT_BLAS, BLAS_STR, LAPACK_STR, USE_OPENMP, r
             url = 'http://github.com/cvxgrp/scs',
             description='scs: splittling cone solver',
             py_modules=['scs'],
-            ext_modules=[_scs_direct, _scs_indirect],
+            ext_modules=ext_modules,
             requires=["numpy (>= 1.7)","scipy (>= 0.13.2)"],
             license = "GPLv3",
             long_description="Solves convex cone programs via operator splitting. Can solve: linear programs (LPs) second-order cone programs (SOCPs), semidefinite programs (SDPs), and exponential cone programs (ECPs). See http://github.com/cvxgrp/scs for more details."
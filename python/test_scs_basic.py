@@ -1,6 +1,8 @@
 # nost test suite copied initially from ECOS project
 from __future__ import print_function
 import platform
+import os
+import tempfile
 
 def import_error(msg):
   print()
@@ -37,6 +39,7 @@ b = np.array([1., -0.])
 A = sp.csc_matrix([1., -1.]).T.tocsc()
 data = {'A':A, 'b':b, 'c':c}
 cone = {'q': [], 'l': 2}
+new_cone = {'q':[2], 'l': 0}
 
 FAIL = 'Failure' # scs code for failure
 
@@ -50,7 +53,6 @@ def test_problems():
   sol = scs.solve(data, cone)
   yield check_solution, sol['x'][0], 1
 
-  new_cone = {'q':[2], 'l': 0}
   sol = scs.solve(data, new_cone)
   yield check_solution, sol['x'][0], 0.5
 
@@ -60,6 +62,142 @@ def test_problems():
   sol = scs.solve(data, new_cone, opts={'USE_INDIRECT':True})
   yield check_solution, sol['x'][0], 0.5
 
+  sol = scs.solve(data, cone, opts={'STORE_TRANSPOSE':1})
+  yield check_solution, sol['x'][0], 1
+
+  sol = scs.solve(data, new_cone, opts={'ACCEL_MEM':5})
+  yield check_solution, sol['x'][0], 0.5
+
+  sol = scs.solve(data, new_cone, opts={'USE_INDIRECT':True, 'MIXED_PRECISION':1})
+  yield check_solution, sol['x'][0], 0.5
+
+  sol = scs.solve(data, new_cone, opts={'USE_INDIRECT':True, 'CG_ADAPTIVE':1, 'CG_MAX_ITERS':10})
+  yield check_solution, sol['x'][0], 0.5
+
+  for precond in (1, 2):
+    sol = scs.solve(data, new_cone, opts={'USE_INDIRECT':True, 'CG_PRECOND':precond})
+    yield check_solution, sol['x'][0], 0.5
+
+def check_trace(info, traceLen):
+  trace = info['resTrace']
+  assert trace.shape == (min(info['iter'] + 1, traceLen), 4)
+  assert (trace[:, 0] == np.arange(trace.shape[0])).all()
+
+def test_profile():
+  for indirect in (False, True):
+    sol = scs.solve(data, new_cone, opts={'USE_INDIRECT':indirect, 'TRACE_LEN':10})
+    yield check_solution, sol['x'][0], 0.5
+    yield check_trace, sol['info'], 10
+    prof = sol['info']['prof']
+    assert prof['minIterTime'] <= prof['avgIterTime'] <= prof['maxIterTime']
+    assert prof['linSysTime'] > 0 and prof['coneTime'] >= 0
+    work = scs.Workspace(data, new_cone, opts={'TRACE_LEN':1000}, USE_INDIRECT=indirect)
+    sol = work.solve()
+    yield check_trace, sol['info'], 1000
+
+def test_time_limit():
+  sol = scs.solve(data, new_cone, opts={'TIME_LIMIT':1e-9, 'EPS':1e-9})
+  assert sol['info']['statusVal'] == 2 and sol['info']['status'].startswith('Timeout/')
+  assert sol['info']['iter'] == 0
+  sol = scs.solve(data, new_cone, opts={'TIME_LIMIT':60})
+  yield check_solution, sol['x'][0], 0.5
+
+def test_adaptive_rho():
+  for use_indirect in [False, True]:
+    sol = scs.solve(data, new_cone, opts={'ADAPTIVE_RHO':1, 'USE_INDIRECT':use_indirect})
+    yield check_solution, sol['x'][0], 0.5
+
+def test_normal_eqs():
+  # the direct solver factoring RHO_X * I + A'A (1), the KKT matrix (2) or either (0)
+  for normal in (0, 1, 2):
+    sol = scs.solve(data, new_cone, opts={'NORMAL_EQS':normal})
+    yield check_solution, sol['x'][0], 0.5
+    sol = scs.solve(data, cone, opts={'NORMAL_EQS':normal})
+    yield check_solution, sol['x'][0], 1
+
+def test_ordering():
+  # AMD (0), nested dissection (1) and a given permutation (2) of the n + m rows of the KKT matrix
+  for ordering in (0, 1, 2):
+    opts = {'ORDERING':ordering, 'NORMAL_EQS':2}
+    if ordering == 2:
+      opts['PERM'] = np.arange(A.shape[0] + A.shape[1])[::-1]
+    sol = scs.solve(data, cone, opts=opts)
+    yield check_solution, sol['x'][0], 1
+    assert sol['info']['ordering'] == ordering
+    assert sol['info']['lnz'] > 0
+    assert sol['info']['treeHeight'] > 0
+
+def test_arena():
+  for use_indirect in [False, True]:
+    sol = scs.solve(data, new_cone, opts={'ARENA':1, 'USE_INDIRECT':use_indirect})
+    yield check_solution, sol['x'][0], 0.5
+
+def test_low_memory():
+  for use_indirect in [False, True]:
+    sol = scs.solve(data, new_cone, opts={'LOW_MEMORY':1, 'USE_INDIRECT':use_indirect})
+    yield check_solution, sol['x'][0], 0.5
+    sol = scs.solve(data, cone, opts={'LOW_MEMORY':1, 'USE_INDIRECT':use_indirect})
+    yield check_solution, sol['x'][0], 1
+    # the workspace is held through the solve
+    assert sol['info']['workBytes'] > 0
+    assert sol['info']['solvePeakBytes'] >= sol['info']['workBytes']
+
+def test_presolve():
+  # the second equality row repeats the first and the third fixes x[1]
+  A2 = sp.csc_matrix(np.array([[1., 1.], [1., 1.], [0., 1.], [-1., 0.], [0., -1.]]))
+  data2 = {'A':A2, 'b':np.array([1., 1., 0.25, 0., 0.]), 'c':np.array([-1., -2.])}
+  cone2 = {'f':3, 'l':2}
+  for use_indirect in [False, True]:
+    sol = scs.solve(data2, cone2, opts={'PRESOLVE':1, 'USE_INDIRECT':use_indirect})
+    yield check_solution, sol['x'][0], 0.75
+    yield check_solution, sol['x'][1], 0.25
+  sol = scs.solve(dict(data2, b=np.array([1., 2., 0.25, 0., 0.])), cone2, opts={'PRESOLVE':1})
+  assert sol['info']['statusVal'] == -2
+
+def test_chordal():
+  # min t s.t. t I + T is psd, T tridiagonal of ones, so t = -(min eigenvalue of T)
+  N = 30
+  A3 = sp.csc_matrix(-np.eye(N).reshape(N * N, 1))
+  T = np.eye(N, k=1) + np.eye(N, k=-1)
+  data3 = {'A':A3, 'b':T.flatten(), 'c':np.array([1.])}
+  for chordal in (0, 1):
+    sol = scs.solve(data3, {'s':[N]}, opts={'CHORDAL':chordal})
+    yield check_solution, sol['x'][0], 2 * np.cos(np.pi / (N + 1))
+    assert np.linalg.eigvalsh(sol['y'].reshape(N, N)).min() > -1e-4
+
+def test_data_file():
+  fd, name = tempfile.mkstemp()
+  os.close(fd)
+  try:
+    warm = dict(data, x=np.array([0.5]), y=np.zeros(2), s=np.zeros(2))
+    scs.write_data(name, warm, new_cone, opts={'EPS':1e-5})
+    data2, cone2, opts = scs.read_data(name)
+    assert (data2['A'] != A).nnz == 0 and (data2['b'] == b).all() and (data2['c'] == c).all()
+    assert cone2['q'] == [2] and cone2['l'] == 0 and opts['EPS'] == 1e-5
+    assert (data2['x'] == warm['x']).all()
+    sol = scs.solve(data2, cone2, opts=opts)
+    yield check_solution, sol['x'][0], 0.5
+  finally:
+    os.remove(name)
+
+def test_data_not_modified():
+  Ax, bb, cc = A.data.copy(), b.copy(), c.copy()
+  for indices in (np.int32, np.int64):
+    A32 = sp.csc_matrix((A.data, A.indices.astype(indices), A.indptr.astype(indices)), shape=A.shape)
+    sol = scs.solve({'A':A32, 'b':b, 'c':c}, cone)
+    yield check_solution, sol['x'][0], 1
+  assert (A.data == Ax).all() and (b == bb).all() and (c == cc).all()
+
+def test_workspace():
+  for indirect in (False, True):
+    work = scs.Workspace(data, cone, USE_INDIRECT=indirect)
+    sol = work.solve()
+    yield check_solution, sol['x'][0], 1
+    sol = work.solve(b=np.array([2., -0.]), warm=sol)
+    yield check_solution, sol['x'][0], 2
+    sol = work.solve(c=np.array([1.]))
+    yield check_solution, sol['x'][0], 0
+
 
 if platform.python_version_tuple() < ('3','0','0'):
   def test_problems_with_longs():
@@ -83,6 +221,17 @@ def test_failures():
   yield assert_raises, ValueError, scs.solve, data, {'q':[4], 'l':-2}
   yield check_keyword, ValueError, 'MAX_ITERS', -1
   yield check_keyword, ValueError, 'MAX_ITERS', 1.1
+  yield check_keyword, ValueError, 'PERM', np.arange(2)
+  yield check_keyword, ValueError, 'PERM', np.arange(A.shape[0] + A.shape[1]) + 1
 
   yield check_failure, scs.solve( data, {'q':[1], 'l': 0} )
 
+
+def test_packed_sd():
+  # min x s.t. [x 1; 1 x] is psd, as a full and as a packed 2x2 cone
+  full = {'A':sp.csc_matrix([-1., 0., 0., -1.]).T.tocsc(), 'b':np.array([0., 1., 1., 0.]), 'c':np.array([1.])}
+  sol = scs.solve(full, {'s':[2]})
+  yield check_solution, sol['x'][0], 1
+  packed = {'A':sp.csc_matrix([-1., 0., -1.]).T.tocsc(), 'b':np.array([0., np.sqrt(2), 0.]), 'c':np.array([1.])}
+  sol = scs.solve(packed, {'sp':[2]})
+  yield check_solution, sol['x'][0], 1
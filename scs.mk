@@ -10,6 +10,8 @@ else
 LDFLAGS = -lm
 SHARED = dylib
 endif
+# the workers of the solve queue (include/queue.h)
+LDFLAGS += -lpthread
 
 CFLAGS = -g -Wall -pedantic -O3 -funroll-loops -Wstrict-prototypes -fPIC -I. -Iinclude #-Wextra
 
@@ -17,6 +19,12 @@ LINSYS = linsys
 DIRSRC = $(LINSYS)/direct
 DIRSRCEXT = $(DIRSRC)/external
 INDIRSRC = $(LINSYS)/indirect
+SUPERSRC = $(LINSYS)/supernodal
+MATFREESRC = $(LINSYS)/matfree
+AUTOSRC = $(LINSYS)/auto
+DENSESRC = $(LINSYS)/dense
+GPUSRC = $(LINSYS)/gpu
+MPISRC = $(LINSYS)/mpi
 
 OUT = out
 AR = ar
@@ -26,6 +34,7 @@ RANLIB = ranlib
 
 ########### OPTIONAL FLAGS ##########
 # CFLAGS += -DDLONG # use longs rather than ints
+# CFLAGS += -DCOMPACT_INDICES # with DLONG, keep ints for the row indices of A' and L (needs m + n < 2^31)
 # CFLAGS += -DFLOAT # use floats rather than doubles
 # CFLAGS += -DNOVALIDATE # remove data validation step
 # CFLAGS += -DEXTRAVERBOSE # extra verbosity level
@@ -44,7 +53,7 @@ ifneq ($(USE_OPENMP), 0)
 endif
 
 ############ SDPS: BLAS + LAPACK ############
-# set USE_LAPACK = 1 below to enable solving SDPs
+# set USE_LAPACK = 1 below to enable solving SDPs (and to build libscsdense, the solver for dense A)
 # NB: point the libraries to the locations where
 # you have blas and lapack installed
 
@@ -56,3 +65,19 @@ ifneq ($(USE_LAPACK), 0)
   CFLAGS += -DLAPACK_LIB_FOUND
   # CFLAGS += -DBLAS64 # if blas/lapack lib uses long rather than int
 endif
+
+############ GPU: CUDA ############
+# set USE_GPU = 1 to also build libscsgpu, the indirect solver running CG on the GPU
+# with cuSPARSE and cuBLAS (needs CUDA 11.2 or later), point CUDA_PATH to your install
+
+USE_GPU = 0
+CUDA_PATH = /usr/local/cuda
+GPU_CFLAGS = -I$(CUDA_PATH)/include
+GPU_LDFLAGS = -L$(CUDA_PATH)/lib64 -lcudart -lcublas -lcusparse
+
+############ MPI ############
+# set USE_MPI = 1 to also build libscsmpi, the indirect solver with the rows of A split between the ranks of
+# MPI_COMM_WORLD, compiled and linked with the MPI wrapper MPICC
+
+USE_MPI = 0
+MPICC = mpicc
@@ -0,0 +1,230 @@
+#include "accel.h"
+
+/* an extrapolated point is rejected if its fixed point residual is larger than this times the last one */
+#define ACCEL_SAFEGUARD 1.0
+/* relative Tikhonov regularization of the least squares problem for the mixing weights */
+#define ACCEL_REG 1e-10
+
+struct ACCEL_WORK {
+	idxint l2; /* length of z = (u, v), 2 * l */
+	idxint mem; /* number of differences kept */
+	idxint nCols; /* number of differences currently stored, at most mem */
+	idxint col; /* column the next difference is written to, the memory is circular */
+	pfloat * S; /* differences of iterates z, l2 by mem column major */
+	pfloat * Y; /* differences of residuals z - F(z), l2 by mem column major */
+	pfloat * YtY; /* Y'Y, mem by mem */
+	pfloat * z; /* current iterate, that F was last applied to */
+	pfloat * zPrev, *g, *gPrev; /* last iterate, and the residuals z - F(z) of both */
+	pfloat * fPlain; /* F(zPrev), the plain step the last extrapolation replaced */
+	pfloat * work; /* mem by (mem + 2): the system for the weights, its right hand side and the weights */
+	pfloat ngPrev; /* |gPrev| */
+	idxint havePrev; /* zPrev and gPrev are set */
+	idxint extrapolated; /* z is an extrapolated point */
+	idxint pause; /* plain steps left before extrapolating again, after a rejection */
+	/* reporting */
+	idxint nAccel, nRejected;
+};
+
+Accel * initAccel(idxint l, idxint mem) {
+	Accel * a = scs_wcalloc(1, sizeof(Accel));
+	if (!a)
+		return NULL;
+	a->l2 = 2 * l;
+	a->mem = mem;
+	a->S = scs_wmalloc(a->l2 * mem * sizeof(pfloat));
+	a->Y = scs_wmalloc(a->l2 * mem * sizeof(pfloat));
+	a->YtY = scs_wmalloc(mem * mem * sizeof(pfloat));
+	a->z = scs_wmalloc(a->l2 * sizeof(pfloat));
+	a->zPrev = scs_wmalloc(a->l2 * sizeof(pfloat));
+	a->g = scs_wmalloc(a->l2 * sizeof(pfloat));
+	a->gPrev = scs_wmalloc(a->l2 * sizeof(pfloat));
+	a->fPlain = scs_wmalloc(a->l2 * sizeof(pfloat));
+	a->work = scs_wmalloc(mem * (mem + 2) * sizeof(pfloat));
+	if (!a->S || !a->Y || !a->YtY || !a->z || !a->zPrev || !a->g || !a->gPrev || !a->fPlain || !a->work) {
+		freeAccel(a);
+		return NULL;
+	}
+	return a;
+}
+
+void freeAccel(Accel * a) {
+	if (a) {
+		if (a->S)
+			scs_free(a->S);
+		if (a->Y)
+			scs_free(a->Y);
+		if (a->YtY)
+			scs_free(a->YtY);
+		if (a->z)
+			scs_free(a->z);
+		if (a->zPrev)
+			scs_free(a->zPrev);
+		if (a->g)
+			scs_free(a->g);
+		if (a->gPrev)
+			scs_free(a->gPrev);
+		if (a->fPlain)
+			scs_free(a->fPlain);
+		if (a->work)
+			scs_free(a->work);
+		scs_free(a);
+	}
+}
+
+static void clearMemory(Accel * a) {
+	a->nCols = 0;
+	a->col = 0;
+	a->havePrev = 0;
+	a->extrapolated = 0;
+	a->pause = 0;
+}
+
+void resetAccel(Accel * a, const pfloat * u, const pfloat * v) {
+	idxint l = a->l2 / 2;
+	clearMemory(a);
+	memcpy(a->z, u, l * sizeof(pfloat));
+	memcpy(&(a->z[l]), v, l * sizeof(pfloat));
+	a->nAccel = 0;
+	a->nRejected = 0;
+}
+
+/* solves the n by n system K x = r in place by Gaussian elimination with partial pivoting, x overwrites r,
+ returns -1 if K is numerically singular */
+static idxint solveSmall(pfloat * K, pfloat * r, idxint n) {
+	idxint i, j, q, piv;
+	pfloat t, mx;
+	for (j = 0; j < n; ++j) {
+		piv = j;
+		mx = ABS(K[j * n + j]);
+		for (i = j + 1; i < n; ++i) {
+			if (ABS(K[j * n + i]) > mx) {
+				mx = ABS(K[j * n + i]);
+				piv = i;
+			}
+		}
+		if (mx == 0 || mx != mx)
+			return -1;
+		if (piv != j) {
+			for (q = j; q < n; ++q) {
+				t = K[q * n + j];
+				K[q * n + j] = K[q * n + piv];
+				K[q * n + piv] = t;
+			}
+			t = r[j];
+			r[j] = r[piv];
+			r[piv] = t;
+		}
+		for (i = j + 1; i < n; ++i) {
+			t = K[j * n + i] / K[j * n + j];
+			for (q = j + 1; q < n; ++q) {
+				K[q * n + i] -= t * K[q * n + j];
+			}
+			r[i] -= t * r[j];
+		}
+	}
+	for (j = n - 1; j >= 0; --j) {
+		for (q = j + 1; q < n; ++q) {
+			r[j] -= K[q * n + j] * r[q];
+		}
+		r[j] /= K[j * n + j];
+	}
+	return 0;
+}
+
+/* appends s = z - zPrev and y = g - gPrev to the memory and updates Y'Y */
+static void pushDifference(Accel * a) {
+	idxint j, l2 = a->l2, c = a->col;
+	pfloat * s = &(a->S[c * l2]), *y = &(a->Y[c * l2]);
+	memcpy(s, a->z, l2 * sizeof(pfloat));
+	addScaledArray(s, a->zPrev, l2, -1);
+	memcpy(y, a->g, l2 * sizeof(pfloat));
+	addScaledArray(y, a->gPrev, l2, -1);
+	if (a->nCols < a->mem)
+		a->nCols++;
+	for (j = 0; j < a->nCols; ++j) {
+		a->YtY[c * a->mem + j] = a->YtY[j * a->mem + c] = innerProd(y, &(a->Y[j * l2]), l2);
+	}
+	a->col = (c + 1) % a->mem;
+}
+
+/* out = f - (S - Y) gamma with gamma = argmin |g - Y gamma|, returns -1 if the weights could not be found */
+static idxint extrapolate(Accel * a, const pfloat * f, pfloat * out) {
+	idxint i, j, nc = a->nCols, l2 = a->l2;
+	pfloat * K = a->work, *gamma = &(a->work[nc * nc]);
+	pfloat reg = 0;
+	for (j = 0; j < nc; ++j) {
+		reg = MAX(reg, a->YtY[j * a->mem + j]);
+	}
+	reg = ACCEL_REG * reg;
+	for (j = 0; j < nc; ++j) {
+		for (i = 0; i < nc; ++i) {
+			K[j * nc + i] = a->YtY[j * a->mem + i];
+		}
+		K[j * nc + j] += reg;
+		gamma[j] = innerProd(&(a->Y[j * l2]), a->g, l2);
+	}
+	if (solveSmall(K, gamma, nc) < 0)
+		return -1;
+	memcpy(out, f, l2 * sizeof(pfloat));
+	for (j = 0; j < nc; ++j) {
+		addScaledArray2(out, &(a->S[j * l2]), &(a->Y[j * l2]), l2, -gamma[j], gamma[j]);
+	}
+	for (i = 0; i < l2; ++i) {
+		if (out[i] != out[i])
+			return -1;
+	}
+	return 0;
+}
+
+idxint accelerate(Accel * a, pfloat * u, pfloat * v) {
+	idxint ok, l = a->l2 / 2, l2 = a->l2;
+	pfloat ng, *f = a->fPlain, *tmp;
+	/* g = z - F(z) */
+	memcpy(a->g, a->z, l2 * sizeof(pfloat));
+	addScaledArray(a->g, u, l, -1);
+	addScaledArray(&(a->g[l]), v, l, -1);
+	ng = calcNorm(a->g, l2);
+	if (a->extrapolated && ng > ACCEL_SAFEGUARD * a->ngPrev) {
+		/* the extrapolated point did worse, continue from the plain step it replaced */
+		memcpy(u, f, l * sizeof(pfloat));
+		memcpy(v, &(f[l]), l * sizeof(pfloat));
+		memcpy(a->z, f, l2 * sizeof(pfloat));
+		clearMemory(a);
+		a->nRejected++;
+		a->pause = a->mem;
+		return 0;
+	}
+	if (a->havePrev)
+		pushDifference(a);
+	memcpy(f, u, l * sizeof(pfloat));
+	memcpy(&(f[l]), v, l * sizeof(pfloat));
+	/* zPrev is spent, the next iterate is built in it and then the buffers swap */
+	if (a->pause > 0)
+		a->pause--;
+	ok = a->nCols > 0 && a->pause == 0 && extrapolate(a, f, a->zPrev) == 0;
+	tmp = a->zPrev;
+	a->zPrev = a->z;
+	a->z = tmp;
+	tmp = a->gPrev;
+	a->gPrev = a->g;
+	a->g = tmp;
+	a->ngPrev = ng;
+	a->havePrev = 1;
+	if (!ok) {
+		memcpy(a->z, f, l2 * sizeof(pfloat));
+		a->extrapolated = 0;
+		return 0;
+	}
+	memcpy(u, a->z, l * sizeof(pfloat));
+	memcpy(v, &(a->z[l]), l * sizeof(pfloat));
+	a->extrapolated = 1;
+	a->nAccel++;
+	return 1;
+}
+
+char * getAccelSummary(Accel * a, Info * info) {
+	char * str = scs_malloc(sizeof(char) * 96);
+	sprintf(str, "\tAccel: memory %li, extrapolated steps: %li, rejected: %li\n", (long) a->mem, (long) a->nAccel,
+			(long) a->nRejected);
+	return str;
+}
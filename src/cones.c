@@ -5,46 +5,73 @@
 #define EXP_CONE_MAX_ITERS 100
 
 #ifdef LAPACK_LIB_FOUND
-/* underscore for blas / lapack, single or double precision */
-#ifdef NOBLASUNDERSCORE
-#ifndef FLOAT
-#define BLAS(x) d ## x
-#else
-#define BLAS(x) s ## x
-#endif
-#else
-#ifndef FLOAT
-#define BLAS(x) d ## x ## _
-#else
-#define BLAS(x) s ## x ## _
-#endif
+void BLAS(syevr)(char* jobz, char* range, char* uplo, blasint* n, pfloat* a, blasint* lda, pfloat* vl,
+		pfloat* vu, blasint* il, blasint* iu, pfloat* abstol, blasint* m, pfloat* w, pfloat* z, blasint* ldz,
+		blasint* isuppz, pfloat* work, blasint* lwork, blasint* iwork, blasint* liwork, blasint* info);
+void BLAS(syrk)(const char *uplo, const char *trans, const blasint *n, const blasint *k, const pfloat *alpha,
+		const pfloat *a, const blasint *lda, const pfloat *beta, pfloat *c, const blasint *ldc);
 #endif
 
-#ifdef MATLAB_MEX_FILE
-typedef ptrdiff_t blasint;
-#elif defined BLAS64
-typedef long blasint;
-#else
-typedef int blasint;
+#ifdef OPENMP
+#include <omp.h>
 #endif
 
-void BLAS(syevr)(char* jobz, char* range, char* uplo, blasint* n, pfloat* a, blasint* lda, pfloat* vl,
-		pfloat* vu, blasint* il, blasint* iu, pfloat* abstol, blasint* m, pfloat* w, pfloat* z, blasint* ldz,
-		blasint* isuppz, pfloat* work, blasint* lwork, blasint* iwork, blasint* liwork, blasint* info);
-void BLAS(syr)(const char *uplo, const blasint *n, const pfloat *alpha, const pfloat *x, const blasint *incx,
-		pfloat *a, const blasint *lda);
-void BLAS(axpy)(const blasint *n, const pfloat *alpha, const pfloat *dx, const blasint *incx, pfloat *dy,
-		const blasint *incy);
-/* private data to help cone projection step */
-static struct ConeData_t {
-	/* workspace for eigenvector decompositions: */
+/* relative projection cost estimates used to balance cone work across threads */
+#define EXP_CONE_COST 100
+/* aim for about this many tasks per thread so dynamic scheduling can balance load */
+#define TASKS_PER_THREAD 8
+/* below this total estimated cost the projection is not worth running in parallel */
+#define MIN_PARALLEL_CONE_COST 1e4
+
+/* cone types that can appear in a projection task */
+#define SOC_TASK 0
+#define SD_TASK 1
+#define EXP_P_TASK 2
+#define EXP_D_TASK 3
+#define SDP_TASK 4 /* packed SD */
+
+/* number of entries of a packed n by n SD cone */
+#define SVEC_LEN(n) ((n) * ((n) + 1) / 2)
+#define SQRT2 1.41421356237309504880
+/* runs of equal sized SOCs up to this dimension are projected by the fixed size kernels below */
+#define SMALL_SOC_MAX 8
+/* the fused step relaxes, projects and updates the SOCs of a task in chunks of about this many entries, so the four
+ arrays of a chunk stay in the L1 cache between the three passes */
+#define SOC_CHUNK 512
+
+/* a contiguous run of cones of one type, projected as a single unit of work */
+typedef struct {
+	idxint type; /* one of the *_TASK types above */
+	idxint start, end; /* range of cones [start, end) within their type */
+	idxint offset; /* index into x of the first entry of cone 'start' */
+	idxint len; /* number of entries of x covered by the task */
+	pfloat cost; /* estimated projection cost */
+} ConeTask;
+
+#ifdef LAPACK_LIB_FOUND
+/* workspace for eigenvector decompositions, one per thread */
+typedef struct {
 	pfloat * Xs, *Z, *e, *work;
+	pfloat * Xp; /* a packed cone unpacked */
 	blasint *iwork, lwork, liwork;
-}c;
+} EigWork;
 #endif
 
-static timer coneTimer;
-static pfloat totalConeTime;
+/* private data to help cone projection step, one per workspace */
+struct CONE_WORK {
+	/* projection schedule, built once in initCone */
+	ConeTask * tasks;
+	idxint nTasks;
+	idxint nThreads;
+	idxint parallel; /* boolean, whether the schedule is run in parallel */
+	idxint lpOnly; /* boolean, only free and LP cones: the fused step is a single pass without the schedule */
+#ifdef LAPACK_LIB_FOUND
+	EigWork * eig; /* nThreads eigen workspaces */
+#endif
+	idxint * sdPos; /* number of positive eigenvalues of each SD cone (full then packed) at the last projection */
+	idxint * socRun; /* number of consecutive SOCs of the same small size starting at each SOC, 0 if large */
+	pfloat * expRho; /* dual variable of the last projection of each exp cone (primal then dual), warm start */
+};
 
  /*
  * boundaries will contain array of indices of rows of A corresponding to
@@ -53,7 +80,7 @@ static pfloat totalConeTime;
  */
 idxint getConeBoundaries(Cone * k, idxint ** boundaries) {
 	idxint i, count = 0;
-	idxint len = 1 + k->qsize + k->ssize + k->ed + k->ep;
+	idxint len = 1 + k->qsize + k->ssize + k->spsize + k->ed + k->ep;
 	idxint * b = scs_malloc(sizeof(idxint) * len);
 	b[count] = k->f + k->l;
 	count += 1;
@@ -65,6 +92,10 @@ idxint getConeBoundaries(Cone * k, idxint ** boundaries) {
 		b[count + i] = k->s[i] * k->s[i];
 	}
 	count += k->ssize;
+	for (i = 0; i < k->spsize; ++i) {
+		b[count + i] = SVEC_LEN(k->sp[i]);
+	}
+	count += k->spsize;
 	for (i = 0; i < k->ep + k->ed; ++i) {
 		b[count + i] = 3;
 	}
@@ -89,6 +120,11 @@ idxint getFullConeDims(Cone * k) {
 			c += k->s[i] * k->s[i];
 		}
 	}
+	if (k->spsize && k->sp) {
+		for (i = 0; i < k->spsize; ++i) {
+			c += SVEC_LEN(k->sp[i]);
+		}
+	}
 	if (k->ed)
 		c += 3 * k->ed;
 	if (k->ep)
@@ -122,6 +158,14 @@ idxint validateCones(Data * d, Cone * k) {
 			}
 		}
 	}
+	if (k->spsize && k->sp) {
+		for (i = 0; i < k->spsize; ++i) {
+			if (k->sp[i] < 0) {
+				scs_printf("packed sd cone error\n");
+				return -1;
+			}
+		}
+	}
 	if (k->ed && k->ed < 0) {
 		scs_printf("ep cone error\n");
 		return -1;
@@ -139,24 +183,44 @@ idxint validateCones(Data * d, Cone * k) {
 
 char * getConeSummary(Info * info) {
 	char * str = scs_malloc(sizeof(char) * 64);
-	sprintf(str, "\tCones: avg projection time: %1.2es\n", totalConeTime / (info->iter + 1) / 1e3);
-	totalConeTime = 0.0;
+	sprintf(str, "\tCones: avg projection time: %1.2es\n", info->prof.coneTime / (info->iter + 1) / 1e3);
 	return str;
 }
 
-void finishCone() {
+void finishCone(ConeWork * c) {
+#ifdef LAPACK_LIB_FOUND
+	idxint i;
+#endif
+	if (!c)
+		return;
 #ifdef LAPACK_LIB_FOUND
-	if (c.Xs)
-	scs_free(c.Xs);
-	if (c.Z)
-	scs_free(c.Z);
-	if (c.e)
-	scs_free(c.e);
-	if (c.work)
-	scs_free(c.work);
-	if (c.iwork)
-	scs_free(c.iwork);
+	if (c->eig) {
+		for (i = 0; i < c->nThreads; ++i) {
+			if (c->eig[i].Xs)
+				scs_free(c->eig[i].Xs);
+			if (c->eig[i].Z)
+				scs_free(c->eig[i].Z);
+			if (c->eig[i].e)
+				scs_free(c->eig[i].e);
+			if (c->eig[i].work)
+				scs_free(c->eig[i].work);
+			if (c->eig[i].iwork)
+				scs_free(c->eig[i].iwork);
+			if (c->eig[i].Xp)
+				scs_free(c->eig[i].Xp);
+		}
+		scs_free(c->eig);
+	}
 #endif
+	if (c->tasks)
+		scs_free(c->tasks);
+	if (c->sdPos)
+		scs_free(c->sdPos);
+	if (c->socRun)
+		scs_free(c->socRun);
+	if (c->expRho)
+		scs_free(c->expRho);
+	scs_free(c);
 }
 
 char * getConeHeader(Cone * k) {
@@ -187,6 +251,13 @@ char * getConeHeader(Cone * k) {
 		}
         sprintf(tmp + strlen(tmp), "\tsd vars: %i, sd blks: %i\n", (int) sdVars, (int) sdBlks);
 	}
+	if (k->spsize && k->sp) {
+		sdVars = 0;
+		for (i = 0; i < k->spsize; i++) {
+			sdVars += SVEC_LEN(k->sp[i]);
+		}
+		sprintf(tmp + strlen(tmp), "\tpacked sd vars: %i, packed sd blks: %i\n", (int) sdVars, (int) k->spsize);
+	}
     if (k->ep || k->ed) {
 	    expPvars = k->ep ? 3 * k->ep : 0;
 	    expDvars = k->ed ? 3 * k->ed : 0;
@@ -205,56 +276,62 @@ idxint isSimpleSemiDefiniteCone(idxint * s, idxint ssize) {
 	return 1; /* true */
 }
 
-pfloat expNewtonOneD(pfloat rho, pfloat y_hat, pfloat z_hat) {
-	pfloat t = MAX(-z_hat, 1e-6);
+/*
+ * solves t (t + z) / rho^2 - y / rho + log(t / rho) + 1 = 0 for t > max(-z, 0), where the left hand side is
+ * increasing, by Newton from t0 (if feasible, else from max(-z, 1e-6)), returns t + z, or 0 if the solution
+ * is on the boundary t = -z
+ */
+static pfloat expNewtonOneD(pfloat rho, pfloat y_hat, pfloat z_hat, pfloat t0) {
+	pfloat lb = MAX(-z_hat, 0);
+	pfloat t = t0 > lb ? t0 : MAX(-z_hat, 1e-6);
 	pfloat f, fp;
 	idxint i;
+	if (z_hat < 0 && -y_hat / rho + log(-z_hat / rho) + 1 >= 0) {
+		return 0;
+	}
 	for (i = 0; i < EXP_CONE_MAX_ITERS; ++i) {
 
 		f = t * (t + z_hat) / rho / rho - y_hat / rho + log(t / rho) + 1;
 		fp = (2 * t + z_hat) / rho / rho + 1 / t;
 
-		t = t - f / fp;
-
-		if (t <= -z_hat) {
-			return 0;
-		} else if (t <= 0) {
-			return z_hat;
-		} else if ( ABS(f) < CONE_TOL) {
+		if ( ABS(f) < CONE_TOL) {
 			break;
 		}
+		/* a step out of the domain means the root is between lb and t */
+		t = MAX(t - f / fp, (t + lb) / 2);
 	}
 	return t + z_hat;
 }
 
-void expSolveForXWithRho(pfloat * v, pfloat * x, pfloat rho) {
-	x[2] = expNewtonOneD(rho, v[1], v[2]);
-	x[1] = (x[2] - v[2]) * x[2] / rho;
+/*
+ * x = the point for dual variable rho, returns g(rho) = x0 + x1 log(x1 / x2), the projection is at its root and
+ * g is decreasing, dg is set to g'(rho) (0 if x is on a boundary). *w = x2 - v2 is the starting point of the
+ * inner Newton solve and is updated
+ */
+static pfloat expCalcGrad(const pfloat * v, pfloat * x, pfloat rho, pfloat * w, pfloat * dg) {
+	pfloat dw, dx1;
+	x[2] = expNewtonOneD(rho, v[1], v[2], *w);
+	*w = x[2] - v[2];
+	x[1] = *w * x[2] / rho;
 	x[0] = v[0] - rho;
-}
-
-pfloat expCalcGrad(pfloat * v, pfloat * x, pfloat rho) {
-	expSolveForXWithRho(v, x, rho);
-	if (x[1] <= 1e-12) {
+	if (x[1] <= 1e-12 || *w <= 0) {
+		*dg = 0;
 		return x[0];
-	} else {
-		return x[0] + x[1] * log(x[1] / x[2]);
 	}
+	/* implicit derivative of the inner solution, then of g = v0 - rho + x1 ((v1 - x1) / rho - 1) */
+	dw = -(-2 * x[1] / rho / rho + v[1] / rho / rho - 1 / rho) / ((2 * *w + v[2]) / rho / rho + 1 / *w);
+	dx1 = (2 * *w + v[2]) / rho * dw - x[1] / rho;
+	*dg = -1 + dx1 * ((v[1] - x[1]) / rho - 1) - x[1] * (dx1 / rho + (v[1] - x[1]) / rho / rho);
+	return x[0] + x[1] * log(x[1] / x[2]);
 }
 
-void expGetRhoUb(pfloat * v, pfloat * x, pfloat * ub, pfloat * lb) {
-	*lb = 0;
-	*ub = 0.125;
-	while (expCalcGrad(v, x, *ub) > 0) {
-		*lb = *ub;
-		(*ub) *= 2;
-	}
-}
-
-/* project onto the exponential cone, v has dimension *exactly* 3 */
-static idxint projExpCone(pfloat * v, idxint iter) {
+/*
+ * project onto the exponential cone, v has dimension *exactly* 3, rho is the dual variable of the last
+ * projection of this cone (<= 0 if there is none) and is updated
+ */
+static idxint projExpCone(pfloat * v, idxint iter, pfloat * rhoWarm) {
 	idxint i;
-	pfloat ub, lb, rho, g, x[3];
+	pfloat lb = 0, ub = -1, rho, rhoNew, g, dg, w = 0, x[3];
 	pfloat r = v[0], s = v[1], t = v[2];
 	pfloat tol = CONE_TOL; /* iter < 0 ? CONE_TOL : MAX(CONE_TOL, 1 / POWF((iter + 1), CONE_RATE)); */
 
@@ -276,57 +353,233 @@ static idxint projExpCone(pfloat * v, idxint iter) {
 		return 0;
 	}
 
-    /* iterative procedure to find projection, bisects on dual variable: */
-	expGetRhoUb(v, x, &ub, &lb); /* get starting upper and lower bounds */
+	/*
+	 * safeguarded Newton on the dual variable, from the last projection's rho: steps that leave the bracket
+	 * [lb, ub] known to hold the root fall back to bisection (or doubling while there is no upper bound)
+	 */
+	rho = *rhoWarm > 0 ? *rhoWarm : 0.125;
 	for (i = 0; i < EXP_CONE_MAX_ITERS; ++i) {
-		rho = (ub + lb) / 2; /* halfway between upper and lower bounds */
-		g = expCalcGrad(v, x, rho); /* calculates gradient wrt dual var */
+		g = expCalcGrad(v, x, rho, &w, &dg);
 		if (g > 0) {
 			lb = rho;
 		} else {
 			ub = rho;
 		}
-		if (ub - lb < tol) {
+		if (ub >= 0 && ub - lb < tol) {
+			break;
+		}
+		rhoNew = dg < 0 ? rho - g / dg : -1;
+		if (!(rhoNew > lb && (ub < 0 || rhoNew < ub))) {
+			rhoNew = ub < 0 ? 2 * rho : (lb + ub) / 2;
+		}
+		if (ABS(rhoNew - rho) < tol) {
+			rho = rhoNew;
+			g = expCalcGrad(v, x, rho, &w, &dg);
 			break;
 		}
+		rho = rhoNew;
 	}
-	/*
-#ifdef EXTRAVERBOSE
-	scs_printf("exponential cone proj iters %i\n", i);
-#endif
-	 */
+	*rhoWarm = rho;
 	v[0] = x[0];
 	v[1] = x[1];
 	v[2] = x[2];
 	return 0;
 }
 
-idxint initCone(Cone * k) {
-#ifdef LAPACK_LIB_FOUND
+static pfloat getSdCost(idxint n) {
+	/* eigen decomposition is cubic in the matrix dimension */
+	return n <= 2 ? (pfloat) (n * n) : (pfloat) n * n * n;
+}
+
+/* orders tasks by decreasing cost so the largest are started first */
+static int compareTaskCost(const void * a, const void * b) {
+	pfloat ca = ((const ConeTask *) a)->cost, cb = ((const ConeTask *) b)->cost;
+	return ca < cb ? 1 : (ca > cb ? -1 : 0);
+}
+
+/* appends a task for cones [start, end) to c->tasks, grows the array as needed */
+static idxint addConeTask(ConeWork * c, idxint * capacity, idxint type, idxint start, idxint end, idxint offset,
+		idxint len, pfloat cost) {
+	ConeTask * t;
+	if (c->nTasks == *capacity) {
+		*capacity = 2 * (*capacity) + 16;
+		t = scs_malloc(*capacity * sizeof(ConeTask));
+		if (!t) {
+			return -1;
+		}
+		if (c->tasks) {
+			memcpy(t, c->tasks, c->nTasks * sizeof(ConeTask));
+			scs_free(c->tasks);
+		}
+		c->tasks = t;
+	}
+	t = &(c->tasks[c->nTasks++]);
+	t->type = type;
+	t->start = start;
+	t->end = end;
+	t->offset = offset;
+	t->len = len;
+	t->cost = cost;
+	return 0;
+}
+
+/*
+ * splits the (non-LP) cones into tasks of roughly equal estimated cost: cheap cones of the same
+ * type are grouped together, a cone more expensive than the target cost gets a task of its own
+ */
+static idxint buildConeTasks(Cone * k, ConeWork * c) {
+	idxint i, start, end, offset, taskOffset, capacity = 0;
+	pfloat cost, taskCost, totalCost = 0, target;
+	for (i = 0; i < k->qsize; ++i) {
+		totalCost += k->q[i];
+	}
+	for (i = 0; i < k->ssize; ++i) {
+		totalCost += getSdCost(k->s[i]);
+	}
+	for (i = 0; i < k->spsize; ++i) {
+		totalCost += getSdCost(k->sp[i]);
+	}
+	totalCost += (pfloat) EXP_CONE_COST * (k->ep + k->ed);
+	target = totalCost / (c->nThreads * TASKS_PER_THREAD);
+	c->parallel = c->nThreads > 1 && totalCost > MIN_PARALLEL_CONE_COST;
+
+	offset = k->f + k->l;
+	/* soc */
+	start = 0;
+	taskOffset = offset;
+	taskCost = 0;
+	for (i = 0; i < k->qsize; ++i) {
+		taskCost += k->q[i];
+		offset += k->q[i];
+		if (taskCost >= target || i == k->qsize - 1) {
+			if (addConeTask(c, &capacity, SOC_TASK, start, i + 1, taskOffset, offset - taskOffset, taskCost) < 0)
+				return -1;
+			start = i + 1;
+			taskOffset = offset;
+			taskCost = 0;
+		}
+	}
+	/* sd */
+	start = 0;
+	taskOffset = offset;
+	taskCost = 0;
+	for (i = 0; i < k->ssize; ++i) {
+		taskCost += getSdCost(k->s[i]);
+		offset += k->s[i] * k->s[i];
+		if (taskCost >= target || i == k->ssize - 1) {
+			if (addConeTask(c, &capacity, SD_TASK, start, i + 1, taskOffset, offset - taskOffset, taskCost) < 0)
+				return -1;
+			start = i + 1;
+			taskOffset = offset;
+			taskCost = 0;
+		}
+	}
+	/* packed sd */
+	start = 0;
+	taskOffset = offset;
+	taskCost = 0;
+	for (i = 0; i < k->spsize; ++i) {
+		taskCost += getSdCost(k->sp[i]);
+		offset += SVEC_LEN(k->sp[i]);
+		if (taskCost >= target || i == k->spsize - 1) {
+			if (addConeTask(c, &capacity, SDP_TASK, start, i + 1, taskOffset, offset - taskOffset, taskCost) < 0)
+				return -1;
+			start = i + 1;
+			taskOffset = offset;
+			taskCost = 0;
+		}
+	}
+	/* exp, primal then dual, all cones have equal cost */
+	cost = MAX(target / EXP_CONE_COST, 1);
+	for (i = 0; i < k->ep; i += (idxint) cost) {
+		start = i;
+		end = MIN(start + (idxint) cost, k->ep);
+		if (addConeTask(c, &capacity, EXP_P_TASK, start, end, offset + 3 * start, 3 * (end - start),
+				EXP_CONE_COST * (end - start)) < 0)
+			return -1;
+	}
+	offset += 3 * k->ep;
+	for (i = 0; i < k->ed; i += (idxint) cost) {
+		start = i;
+		end = MIN(start + (idxint) cost, k->ed);
+		if (addConeTask(c, &capacity, EXP_D_TASK, start, end, offset + 3 * start, 3 * (end - start),
+				EXP_CONE_COST * (end - start)) < 0)
+			return -1;
+	}
+	if (c->parallel) {
+		qsort(c->tasks, c->nTasks, sizeof(ConeTask), compareTaskCost);
+	}
+	return 0;
+}
+
+ConeWork * initCone(Cone * k) {
 	idxint i;
+#ifdef LAPACK_LIB_FOUND
+	idxint t;
 	blasint nMax = 0;
 	pfloat eigTol = 1e-8;
 	blasint negOne = -1;
 	blasint m = 0;
-    blasint info;
+	blasint info;
 	pfloat wkopt;
-	c.Xs = NULL;
-	c.Z = NULL;
-	c.e = NULL;
-	c.work = NULL;
-	c.iwork = NULL;
+	EigWork * eig;
+#endif
+	ConeWork * c = scs_wcalloc(1, sizeof(ConeWork));
+	if (!c) {
+		return NULL;
+	}
+#ifdef OPENMP
+	c->nThreads = omp_get_max_threads();
+#else
+	c->nThreads = 1;
 #endif
-	totalConeTime = 0.0;
 #ifdef EXTRAVERBOSE
-    scs_printf("initCone\n");
+	scs_printf("initCone\n");
 #ifdef MATLAB_MEX_FILE
-    mexEvalString("drawnow;");
+	mexEvalString("drawnow;");
 #endif
 #endif
+	if (buildConeTasks(k, c) < 0) {
+		finishCone(c);
+		return NULL;
+	}
+	c->lpOnly = c->nTasks == 0;
+	if (k->qsize > 0) {
+		c->socRun = scs_wmalloc(k->qsize * sizeof(idxint));
+		if (!c->socRun) {
+			finishCone(c);
+			return NULL;
+		}
+		for (i = k->qsize - 1; i >= 0; --i) {
+			if (k->q[i] < 2 || k->q[i] > SMALL_SOC_MAX)
+				c->socRun[i] = 0;
+			else if (i < k->qsize - 1 && k->q[i + 1] == k->q[i])
+				c->socRun[i] = c->socRun[i + 1] + 1;
+			else
+				c->socRun[i] = 1;
+		}
+	}
+	if (k->ep + k->ed > 0) {
+		c->expRho = scs_wcalloc(k->ep + k->ed, sizeof(pfloat));
+		if (!c->expRho) {
+			finishCone(c);
+			return NULL;
+		}
+	}
+	if (k->ssize + k->spsize > 0) {
+		c->sdPos = scs_wmalloc((k->ssize + k->spsize) * sizeof(idxint));
+		if (!c->sdPos) {
+			finishCone(c);
+			return NULL;
+		}
+		for (i = 0; i < k->ssize + k->spsize; ++i) {
+			c->sdPos[i] = -1; /* unknown, start from the positive side */
+		}
+	}
 
-if (k->ssize && k->s) {
-		if (isSimpleSemiDefiniteCone(k->s, k->ssize)) {
-			return 0;
+	if ((k->ssize && k->s) || (k->spsize && k->sp)) {
+		if (isSimpleSemiDefiniteCone(k->s, k->ssize) && isSimpleSemiDefiniteCone(k->sp, k->spsize)) {
+			return c;
 		}
 #ifdef LAPACK_LIB_FOUND
 		/* eigenvector decomp workspace */
@@ -335,37 +588,54 @@ if (k->ssize && k->s) {
 				nMax = (blasint) k->s[i];
 			}
 		}
-		c.Xs = scs_calloc(nMax * nMax, sizeof(pfloat));
-		c.Z = scs_calloc(nMax * nMax, sizeof(pfloat));
-		c.e = scs_calloc(nMax, sizeof(pfloat));
+		for (i = 0; i < k->spsize; ++i) {
+			if (k->sp[i] > nMax) {
+				nMax = (blasint) k->sp[i];
+			}
+		}
+		c->eig = scs_wcalloc(c->nThreads, sizeof(EigWork));
+		if (!c->eig) {
+			finishCone(c);
+			return NULL;
+		}
+		for (t = 0; t < c->nThreads; ++t) {
+			eig = &(c->eig[t]);
+			eig->Xs = scs_wcalloc(nMax * nMax, sizeof(pfloat));
+			eig->Xp = k->spsize ? scs_wcalloc(nMax * nMax, sizeof(pfloat)) : NULL;
+			eig->Z = scs_wcalloc(nMax * nMax, sizeof(pfloat));
+			eig->e = scs_wcalloc(nMax, sizeof(pfloat));
 
-        BLAS(syevr)("Vectors", "All", "Upper", &nMax, c.Xs, &nMax, NULL, NULL, NULL, NULL,
-            &eigTol, &m, c.e, c.Z, &nMax, NULL, &wkopt, &negOne, &(c.liwork), &negOne, &info);
+			BLAS(syevr)("Vectors", "All", "Upper", &nMax, eig->Xs, &nMax, NULL, NULL, NULL, NULL,
+				&eigTol, &m, eig->e, eig->Z, &nMax, NULL, &wkopt, &negOne, &(eig->liwork), &negOne, &info);
 
-        if (info != 0) {
-            scs_printf("FATAL: syevr failure, info = %i\n", info);
-            return -1;
-        }
-        c.lwork = (blasint) (wkopt + 0.01); /* 0.01 for int casting safety */
-        c.work = scs_malloc(c.lwork * sizeof(pfloat));
-        c.iwork = scs_malloc(c.liwork * sizeof(blasint));
+			if (info != 0) {
+				scs_printf("FATAL: syevr failure, info = %i\n", (int) info);
+				finishCone(c);
+				return NULL;
+			}
+			eig->lwork = (blasint) (wkopt + 0.01); /* 0.01 for int casting safety */
+			eig->work = scs_wmalloc(eig->lwork * sizeof(pfloat));
+			eig->iwork = scs_wmalloc(eig->liwork * sizeof(blasint));
 
-		if (!c.Xs || !c.Z || !c.e || !c.work || !c.iwork) {
-			return -1;
+			if (!eig->Xs || !eig->Z || !eig->e || !eig->work || !eig->iwork || (k->spsize && !eig->Xp)) {
+				finishCone(c);
+				return NULL;
+			}
 		}
 #else
 		scs_printf("FATAL: Cannot solve SDPs with > 2x2 matrices without linked blas+lapack libraries\n");
 		scs_printf("Edit scs.mk to point to blas+lapack libray locations\n");
-		return -1;
+		finishCone(c);
+		return NULL;
 #endif
 	}
 #ifdef EXTRAVERBOSE
-    scs_printf("initCone complete\n");
+	scs_printf("initCone complete, %li projection tasks over %li threads\n", (long) c->nTasks, (long) c->nThreads);
 #ifdef MATLAB_MEX_FILE
-    mexEvalString("drawnow;");
+	mexEvalString("drawnow;");
 #endif
 #endif
-	return 0;
+	return c;
 }
 
 idxint project2By2Sdc(pfloat *X) {
@@ -402,26 +672,57 @@ idxint project2By2Sdc(pfloat *X) {
 	return 0;
 }
 
-static idxint projSemiDefiniteCone(pfloat *X, idxint n, idxint iter) {
-	/* project onto the positive semi-definite cone */
 #ifdef LAPACK_LIB_FOUND
+/*
+ * replaces the lower triangle of the symmetric n by n matrix S with that of its projection onto the PSD cone,
+ * from whichever side of the spectrum was smaller last time (*nPos positive eigenvalues, < 0 if unknown):
+ * S+ = Z+ diag(e+) Z+' or S+ = S - Z- diag(e-) Z-', formed with one syrk on the eigenvectors scaled by sqrt(|e|)
+ */
+static idxint projSymmetric(pfloat * S, blasint n, EigWork * eig, idxint * nPos) {
 	idxint i, j;
-	blasint one = 1;
-	blasint m = 0;
-	blasint nb = (blasint) n;
-	pfloat * Xs = c.Xs;
-	pfloat * Z = c.Z;
-	pfloat * e = c.e;
-	pfloat * work = c.work;
-	blasint * iwork = c.iwork;
-	blasint lwork = c.lwork;
-	blasint liwork = c.liwork;
-
+	blasint m = 0, info;
+	pfloat * Xs = eig->Xs, *Z = eig->Z, *e = eig->e;
 	pfloat eigTol = CONE_TOL; /* iter < 0 ? CONE_TOL : MAX(CONE_TOL, 1 / POWF(iter + 1, CONE_RATE)); */
-	pfloat onef = 1.0;
-	pfloat zero = 0.0;
-	blasint info;
-	pfloat vupper;
+	pfloat zero = 0.0, one = 1.0, vlower, vupper = 0, beta;
+	idxint negSide = *nPos > n / 2;
+	for (j = 0; j < n; ++j) {
+		Xs[j + j * n] = S[j + j * n];
+		vupper += S[j + j * n] * S[j + j * n];
+		for (i = j + 1; i < n; ++i) {
+			Xs[i + j * n] = S[i + j * n];
+			vupper += 2 * S[i + j * n] * S[i + j * n];
+		}
+	}
+	/* |S|_F bounds the eigenvalues */
+	vupper = MAX(SQRTF(vupper), 0.001);
+	vlower = -2 * vupper;
+	BLAS(syevr)("Vectors", "VInterval", "Lower", &n, Xs, &n, negSide ? &vlower : &zero, negSide ? &zero : &vupper,
+			NULL, NULL, &eigTol, &m, e, Z, &n, NULL, eig->work, &(eig->lwork), eig->iwork, &(eig->liwork), &info);
+	if (info != 0) {
+		scs_printf("FATAL: syevr failure, info = %i\n", info);
+		return -1;
+	}
+	*nPos = negSide ? n - m : m;
+	for (i = 0; i < m; ++i) {
+		scaleArray(&(Z[i * n]), SQRTF(ABS(e[i])), n);
+	}
+	/* the e- are negative, so S - Z- diag(e-) Z-' = S + W W' */
+	beta = negSide ? 1.0 : 0.0;
+	if (m > 0) {
+		BLAS(syrk)("Lower", "NoTrans", &n, &m, &one, Z, &n, &beta, S, &n);
+	} else if (!negSide) {
+		for (j = 0; j < n; ++j) {
+			memset(&(S[j + j * n]), 0, (n - j) * sizeof(pfloat));
+		}
+	}
+	return 0;
+}
+#endif
+
+static idxint projSemiDefiniteCone(pfloat *X, idxint n, ConeWork * c, idxint thread, idxint * nPos) {
+	/* project onto the positive semi-definite cone */
+#ifdef LAPACK_LIB_FOUND
+	idxint i, j;
 #endif
 	if (n == 0) {
 		return 0;
@@ -436,30 +737,17 @@ static idxint projSemiDefiniteCone(pfloat *X, idxint n, idxint iter) {
 		return project2By2Sdc(X);
 	}
 #ifdef LAPACK_LIB_FOUND
-	memcpy(Xs, X, nb * nb * sizeof(pfloat));
-
-	/* Xs = X + X', save div by 2 for eigen-recomp */
-	for (i = 0; i < nb; ++i) {
-		BLAS(axpy)(&nb, &onef, &(X[i]), &nb, &(Xs[i * n]), &one);
-	}
-	vupper = MAX(calcNorm(Xs, nb * nb), 0.001);
-	/* Solve eigenproblem, reuse workspaces */
-    BLAS(syevr)("Vectors", "VInterval", "Upper", &nb, Xs, &nb, &zero, &vupper,
-			NULL, NULL, &eigTol, &m, e, Z, &nb, NULL, work, &lwork, iwork, &liwork, &info);
-    if (info != 0) {
-        scs_printf("FATAL: syevr failure, info = %i\n", info);
-        return -1;
-    }
-
-	memset(X, 0, n * n * sizeof(pfloat));
-	for (i = 0; i < m; ++i) {
-		pfloat a = e[i] / 2;
-		BLAS(syr)("Lower", &nb, &a, &(Z[i * nb]), &one, X, &nb);
+	/* symmetrize into the lower half, project, then fill in the upper half */
+	for (j = 0; j < n; ++j) {
+		for (i = j + 1; i < n; ++i) {
+			X[i + j * n] = 0.5 * (X[i + j * n] + X[j + i * n]);
+		}
 	}
-	/* fill in upper half */
-	for (i = 0; i < nb; ++i) {
-		for (j = i + 1; j < nb; ++j) {
-			X[i + j * nb] = X[j + i * nb];
+	if (projSymmetric(X, (blasint) n, &(c->eig[thread]), nPos) < 0)
+		return -1;
+	for (j = 0; j < n; ++j) {
+		for (i = j + 1; i < n; ++i) {
+			X[j + i * n] = X[i + j * n];
 		}
 	}
 #else
@@ -471,45 +759,136 @@ static idxint projSemiDefiniteCone(pfloat *X, idxint n, idxint iter) {
 	return 0;
 }
 
-/* outward facing cone projection routine, iter is outer algorithm iteration, if iter < 0 then iter is ignored
-    warm_start contains guess of projection (can be set to NULL) */
-idxint projDualCone(pfloat *x, Cone * k, const pfloat * warm_start, idxint iter)  {
-	idxint i;
-	idxint count = (k->f ? k->f : 0);
-#ifdef EXTRAVERBOSE
-	timer projTimer;
-	tic(&projTimer);
+/* as projSemiDefiniteCone for an n by n matrix packed in x (see Cone) */
+static idxint projPackedSemiDefiniteCone(pfloat *x, idxint n, ConeWork * c, idxint thread, idxint * nPos) {
+	pfloat X2[4];
+#ifdef LAPACK_LIB_FOUND
+	idxint i, j, q;
+	pfloat * S = c->eig[thread].Xp;
 #endif
-	tic(&coneTimer);
-
-
-	if (k->l) {
-		/* project onto positive orthant */
-		for (i = count; i < count + k->l; ++i) {
-			if (x[i] < 0.0)
-				x[i] = 0.0;
-			/*x[i] = (x[i] < 0.0) ? 0.0 : x[i]; */
+	if (n == 0) {
+		return 0;
+	}
+	if (n == 1) {
+		if (x[0] < 0.0) {
+			x[0] = 0.0;
 		}
-		count += k->l;
-#ifdef EXTRAVERBOSE
-	scs_printf("pos orthant proj time: %1.2es\n", tocq(&projTimer) / 1e3);
-	tic(&projTimer);
+		return 0;
+	}
+	if (n == 2) {
+		X2[0] = x[0];
+		X2[1] = X2[2] = x[1] / SQRT2;
+		X2[3] = x[2];
+		project2By2Sdc(X2);
+		x[0] = X2[0];
+		x[1] = X2[1] * SQRT2;
+		x[2] = X2[3];
+		return 0;
+	}
+#ifdef LAPACK_LIB_FOUND
+	for (j = 0, q = 0; j < n; ++j) {
+		S[j + j * n] = x[q++];
+		for (i = j + 1; i < n; ++i) {
+			S[i + j * n] = x[q++] / SQRT2;
+		}
+	}
+	if (projSymmetric(S, (blasint) n, &(c->eig[thread]), nPos) < 0)
+		return -1;
+	for (j = 0, q = 0; j < n; ++j) {
+		x[q++] = S[j + j * n];
+		for (i = j + 1; i < n; ++i) {
+			x[q++] = S[i + j * n] * SQRT2;
+		}
+	}
+#else
+	scs_printf("FAILURE: solving SDP with > 2x2 matrices, but no blas/lapack libraries were linked!\n");
+	scs_printf("scs will return nonsense!\n");
+	scaleArray(x, NAN, SVEC_LEN(n));
+	return -1;
 #endif
+	return 0;
+}
+
+/*
+ * projects nCones consecutive SOCs of dimension D, D is a compile time constant so the inner loops unroll,
+ * and the three cases are selected without branches so the loop over cones can be vectorized
+ */
+#define SMALL_SOC_KERNEL(D) \
+static void projSmallSocs##D(pfloat * x, idxint nCones) { \
+	idxint i, j; \
+	pfloat s, v1, a, b; \
+	for (i = 0; i < nCones; ++i, x += D) { \
+		s = 0; \
+		for (j = 1; j < D; ++j) \
+			s += x[j] * x[j]; \
+		s = SQRTF(s); \
+		v1 = x[0]; \
+		a = (s + v1) / 2; \
+		b = s <= v1 ? 1 : (s <= -v1 ? 0 : a / s); \
+		x[0] = s <= v1 ? v1 : (s <= -v1 ? 0 : a); \
+		for (j = 1; j < D; ++j) \
+			x[j] *= b; \
+	} \
+}
+SMALL_SOC_KERNEL(2)
+SMALL_SOC_KERNEL(3)
+SMALL_SOC_KERNEL(4)
+SMALL_SOC_KERNEL(5)
+SMALL_SOC_KERNEL(6)
+SMALL_SOC_KERNEL(7)
+SMALL_SOC_KERNEL(8)
+
+/* projects nCones consecutive SOCs of dimension 2 <= dim <= SMALL_SOC_MAX */
+static void projSmallSocs(pfloat * x, idxint dim, idxint nCones) {
+	switch (dim) {
+	case 2:
+		projSmallSocs2(x, nCones);
+		break;
+	case 3:
+		projSmallSocs3(x, nCones);
+		break;
+	case 4:
+		projSmallSocs4(x, nCones);
+		break;
+	case 5:
+		projSmallSocs5(x, nCones);
+		break;
+	case 6:
+		projSmallSocs6(x, nCones);
+		break;
+	case 7:
+		projSmallSocs7(x, nCones);
+		break;
+	case 8:
+		projSmallSocs8(x, nCones);
+		break;
 	}
+}
 
-	if (k->qsize && k->q) {
-		/* project onto SOC */
-		for (i = 0; i < k->qsize; ++i) {
+/* projects the cones in task t, thread is the index of the calling thread */
+static idxint projConeTask(pfloat * x, Cone * k, ConeWork * c, ConeTask * t, idxint thread, idxint iter) {
+	idxint i, run, count = t->offset;
+	pfloat s, v1, alpha, v[3];
+	switch (t->type) {
+	case SOC_TASK:
+		for (i = t->start; i < t->end; ++i) {
 			if (k->q[i] == 0) {
 				continue;
 			}
+			if (c->socRun[i] > 0) {
+				run = MIN(c->socRun[i], t->end - i);
+				projSmallSocs(&(x[count]), k->q[i], run);
+				count += run * k->q[i];
+				i += run - 1;
+				continue;
+			}
 			if (k->q[i] == 1) {
 				if (x[count] < 0.0)
 					x[count] = 0.0;
 			} else {
-				pfloat v1 = x[count];
-				pfloat s = calcNorm(&(x[count + 1]), k->q[i] - 1);
-				pfloat alpha = (s + v1) / 2.0;
+				v1 = x[count];
+				s = calcNorm(&(x[count + 1]), k->q[i] - 1);
+				alpha = (s + v1) / 2.0;
 
 				if (s <= v1) { /* do nothing */
 				} else if (s <= -v1) {
@@ -521,75 +900,204 @@ idxint projDualCone(pfloat *x, Cone * k, const pfloat * warm_start, idxint iter)
 			}
 			count += k->q[i];
 		}
-#ifdef EXTRAVERBOSE
-	scs_printf("SOC proj time: %1.2es\n", tocq(&projTimer) / 1e3);
-	tic(&projTimer);
-#endif
-	}
-
-	if (k->ssize && k->s) {
-		/* project onto PSD cone */
-		for (i = 0; i < k->ssize; ++i) {
+		break;
+	case SD_TASK:
+		for (i = t->start; i < t->end; ++i) {
 			if (k->s[i] == 0) {
 				continue;
 			}
-			if (projSemiDefiniteCone(&(x[count]), k->s[i], iter) < 0) return -1;
+			if (projSemiDefiniteCone(&(x[count]), k->s[i], c, thread, &(c->sdPos[i])) < 0)
+				return -1;
 			count += (k->s[i]) * (k->s[i]);
 		}
-#ifdef EXTRAVERBOSE
-	scs_printf("SD proj time: %1.2es\n", tocq(&projTimer) / 1e3);
-	tic(&projTimer);
-#endif
-	}
-
-	if (k->ep) {
-		pfloat r, s, t;
-		idxint idx;
+		break;
+	case SDP_TASK:
+		for (i = t->start; i < t->end; ++i) {
+			if (projPackedSemiDefiniteCone(&(x[count]), k->sp[i], c, thread, &(c->sdPos[k->ssize + i])) < 0)
+				return -1;
+			count += SVEC_LEN(k->sp[i]);
+		}
+		break;
+	case EXP_P_TASK:
 		/*
 		 * exponential cone is not self dual, if s \in K
 		 * then y \in K^* and so if K is the primal cone
 		 * here we project onto K^*, via Moreau
 		 * \Pi_C^*(y) = y + \Pi_C(-y)
 		 */
-		scaleArray(&(x[count]), -1, 3 * k->ep); /* x = -x; */
-#ifdef OPENMP
-#pragma omp parallel for private(r,s,t,idx)
-#endif
-		for (i = 0; i < k->ep; ++i) {
-			idx = count + 3 * i;
-			r = x[idx];
-			s = x[idx + 1];
-			t = x[idx + 2];
+		for (i = t->start; i < t->end; ++i) {
+			scaleArray(&(x[count]), -1, 3); /* x = -x; */
+			memcpy(v, &(x[count]), 3 * sizeof(pfloat));
+			if (projExpCone(&(x[count]), iter, &(c->expRho[i])) < 0)
+				return -1;
+			addScaledArray(&(x[count]), v, 3, -1);
+			count += 3;
+		}
+		break;
+	case EXP_D_TASK:
+		for (i = t->start; i < t->end; ++i) {
+			if (projExpCone(&(x[count]), iter, &(c->expRho[k->ep + i])) < 0)
+				return -1;
+			count += 3;
+		}
+		break;
+	}
+	return 0;
+}
 
-			if (projExpCone(&(x[idx]), iter) < 0) return -1;
+/* outward facing cone projection routine, iter is outer algorithm iteration, if iter < 0 then iter is ignored
+    warm_start contains guess of projection (can be set to NULL) */
+idxint projDualCone(pfloat *x, Cone * k, ConeWork * c, const pfloat * warm_start, idxint iter) {
+	idxint i, nFailed = 0;
+	idxint count = (k->f ? k->f : 0);
+#ifdef EXTRAVERBOSE
+	timer projTimer;
+	tic(&projTimer);
+#endif
 
-			x[idx] -= r;
-			x[idx + 1] -= s;
-			x[idx + 2] -= t;
+	if (k->l) {
+		/* project onto positive orthant */
+		for (i = count; i < count + k->l; ++i) {
+			if (x[i] < 0.0)
+				x[i] = 0.0;
+			/*x[i] = (x[i] < 0.0) ? 0.0 : x[i]; */
 		}
-		count += 3 * k->ep;
+		count += k->l;
 #ifdef EXTRAVERBOSE
-	scs_printf("EP proj time: %1.2es\n", tocq(&projTimer) / 1e3);
+	scs_printf("pos orthant proj time: %1.2es\n", tocq(&projTimer) / 1e3);
 	tic(&projTimer);
 #endif
 	}
 
-
-	if (k->ed) {
-		/* exponential cone: */
+	/* project onto SOC, SD (full and packed) and exponential cones, tasks are independent */
+#ifdef OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(c->nThreads) reduction(+:nFailed) if (c->parallel)
+#endif
+	for (i = 0; i < c->nTasks; ++i) {
 #ifdef OPENMP
-#pragma omp parallel for
+		idxint thread = omp_get_thread_num();
+#else
+		idxint thread = 0;
 #endif
-		for (i = 0; i < k->ed; ++i) {
-			if (projExpCone(&(x[count + 3 * i]), iter) < 0) return -1;
+		if (projConeTask(x, k, c, &(c->tasks[i]), thread, iter) < 0) {
+			nFailed++;
 		}
-		count += 3 * k->ed;
+	}
 #ifdef EXTRAVERBOSE
-	scs_printf("ED proj time: %1.2es\n", tocq(&projTimer) / 1e3);
-	tic(&projTimer);
+	scs_printf("SOC, SD, EXP proj time: %1.2es\n", tocq(&projTimer) / 1e3);
 #endif
+	return nFailed > 0 ? -1 : 0;
+}
+
+/* x = alpha * ut + (1 - alpha) * uprev - v on entries [start, end), in place (uprev == x) v is set to x as well */
+static void relaxBlock(pfloat * x, pfloat * v, const pfloat * ut, const pfloat * uprev, pfloat alpha, idxint start,
+		idxint end) {
+	idxint i;
+	if (uprev == x) {
+		for (i = start; i < end; ++i) {
+			v[i] = x[i] = alpha * ut[i] + (1 - alpha) * x[i] - v[i];
+		}
+		return;
 	}
-	/* project onto OTHER cones */
-	totalConeTime += tocq(&coneTimer);
-	return 0;
+	for (i = start; i < end; ++i) {
+		x[i] = alpha * ut[i] + (1 - alpha) * uprev[i] - v[i];
+	}
+}
+
+/* v += x - alpha * ut - (1 - alpha) * uprev on entries [start, end), in place v = x - v with v holding x before the
+ projection (see relaxBlock) */
+static void dualUpdateBlock(const pfloat * x, pfloat * v, const pfloat * ut, const pfloat * uprev, pfloat alpha,
+		idxint start, idxint end) {
+	idxint i;
+	if (uprev == x) {
+		for (i = start; i < end; ++i) {
+			v[i] = x[i] - v[i];
+		}
+		return;
+	}
+	for (i = start; i < end; ++i) {
+		v[i] += (x[i] - alpha * ut[i] - (1.0 - alpha) * uprev[i]);
+	}
+}
+
+/* the fused step of the free cone (the projection is the identity) and the positive orthant, f and l entries, one
+ pass over each */
+static void lpFused(pfloat * x, pfloat * v, const pfloat * ut, const pfloat * uprev, pfloat alpha, idxint f,
+		idxint l) {
+	idxint i;
+	pfloat xi;
+	if (uprev == x) {
+		/* in place, v = x - (x before the projection) */
+		for (i = 0; i < f; ++i) {
+			x[i] = alpha * ut[i] + (1 - alpha) * x[i] - v[i];
+			v[i] = 0;
+		}
+		for (i = f; i < f + l; ++i) {
+			xi = alpha * ut[i] + (1 - alpha) * x[i] - v[i];
+			x[i] = xi < 0.0 ? 0.0 : xi;
+			v[i] = x[i] - xi;
+		}
+		return;
+	}
+	for (i = 0; i < f; ++i) {
+		x[i] = alpha * ut[i] + (1 - alpha) * uprev[i] - v[i];
+		v[i] += (x[i] - alpha * ut[i] - (1.0 - alpha) * uprev[i]);
+	}
+	for (i = f; i < f + l; ++i) {
+		x[i] = alpha * ut[i] + (1 - alpha) * uprev[i] - v[i];
+		if (x[i] < 0.0)
+			x[i] = 0.0;
+		v[i] += (x[i] - alpha * ut[i] - (1.0 - alpha) * uprev[i]);
+	}
+}
+
+/* the fused step of the SOC task t, over chunks of whole cones of about SOC_CHUNK entries */
+static void socTaskFused(pfloat * x, pfloat * v, const pfloat * ut, const pfloat * uprev, pfloat alpha, Cone * k,
+		ConeWork * c, const ConeTask * t, idxint iter) {
+	ConeTask chunk = *t;
+	idxint i = t->start;
+	while (i < t->end) {
+		chunk.start = i;
+		chunk.len = 0;
+		do {
+			chunk.len += k->q[i++];
+		} while (i < t->end && chunk.len + k->q[i] <= SOC_CHUNK);
+		chunk.end = i;
+		relaxBlock(x, v, ut, uprev, alpha, chunk.offset, chunk.offset + chunk.len);
+		projConeTask(x, k, c, &chunk, 0, iter);
+		dualUpdateBlock(x, v, ut, uprev, alpha, chunk.offset, chunk.offset + chunk.len);
+		chunk.offset += chunk.len;
+	}
+}
+
+idxint projDualConeFused(pfloat * x, pfloat * v, const pfloat * ut, const pfloat * uprev, pfloat alpha, Cone * k,
+		ConeWork * c, idxint iter) {
+	idxint i, nFailed = 0;
+	lpFused(x, v, ut, uprev, alpha, k->f ? k->f : 0, k->l);
+	if (c->lpOnly) {
+		return 0;
+	}
+	/* SOC, SD and exponential cones, a task at a time */
+#ifdef OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(c->nThreads) reduction(+:nFailed) if (c->parallel)
+#endif
+	for (i = 0; i < c->nTasks; ++i) {
+		ConeTask * t = &(c->tasks[i]);
+#ifdef OPENMP
+		idxint thread = omp_get_thread_num();
+#else
+		idxint thread = 0;
+#endif
+		if (t->type == SOC_TASK) {
+			/* cannot fail */
+			socTaskFused(x, v, ut, uprev, alpha, k, c, t, iter);
+			continue;
+		}
+		relaxBlock(x, v, ut, uprev, alpha, t->offset, t->offset + t->len);
+		if (projConeTask(x, k, c, t, thread, iter) < 0) {
+			nFailed++;
+		}
+		dualUpdateBlock(x, v, ut, uprev, alpha, t->offset, t->offset + t->len);
+	}
+	return nFailed > 0 ? -1 : 0;
 }
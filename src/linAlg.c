@@ -15,24 +15,39 @@ void scaleArray(pfloat * a, const pfloat b, idxint len) {
 		a[i] *= b;
 }
 
+/* the reductions below keep four independent partial sums, which breaks the dependency
+ * chain through a single accumulator so the loop can be pipelined and vectorized */
+
 /* x'*y */
 pfloat innerProd(const pfloat * x, const pfloat * y, idxint len) {
-	idxint i;
-	pfloat ip = 0.0;
-	for (i = 0; i < len; ++i) {
-		ip += x[i] * y[i];
+	idxint i, len4 = len - len % 4;
+	pfloat ip0 = 0.0, ip1 = 0.0, ip2 = 0.0, ip3 = 0.0;
+	for (i = 0; i < len4; i += 4) {
+		ip0 += x[i] * y[i];
+		ip1 += x[i + 1] * y[i + 1];
+		ip2 += x[i + 2] * y[i + 2];
+		ip3 += x[i + 3] * y[i + 3];
 	}
-	return ip;
+	for (; i < len; ++i) {
+		ip0 += x[i] * y[i];
+	}
+	return (ip0 + ip1) + (ip2 + ip3);
 }
 
 /* ||v||_2^2 */
 pfloat calcNormSq(const pfloat * v, idxint len) {
-	idxint i;
-	pfloat nmsq = 0.0;
-	for (i = 0; i < len; ++i) {
-		nmsq += v[i] * v[i];
+	idxint i, len4 = len - len % 4;
+	pfloat nm0 = 0.0, nm1 = 0.0, nm2 = 0.0, nm3 = 0.0;
+	for (i = 0; i < len4; i += 4) {
+		nm0 += v[i] * v[i];
+		nm1 += v[i + 1] * v[i + 1];
+		nm2 += v[i + 2] * v[i + 2];
+		nm3 += v[i + 3] * v[i + 3];
 	}
-	return nmsq;
+	for (; i < len; ++i) {
+		nm0 += v[i] * v[i];
+	}
+	return (nm0 + nm1) + (nm2 + nm3);
 }
 
 /* ||v||_2 */
@@ -59,14 +74,63 @@ void addScaledArray(pfloat * a, const pfloat * b, idxint n, const pfloat sc) {
 	}
 }
 
-pfloat calcNormDiff(const pfloat *a, const pfloat *b, idxint l) {
-	pfloat nmDiff = 0.0, tmp;
+/* fused kernels, one pass over the data instead of two */
+
+/* a += sb*b + sc*c */
+void addScaledArray2(pfloat * a, const pfloat * b, const pfloat * c, idxint n, const pfloat sb, const pfloat sc) {
 	idxint i;
-	for (i = 0; i < l; ++i) {
-		tmp = (a[i] - b[i]);
-		nmDiff += tmp * tmp;
+	for (i = 0; i < n; ++i) {
+		a[i] += sb * b[i] + sc * c[i];
+	}
+}
+
+/* a += sc*b, returns ||a||_2^2 of the updated a */
+pfloat addScaledArrayNormSq(pfloat * a, const pfloat * b, idxint n, const pfloat sc) {
+	idxint i, n4 = n - n % 4;
+	pfloat nm0 = 0.0, nm1 = 0.0, nm2 = 0.0, nm3 = 0.0;
+	for (i = 0; i < n4; i += 4) {
+		a[i] += sc * b[i];
+		a[i + 1] += sc * b[i + 1];
+		a[i + 2] += sc * b[i + 2];
+		a[i + 3] += sc * b[i + 3];
+		nm0 += a[i] * a[i];
+		nm1 += a[i + 1] * a[i + 1];
+		nm2 += a[i + 2] * a[i + 2];
+		nm3 += a[i + 3] * a[i + 3];
+	}
+	for (; i < n; ++i) {
+		a[i] += sc * b[i];
+		nm0 += a[i] * a[i];
+	}
+	return (nm0 + nm1) + (nm2 + nm3);
+}
+
+/* a = sa*a + b */
+void scaleAndAddArray(pfloat * a, const pfloat sa, const pfloat * b, idxint n) {
+	idxint i;
+	for (i = 0; i < n; ++i) {
+		a[i] = sa * a[i] + b[i];
+	}
+}
+
+pfloat calcNormDiff(const pfloat *a, const pfloat *b, idxint l) {
+	idxint i, l4 = l - l % 4;
+	pfloat nm0 = 0.0, nm1 = 0.0, nm2 = 0.0, nm3 = 0.0, t0, t1, t2, t3;
+	for (i = 0; i < l4; i += 4) {
+		t0 = a[i] - b[i];
+		t1 = a[i + 1] - b[i + 1];
+		t2 = a[i + 2] - b[i + 2];
+		t3 = a[i + 3] - b[i + 3];
+		nm0 += t0 * t0;
+		nm1 += t1 * t1;
+		nm2 += t2 * t2;
+		nm3 += t3 * t3;
+	}
+	for (; i < l; ++i) {
+		t0 = a[i] - b[i];
+		nm0 += t0 * t0;
 	}
-	return SQRTF(nmDiff);
+	return SQRTF((nm0 + nm1) + (nm2 + nm3));
 }
 
 pfloat calcNormInfDiff(const pfloat *a, const pfloat *b, idxint l) {
@@ -0,0 +1,188 @@
+#include "queue.h"
+
+#if !(defined _WIN32 || defined _WIN64 || defined _WINDLL || defined MATLAB_MEX_FILE)
+
+#include <pthread.h>
+#include <unistd.h>
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+struct SCS_JOB {
+	Data * d;
+	Cone * k;
+	Sol * sol;
+	Info * info;
+	JobCallback cb;
+	void * ctx;
+	idxint status, done;
+	pthread_mutex_t lock; /* guards done, the waiter of scs_job_wait sleeps on cond */
+	pthread_cond_t cond;
+	Job * next;
+};
+
+/* only its address is used */
+static Job queued;
+Job * const SCS_JOB_QUEUED = &queued;
+
+struct SCS_QUEUE {
+	pthread_mutex_t lock; /* guards all but threads and nWorkers */
+	pthread_cond_t cond; /* signalled when a job is queued or done, or the queue stops */
+	pthread_t * threads;
+	idxint nWorkers;
+	idxint free; /* workers neither solving nor lending their processor to a job */
+	Job * head, * tail; /* jobs not started, in order of submission */
+	idxint stop;
+};
+
+/* threads for the solve of j given free workers, the worker running it included */
+static idxint jobThreads(const Job * j, idxint free) {
+#ifdef OPENMP
+	idxint want = (j->d->m + j->d->n) / QUEUE_ROWS_PER_THREAD;
+	return MAX(1, MIN(want, free));
+#else
+	return 1;
+#endif
+}
+
+static void * worker(void * arg) {
+	Queue * q = arg;
+	Job * j;
+	idxint nThreads;
+	pthread_mutex_lock(&(q->lock));
+	for (;;) {
+		while (!(q->head && q->free > 0) && !(q->stop && !q->head)) {
+			pthread_cond_wait(&(q->cond), &(q->lock));
+		}
+		if (!q->head) {
+			break;
+		}
+		j = q->head;
+		q->head = j->next;
+		if (!q->head) {
+			q->tail = NULL;
+		}
+		nThreads = jobThreads(j, q->free);
+		q->free -= nThreads;
+		pthread_mutex_unlock(&(q->lock));
+
+#ifdef OPENMP
+		omp_set_num_threads((int) nThreads);
+#endif
+		j->status = scs(j->d, j->k, j->sol, j->info);
+		if (j->cb) {
+			j->cb(j->status, j->d, j->k, j->sol, j->info, j->ctx);
+			pthread_mutex_destroy(&(j->lock));
+			pthread_cond_destroy(&(j->cond));
+			scs_free(j);
+		} else {
+			pthread_mutex_lock(&(j->lock));
+			j->done = 1;
+			pthread_cond_signal(&(j->cond));
+			pthread_mutex_unlock(&(j->lock));
+		}
+
+		pthread_mutex_lock(&(q->lock));
+		q->free += nThreads;
+		pthread_cond_broadcast(&(q->cond));
+	}
+	pthread_mutex_unlock(&(q->lock));
+	return NULL;
+}
+
+Queue * scs_queue_init(idxint nWorkers) {
+	Queue * q;
+	idxint i;
+	if (nWorkers <= 0) {
+		nWorkers = MAX(1, (idxint) sysconf(_SC_NPROCESSORS_ONLN));
+	}
+	q = scs_calloc(1, sizeof(Queue));
+	if (!q) {
+		return NULL;
+	}
+	q->threads = scs_malloc(nWorkers * sizeof(pthread_t));
+	if (!q->threads) {
+		scs_free(q);
+		return NULL;
+	}
+	pthread_mutex_init(&(q->lock), NULL);
+	pthread_cond_init(&(q->cond), NULL);
+	q->free = nWorkers;
+	for (i = 0; i < nWorkers; ++i) {
+		if (pthread_create(&(q->threads[i]), NULL, worker, q)) {
+			scs_printf("ERROR: could not start the workers of the solve queue\n");
+			break;
+		}
+	}
+	q->nWorkers = i;
+	if (i < nWorkers) {
+		scs_queue_finish(q);
+		return NULL;
+	}
+	return q;
+}
+
+Job * scs_submit(Queue * q, Data * d, Cone * k, Sol * sol, Info * info, JobCallback cb, void * ctx) {
+	Job * j = scs_calloc(1, sizeof(Job));
+	if (!j) {
+		return NULL;
+	}
+	j->d = d;
+	j->k = k;
+	j->sol = sol;
+	j->info = info;
+	j->cb = cb;
+	j->ctx = ctx;
+	pthread_mutex_init(&(j->lock), NULL);
+	pthread_cond_init(&(j->cond), NULL);
+	pthread_mutex_lock(&(q->lock));
+	if (q->tail) {
+		q->tail->next = j;
+	} else {
+		q->head = j;
+	}
+	q->tail = j;
+	pthread_cond_broadcast(&(q->cond));
+	pthread_mutex_unlock(&(q->lock));
+	/* j may already be solved and freed with cb */
+	return cb ? SCS_JOB_QUEUED : j;
+}
+
+idxint scs_job_done(Job * j) {
+	idxint done;
+	pthread_mutex_lock(&(j->lock));
+	done = j->done;
+	pthread_mutex_unlock(&(j->lock));
+	return done;
+}
+
+idxint scs_job_wait(Job * j) {
+	idxint status;
+	pthread_mutex_lock(&(j->lock));
+	while (!j->done) {
+		pthread_cond_wait(&(j->cond), &(j->lock));
+	}
+	pthread_mutex_unlock(&(j->lock));
+	status = j->status;
+	pthread_mutex_destroy(&(j->lock));
+	pthread_cond_destroy(&(j->cond));
+	scs_free(j);
+	return status;
+}
+
+void scs_queue_finish(Queue * q) {
+	idxint i;
+	pthread_mutex_lock(&(q->lock));
+	q->stop = 1;
+	pthread_cond_broadcast(&(q->cond));
+	pthread_mutex_unlock(&(q->lock));
+	for (i = 0; i < q->nWorkers; ++i) {
+		pthread_join(q->threads[i], NULL);
+	}
+	pthread_mutex_destroy(&(q->lock));
+	pthread_cond_destroy(&(q->cond));
+	scs_free(q->threads);
+	scs_free(q);
+}
+
+#endif
@@ -1,16 +1,27 @@
 #include "scs.h"
 #include "normalize.h"
+#include "presolve.h"
 
 #ifndef EXTRAVERBOSE
 /* if verbose print summary output every this num iterations */
 #define PRINT_INTERVAL 100
-/* check for convergence every this num iterations */
+/* check for convergence every this num iterations near the tolerance, up to every MAX_CONVERGED_INTERVAL far from it */
 #define CONVERGED_INTERVAL 20
+#define MAX_CONVERGED_INTERVAL 160
 #else
 #define PRINT_INTERVAL 1
 #define CONVERGED_INTERVAL 1
+#define MAX_CONVERGED_INTERVAL 16
 #endif
 
+/* ADAPTIVE_RHO: every RHO_INTERVAL iterations (doubling after each update, so there are only a few) RHO_X is
+ multiplied by the geometric mean of resPri / resDual at the convergence checks since the last decision if that
+ is beyond RHO_RATIO either way, keeping it in [RHO_X_MIN, RHO_X_MAX] */
+#define RHO_INTERVAL 100
+#define RHO_RATIO 5
+#define RHO_X_MIN 1e-6
+#define RHO_X_MAX 1e3
+
 /* tolerance at which we declare problem indeterminate */
 #define INDETERMINATE_TOL 1e-9
 
@@ -19,7 +30,6 @@ static const char* HEADER[] = { " Iter ", " pri res ", " dua res ", " rel gap ",
 		" time (s)", };
 static const idxint HSPACE = 9;
 static const idxint HEADER_LEN = 8;
-static idxint _lineLen_;
 
 static idxint scs_isnan(pfloat x) {
 	return (x == NAN || x != x);
@@ -29,16 +39,16 @@ static void printInitHeader(Data * d, Work * w, Cone * k) {
 	idxint i;
 	char * coneStr = getConeHeader(k);
 	char * linSysMethod = getLinSysMethod(d, w->p);
-	_lineLen_ = -1;
+	w->lineLen = -1;
 	for (i = 0; i < HEADER_LEN; ++i) {
-		_lineLen_ += (idxint) strlen(HEADER[i]) + 1;
+		w->lineLen += (idxint) strlen(HEADER[i]) + 1;
 	}
-	for (i = 0; i < _lineLen_; ++i) {
+	for (i = 0; i < w->lineLen; ++i) {
 		scs_printf("-");
 	}
 	scs_printf("\n\tSCS v%s - Splitting Conic Solver\n\t(c) Brendan O'Donoghue, Stanford University, 2012\n",
 			SCS_VERSION);
-	for (i = 0; i < _lineLen_; ++i) {
+	for (i = 0; i < w->lineLen; ++i) {
 		scs_printf("-");
 	}
     scs_printf("\n");
@@ -53,6 +63,9 @@ static void printInitHeader(Data * d, Work * w, Cone * k) {
 		scs_printf("EPS = %.2e, ALPHA = %.2f, MAX_ITERS = %i, NORMALIZE = %i\n", d->EPS, d->ALPHA, (int) d->MAX_ITERS,
 				(int) d->NORMALIZE);
 	}
+	if (d->ACCEL_MEM > 0) {
+		scs_printf("Anderson acceleration, ACCEL_MEM = %i\n", (int) d->ACCEL_MEM);
+	}
 	scs_printf("Variables n = %i, constraints m = %i\n", (int) d->n, (int) d->m);
 	scs_printf("%s", coneStr);
 	scs_free(coneStr);
@@ -70,15 +83,16 @@ static idxint failureDefaultReturn(Data * d, Work * w, Sol * sol, Info * info, c
 	info->iter = -1;
 	info->statusVal = FAILURE;
 	info->solveTime = NAN;
+	info->linSysIters = 0;
 	strcpy(info->status, "Failure");
 	if (!sol->x)
-		sol->x = scs_malloc(sizeof(pfloat) * d->n);
+		sol->x = scs_caller_malloc(sizeof(pfloat) * d->n);
 	scaleArray(sol->x, NAN, d->n);
 	if (!sol->y)
-		sol->y = scs_malloc(sizeof(pfloat) * d->m);
+		sol->y = scs_caller_malloc(sizeof(pfloat) * d->m);
 	scaleArray(sol->y, NAN, d->m);
 	if (!sol->s)
-		sol->s = scs_malloc(sizeof(pfloat) * d->m);
+		sol->s = scs_caller_malloc(sizeof(pfloat) * d->m);
 	scaleArray(sol->s, NAN, d->m);
 	scs_printf("FAILURE:%s\n", msg);
 	return FAILURE;
@@ -104,9 +118,10 @@ static void warmStartVars(Data * d, Work * w, Sol * sol) {
 		normalizeWarmStart(d, w);
 }
 
+/* without pr and dr (LOW_MEMORY) the residuals go to u_t, which the next projectLinSys overwrites */
 static pfloat calcPrimalResid(Data * d, Work * w, pfloat * x, pfloat * s, pfloat tau, pfloat *nmAxs) {
 	idxint i;
-	pfloat pres = 0, scale, *pr = w->pr, *D = w->D;
+	pfloat pres = 0, scale, *pr = w->pr ? w->pr : &(w->u_t[d->n]), *D = w->D;
 	*nmAxs = 0;
 	memset(pr, 0, d->m * sizeof(pfloat));
 	accumByA(d, w->p, x, pr);
@@ -123,7 +138,7 @@ static pfloat calcPrimalResid(Data * d, Work * w, pfloat * x, pfloat * s, pfloat
 
 static pfloat calcDualResid(Data * d, Work * w, pfloat * y, pfloat tau, pfloat *nmATy) {
 	idxint i;
-	pfloat dres = 0, scale, *dr = w->dr, *E = w->E;
+	pfloat dres = 0, scale, *dr = w->dr ? w->dr : w->u_t, *E = w->E;
 	*nmATy = 0;
 	memset(dr, 0, d->n * sizeof(pfloat));
 	accumByAtrans(d, w->p, y, dr); /* dr = A'y */
@@ -142,8 +157,7 @@ static pfloat fastCalcPrimalResid(Data * d, Work * w, pfloat * nmAxs) {
 	pfloat pres = 0, scale, *pr = w->pr, *D = w->D, tau = ABS(w->u[n + m]);
 	*nmAxs = 0;
 	memcpy(pr, &(w->u[n]), m * sizeof(pfloat)); /* overwrite pr */
-	addScaledArray(pr, &(w->u_prev[n]), m, d->ALPHA - 2);
-	addScaledArray(pr, &(w->u_t[n]), m, 1 - d->ALPHA);
+	addScaledArray2(pr, &(w->u_prev[n]), &(w->u_t[n]), m, d->ALPHA - 2, 1 - d->ALPHA);
 	addScaledArray(pr, d->b, m, w->u_t[n + m]); /* pr = Ax + s */
 	for (i = 0; i < m; ++i) {
 		scale = d->NORMALIZE ? D[i] / (w->sc_b * d->SCALE) : 1;
@@ -155,6 +169,24 @@ static pfloat fastCalcPrimalResid(Data * d, Work * w, pfloat * nmAxs) {
 	return SQRTF(pres); /* norm(Ax + s - b * tau) */
 }
 
+/* A'y for y = u_t_y read off the x rows of the linear system, RHO_X * (u_t_x - u_prev_x - v_x) + A'y + c * tau_t = 0 */
+static pfloat fastCalcDualResid(Data * d, Work * w, pfloat * nmATy) {
+	idxint i, n = d->n, m = d->m;
+	pfloat dres = 0, scale, *dr = w->dr, *E = w->E, tau = ABS(w->u[n + m]);
+	*nmATy = 0;
+	for (i = 0; i < n; ++i) {
+		dr[i] = d->RHO_X * (w->u_prev[i] + w->v[i] - w->u_t[i]) - d->c[i] * w->u_t[n + m]; /* dr = A'y */
+	}
+	for (i = 0; i < n; ++i) {
+		scale = d->NORMALIZE ? E[i] / (w->sc_c * d->SCALE) : 1;
+		scale = scale * scale;
+		*nmATy += (dr[i] * dr[i]) * scale;
+		dres += (dr[i] + d->c[i] * tau) * (dr[i] + d->c[i] * tau) * scale;
+	}
+	*nmATy = SQRTF(*nmATy);
+	return SQRTF(dres); /* norm(A'y + c * tau) */
+}
+
 static void getInfo(Data * d, Work * w, Sol * sol, Info * info) {
 	pfloat cTx, bTy, nmAxs, nmATy, nmpr, nmdr;
 	pfloat * x = sol->x, *y = sol->y, *s = sol->s;
@@ -175,6 +207,8 @@ static void getInfo(Data * d, Work * w, Sol * sol, Info * info) {
 		info->relGap = ABS(cTx + bTy) / (1 + ABS(cTx) + ABS(bTy));
 		info->resPri = nmpr / (1 + w->nm_b);
 		info->resDual = nmdr / (1 + w->nm_c);
+	} else if (info->statusVal == INDETERMINATE) {
+		info->pobj = info->dobj = info->relGap = info->resPri = info->resDual = NAN;
 	} else {
 		if (info->statusVal == UNBOUNDED) {
 			info->dobj = NAN;
@@ -203,23 +237,41 @@ static void coldStartVars(Data * d, Work * w) {
 	w->v[l - 1] = SQRTF((pfloat) l);
 }
 
-/* status < 0 indicates failure */
-static idxint projectLinSys(Data * d, Work * w, idxint iter) {
-	/* ut = u + v */
-	idxint n = d->n, m = d->m, l = n + m + 1, status;
-	memcpy(w->u_t, w->u, l * sizeof(pfloat));
-	addScaledArray(w->u_t, w->v, l, 1.0);
-
-	scaleArray(w->u_t, d->RHO_X, n);
+/* the current u, in u_prev after the swap of scs_solve or still in u without u_prev (LOW_MEMORY) */
+static pfloat * currentU(Work * w) {
+	return w->u_prev ? w->u_prev : w->u;
+}
 
-	addScaledArray(w->u_t, w->h, l - 1, -w->u_t[l - 1]);
-	addScaledArray(w->u_t, w->h, l - 1, -innerProd(w->u_t, w->g, l - 1) / (w->gTh + 1));
-	scaleArray(&(w->u_t[n]), -1, m);
+static void formLinSysRhs(Data * d, Work * w) {
+	/* ut = u + v */
+	idxint i, n = d->n, m = d->m, l = n + m + 1;
+	pfloat *ut = w->u_t, *u = currentU(w), *v = w->v, *h = w->h;
+	pfloat tau = u[l - 1] + v[l - 1], sc;
 
-	status = solveLinSys(d, w->p, w->u_t, w->u, iter);
+	/* ut = [RHO_X * (u_x + v_x); u_y + v_y] - tau * h */
+	ut[l - 1] = tau;
+	for (i = 0; i < n; ++i) {
+		ut[i] = (u[i] + v[i]) * d->RHO_X - tau * h[i];
+	}
+	for (i = n; i < l - 1; ++i) {
+		ut[i] = (u[i] + v[i]) - tau * h[i];
+	}
+	/* ut -= (ut'g / (g'h + 1)) * h, and negate the y part */
+	sc = -innerProd(ut, w->g, l - 1) / (w->gTh + 1);
+	for (i = 0; i < n; ++i) {
+		ut[i] += sc * h[i];
+	}
+	for (i = n; i < l - 1; ++i) {
+		ut[i] = -(ut[i] + sc * h[i]);
+	}
+}
 
+/* status < 0 indicates failure */
+static idxint projectLinSys(Data * d, Work * w, idxint iter) {
+	idxint l = d->n + d->m + 1, status;
+	formLinSysRhs(d, w);
+	status = solveLinSys(d, w->p, w->u_t, currentU(w), iter);
 	w->u_t[l - 1] += innerProd(w->u_t, w->h, l - 1);
-
 	return status;
 }
 
@@ -264,28 +316,23 @@ void printSol(Data * d, Sol * sol, Info * info) {
 	}
 }
 
-static void updateDualVars(Data * d, Work * w) {
-	idxint i, n = d->n, l = n + d->m + 1;
-	/* this does not relax 'x' variable */
-	for (i = n; i < l; ++i) {
-		w->v[i] += (w->u[i] - d->ALPHA * w->u_t[i] - (1.0 - d->ALPHA) * w->u_prev[i]);
-	}
-}
-
 /* status < 0 indicates failure */
 static idxint projectCones(Data *d, Work * w, Cone * k, idxint iter) {
+	/* over-relaxation, cone projection and dual update, the cone part block by block, in place without u_prev */
 	idxint i, n = d->n, l = n + d->m + 1, status;
+	pfloat * uprev = currentU(w), tau;
 	/* this does not relax 'x' variable */
 	for (i = 0; i < n; ++i) {
 		w->u[i] = w->u_t[i] - w->v[i];
 	}
-	for (i = n; i < l; ++i) {
-		w->u[i] = d->ALPHA * w->u_t[i] + (1 - d->ALPHA) * w->u_prev[i] - w->v[i];
-	}
 	/* u = [x;y;tau] */
-	status = projDualCone(&(w->u[n]), k, &(w->u_prev[n]), iter);
-	if (w->u[l - 1] < 0.0)
-		w->u[l - 1] = 0.0;
+	status = projDualConeFused(&(w->u[n]), &(w->v[n]), &(w->u_t[n]), &(uprev[n]), d->ALPHA, k, w->coneWork, iter);
+	tau = d->ALPHA * w->u_t[l - 1] + (1 - d->ALPHA) * uprev[l - 1] - w->v[l - 1];
+	w->u[l - 1] = tau < 0.0 ? 0.0 : tau;
+	if (w->u_prev)
+		w->v[l - 1] += (w->u[l - 1] - d->ALPHA * w->u_t[l - 1] - (1.0 - d->ALPHA) * w->u_prev[l - 1]);
+	else
+		w->v[l - 1] = w->u[l - 1] - tau;
 
 	return status;
 }
@@ -323,19 +370,19 @@ static idxint unbounded(Data * d, Sol * sol, Info * info) {
 
 static void sety(Data * d, Work * w, Sol * sol) {
 	if (!sol->y)
-		sol->y = scs_malloc(sizeof(pfloat) * d->m);
+		sol->y = scs_caller_malloc(sizeof(pfloat) * d->m);
 	memcpy(sol->y, &(w->u[d->n]), d->m * sizeof(pfloat));
 }
 
 static void sets(Data * d, Work * w, Sol * sol) {
 	if (!sol->s)
-		sol->s = scs_malloc(sizeof(pfloat) * d->m);
+		sol->s = scs_caller_malloc(sizeof(pfloat) * d->m);
 	memcpy(sol->s, &(w->v[d->n]), d->m * sizeof(pfloat));
 }
 
 static void setx(Data * d, Work * w, Sol * sol) {
 	if (!sol->x)
-		sol->x = scs_malloc(sizeof(pfloat) * d->n);
+		sol->x = scs_caller_malloc(sizeof(pfloat) * d->n);
 	memcpy(sol->x, w->u, d->n * sizeof(pfloat));
 }
 
@@ -344,7 +391,17 @@ static void setSolution(Data * d, Work * w, Sol * sol, Info * info) {
 	setx(d, w, sol);
 	sety(d, w, sol);
 	sets(d, w, sol);
-	if (info->statusVal == 0 || info->statusVal == SOLVED) {
+	if (info->statusVal == TIMEOUT) {
+		/* never a certificate, the iterate is returned as the solution it approximates */
+		pfloat tau = w->u[l - 1];
+		if (tau > INDETERMINATE_TOL) {
+			info->statusVal = solved(d, sol, info, tau);
+		} else {
+			/* too early to tell, the raw iterate as it is */
+			strcpy(info->status, "Indeterminate");
+			info->statusVal = INDETERMINATE;
+		}
+	} else if (info->statusVal == 0 || info->statusVal == SOLVED) {
 		pfloat tau = w->u[l - 1];
 		pfloat kap = ABS(w->v[l - 1]);
 		if (tau > INDETERMINATE_TOL && tau > kap) {
@@ -388,7 +445,7 @@ static void printHeader(Data * d, Work * w, Cone * k) {
 	idxint i;
     if (d->WARM_START)
         scs_printf("SCS using variable warm-starting\n");
-    for (i = 0; i < _lineLen_; ++i) {
+    for (i = 0; i < w->lineLen; ++i) {
         scs_printf("-");
     }
     scs_printf("\n");
@@ -396,7 +453,7 @@ static void printHeader(Data * d, Work * w, Cone * k) {
         scs_printf("%s|", HEADER[i]);
     }
     scs_printf("%s\n", HEADER[HEADER_LEN - 1]);
-    for (i = 0; i < _lineLen_; ++i) {
+    for (i = 0; i < w->lineLen; ++i) {
         scs_printf("-");
     }
     scs_printf("\n");
@@ -409,14 +466,20 @@ static void printFooter(Data * d, Work * w, Info * info) {
 	idxint i;
 	char * linSysStr = getLinSysSummary(w->p, info);
 	char * coneStr = getConeSummary(info);
-	for (i = 0; i < _lineLen_; ++i) {
+	char * accelStr = w->accel ? getAccelSummary(w->accel, info) : NULL;
+	for (i = 0; i < w->lineLen; ++i) {
 		scs_printf("-");
 	}
 	scs_printf("\nStatus: %s\n", info->status);
-	if (info->iter == d->MAX_ITERS) {
+	if (info->statusVal == TIMEOUT) {
+		scs_printf("Hit TIME_LIMIT, solution may be inaccurate\n");
+	} else if (info->iter == d->MAX_ITERS) {
 		scs_printf("Hit MAX_ITERS, solution may be inaccurate\n");
 	}
 	scs_printf("Timing: Total solve time: %1.2es\n", info->solveTime / 1e3);
+	if (w->rhoUpdates > 0) {
+		scs_printf("RHO_X adapted to %.2e (%li updates)\n", d->RHO_X, (long) w->rhoUpdates);
+	}
 
 	if (linSysStr) {
 		scs_printf("%s", linSysStr);
@@ -426,8 +489,12 @@ static void printFooter(Data * d, Work * w, Info * info) {
 		scs_printf("%s", coneStr);
 		scs_free(coneStr);
 	}
+	if (accelStr) {
+		scs_printf("%s", accelStr);
+		scs_free(accelStr);
+	}
 
-	for (i = 0; i < _lineLen_; ++i) {
+	for (i = 0; i < w->lineLen; ++i) {
 		scs_printf("-");
 	}
 	scs_printf("\n");
@@ -448,13 +515,13 @@ static void printFooter(Data * d, Work * w, Info * info) {
 		scs_printf("|A'y + c|_2 / (1 + |c|_2) = %.4e\n", info->resDual);
 		scs_printf("|c'x + b'y| / (1 + |c'x| + |b'y|) = %.4e\n", info->relGap);
 		scs_printf("dist(s, K) = 0, dist(y, K*) = 0, s'y = 0\n");
-		for (i = 0; i < _lineLen_; ++i) {
+		for (i = 0; i < w->lineLen; ++i) {
 			scs_printf("-");
 		}
 		scs_printf("\n");
 		scs_printf("c'x = %.4f, -b'y = %.4f\n", info->pobj, info->dobj);
 	}
-	for (i = 0; i < _lineLen_; ++i) {
+	for (i = 0; i < w->lineLen; ++i) {
 		scs_printf("=");
 	}
 	scs_printf("\n");
@@ -463,10 +530,33 @@ static void printFooter(Data * d, Work * w, Info * info) {
 #endif
 }
 
-static idxint converged(Data * d, Work * w, struct residuals * r, idxint iter) {
+/* checks less often the further the residuals are from EPS, largest (worst) is NAN if tau <= kap */
+static void scheduleCheck(Data * d, Work * w, idxint iter, pfloat largest) {
+	idxint interval = CONVERGED_INTERVAL;
+	pfloat ratio = largest / d->EPS;
+	while (ratio > 10 && interval < MAX_CONVERGED_INTERVAL) {
+		interval = MIN(2 * interval, MAX_CONVERGED_INTERVAL);
+		ratio /= 10;
+	}
+	w->nextCheck = iter + interval;
+}
+
+/* appends an entry to the residual trace of info, which must have room */
+static void traceResiduals(Info * info, idxint iter, pfloat rpri, pfloat rdua, pfloat gap) {
+	pfloat * e = &(info->resTrace[4 * info->resTraceLen]);
+	e[0] = (pfloat) iter;
+	e[1] = rpri;
+	e[2] = rdua;
+	e[3] = gap;
+	info->resTraceLen++;
+}
+
+static idxint converged(Data * d, Work * w, struct residuals * r, idxint iter, Info * info) {
 	pfloat nmpr, nmdr, tau, kap, *x, *y, cTx, nmAxs, bTy, nmATy, rpri, rdua, gap;
-	idxint n = d->n, m = d->m;
-	if (iter % CONVERGED_INTERVAL != 0) {
+	idxint n = d->n, m = d->m, exact = 0;
+	idxint trace = info->resTrace && info->resTraceLen < info->resTraceCap;
+	/* the summary printed every PRINT_INTERVAL iterations and the trace need fresh residuals */
+	if (iter < w->nextCheck && !(d->VERBOSE && iter % PRINT_INTERVAL == 0) && !trace) {
 		return 0;
 	}
 	x = w->u;
@@ -480,8 +570,8 @@ static idxint converged(Data * d, Work * w, struct residuals * r, idxint iter) {
 	 nmpr = calcPrimalResid(d, w, w->u, &(w->v[n]), ABS(w->u[n + m]), &nmAxs);
 	 */
 
-	/* does not require mult by A: */
-	nmpr = fastCalcPrimalResid(d, w, &nmAxs);
+	/* does not require mult by A, but needs u_prev: */
+	nmpr = w->u_prev ? fastCalcPrimalResid(d, w, &nmAxs) : calcPrimalResid(d, w, x, &(w->v[n]), tau, &nmAxs);
 	cTx = innerProd(x, d->c, n) / (d->NORMALIZE ? (d->SCALE * w->sc_c * w->sc_b) : 1);
 
 	r->resPri = cTx < 0 ? w->nm_c * nmAxs / -cTx : NAN;
@@ -489,26 +579,44 @@ static idxint converged(Data * d, Work * w, struct residuals * r, idxint iter) {
 		return UNBOUNDED;
 	}
 
-	nmdr = calcDualResid(d, w, y, tau, &nmATy);
+	/* does not require mult by A', but is at u_t_y rather than y so is redone exactly before terminating */
+	exact = !w->u_prev;
+	nmdr = exact ? calcDualResid(d, w, y, tau, &nmATy) : fastCalcDualResid(d, w, &nmATy);
 	bTy = innerProd(y, d->b, m) / (d->NORMALIZE ? (d->SCALE * w->sc_c * w->sc_b) : 1);
 
 	r->resDual = bTy < 0 ? w->nm_b * nmATy / -bTy : NAN;
+	if (r->resDual < d->EPS && !exact) {
+		nmdr = calcDualResid(d, w, y, tau, &nmATy);
+		exact = 1;
+		r->resDual = w->nm_b * nmATy / -bTy;
+	}
 	if (r->resDual < d->EPS) {
 		return INFEASIBLE;
 	}
 
-	r->cTx = cTx / tau;
-	r->bTy = bTy / tau;
+	/* the objectives of the original problem: b'y of PRESOLVE's reduced problem is short by -objOffset at the
+	 solution, as c'x is by objOffset */
+	r->cTx = cTx / tau + w->objOffset;
+	r->bTy = bTy / tau - w->objOffset;
 	r->relGap = NAN;
 
 	rpri = nmpr / (1 + w->nm_b) / tau;
 	rdua = nmdr / (1 + w->nm_c) / tau;
-	gap = ABS(cTx + bTy) / (tau + ABS(cTx) + ABS(bTy));
+	gap = ABS(cTx + bTy) / (tau + ABS(cTx + tau * w->objOffset) + ABS(bTy - tau * w->objOffset));
+	if (!exact && MAX(MAX(rpri,rdua),gap) < d->EPS) {
+		nmdr = calcDualResid(d, w, y, tau, &nmATy);
+		rdua = nmdr / (1 + w->nm_c) / tau;
+	}
 	if (tau > kap) {
 		r->resPri = rpri;
 		r->resDual = rdua;
 		r->relGap = gap;
 	}
+	if (trace)
+		traceResiduals(info, iter, rpri, rdua, gap);
+	w->lastCheck = iter;
+	setLinSysResidual(w->p, tau > kap ? MAX(rpri, rdua) : NAN);
+	scheduleCheck(d, w, iter, tau > kap ? MAX(MAX(rpri,rdua),gap) : NAN);
 	return (MAX(MAX(rpri,rdua),gap) < d->EPS ? SOLVED : 0);
 }
 
@@ -549,35 +657,104 @@ static idxint validate(Data * d, Cone * k) {
 		scs_printf("SCALE must be positive (1 works well).\n");
 		return -1;
 	}
+	if (d->ACCEL_MEM < 0) {
+		scs_printf("ACCEL_MEM must be nonnegative (0 turns acceleration off).\n");
+		return -1;
+	}
+	if (d->CG_MAX_ITERS < 0) {
+		scs_printf("CG_MAX_ITERS must be nonnegative (0 for no cap).\n");
+		return -1;
+	}
+	if (d->CG_PRECOND < 0 || d->CG_PRECOND > 2) {
+		scs_printf("CG_PRECOND must be 0, 1 or 2.\n");
+		return -1;
+	}
+	if (d->NORMAL_EQS < 0 || d->NORMAL_EQS > 2) {
+		scs_printf("NORMAL_EQS must be 0, 1 or 2.\n");
+		return -1;
+	}
+	if (d->LOW_MEMORY < 0 || d->LOW_MEMORY > 1) {
+		scs_printf("LOW_MEMORY must be 0 or 1.\n");
+		return -1;
+	}
+	if (d->ORDERING < ORDER_AMD || d->ORDERING > ORDER_USER) {
+		scs_printf("ORDERING must be ORDER_AMD, ORDER_ND or ORDER_USER.\n");
+		return -1;
+	}
+	if (d->ORDERING == ORDER_USER && !d->PERM) {
+		scs_printf("ORDER_USER needs the permutation PERM.\n");
+		return -1;
+	}
+	if (d->TIME_LIMIT < 0) {
+		scs_printf("TIME_LIMIT must be nonnegative (0 for none).\n");
+		return -1;
+	}
 	return 0;
 }
 
-static Work * initWork(Data *d, Cone * k) {
-	Work * w = scs_calloc(1, sizeof(Work));
+/* copies a normalization saved by scs_get_scaling into w, as normalizeA would have computed it */
+static idxint useScaling(Data * d, Work * w, const Scaling * s) {
+	w->D = scs_wmalloc(d->m * sizeof(pfloat));
+	w->E = scs_wmalloc(d->n * sizeof(pfloat));
+	if (!w->D || !w->E)
+		return -1;
+	memcpy(w->D, s->D, d->m * sizeof(pfloat));
+	memcpy(w->E, s->E, d->n * sizeof(pfloat));
+	w->meanNormRowA = s->meanNormRowA;
+	w->meanNormColA = s->meanNormColA;
+	return 0;
+}
+
+/* frees the parts of w, with ARENA in the arena scope of w (see scs_finish) */
+static void finishWork(Work * w) {
+	finishCone(w->coneWork);
+	freePriv(w->p);
+	freeAccel(w->accel);
+	freePresolve(w->pre);
+	if (w->best)
+		scs_free(w->best);
+	freeWork(w);
+}
+
+static Work * initWork(Data *d, Cone * k, Info * info) {
+	Work * w = scs_wcalloc(1, sizeof(Work));
 	idxint l = d->n + d->m + 1;
-	if (d->VERBOSE) {
-		printInitHeader(d, w, k);
-	}
+	timer normalizeTimer;
 	if (!w) {
 		scs_printf("ERROR: allocating work failure\n");
 		return NULL;
 	}
+	if (d->VERBOSE) {
+		printInitHeader(d, w, k);
+	}
 	/* allocate workspace: */
-	w->u = scs_malloc(l * sizeof(pfloat));
-	w->v = scs_malloc(l * sizeof(pfloat));
-	w->u_t = scs_malloc(l * sizeof(pfloat));
-	w->u_prev = scs_malloc(l * sizeof(pfloat));
-	w->h = scs_malloc((l - 1) * sizeof(pfloat));
-	w->g = scs_malloc((l - 1) * sizeof(pfloat));
-	w->pr = scs_malloc(d->m * sizeof(pfloat));
-	w->dr = scs_malloc(d->n * sizeof(pfloat));
-	if (!w->u || !w->v || !w->u_t || !w->u_prev || !w->h || !w->g || !w->pr || !w->dr) {
+	w->u = scs_wmalloc(l * sizeof(pfloat));
+	w->v = scs_wmalloc(l * sizeof(pfloat));
+	w->u_t = scs_wmalloc(l * sizeof(pfloat));
+	w->h = scs_wmalloc((l - 1) * sizeof(pfloat));
+	w->g = scs_wmalloc((l - 1) * sizeof(pfloat));
+	if (!d->LOW_MEMORY) {
+		w->u_prev = scs_wmalloc(l * sizeof(pfloat));
+		w->pr = scs_wmalloc(d->m * sizeof(pfloat));
+		w->dr = scs_wmalloc(d->n * sizeof(pfloat));
+	}
+	if (!w->u || !w->v || !w->u_t || !w->h || !w->g || (!d->LOW_MEMORY && (!w->u_prev || !w->pr || !w->dr))) {
 		scs_printf("ERROR: work memory allocation failure\n");
-		scs_finish(d, w);
+		finishWork(w);
 		return NULL;
 	}
 	if (d->NORMALIZE) {
-		normalizeA(d, w, k);
+		tic(&normalizeTimer);
+		if (d->scaling) {
+			if (useScaling(d, w, d->scaling) < 0) {
+				scs_printf("ERROR: work memory allocation failure\n");
+				finishWork(w);
+				return NULL;
+			}
+		} else {
+			normalizeA(d, w, k);
+		}
+		info->prof.normalizeTime = tocq(&normalizeTimer);
 #ifdef EXTRAVERBOSE
 	printArray(w->D, d->m, "D");
 	scs_printf("norm D = %4f\n", calcNorm(w->D, d->m));
@@ -588,20 +765,39 @@ static Work * initWork(Data *d, Cone * k) {
 		w->D = NULL;
 		w->E = NULL;
 	}
-	if (initCone(k) < 0) {
+	w->coneWork = initCone(k);
+	if (!w->coneWork) {
 		scs_printf("ERROR: initCone failure\n");
-		scs_finish(d, w);
+		finishWork(w);
 		return NULL;
 	}
-	w->p = initPriv(d);
+	w->p = initPriv(d, w->D, w->E);
 	if (!w->p) {
 		scs_printf("ERROR: initPriv failure\n");
-		scs_finish(d, w);
+		finishWork(w);
 		return NULL;
 	}
+	getLinSysProfile(w->p, &(info->prof));
+	if (d->ACCEL_MEM > 0) {
+		w->accel = initAccel(l, d->ACCEL_MEM);
+		if (!w->accel) {
+			scs_printf("ERROR: initAccel failure\n");
+			finishWork(w);
+			return NULL;
+		}
+	}
 	return w;
 }
 
+/* g = inv([RHO_X * I  A' ; A  -I]) * h with the y part negated, depends on RHO_X */
+static void setG(Data * d, Work * w) {
+	idxint n = d->n, m = d->m;
+	memcpy(w->g, w->h, (n + m) * sizeof(pfloat));
+	solveLinSys(d, w->p, w->g, NULL, -1);
+	scaleArray(&(w->g[n]), -1, m);
+	w->gTh = innerProd(w->h, w->g, n + m);
+}
+
 static void updateWork(Data * d, Work * w, Sol * sol) {
 	/* before normalization */
 	idxint n = d->n;
@@ -632,15 +828,135 @@ static void updateWork(Data * d, Work * w, Sol * sol) {
 	}
 	memcpy(w->h, d->c, n * sizeof(pfloat));
 	memcpy(&(w->h[d->n]), d->b, m * sizeof(pfloat));
-	memcpy(w->g, w->h, (n + m) * sizeof(pfloat));
-	solveLinSys(d, w->p, w->g, NULL, -1);
-	scaleArray(&(w->g[d->n]), -1, m);
-	w->gTh = innerProd(w->h, w->g, n + m);
+	setG(d, w);
+	w->nextCheck = 0;
+	w->lastCheck = -1;
+	w->rhoLogRatio = 0;
+	w->rhoChecks = 0;
+	w->rhoInterval = RHO_INTERVAL;
+	w->nextRhoUpdate = RHO_INTERVAL;
+	w->rhoUpdates = 0;
+	setLinSysResidual(w->p, NAN);
+	if (w->accel)
+		resetAccel(w->accel, w->u, w->v);
 }
 
-idxint scs_solve(Work * w, Data * d, Cone * k, Sol * sol, Info * info) {
-	idxint i;
-	timer solveTimer;
+/* ADAPTIVE_RHO, after a convergence check at iteration iter with residuals r: records the balance of the
+ residuals and, once an interval is over, rescales RHO_X if they are far apart. The iterates stay valid, RHO_X
+ weights only x in the linear system, where v is always 0, but g and the acceleration history depend on it.
+ A large resPri / resDual means x moves too freely, so RHO_X grows with it. Returns < 0 on failure */
+static idxint adaptRho(Data * d, Work * w, struct residuals * r, idxint iter) {
+	pfloat ratio, rho;
+	/* only the residuals of a solution estimate (tau > kap) count */
+	if (!scs_isnan(r->relGap) && r->resPri > 0 && r->resDual > 0) {
+		w->rhoLogRatio += log(r->resPri / r->resDual);
+		w->rhoChecks++;
+	}
+	if (iter < w->nextRhoUpdate || w->rhoChecks == 0) {
+		return 0;
+	}
+	ratio = exp(w->rhoLogRatio / w->rhoChecks);
+	w->rhoLogRatio = 0;
+	w->rhoChecks = 0;
+	w->nextRhoUpdate = iter + w->rhoInterval;
+	rho = MIN(MAX(d->RHO_X * ratio, RHO_X_MIN), RHO_X_MAX);
+	if ((ratio < RHO_RATIO && ratio > 1.0 / RHO_RATIO) || rho == d->RHO_X) {
+		return 0;
+	}
+	d->RHO_X = rho;
+	if (updateLinSys(d, w->p) < 0) {
+		return -1;
+	}
+	setG(d, w);
+	if (w->accel)
+		resetAccel(w->accel, w->u, w->v);
+	w->rhoInterval *= 2;
+	w->nextRhoUpdate = iter + w->rhoInterval;
+	w->rhoUpdates++;
+	return 0;
+}
+
+/* zeroes the solve phase times of prof, leaving those of the setup */
+static void resetSolveProfile(Profile * prof) {
+	prof->linSysTime = 0;
+	prof->coneTime = 0;
+	prof->convergedTime = 0;
+	prof->minIterTime = 0;
+	prof->maxIterTime = 0;
+	prof->avgIterTime = 0;
+}
+
+/* copies the solve phase times of src to dst */
+static void copySolveProfile(Profile * dst, const Profile * src) {
+	dst->linSysTime = src->linSysTime;
+	dst->coneTime = src->coneTime;
+	dst->convergedTime = src->convergedTime;
+	dst->minIterTime = src->minIterTime;
+	dst->maxIterTime = src->maxIterTime;
+	dst->avgIterTime = src->avgIterTime;
+}
+
+/* adds the time since *last (both times into the iteration) to *total and moves *last to now */
+static void addPhaseTime(timer * iterTimer, pfloat * last, pfloat * total) {
+	pfloat now = tocq(iterTimer);
+	*total += now - *last;
+	*last = now;
+}
+
+/* adds time t of iteration iter to the per-iteration statistics of prof */
+static void addIterTime(Profile * prof, idxint iter, pfloat t) {
+	if (iter == 0 || t < prof->minIterTime)
+		prof->minIterTime = t;
+	if (iter == 0 || t > prof->maxIterTime)
+		prof->maxIterTime = t;
+	prof->avgIterTime += (t - prof->avgIterTime) / (iter + 1);
+}
+
+/* whether the solve should stop for TIME_LIMIT, elapsed is the solve time so far and next an estimate of the
+ time of the next iteration (milli-seconds): stops once that iteration would end past the limit */
+static idxint outOfTime(Data * d, pfloat elapsed, pfloat next) {
+	return d->TIME_LIMIT > 0 && elapsed + next > d->TIME_LIMIT * 1e3;
+}
+
+/* keeps u and v in w->best if the convergence check of this iteration has the smallest residuals of the solve so far,
+ where tau > kappa (relGap is NaN otherwise) */
+static void keepBest(Data * d, Work * w, const struct residuals * r) {
+	idxint l = d->n + d->m + 1;
+	pfloat res = MAX(MAX(r->resPri, r->resDual), r->relGap);
+	if (scs_isnan(r->relGap) || !(res < w->bestRes))
+		return;
+	if (!w->best && !(w->best = scs_malloc(2 * l * sizeof(pfloat))))
+		return; /* then the last iterate is returned */
+	w->bestRes = res;
+	memcpy(w->best, w->u, l * sizeof(pfloat));
+	memcpy(&(w->best[l]), w->v, l * sizeof(pfloat));
+}
+
+/* before setSolution of a solve stopped by TIME_LIMIT: the best iterate of keepBest, if any, replaces the last one,
+ which setSolution then returns as a solution, never as a certificate */
+static void timeoutIterate(Data * d, Work * w, Info * info) {
+	idxint l = d->n + d->m + 1;
+	if (w->bestRes < INFINITY) {
+		memcpy(w->u, w->best, l * sizeof(pfloat));
+		memcpy(w->v, &(w->best[l]), l * sizeof(pfloat));
+	}
+	info->statusVal = TIMEOUT;
+}
+
+/* marks a solve stopped by TIME_LIMIT, after setSolution and getInfo */
+static void timeout(Info * info) {
+	char * slash = strchr(info->status, '/');
+	if (slash)
+		*slash = '\0'; /* drop /Inaccurate */
+	memmove(&(info->status[8]), info->status, strlen(info->status) + 1);
+	memcpy(info->status, "Timeout/", 8);
+	info->statusVal = TIMEOUT;
+}
+
+static idxint solve(Work * w, Data * d, Cone * k, Sol * sol, Info * info) {
+	idxint i, linSysIters, timedOut = 0;
+	pfloat * uTmp, last, elapsed;
+	timer solveTimer, iterTimer;
 	struct residuals r;
 	if (!d || !k || !sol || !info || !w || !d->b || !d->c) {
 		scs_printf("ERROR: NULL input\n");
@@ -648,19 +964,51 @@ idxint scs_solve(Work * w, Data * d, Cone * k, Sol * sol, Info * info) {
 	}
 	tic(&solveTimer);
 	info->statusVal = 0; /* not yet converged */
+	info->resTraceLen = 0;
+	resetSolveProfile(&(info->prof));
 	updateWork(d, w, sol);
+	w->bestRes = INFINITY;
+	linSysIters = getLinSysIters(w->p);
 	if (d->VERBOSE)
 		printHeader(d, w, k);
+	/* the time limit is checked with the iteration times already taken for the profile, no extra clock reads */
+	elapsed = tocq(&solveTimer);
 	/* scs: */
 	for (i = 0; i < d->MAX_ITERS; ++i) {
-		memcpy(w->u_prev, w->u, (d->n + d->m + 1) * sizeof(pfloat));
+		tic(&iterTimer);
+		last = 0;
+		/* u_prev = u by swapping the buffers, projectCones overwrites all of u */
+		if (w->u_prev) {
+			uTmp = w->u_prev;
+			w->u_prev = w->u;
+			w->u = uTmp;
+		}
 
 		if (projectLinSys(d, w, i) < 0) return failureDefaultReturn(d, w, sol, info, "error in projectLinSys");
+		addPhaseTime(&iterTimer, &last, &(info->prof.linSysTime));
 		if (projectCones(d, w, k, i) < 0) return failureDefaultReturn(d, w, sol, info, "error in projectCones");
-		updateDualVars(d, w);
+		addPhaseTime(&iterTimer, &last, &(info->prof.coneTime));
 
-		if ((info->statusVal = converged(d, w, &r, i)) != 0)
+		info->statusVal = converged(d, w, &r, i, info);
+		if (d->TIME_LIMIT > 0 && info->statusVal == 0 && w->lastCheck == i)
+			keepBest(d, w, &r);
+		addPhaseTime(&iterTimer, &last, &(info->prof.convergedTime));
+		if (d->ADAPTIVE_RHO && info->statusVal == 0 && w->lastCheck == i) {
+			if (adaptRho(d, w, &r, i) < 0) return failureDefaultReturn(d, w, sol, info, "error in updateLinSys");
+			addPhaseTime(&iterTimer, &last, &(info->prof.linSysTime));
+		}
+		timedOut = info->statusVal == 0 && outOfTime(d, elapsed + last, i > 0 ? info->prof.avgIterTime : last);
+		if (info->statusVal != 0 || timedOut || (d->callback && w->lastCheck == i
+				&& d->callback(d->callbackData, i, &r, tocq(&solveTimer)))) {
+			addIterTime(&(info->prof), i, tocq(&iterTimer));
 			break;
+		}
+		/* the residuals above are of the plain step, the last iterate is never extrapolated */
+		if (w->accel && i < d->MAX_ITERS - 1)
+			accelerate(w->accel, w->u, w->v);
+		last = tocq(&iterTimer);
+		addIterTime(&(info->prof), i, last);
+		elapsed += last;
 
 		if (i % PRINT_INTERVAL == 0) {
 			if (d->VERBOSE) {
@@ -671,7 +1019,8 @@ idxint scs_solve(Work * w, Data * d, Cone * k, Sol * sol, Info * info) {
 				 scs_printf("Norm v = %4f, ", calcNorm(w->v, d->n + d->m + 1));
 				 scs_printf("tau = %4f, ", w->u[d->n + d->m]);
 				 scs_printf("kappa = %4f, ", w->v[d->n + d->m]);
-				 scs_printf("|u - u_prev| = %4f, ", calcNormDiff(w->u, w->u_prev, d->n + d->m + 1));
+				 if (w->u_prev)
+					 scs_printf("|u - u_prev| = %4f, ", calcNormDiff(w->u, w->u_prev, d->n + d->m + 1));
 				 scs_printf("|u - u_t| = %4f\n", calcNormDiff(w->u, w->u_t, d->n + d->m + 1));
 #endif
 			}
@@ -680,32 +1029,525 @@ idxint scs_solve(Work * w, Data * d, Cone * k, Sol * sol, Info * info) {
 	if (d->VERBOSE) {
 		printSummary(i, &r, &solveTimer);
 	}
+	if (timedOut)
+		timeoutIterate(d, w, info);
 	setSolution(d, w, sol, info);
 	/* populate info */
 	info->iter = i;
 	getInfo(d, w, sol, info);
+	if (timedOut)
+		timeout(info);
 	info->solveTime = tocq(&solveTimer);
+	info->linSysIters = getLinSysIters(w->p) - linSysIters;
 
 	if (d->VERBOSE)
 		printFooter(d, w, info);
-	/* un-normalize sol, b, c but not A */
+	/* un-normalize sol, b, c (A itself is never modified) */
+	if (d->NORMALIZE)
+		unNormalizeSolBC(d, w, sol);
+	return info->statusVal;
+}
+
+/* the iterates of one problem of a batch, swapped into Work (and d->b, d->c) while it is advanced */
+typedef struct {
+	pfloat *u, *v, *u_t, *u_prev, *h, *g;
+	pfloat *b, *c; /* copies of its columns of B and C, normalized in place */
+	pfloat gTh, sc_b, sc_c, nm_b, nm_c, objOffset;
+	idxint nextCheck;
+	Accel * accel;
+	idxint done;
+} BatchIterate;
+
+#define SWAP(type, a, b) { type tmp_ = (a); (a) = (b); (b) = tmp_; }
+
+/* exchanges the iterates in w and d with those of it, calling it again swaps them back */
+static void swapIterate(Data * d, Work * w, BatchIterate * it) {
+	SWAP(pfloat *, w->u, it->u);
+	SWAP(pfloat *, w->v, it->v);
+	SWAP(pfloat *, w->u_t, it->u_t);
+	SWAP(pfloat *, w->u_prev, it->u_prev);
+	SWAP(pfloat *, w->h, it->h);
+	SWAP(pfloat *, w->g, it->g);
+	SWAP(pfloat *, d->b, it->b);
+	SWAP(pfloat *, d->c, it->c);
+	SWAP(pfloat, w->gTh, it->gTh);
+	SWAP(pfloat, w->sc_b, it->sc_b);
+	SWAP(pfloat, w->sc_c, it->sc_c);
+	SWAP(pfloat, w->nm_b, it->nm_b);
+	SWAP(pfloat, w->nm_c, it->nm_c);
+	SWAP(pfloat, w->objOffset, it->objOffset);
+	SWAP(idxint, w->nextCheck, it->nextCheck);
+	SWAP(Accel *, w->accel, it->accel);
+}
+
+static void freeBatch(BatchIterate * its, idxint K) {
+	idxint j;
+	for (j = 0; j < K; ++j) {
+		if (its[j].u)
+			scs_free(its[j].u);
+		if (its[j].v)
+			scs_free(its[j].v);
+		if (its[j].u_t)
+			scs_free(its[j].u_t);
+		if (its[j].u_prev)
+			scs_free(its[j].u_prev);
+		if (its[j].h)
+			scs_free(its[j].h);
+		if (its[j].g)
+			scs_free(its[j].g);
+		if (its[j].b)
+			scs_free(its[j].b);
+		if (its[j].c)
+			scs_free(its[j].c);
+		freeAccel(its[j].accel);
+	}
+	scs_free(its);
+}
+
+static BatchIterate * initBatch(Data * d, idxint K, const pfloat * B, const pfloat * C, const pfloat * offsets) {
+	idxint j, l = d->n + d->m + 1;
+	BatchIterate * its = scs_calloc(K, sizeof(BatchIterate));
+	if (!its)
+		return NULL;
+	for (j = 0; j < K; ++j) {
+		its[j].u = scs_malloc(l * sizeof(pfloat));
+		its[j].v = scs_malloc(l * sizeof(pfloat));
+		its[j].u_t = scs_malloc(l * sizeof(pfloat));
+		its[j].u_prev = d->LOW_MEMORY ? NULL : scs_malloc(l * sizeof(pfloat));
+		its[j].h = scs_malloc((l - 1) * sizeof(pfloat));
+		its[j].g = scs_malloc((l - 1) * sizeof(pfloat));
+		its[j].b = scs_malloc(d->m * sizeof(pfloat));
+		its[j].c = scs_malloc(d->n * sizeof(pfloat));
+		if (!its[j].u || !its[j].v || !its[j].u_t || (!d->LOW_MEMORY && !its[j].u_prev) || !its[j].h || !its[j].g
+				|| !its[j].b || !its[j].c) {
+			freeBatch(its, K);
+			return NULL;
+		}
+		if (d->ACCEL_MEM > 0 && !(its[j].accel = initAccel(l, d->ACCEL_MEM))) {
+			freeBatch(its, K);
+			return NULL;
+		}
+		memcpy(its[j].b, &(B[j * d->m]), d->m * sizeof(pfloat));
+		memcpy(its[j].c, &(C[j * d->n]), d->n * sizeof(pfloat));
+		its[j].objOffset = offsets ? offsets[j] : 0;
+	}
+	return its;
+}
+
+/* as the end of scs_solve, for problem j which must be swapped in */
+static void finishBatchProblem(Data * d, Work * w, idxint j, Sol * sol, Info * info, idxint iter, timer * solveTimer,
+		idxint linSysIters, const Profile * prof, idxint timedOut) {
+	/* the last iterate, the batch keeps no best one */
+	if (timedOut)
+		info->statusVal = TIMEOUT;
+	setSolution(d, w, sol, info);
+	info->iter = iter;
+	getInfo(d, w, sol, info);
+	if (timedOut)
+		timeout(info);
+	info->solveTime = tocq(solveTimer);
+	/* the solves are shared, this is the work of the whole batch so far */
+	info->linSysIters = getLinSysIters(w->p) - linSysIters;
+	copySolveProfile(&(info->prof), prof);
 	if (d->NORMALIZE)
 		unNormalizeSolBC(d, w, sol);
+	if (d->VERBOSE) {
+		scs_printf("Problem %li: %s, iter %li, pobj %.4e, dobj %.4e, time %1.2es\n", (long) j, info->status,
+				(long) iter, info->pobj, info->dobj, info->solveTime / 1e3);
+	}
+}
+
+/* offsets, NULL for none, are the objOffset of each problem */
+static idxint solveBatch(Work * w, Data * d, Cone * k, idxint K, const pfloat * B, const pfloat * C,
+		const pfloat * offsets, Sol * sols, Info * infos) {
+	idxint i, j, nAct, nSolved = 0, l, linSysIters, timedOut = 0;
+	pfloat * uTmp, last, elapsed;
+	pfloat ** rhs;
+	const pfloat ** warm;
+	BatchIterate * its;
+	struct residuals r;
+	timer solveTimer, iterTimer;
+	Profile prof = { 0 }; /* of the whole batch */
+	if (!d || !k || !sols || !infos || !w || !B || !C || K <= 0) {
+		scs_printf("ERROR: NULL input\n");
+		return FAILURE;
+	}
+	tic(&solveTimer);
+	l = d->n + d->m + 1;
+	its = initBatch(d, K, B, C, offsets);
+	rhs = scs_malloc(K * sizeof(pfloat *));
+	warm = scs_malloc(K * sizeof(const pfloat *));
+	if (!its || !rhs || !warm) {
+		scs_printf("ERROR: batch memory allocation failure\n");
+		if (its)
+			freeBatch(its, K);
+		if (rhs)
+			scs_free(rhs);
+		if (warm)
+			scs_free(warm);
+		return FAILURE;
+	}
+	if (d->VERBOSE) {
+		scs_printf("Solving a batch of %li problems\n", (long) K);
+	}
+	for (j = 0; j < K; ++j) {
+		swapIterate(d, w, &(its[j]));
+		infos[j].statusVal = 0; /* not yet converged */
+		infos[j].resTraceLen = 0;
+		updateWork(d, w, &(sols[j]));
+		swapIterate(d, w, &(its[j]));
+	}
+	linSysIters = getLinSysIters(w->p);
+	elapsed = tocq(&solveTimer);
+	for (i = 0; i < d->MAX_ITERS; ++i) {
+		/* all unconverged problems take one step, sharing the linear system solve */
+		tic(&iterTimer);
+		last = 0;
+		nAct = 0;
+		for (j = 0; j < K; ++j) {
+			if (its[j].done)
+				continue;
+			if (its[j].u_prev) {
+				uTmp = its[j].u_prev;
+				its[j].u_prev = its[j].u;
+				its[j].u = uTmp;
+			}
+			swapIterate(d, w, &(its[j]));
+			formLinSysRhs(d, w);
+			swapIterate(d, w, &(its[j]));
+			rhs[nAct] = its[j].u_t;
+			warm[nAct] = its[j].u_prev ? its[j].u_prev : its[j].u;
+			nAct++;
+		}
+		if (nAct == 0)
+			break;
+		if (solveLinSysBatch(d, w->p, nAct, rhs, warm, i) < 0) {
+			for (j = 0; j < K; ++j) {
+				if (!its[j].done) {
+					failureDefaultReturn(d, w, &(sols[j]), &(infos[j]), "error in solveLinSysBatch");
+					its[j].done = 1;
+				}
+			}
+			break;
+		}
+		for (j = 0; j < K; ++j) {
+			if (its[j].done)
+				continue;
+			swapIterate(d, w, &(its[j]));
+			w->u_t[l - 1] += innerProd(w->u_t, w->h, l - 1);
+			addPhaseTime(&iterTimer, &last, &(prof.linSysTime));
+			if (projectCones(d, w, k, i) < 0) {
+				failureDefaultReturn(d, w, &(sols[j]), &(infos[j]), "error in projectCones");
+				its[j].done = 1;
+				swapIterate(d, w, &(its[j]));
+				continue;
+			}
+			addPhaseTime(&iterTimer, &last, &(prof.coneTime));
+			infos[j].statusVal = converged(d, w, &r, i, &(infos[j]));
+			addPhaseTime(&iterTimer, &last, &(prof.convergedTime));
+			if (infos[j].statusVal != 0) {
+				finishBatchProblem(d, w, j, &(sols[j]), &(infos[j]), i, &solveTimer, linSysIters, &prof, 0);
+				its[j].done = 1;
+			} else if (w->accel && i < d->MAX_ITERS - 1) {
+				accelerate(w->accel, w->u, w->v);
+			}
+			swapIterate(d, w, &(its[j]));
+			last = tocq(&iterTimer);
+		}
+		last = tocq(&iterTimer);
+		addIterTime(&prof, i, last);
+		elapsed += last;
+		/* the unconverged problems stop together, after a whole step */
+		if (outOfTime(d, elapsed, prof.avgIterTime)) {
+			timedOut = 1;
+			break;
+		}
+	}
+	for (j = 0; j < K; ++j) {
+		if (!its[j].done) {
+			swapIterate(d, w, &(its[j]));
+			finishBatchProblem(d, w, j, &(sols[j]), &(infos[j]), i, &solveTimer, linSysIters, &prof, timedOut);
+			swapIterate(d, w, &(its[j]));
+		}
+		if (infos[j].statusVal == SOLVED)
+			nSolved++;
+	}
+	freeBatch(its, K);
+	scs_free(rhs);
+	scs_free(warm);
+	return nSolved;
+}
+
+/* the status of the iterate returned, that after "Timeout/" if TIME_LIMIT was reached */
+static idxint iterateStatus(const Info * info) {
+	const char * status = &(info->status[8]);
+	if (info->statusVal != TIMEOUT)
+		return info->statusVal;
+	if (strncmp(status, "Solved", 6) == 0)
+		return SOLVED;
+	if (strncmp(status, "Infeasible", 10) == 0)
+		return INFEASIBLE;
+	if (strncmp(status, "Unbounded", 9) == 0)
+		return UNBOUNDED;
+	return INDETERMINATE;
+}
+
+/* info of a problem that presolveBC showed infeasible, with the certificate of postsolve */
+static void presolvedInfeasible(Info * info, pfloat solveTime) {
+	info->iter = 0;
+	strcpy(info->status, "Infeasible");
+	info->statusVal = INFEASIBLE;
+	info->pobj = NAN;
+	info->dobj = -1;
+	info->resPri = NAN;
+	info->resDual = 0;
+	info->relGap = NAN;
+	info->solveTime = solveTime;
+	info->linSysIters = 0;
+	info->resTraceLen = 0;
+	resetSolveProfile(&(info->prof));
+}
+
+/* with PRESOLVE: solves the reduced problem for the b and c of d and maps the solution back */
+static idxint solvePresolved(Work * w, Data * d, Cone * k, Sol * sol, Info * info) {
+	Presolve * pre = w->pre;
+	Data * rd;
+	idxint status;
+	timer solveTimer;
+	if (!d || !k || !sol || !info || !d->b || !d->c) {
+		scs_printf("ERROR: NULL input\n");
+		return FAILURE;
+	}
+	tic(&solveTimer);
+	rd = reducedData(pre, d);
+	status = presolveBC(pre, d, d->b, d->c, rd->b, rd->c);
+	if (status == FAILURE)
+		return failureDefaultReturn(d, NULL, sol, info, "b is nonzero on a row CHORDAL dropped, call scs_init again");
+	if (status == INFEASIBLE) {
+		postsolve(pre, d, d->b, d->c, NULL, sol, INFEASIBLE, info);
+		presolvedInfeasible(info, tocq(&solveTimer));
+		if (d->VERBOSE)
+			scs_printf("Presolve: row %li shows the problem is infeasible\n", (long) pre->infeasRow);
+		return info->statusVal;
+	}
+	if (d->WARM_START)
+		presolveSol(pre, sol, pre->sol);
+	w->objOffset = pre->cFix;
+	solve(w, rd, pre->k, pre->sol, info);
+	w->objOffset = 0;
+	d->RHO_X = rd->RHO_X; /* as left by ADAPTIVE_RHO */
+	postsolve(pre, d, d->b, d->c, pre->sol, sol, iterateStatus(info), info);
 	return info->statusVal;
 }
 
+/* with PRESOLVE: solves the reduced problems of the batch, those presolveBC shows infeasible are solved along
+ with the others (the batch shares the iterations) and then replaced by the certificate */
+static idxint solveBatchPresolved(Work * w, Data * d, Cone * k, idxint K, const pfloat * B, const pfloat * C,
+		Sol * sols, Info * infos) {
+	Presolve * pre = w->pre;
+	Data * rd;
+	idxint j, rm, rn, status, * infeasible;
+	pfloat * rB, * rC, * offsets;
+	Sol * rsols;
+	if (!d || !k || !sols || !infos || !B || !C || K <= 0) {
+		scs_printf("ERROR: NULL input\n");
+		return FAILURE;
+	}
+	rd = reducedData(pre, d);
+	rm = rd->m;
+	rn = rd->n;
+	rB = scs_malloc(K * rm * sizeof(pfloat));
+	rC = scs_malloc(K * rn * sizeof(pfloat));
+	offsets = scs_malloc(K * sizeof(pfloat));
+	rsols = scs_calloc(K, sizeof(Sol));
+	infeasible = scs_calloc(K, sizeof(idxint));
+	status = rB && rC && offsets && rsols && infeasible ? 0 : FAILURE;
+	if (status < 0)
+		scs_printf("ERROR: batch memory allocation failure\n");
+	for (j = 0; j < K && status == 0; ++j) {
+		infeasible[j] = presolveBC(pre, d, &(B[j * d->m]), &(C[j * d->n]), &(rB[j * rm]), &(rC[j * rn]));
+		if (infeasible[j] == FAILURE) {
+			scs_printf("ERROR: b of problem %li is nonzero on a row CHORDAL dropped\n", (long) j);
+			status = FAILURE;
+		}
+		offsets[j] = pre->cFix;
+		if (d->WARM_START)
+			presolveSol(pre, &(sols[j]), &(rsols[j]));
+	}
+	if (status == 0)
+		status = solveBatch(w, rd, pre->k, K, rB, rC, offsets, rsols, infos);
+	if (status >= 0) {
+		status = 0;
+		for (j = 0; j < K; ++j) {
+			/* again, for the fixed variables (or the certificate) of problem j */
+			presolveBC(pre, d, &(B[j * d->m]), &(C[j * d->n]), &(rB[j * rm]), &(rC[j * rn]));
+			postsolve(pre, d, &(B[j * d->m]), &(C[j * d->n]), &(rsols[j]), &(sols[j]), iterateStatus(&(infos[j])),
+					&(infos[j]));
+			if (infeasible[j])
+				presolvedInfeasible(&(infos[j]), infos[j].solveTime);
+			if (infos[j].statusVal == SOLVED)
+				status++;
+		}
+	}
+	for (j = 0; rsols && j < K; ++j) {
+		if (rsols[j].x)
+			scs_free(rsols[j].x);
+		if (rsols[j].y)
+			scs_free(rsols[j].y);
+		if (rsols[j].s)
+			scs_free(rsols[j].s);
+	}
+	if (rB)
+		scs_free(rB);
+	if (rC)
+		scs_free(rC);
+	if (offsets)
+		scs_free(offsets);
+	if (rsols)
+		scs_free(rsols);
+	if (infeasible)
+		scs_free(infeasible);
+	return status;
+}
+
+/* the calls on a workspace run with its arena (NULL without ARENA) as that of the thread, so scs_free skips the
+ memory of the arena and leaves it to arenaFree in scs_finish, and with its meter, which counts their memory */
+/* the memory of a solve of w that started with base bytes held, see Info */
+static void solveBytes(const Work * w, Info * info, ptrdiff_t base) {
+	info->workBytes = (pfloat) w->bytes;
+	info->solvePeakBytes = (pfloat) (w->bytes + (memPeak() - base));
+}
+
+idxint scs_solve(Work * w, Data * d, Cone * k, Sol * sol, Info * info) {
+	Meter * prevMeter = meterEnter(w ? w->meter : NULL);
+	ptrdiff_t base = memMark();
+	Arena * prev = arenaEnter(w ? w->arena : NULL);
+	idxint status = w && w->pre ? solvePresolved(w, d, k, sol, info) : solve(w, d, k, sol, info);
+	arenaLeave(prev);
+	if (w && info)
+		solveBytes(w, info, base);
+	meterLeave(prevMeter);
+	return status;
+}
+
+idxint scs_solve_batch(Work * w, Data * d, Cone * k, idxint K, const pfloat * B, const pfloat * C, Sol * sols,
+		Info * infos) {
+	Meter * prevMeter = meterEnter(w ? w->meter : NULL);
+	ptrdiff_t base = memMark();
+	idxint j;
+	Arena * prev = arenaEnter(w ? w->arena : NULL);
+	idxint status = w && w->pre ? solveBatchPresolved(w, d, k, K, B, C, sols, infos)
+			: solveBatch(w, d, k, K, B, C, NULL, sols, infos);
+	arenaLeave(prev);
+	/* the peak of the whole batch */
+	for (j = 0; w && infos && j < K; ++j)
+		solveBytes(w, &(infos[j]), base);
+	meterLeave(prevMeter);
+	return status;
+}
+
 void scs_finish(Data * d, Work * w) {
-	finishCone();
+	Arena * arena, * prev;
+	Meter * meter, * prevMeter;
 	if (w) {
-		if (d && d->NORMALIZE)
-			unNormalizeA(d, w);
-		freePriv(w->p);
-		freeWork(w);
+		arena = w->arena;
+		meter = w->meter;
+		prevMeter = meterEnter(meter);
+		prev = arenaEnter(arena);
+		finishWork(w);
+		arenaLeave(prev);
+#ifndef MATLAB_MEX_FILE
+		arenaFree(arena);
+#endif
+		meterLeave(prevMeter);
+		meterFree(meter);
+	}
+}
+
+static idxint updateA(Work * w, Data * d, Cone * k, const pfloat * Ax) {
+	timer updateTimer;
+	tic(&updateTimer);
+	setAMatrixValues(d, Ax);
+	if (w->pre) {
+		/* equal rows must still be equal and the fixing entries nonzero */
+		if (updatePresolve(w->pre, d) < 0) {
+			scs_printf("ERROR: the new A does not allow the reduction of PRESOLVE, call scs_init again\n");
+			return FAILURE;
+		}
+		k = w->pre->k;
+		d = reducedData(w->pre, d);
 	}
+	if (d->NORMALIZE) {
+		/* never d->scaling, that is of the previous A */
+		normalizeA(d, w, k);
+	}
+	if (updateLinSys(d, w->p) < 0) {
+		scs_printf("ERROR: updateLinSys failure\n");
+		return FAILURE;
+	}
+	if (d->VERBOSE) {
+		scs_printf("Update A time: %1.2es\n", tocq(&updateTimer) / 1e3);
+	}
+	return 0;
+}
+
+idxint scs_update_A(Work * w, Data * d, Cone * k, const pfloat * Ax) {
+	Arena * prev;
+	Meter * prevMeter;
+	idxint status;
+	if (!w || !d || !k || !Ax) {
+		scs_printf("ERROR: NULL input\n");
+		return FAILURE;
+	}
+	/* the memory it frees and allocates stays counted as the workspace's */
+	prevMeter = meterEnter(w->meter);
+	prev = arenaEnter(w->arena);
+	status = updateA(w, d, k, Ax);
+	arenaLeave(prev);
+	w->bytes = memHeld();
+	meterLeave(prevMeter);
+	return status;
 }
 
+idxint scs_get_scaling(const Work * w, const Data * d, Scaling * s) {
+	if (!w || !d || !s || !s->D || !s->E) {
+		scs_printf("ERROR: NULL input\n");
+		return FAILURE;
+	}
+	if (!w->D) {
+		scs_printf("ERROR: A is not normalized\n");
+		return FAILURE;
+	}
+	if (w->pre) {
+		scs_printf("ERROR: the normalization is of the A of PRESOLVE or CHORDAL\n");
+		return FAILURE;
+	}
+	memcpy(s->D, w->D, d->m * sizeof(pfloat));
+	memcpy(s->E, w->E, d->n * sizeof(pfloat));
+	s->meanNormRowA = w->meanNormRowA;
+	s->meanNormColA = w->meanNormColA;
+	return 0;
+}
+
+#ifndef MATLAB_MEX_FILE
+/* the first block of the arena of ARENA: the iterates, the normalization and the acceleration workspace, with
+ room for the cone workspace and the alignment of the allocations, the solvers reserve room for their own data
+ with scs_wreserve and more blocks are added if that is not enough */
+static size_t arenaGuess(Data * d, Cone * k) {
+	size_t l = d->m + d->n + 1, mem = d->ACCEL_MEM;
+	/* u_prev, pr and dr only without LOW_MEMORY */
+	size_t size = sizeof(Work) + (d->LOW_MEMORY ? 5 * l + d->m + d->n : 6 * l + 2 * (d->m + d->n)) * sizeof(pfloat);
+	if (mem > 0)
+		size += ((4 * mem + 10) * l + mem * (2 * mem + 2)) * sizeof(pfloat);
+	return size + (k->ep + k->ed + 2 * (k->qsize + k->ssize + k->spsize)) * sizeof(pfloat) + 4096;
+}
+#endif
+
 Work * scs_init(Data * d, Cone * k, Info * info) {
 	Work * w;
+	Presolve * pre;
+	Arena * arena = NULL, * prev;
+	Meter * meter = NULL, * prevMeter;
 	timer initTimer;
 	if (!d || !k || !info) {
 		scs_printf("ERROR: Missing Data, Cone or Info input\n");
@@ -722,11 +1564,72 @@ Work * scs_init(Data * d, Cone * k, Info * info) {
 	}
 #endif
 	tic(&initTimer);
-	w = initWork(d, k);
+	memset(&(info->prof), 0, sizeof(Profile));
+#ifndef MATLAB_MEX_FILE
+	if (!(meter = meterInit())) {
+		scs_printf("ERROR: allocating meter failure\n");
+		return NULL;
+	}
+#endif
+	/* counts the memory from here, the arena included */
+	prevMeter = meterEnter(meter);
+#ifndef MATLAB_MEX_FILE
+	if (d->ARENA && !(arena = arenaInit(arenaGuess(d, k)))) {
+		scs_printf("ERROR: allocating arena failure\n");
+		meterLeave(prevMeter);
+		meterFree(meter);
+		return NULL;
+	}
+#endif
+	/* the workspace allocations of initWork come from the arena */
+	prev = arenaEnter(arena);
+	/* a saved scaling is of the whole A, as PERM is of its rows */
+	pre = (d->PRESOLVE || d->CHORDAL) && !d->scaling && d->ORDERING != ORDER_USER ? initPresolve(d, k) : NULL;
+	if (pre && pre->rd && d->VERBOSE) {
+		scs_printf("Presolve: removed %li of %li rows and %li of %li variables\n", (long) (d->m - pre->rd->m),
+				(long) d->m, (long) (d->n - pre->rd->n), (long) d->n);
+	}
+	if (pre && pre->ch && d->VERBOSE) {
+		scs_printf("Chordal: split %li semidefinite cones into %li of size at most %li, %li rows and %li variables\n",
+				(long) pre->ch->nBlk, (long) pre->ch->nCl, (long) pre->ch->maxCl, (long) pre->d->m,
+				(long) pre->d->n);
+	}
+	w = initWork(pre ? reducedData(pre, d) : d, pre ? pre->k : k, info);
+	if (w) {
+		w->pre = pre;
+	} else {
+		freePresolve(pre);
+	}
+	arenaLeave(prev);
+#ifndef MATLAB_MEX_FILE
+	if (arena) {
+		arenaClose(arena);
+		if (w) {
+			w->arena = arena;
+		} else {
+			arenaFree(arena);
+		}
+	}
+#endif
 	/* strtoc("init", &initTimer); */
 	info->setupTime = tocq(&initTimer);
+	info->setupPeakBytes = (pfloat) memPeak();
+	info->workBytes = w ? (pfloat) (w->bytes = memHeld()) : 0;
+	meterLeave(prevMeter);
+	if (w) {
+		w->meter = meter;
+	} else {
+		meterFree(meter);
+	}
 	if (d->VERBOSE) {
 		scs_printf("Setup time: %1.2es\n", info->setupTime / 1e3);
+#ifndef MATLAB_MEX_FILE
+		if (w && w->arena) {
+			idxint nBlocks;
+			size_t used, size = arenaSize(w->arena, &nBlocks, &used);
+			scs_printf("Arena: %li bytes in %li blocks, %li used\n", (long) size, (long) nBlocks, (long) used);
+		}
+#endif
 	}
 	return w;
 }
@@ -55,6 +55,349 @@ pfloat tocq(timer* t)
 }
 #endif
 
+#ifndef MATLAB_MEX_FILE
+#if defined _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#elif defined __GNUC__
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL /* no thread local storage: ARENA and the accounting only from one thread at a time */
+#endif
+
+/* every arena allocation starts on a cache line */
+#define ARENA_ALIGN 64
+
+static void * stdMalloc(void * ctx, size_t size) {
+	return malloc(size);
+}
+
+static void * stdCalloc(void * ctx, size_t num, size_t size) {
+	return calloc(num, size);
+}
+
+static void stdFree(void * ctx, void * p) {
+	free(p);
+}
+
+static Allocator allocator = { stdMalloc, stdCalloc, stdFree, NULL };
+
+/* a block of an arena, its memory follows the header */
+typedef struct ARENA_BLOCK {
+	struct ARENA_BLOCK * next;
+	char * start; /* first aligned byte after the header */
+	size_t size, used;
+} ArenaBlock;
+
+struct ARENA {
+	ArenaBlock * blocks; /* newest first */
+	size_t size; /* of all blocks */
+	idxint nBlocks, open;
+};
+
+/* the arena of the workspace in use on this thread, NULL if none */
+static THREAD_LOCAL Arena * curArena = NULL;
+
+void scs_set_allocator(const Allocator * a) {
+	if (a) {
+		allocator = *a;
+	} else {
+		allocator.malloc = stdMalloc;
+		allocator.calloc = stdCalloc;
+		allocator.free = stdFree;
+		allocator.ctx = NULL;
+	}
+}
+
+/* the sizes of the allocations of the hooks made during the calls on one workspace, by address, for the memory
+ accounting of Info: an open addressing table rather than a header before each allocation, so scs_free may be given
+ memory of malloc (with the default allocator) as well */
+struct METER {
+	void ** keys; /* NULL for an empty slot */
+	size_t * sizes;
+	size_t cap, count; /* cap a power of two, 0 until the first allocation */
+	ptrdiff_t held, peak; /* bytes held and the most since memMark */
+};
+
+/* the meter of the workspace in use on this thread, NULL if none (the allocations are then not counted) */
+static THREAD_LOCAL Meter * curMeter = NULL;
+
+static size_t slotOf(const Meter * m, const void * p) {
+	return (size_t) (((unsigned long long) (size_t) p >> 4) * 0x9E3779B97F4A7C15ULL >> 17) & (m->cap - 1);
+}
+
+/* the slot of p, or the empty one it would go to */
+static size_t findSlot(const Meter * m, const void * p) {
+	size_t i = slotOf(m, p);
+	while (m->keys[i] && m->keys[i] != p)
+		i = (i + 1) & (m->cap - 1);
+	return i;
+}
+
+/* doubles the table (or makes the first), returns -1 if it could not */
+static idxint grow(Meter * m) {
+	size_t i, j, cap = m->cap, newCap = cap ? 2 * cap : 256;
+	void ** keys = m->keys;
+	size_t * sizes = m->sizes;
+	m->keys = allocator.calloc(allocator.ctx, newCap, sizeof(void *));
+	m->sizes = allocator.malloc(allocator.ctx, newCap * sizeof(size_t));
+	if (!m->keys || !m->sizes) {
+		if (m->keys)
+			allocator.free(allocator.ctx, m->keys);
+		if (m->sizes)
+			allocator.free(allocator.ctx, m->sizes);
+		m->keys = keys;
+		m->sizes = sizes;
+		return -1;
+	}
+	m->cap = newCap;
+	for (i = 0; i < cap; ++i) {
+		if (keys[i]) {
+			j = findSlot(m, keys[i]);
+			m->keys[j] = keys[i];
+			m->sizes[j] = sizes[i];
+		}
+	}
+	if (keys) {
+		allocator.free(allocator.ctx, keys);
+		allocator.free(allocator.ctx, sizes);
+	}
+	return 0;
+}
+
+static void * counted(void * p, size_t size) {
+	Meter * m = curMeter;
+	size_t i;
+	/* uncounted if the table cannot grow, the memory is still good */
+	if (!p || !m || (2 * (m->count + 1) > m->cap && grow(m) < 0))
+		return p;
+	i = findSlot(m, p);
+	if (m->keys[i]) {
+		/* the address of memory freed outside the calls on the workspace */
+		m->held -= m->sizes[i];
+	} else {
+		m->keys[i] = p;
+		m->count++;
+	}
+	m->sizes[i] = size;
+	m->held += size;
+	if (m->held > m->peak)
+		m->peak = m->held;
+	return p;
+}
+
+/* takes p out of the table of the meter in use, with backward shift deletion so no slot is left marked */
+static void uncount(void * p) {
+	Meter * m = curMeter;
+	size_t i, j, home;
+	if (!m || !m->count)
+		return;
+	i = findSlot(m, p);
+	if (!m->keys[i])
+		return;
+	m->held -= m->sizes[i];
+	m->count--;
+	for (j = (i + 1) & (m->cap - 1); m->keys[j]; j = (j + 1) & (m->cap - 1)) {
+		home = slotOf(m, m->keys[j]);
+		/* j may move to i if its home is not in (i, j] */
+		if ((i <= j) ? (home <= i || home > j) : (home <= i && home > j)) {
+			m->keys[i] = m->keys[j];
+			m->sizes[i] = m->sizes[j];
+			i = j;
+		}
+	}
+	m->keys[i] = NULL;
+}
+
+static void freeCounted(void * p) {
+	uncount(p);
+	allocator.free(allocator.ctx, p);
+}
+
+void * scs_hook_malloc(size_t size) {
+	return counted(allocator.malloc(allocator.ctx, size), size);
+}
+
+void * scs_hook_calloc(size_t num, size_t size) {
+	return counted(allocator.calloc(allocator.ctx, num, size), num * size);
+}
+
+void * scs_caller_malloc(size_t size) {
+	return allocator.malloc(allocator.ctx, size);
+}
+
+Meter * meterInit(void) {
+	return allocator.calloc(allocator.ctx, 1, sizeof(Meter));
+}
+
+Meter * meterEnter(Meter * m) {
+	Meter * prev = curMeter;
+	curMeter = m;
+	return prev;
+}
+
+void meterLeave(Meter * prev) {
+	curMeter = prev;
+}
+
+void meterFree(Meter * m) {
+	if (!m)
+		return;
+	if (m->keys) {
+		allocator.free(allocator.ctx, m->keys);
+		allocator.free(allocator.ctx, m->sizes);
+	}
+	allocator.free(allocator.ctx, m);
+}
+
+ptrdiff_t memMark(void) {
+	if (!curMeter)
+		return 0;
+	curMeter->peak = curMeter->held;
+	return curMeter->held;
+}
+
+ptrdiff_t memPeak(void) {
+	return curMeter ? curMeter->peak : 0;
+}
+
+ptrdiff_t memHeld(void) {
+	return curMeter ? curMeter->held : 0;
+}
+
+static idxint arenaOwns(const Arena * a, const void * p) {
+	const ArenaBlock * b;
+	for (b = a->blocks; b; b = b->next) {
+		if ((const char *) p >= b->start && (const char *) p < b->start + b->size)
+			return 1;
+	}
+	return 0;
+}
+
+void scs_hook_free(void * p) {
+	if (!p || (curArena && arenaOwns(curArena, p)))
+		return; /* arena memory goes with arenaFree */
+	freeCounted(p);
+}
+
+static ArenaBlock * addBlock(Arena * a, size_t size) {
+	ArenaBlock * b = scs_hook_malloc(sizeof(ArenaBlock) + size + ARENA_ALIGN);
+	if (!b)
+		return NULL;
+	b->start = (char *) b + sizeof(ArenaBlock);
+	b->start += (ARENA_ALIGN - (size_t) b->start % ARENA_ALIGN) % ARENA_ALIGN;
+	b->size = size;
+	b->used = 0;
+	b->next = a->blocks;
+	a->blocks = b;
+	a->size += size;
+	a->nBlocks++;
+	return b;
+}
+
+/* a block of a with room for size bytes, NULL if none */
+static ArenaBlock * findRoom(Arena * a, size_t size) {
+	ArenaBlock * b;
+	for (b = a->blocks; b; b = b->next) {
+		if (b->size - b->used >= size)
+			return b;
+	}
+	return NULL;
+}
+
+void * scs_wmalloc(size_t size) {
+	Arena * a = curArena;
+	ArenaBlock * b;
+	void * p;
+	if (!a || !a->open)
+		return scs_hook_malloc(size);
+	size = (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+	/* a block at least as large as the arena so far if none has room, so there are few */
+	if (!(b = findRoom(a, size)) && !(b = addBlock(a, MAX(size, a->size))))
+		return NULL;
+	p = b->start + b->used;
+	b->used += size;
+	return p;
+}
+
+void * scs_wcalloc(size_t num, size_t size) {
+	void * p;
+	if (!curArena || !curArena->open)
+		return scs_hook_calloc(num, size);
+	p = scs_wmalloc(num * size);
+	if (p)
+		memset(p, 0, num * size);
+	return p;
+}
+
+void scs_wreserve(size_t size) {
+	Arena * a = curArena;
+	/* slack for aligning a few allocations */
+	size += 8 * ARENA_ALIGN;
+	if (a && a->open && !findRoom(a, size))
+		addBlock(a, size); /* on failure scs_wmalloc fails later */
+}
+
+Arena * arenaInit(size_t size) {
+	Arena * a = scs_hook_calloc(1, sizeof(Arena));
+	if (!a)
+		return NULL;
+	if (!addBlock(a, size)) {
+		freeCounted(a);
+		return NULL;
+	}
+	a->open = 1;
+	return a;
+}
+
+Arena * arenaEnter(Arena * a) {
+	Arena * prev = curArena;
+	curArena = a;
+	return prev;
+}
+
+void arenaLeave(Arena * prev) {
+	curArena = prev;
+}
+
+void arenaClose(Arena * a) {
+	a->open = 0;
+}
+
+void arenaFree(Arena * a) {
+	ArenaBlock * b, * next;
+	if (!a)
+		return;
+	for (b = a->blocks; b; b = next) {
+		next = b->next;
+		freeCounted(b);
+	}
+	freeCounted(a);
+}
+
+size_t arenaSize(const Arena * a, idxint * nBlocks, size_t * used) {
+	const ArenaBlock * b;
+	*nBlocks = a->nBlocks;
+	*used = 0;
+	for (b = a->blocks; b; b = b->next) {
+		*used += b->used;
+	}
+	return a->size;
+}
+#else
+
+void * scs_mex_malloc(size_t size) {
+	void * p = mxMalloc(size);
+	mexMakeMemoryPersistent(p);
+	return p;
+}
+
+void * scs_mex_calloc(size_t num, size_t size) {
+	void * p = mxCalloc(num, size);
+	mexMakeMemoryPersistent(p);
+	return p;
+}
+#endif
+
 pfloat toc(timer * t) {
 	pfloat time = tocq(t);
 	scs_printf("time: %8.4f milli-seconds.\n", time);
@@ -81,6 +424,11 @@ void printConeData(Cone * k) {
 	for (i = 0; i < k->ssize; i++) {
 		scs_printf("%i\n", (int) k->s[i]);
 	}
+	scs_printf("num packed SDCs = %i\n", (int) k->spsize);
+	scs_printf("packed sdc array:\n");
+	for (i = 0; i < k->spsize; i++) {
+		scs_printf("%i\n", (int) k->sp[i]);
+	}
 	scs_printf("num ep = %i\n", (int) k->ep);
 	scs_printf("num ed = %i\n", (int) k->ed);
 }
@@ -109,11 +457,25 @@ void printData(Data * d) {
 	scs_printf("VERBOSE = %i\n", (int) d->VERBOSE);
 	scs_printf("NORMALIZE = %i\n", (int) d->NORMALIZE);
 	scs_printf("WARM_START = %i\n", (int) d->WARM_START);
+	scs_printf("STORE_TRANSPOSE = %i\n", (int) d->STORE_TRANSPOSE);
+	scs_printf("ACCEL_MEM = %i\n", (int) d->ACCEL_MEM);
+	scs_printf("MIXED_PRECISION = %i\n", (int) d->MIXED_PRECISION);
+	scs_printf("CG_ADAPTIVE = %i\n", (int) d->CG_ADAPTIVE);
+	scs_printf("CG_MAX_ITERS = %i\n", (int) d->CG_MAX_ITERS);
+	scs_printf("CG_PRECOND = %i\n", (int) d->CG_PRECOND);
+	scs_printf("NORMAL_EQS = %i\n", (int) d->NORMAL_EQS);
+	scs_printf("ADAPTIVE_RHO = %i\n", (int) d->ADAPTIVE_RHO);
+	scs_printf("ARENA = %i\n", (int) d->ARENA);
+	scs_printf("PRESOLVE = %i\n", (int) d->PRESOLVE);
+	scs_printf("CHORDAL = %i\n", (int) d->CHORDAL);
+	scs_printf("LOW_MEMORY = %i\n", (int) d->LOW_MEMORY);
+	scs_printf("ORDERING = %i\n", (int) d->ORDERING);
 	scs_printf("EPS = %4f\n", d->EPS);
 	scs_printf("ALPHA = %4f\n", d->ALPHA);
 	scs_printf("RHO_X = %4f\n", d->RHO_X);
 	scs_printf("CG_RATE = %4f\n", d->CG_RATE);
 	scs_printf("SCALE = %4f\n", d->SCALE);
+	scs_printf("TIME_LIMIT = %4f\n", d->TIME_LIMIT);
 }
 
 void printArray(pfloat * arr, idxint n, char * name) {